@@ -0,0 +1,75 @@
+# - Try to find the Ogg Vorbis decoding libraries
+# Once done this will define
+#
+#  VORBIS_FOUND - system has libvorbisfile
+#  VORBIS_INCLUDE_DIRS - the Vorbis include directory
+#  VORBIS_LIBRARIES - Link these to decode Vorbis files (vorbisfile, vorbis and ogg)
+#
+
+if (VORBIS_LIBRARIES AND VORBIS_INCLUDE_DIRS)
+  # in cache already
+  set(VORBIS_FOUND TRUE)
+else (VORBIS_LIBRARIES AND VORBIS_INCLUDE_DIRS)
+    find_path(VORBIS_INCLUDE_DIR
+      NAMES
+        vorbis/vorbisfile.h
+      PATHS
+        /usr/include
+        /usr/local/include
+        /opt/local/include
+        /sw/include
+    )
+
+    find_path(OGG_INCLUDE_DIR
+      NAMES
+        ogg/ogg.h
+      PATHS
+        /usr/include
+        /usr/local/include
+        /opt/local/include
+        /sw/include
+    )
+
+    foreach(LIB vorbisfile vorbis ogg)
+      string(TOUPPER ${LIB} LIBVAR)
+      find_library(${LIBVAR}_LIBRARY
+        NAMES
+          ${LIB}
+        PATHS
+          /usr/lib
+          /usr/local/lib
+          /opt/local/lib
+          /sw/lib
+      )
+    endforeach()
+
+    set(VORBIS_INCLUDE_DIRS
+      ${VORBIS_INCLUDE_DIR}
+      ${OGG_INCLUDE_DIR}
+    )
+
+    # order matters when linking statically
+    set(VORBIS_LIBRARIES
+      ${VORBISFILE_LIBRARY}
+      ${VORBIS_LIBRARY}
+      ${OGG_LIBRARY}
+    )
+
+    if (VORBIS_INCLUDE_DIR AND OGG_INCLUDE_DIR AND VORBISFILE_LIBRARY AND VORBIS_LIBRARY AND OGG_LIBRARY)
+       set(VORBIS_FOUND TRUE)
+    endif ()
+
+    if (VORBIS_FOUND)
+      if (NOT Vorbis_FIND_QUIETLY)
+        message(STATUS "Found Vorbis: ${VORBIS_LIBRARIES}")
+      endif (NOT Vorbis_FIND_QUIETLY)
+    else (VORBIS_FOUND)
+      if (Vorbis_FIND_REQUIRED)
+        message(FATAL_ERROR "Could not find Vorbis")
+      endif (Vorbis_FIND_REQUIRED)
+    endif (VORBIS_FOUND)
+
+  # show the VORBIS_INCLUDE_DIRS and VORBIS_LIBRARIES variables only in the advanced view
+  mark_as_advanced(VORBIS_INCLUDE_DIRS VORBIS_LIBRARIES)
+
+endif (VORBIS_LIBRARIES AND VORBIS_INCLUDE_DIRS)
@@ -0,0 +1,155 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+
+#pragma once
+
+#include "FlatResource.hpp"
+
+// Section records of the resources exported in the flat layout; ExportTools writes
+// them and the game views them in place, so any change here needs a new FlatVersion.
+namespace util
+{
+    // ROOM
+    constexpr uint32_t FlatRoomInfo = flat_tag("INFO");         // flat_room_info, one element
+    constexpr uint32_t FlatRoomLayer = flat_tag("LAYR");        // uint8_t, width*height
+    constexpr uint32_t FlatRoomObjects = flat_tag("OBJS");      // flat_room_object
+    constexpr uint32_t FlatRoomParameters = flat_tag("PRMS");   // uint8_t, the objects' parameter blobs
+    constexpr uint32_t FlatRoomWarps = flat_tag("WARP");        // flat_room_warp, indexed by warp id
+    constexpr uint32_t FlatRoomShapes = flat_tag("SHPS");       // flat_room_shape, optional
+    constexpr uint32_t FlatRoomShapePoints = flat_tag("SPTS");  // flat_point
+
+    struct flat_room_info
+    {
+        flat_string tilesetName;
+        uint32_t width, height;
+    };
+
+    struct flat_room_object
+    {
+        flat_string klass, name;
+        uint32_t parametersOffset, parametersLength;
+    };
+
+    struct flat_room_warp
+    {
+        int16_t c1, c2;
+        uint16_t roomId, warpId; // the direction is in the top two bits of warpId
+    };
+
+    struct flat_room_shape
+    {
+        uint8_t type, attribute, padding[2];
+        float radius;
+        uint32_t pointOffset, numPoints;
+        uint32_t x, y;
+        float waitTime, crumbleTime;
+        uint32_t crumblePieceSize;
+    };
+
+    struct flat_point
+    {
+        float x, y;
+    };
+
+    // TSET
+    constexpr uint32_t FlatTileSetInfo = flat_tag("INFO");          // flat_tileset_info, one element
+    constexpr uint32_t FlatTileSetTerrains = flat_tag("TERR");      // flat_terrain
+    constexpr uint32_t FlatTileSetObjects = flat_tag("SOBJ");       // flat_single_object
+    constexpr uint32_t FlatTileSetObjectShapes = flat_tag("OSHP");  // flat_object_shape
+    constexpr uint32_t FlatTileSetShapePoints = flat_tag("OPTS");   // flat_short_point
+    constexpr uint32_t FlatTileSetTiles = flat_tag("TILE");         // flat_tile_identity
+
+    struct flat_tileset_info
+    {
+        flat_string textureName;
+    };
+
+#pragma pack(push, 1)
+    struct flat_terrain
+    {
+        uint8_t attribute;
+        int16_t physicalParameters[5];
+    };
+#pragma pack(pop)
+
+    struct flat_single_object
+    {
+        uint8_t attribute, padding[3];
+        float waitTime, crumbleTime;
+        uint32_t crumblePieceSize;
+        uint32_t shapeOffset, shapeCount;
+    };
+
+    // Boxes are already converted to polygons
+    struct flat_object_shape
+    {
+        uint8_t type, padding;
+        int16_t radius;
+        uint32_t pointOffset, pointCount;
+    };
+
+    struct flat_short_point
+    {
+        int16_t x, y;
+    };
+
+    struct flat_tile_identity
+    {
+        uint8_t type, padding[3];
+        uint32_t id;
+    };
+
+    // LEVEL
+    constexpr uint32_t FlatLevelInfo = flat_tag("INFO");        // flat_level_info, one element
+    constexpr uint32_t FlatLevelRoomNames = flat_tag("RNAM");   // flat_string, indexed by room id
+
+    struct flat_level_info
+    {
+        uint16_t levelNumber, startingRoom;
+        uint8_t mapColor[4];
+        flat_string songName;
+    };
+
+    // PEMIT
+    constexpr uint32_t FlatEmitterNames = flat_tag("ENAM");     // flat_string
+    constexpr uint32_t FlatEmitters = flat_tag("EMIT");         // flat_particle_emitter, same order
+
+#pragma pack(push, 1)
+    struct flat_particle_emitter
+    {
+        uint8_t particleStyle;
+        float totalLifetime, emissionPeriod; // in seconds, infinite lifetime never ends
+        float emissionCenter[2], emissionHalfSize[2], acceleration[2];
+        float emissionInnerLimit;
+        float direction[3], speed[3], sizeBegin[3], sizeEnd[3]; // first, second, weight
+        float lifetime[2];
+        uint8_t colorBegin[2][4], colorEnd[2][4];
+        uint8_t generateHSV;
+    };
+#pragma pack(pop)
+
+    static_assert(sizeof(flat_room_warp) == 8 && sizeof(flat_room_shape) == 36 && sizeof(flat_terrain) == 11 &&
+        sizeof(flat_single_object) == 24 && sizeof(flat_object_shape) == 12 && sizeof(flat_tile_identity) == 8 &&
+        sizeof(flat_level_info) == 16 && sizeof(flat_particle_emitter) == 110, "Flat records must not have padding!");
+}
@@ -0,0 +1,263 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+
+// Shared between ExportTools and the game: a versioned layout made of a header, a
+// table of typed sections and the sections themselves, every one of them aligned so
+// the game can use them in place from the pack mapping instead of parsing a stream.
+namespace util
+{
+    constexpr uint32_t FlatVersion = 1;
+    constexpr size_t FlatAlignment = 16;
+
+    constexpr uint32_t flat_tag(const char (&tag)[5])
+    {
+        return (uint32_t)(uint8_t)tag[0] | (uint32_t)(uint8_t)tag[1] << 8 |
+               (uint32_t)(uint8_t)tag[2] << 16 | (uint32_t)(uint8_t)tag[3] << 24;
+    }
+
+    constexpr uint32_t FlatStringsSection = flat_tag("STRS");
+
+    struct flat_header
+    {
+        char magic[4];
+        char type[8];
+        uint32_t version;
+        uint32_t sectionCount;
+        uint32_t reserved[3];
+    };
+    static_assert(sizeof(flat_header) == 32, "flat_header must not have padding!");
+
+    struct flat_section
+    {
+        uint32_t id;
+        uint32_t elementSize;
+        uint64_t offset; // from the beginning of the header
+        uint64_t count;
+    };
+    static_assert(sizeof(flat_section) == 24, "flat_section must not have padding!");
+
+    // A reference into the string pool
+    struct flat_string
+    {
+        uint32_t offset, length;
+    };
+
+    template <typename T>
+    class flat_view
+    {
+        const T* elements = nullptr;
+        size_t count = 0;
+
+    public:
+        flat_view() {}
+        flat_view(const T* elements, size_t count) : elements(elements), count(count) {}
+
+        const T* begin() const { return elements; }
+        const T* end() const { return elements + count; }
+        const T* data() const { return elements; }
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+
+        const T& operator[](size_t i) const { return elements[i]; }
+
+        const T& at(size_t i) const
+        {
+            if (i >= count) throw std::out_of_range("Attempt to access element outside of bounds of the flat view!");
+            return elements[i];
+        }
+    };
+
+    class flat_reader
+    {
+        const char* base = nullptr;
+        size_t size = 0;
+        const flat_section* sections = nullptr;
+        size_t sectionCount = 0;
+        flat_view<char> strings;
+
+        const flat_section* find(uint32_t id) const
+        {
+            for (size_t i = 0; i < sectionCount; i++)
+                if (sections[i].id == id) return sections + i;
+            return nullptr;
+        }
+
+    public:
+        static bool isFlat(const void* data, size_t size)
+        {
+            return size >= sizeof(flat_header) && memcmp(data, "FLAT", 4) == 0;
+        }
+
+        // data must be aligned to FlatAlignment and outlive the reader and its views
+        bool open(const void* data, size_t size, const char* type)
+        {
+            if (!isFlat(data, size) || (uintptr_t)data % FlatAlignment != 0) return false;
+
+            flat_header header;
+            memcpy(&header, data, sizeof(flat_header));
+
+            char expectedType[sizeof(header.type)] = {};
+            strncpy(expectedType, type, sizeof(expectedType));
+            if (memcmp(header.type, expectedType, sizeof(expectedType)) != 0) return false;
+            if (header.version != FlatVersion) return false;
+
+            if (header.sectionCount > (size - sizeof(flat_header)) / sizeof(flat_section)) return false;
+
+            auto newSections = reinterpret_cast<const flat_section*>((const char*)data + sizeof(flat_header));
+            for (size_t i = 0; i < header.sectionCount; i++)
+            {
+                const auto& section = newSections[i];
+                if (section.offset % FlatAlignment != 0 || section.offset > size) return false;
+                if (section.elementSize == 0 ? section.count != 0
+                    : section.count > (size - section.offset) / section.elementSize) return false;
+            }
+
+            base = (const char*)data;
+            this->size = size;
+            sections = newSections;
+            sectionCount = header.sectionCount;
+            strings = flat_view<char>();
+            if (has(FlatStringsSection) && !get(FlatStringsSection, strings)) return false;
+
+            return true;
+        }
+
+        bool has(uint32_t id) const { return find(id) != nullptr; }
+
+        // Fails if the section is missing or holds elements of a different size
+        template <typename T>
+        bool get(uint32_t id, flat_view<T>& view) const
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Flat sections can only hold trivially copyable types!");
+            static_assert(FlatAlignment % alignof(T) == 0, "Flat sections are not aligned enough for this type!");
+
+            auto section = find(id);
+            if (!section || section->elementSize != sizeof(T)) return false;
+
+            view = flat_view<T>(reinterpret_cast<const T*>(base + section->offset), section->count);
+            return true;
+        }
+
+        bool get(flat_string str, std::string_view& view) const
+        {
+            if (str.offset > strings.size() || str.length > strings.size() - str.offset) return false;
+            view = std::string_view(strings.data() + str.offset, str.length);
+            return true;
+        }
+
+        bool get(flat_string str, std::string& out) const
+        {
+            std::string_view view;
+            if (!get(str, view)) return false;
+            out.assign(view.data(), view.size());
+            return true;
+        }
+    };
+
+    class flat_writer
+    {
+        struct pending_section
+        {
+            uint32_t id, elementSize;
+            uint64_t count;
+            std::string bytes;
+        };
+
+        char type[sizeof(flat_header::type)] = {};
+        std::vector<pending_section> sections;
+        std::string strings;
+
+    public:
+        explicit flat_writer(const char* type) { strncpy(this->type, type, sizeof(this->type)); }
+
+        void addSection(uint32_t id, uint32_t elementSize, size_t count, const void* data)
+        {
+            sections.push_back({ id, elementSize, count, std::string((const char*)data, elementSize * count) });
+        }
+
+        template <typename T>
+        void addSection(uint32_t id, const std::vector<T>& elements)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Flat sections can only hold trivially copyable types!");
+            addSection(id, sizeof(T), elements.size(), elements.data());
+        }
+
+        flat_string addString(std::string_view str)
+        {
+            flat_string result{ (uint32_t)strings.size(), (uint32_t)str.size() };
+            strings.append(str.data(), str.size());
+            return result;
+        }
+
+        void write(std::ostream& out) const
+        {
+            std::vector<const pending_section*> allSections;
+            for (const auto& section : sections) allSections.push_back(&section);
+
+            pending_section stringSection{ FlatStringsSection, 1, strings.size(), strings };
+            if (!strings.empty()) allSections.push_back(&stringSection);
+
+            auto align = [](uint64_t offset) { return (offset + FlatAlignment - 1) / FlatAlignment * FlatAlignment; };
+
+            flat_header header{};
+            memcpy(header.magic, "FLAT", 4);
+            memcpy(header.type, type, sizeof(type));
+            header.version = FlatVersion;
+            header.sectionCount = (uint32_t)allSections.size();
+
+            std::vector<flat_section> table;
+            uint64_t offset = align(sizeof(flat_header) + allSections.size() * sizeof(flat_section));
+            for (auto section : allSections)
+            {
+                table.push_back({ section->id, section->elementSize, offset, section->count });
+                offset = align(offset + section->bytes.size());
+            }
+
+            out.write((const char*)&header, sizeof(flat_header));
+            out.write((const char*)table.data(), table.size() * sizeof(flat_section));
+
+            uint64_t written = sizeof(flat_header) + table.size() * sizeof(flat_section);
+            static const char padding[FlatAlignment] = {};
+            for (size_t i = 0; i < allSections.size(); i++)
+            {
+                out.write(padding, table[i].offset - written);
+                out.write(allSections[i]->bytes.data(), allSections[i]->bytes.size());
+                written = table[i].offset + allSections[i]->bytes.size();
+            }
+            out.write(padding, align(written) - written);
+        }
+    };
+}
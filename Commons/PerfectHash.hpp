@@ -0,0 +1,68 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+// Shared between ExportTools and the game: the language exporter builds the
+// tables with these functions and the game probes them with the same ones, so
+// any change here is a change to the .lang file format.
+namespace util
+{
+    constexpr uint64_t fnv1a64(const char* str, size_t size)
+    {
+        // The empty key maps to zero so a default hash can mean "no key"
+        if (size == 0) return 0;
+
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= (uint8_t)str[i];
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    constexpr uint64_t mixHash(uint64_t x)
+    {
+        x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ull;
+        x ^= x >> 27; x *= 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+
+    // Hash-and-displace minimal perfect hashing: keys are first split into
+    // buckets, then every bucket gets a displacement that sends all of its
+    // keys to distinct free slots
+    constexpr size_t perfectHashBucket(uint64_t key, size_t numBuckets)
+    {
+        return (size_t)((key >> 32) % numBuckets);
+    }
+
+    constexpr size_t perfectHashSlot(uint64_t key, uint32_t displacement, size_t numSlots)
+    {
+        return (size_t)(mixHash(key + displacement * 0x9e3779b97f4a7c15ull) % numSlots);
+    }
+}
@@ -0,0 +1,224 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+// The segmentation that turns the terrain tiles of a room's main layer into collision
+// segments; the game runs it for rooms without baked shapes and ExportTools bakes them
+// with it, so both always agree. Tiles adapts a tileset and must provide:
+//   TileType and Attribute, enums with the enumerators of TileSet::TileType and TileSet::Attribute
+//   identity(tile), with the tile's type and id
+//   attribute(tile), the tile's Attribute
+//   isTerrain(type), isSemiTerrain(type), isIdHorizontalSemiTerrain(id), isIdVerticalSemiTerrain(id)
+//   and refersToSame(identity1, identity2), as in TileSet
+namespace util
+{
+    enum class RoomSegmentEnd { TerrainBoundary, TerrainAnkle, TerrainCorner, LevelEdge };
+
+    struct RoomSegment
+    {
+        RoomSegmentEnd end1, end2;
+        bool isOtherEnd;
+        bool isSemiTerrain;
+        size_t terrain, j, i1, i2;
+    };
+
+    // Where a segment lies, in pixels: from i1 to i2 along it, at j across it
+    struct RoomSegmentCoordinates { float i1, i2, j; };
+
+    namespace detail
+    {
+        template <typename T>
+        constexpr bool isOneOf(T) { return false; }
+
+        template <typename T, typename U, typename... Us>
+        constexpr bool isOneOf(T comp, U first, Us... next) { return comp == first || isOneOf(comp, next...); }
+    }
+
+    // Horizontal segments run along x, one row of tiles j at a time; vertical ones along y
+    template <bool Vertical, typename Tiles, typename Layer>
+    void generateRoomSegments(std::vector<RoomSegment>& segments, const Tiles& tiles, const Layer& layer,
+        size_t width, size_t height)
+    {
+        using TT = typename Tiles::TileType;
+        using At = typename Tiles::Attribute;
+        using detail::isOneOf;
+
+        auto terrainCanMakeNewSegment = [](auto type)
+        {
+            return isOneOf(type, TT::TerrainUpperLeft, TT::TerrainUpperRight, TT::TerrainLowerLeft,
+                TT::TerrainLowerRight, Vertical ? TT::TerrainLeft : TT::TerrainUp,
+                Vertical ? TT::TerrainRight : TT::TerrainDown);
+        };
+
+        auto isCornerTerrain = [](auto type)
+        {
+            return isOneOf(type, TT::TerrainUpperLeft, Vertical ? TT::TerrainUpperRight : TT::TerrainLowerLeft);
+        };
+
+        auto isTerrainOtherEnd = [](auto type)
+        {
+            return isOneOf(type, TT::TerrainLowerRight, Vertical ? TT::TerrainUpperRight : TT::TerrainLowerLeft,
+                Vertical ? TT::TerrainRight : TT::TerrainDown);
+        };
+
+        auto isTerrainSegmentCorner = [](auto type)
+        {
+            return isOneOf(type, TT::TerrainLowerRight, Vertical ? TT::TerrainLowerLeft : TT::TerrainUpperRight);
+        };
+
+        auto getViableContinuation = [](bool semiterrain, bool otherEnd)
+        {
+            if (semiterrain) return TT::SemiTerrain2;
+            else if (otherEnd) return Vertical ? TT::TerrainRight : TT::TerrainDown;
+            else return Vertical ? TT::TerrainLeft : TT::TerrainUp;
+        };
+
+        auto jSize = Vertical ? width : height;
+        auto iSize = Vertical ? height : width;
+
+        RoomSegment curSegment;
+        bool newSegment = false;
+        for (size_t j = 0; j < jSize; j++)
+        {
+            decltype(&tiles.identity(layer(0, 0))) lastIdentity = nullptr;
+            for (size_t i = 0; i < iSize; i++)
+            {
+                auto curTile = Vertical ? layer(j, i) : layer(i, j);
+                const auto& identity = tiles.identity(curTile);
+
+                bool isViableSemiTerrain = Tiles::isSemiTerrain(identity.type) &&
+                    (Vertical ? Tiles::isIdHorizontalSemiTerrain(identity.id) :
+                                Tiles::isIdVerticalSemiTerrain(identity.id));
+                auto terrainAttr = tiles.attribute(curTile);
+
+                if (Tiles::isTerrain(identity.type) || isViableSemiTerrain)
+                {
+                    if (newSegment && !Tiles::refersToSame(*lastIdentity, identity))
+                    {
+                        curSegment.i2 = i-1;
+                        curSegment.end2 = RoomSegmentEnd::TerrainBoundary;
+                        segments.push_back(curSegment);
+                        newSegment = false;
+                    }
+
+                repeatNewSegmentPhase: // People will spank me, but...
+                    if (!newSegment && (isViableSemiTerrain || terrainCanMakeNewSegment(identity.type)))
+                    {
+                        bool isTerrainCorner = isViableSemiTerrain ? identity.type == TT::SemiTerrain1 :
+                            isCornerTerrain(identity.type);
+                        bool isOtherEnd = isViableSemiTerrain ?
+                            (Vertical ? isOneOf(terrainAttr, At::RightSolid, At::RightNoWalljump) :
+                            terrainAttr == At::DownSolid) : isTerrainOtherEnd(identity.type);
+
+                        newSegment = true;
+                        curSegment.j = j;
+                        curSegment.i1 = i;
+                        curSegment.end1 = isTerrainCorner ? RoomSegmentEnd::TerrainCorner :
+                            i == 0 ? RoomSegmentEnd::LevelEdge :
+                            Tiles::refersToSame(*lastIdentity, identity) ? RoomSegmentEnd::TerrainAnkle :
+                            RoomSegmentEnd::TerrainBoundary;
+                        curSegment.isOtherEnd = isOtherEnd;
+
+                        curSegment.isSemiTerrain = isViableSemiTerrain;
+                        curSegment.terrain = identity.id;
+
+                        if (isTerrainCorner) goto skipSegmentTermination;
+                    }
+
+                    if (newSegment && identity.type != getViableContinuation(isViableSemiTerrain, curSegment.isOtherEnd))
+                    {
+                        bool isTerrainCorner = isViableSemiTerrain ? identity.type == TT::SemiTerrain3 :
+                            isTerrainSegmentCorner(identity.type);
+
+                        curSegment.i2 = isTerrainCorner ? i : i-1;
+                        curSegment.end2 = isTerrainCorner ? RoomSegmentEnd::TerrainCorner : RoomSegmentEnd::TerrainAnkle;
+                        segments.push_back(curSegment);
+                        newSegment = false;
+
+                        bool isNewTerrainCorner = isViableSemiTerrain ? identity.type == TT::SemiTerrain1 :
+                            isCornerTerrain(identity.type);
+                        // In order to avoid code duplication
+                        if (isNewTerrainCorner) goto repeatNewSegmentPhase;
+                    }
+                }
+                else if (newSegment)
+                {
+                    curSegment.i2 = i-1;
+                    curSegment.end2 = RoomSegmentEnd::TerrainBoundary;
+                    segments.push_back(curSegment);
+                    newSegment = false;
+                }
+
+            skipSegmentTermination:
+                lastIdentity = &identity;
+            }
+
+            if (newSegment)
+            {
+                curSegment.i2 = iSize-1;
+                curSegment.end2 = RoomSegmentEnd::LevelEdge;
+                segments.push_back(curSegment);
+                newSegment = false;
+            }
+        }
+    }
+
+    // The offsets are the terrain's physical parameters, which pull the segment into its tiles
+    template <bool Vertical>
+    RoomSegmentCoordinates getRoomSegmentCoordinates(const RoomSegment& segment, float tileSize, float upperOffset,
+        float lowerOffset, float leftOffset, float rightOffset, float cornerRadius)
+    {
+        auto perpnOffset = Vertical ? upperOffset : leftOffset,
+             perppOffset = Vertical ? lowerOffset : rightOffset,
+             parnOffset  = Vertical ? leftOffset  : upperOffset,
+             parpOffset  = Vertical ? rightOffset : lowerOffset;
+
+        RoomSegmentCoordinates coords;
+        coords.j = tileSize * segment.j + (segment.isOtherEnd ? tileSize + perpnOffset - cornerRadius
+                                                              : -perppOffset + cornerRadius);
+
+        coords.i1 = tileSize * segment.i1;
+        switch (segment.end1)
+        {
+            case RoomSegmentEnd::LevelEdge: coords.i1 -= tileSize; break;
+            case RoomSegmentEnd::TerrainAnkle: coords.i1 += parpOffset - cornerRadius; break;
+            case RoomSegmentEnd::TerrainCorner: coords.i1 -= parnOffset - cornerRadius; break;
+            default: break;
+        }
+
+        coords.i2 = tileSize * (segment.i2+1);
+        switch (segment.end2)
+        {
+            case RoomSegmentEnd::LevelEdge: coords.i2 += tileSize; break;
+            case RoomSegmentEnd::TerrainAnkle: coords.i2 -= parnOffset - cornerRadius; break;
+            case RoomSegmentEnd::TerrainCorner: coords.i2 += parpOffset - cornerRadius; break;
+            default: break;
+        }
+
+        return coords;
+    }
+}
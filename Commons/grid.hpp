@@ -187,7 +187,7 @@ namespace util
     public:
         grid() noexcept : _width(0), _height(0), elements(nullptr) {}
         grid(size_t w, size_t h) : _width(w), _height(h), elements(new T[w*h]) {}
-        grid(size_t w, size_t h, T* contents) : grid(w, h)
+        grid(size_t w, size_t h, const T* contents) : grid(w, h)
         {
             std::copy(contents, contents+(w*h), elements);
         }
@@ -275,6 +275,37 @@ namespace util
         bool empty() const { return _width == 0 || _height == 0; }
     };
 
+    // A read-only grid over contiguous elements owned by someone else, like a section of a flat resource
+    template <typename T>
+    class grid_view final
+    {
+        const T* elements;
+        size_t _width, _height;
+
+    public:
+        grid_view() noexcept : elements(nullptr), _width(0), _height(0) {}
+        grid_view(const T* elements, size_t w, size_t h) noexcept : elements(elements), _width(w), _height(h) {}
+        grid_view(const grid<T>& g) noexcept : grid_view(g.data(), g.width(), g.height()) {}
+
+        const T& operator()(size_t i, size_t j) const { return elements[j*_width+i]; }
+
+        const T& at(size_t i, size_t j) const
+        {
+            if (i >= _width || j >= _height)
+                throw std::out_of_range("Attempt to access element outside of bounds of the grid!");
+            return operator()(i, j);
+        }
+
+        const T* data() const { return elements; }
+        const T* begin() const { return elements; }
+        const T* end() const { return elements+(_width*_height); }
+
+        size_t width() const { return _width; }
+        size_t height() const { return _height; }
+
+        bool empty() const { return _width == 0 || _height == 0; }
+    };
+
     template <typename T>
     typename grid<T>::view::iterator& operator+(intmax_t val, typename grid<T>::view::iterator &it)
     {
@@ -1,7 +1,6 @@
 #ifndef CHIPMUNK_ARBITER_H
 #define CHIPMUNK_ARBITER_H
 
-#include "Body.h"
 #include <chipmunk/chipmunk.h>
 
 namespace cp
@@ -9,11 +8,11 @@ namespace cp
     class Arbiter
     {
     public:
-        Arbiter(cpArbiter*);
-        cpBody* getBodyA();
-        cpBody* getBodyB();
-        cpShape* getShapeA();
-        cpShape* getShapeB();
+        Arbiter(cpArbiter* a) : arbiter(a) {}
+        cpBody* getBodyA() { cpBody *a, *b; cpArbiterGetBodies(arbiter, &a, &b); return a; }
+        cpBody* getBodyB() { cpBody *a, *b; cpArbiterGetBodies(arbiter, &a, &b); return b; }
+        cpShape* getShapeA() { cpShape *a, *b; cpArbiterGetShapes(arbiter, &a, &b); return a; }
+        cpShape* getShapeB() { cpShape *a, *b; cpArbiterGetShapes(arbiter, &a, &b); return b; }
 
         cpFloat getRestitution() const { return cpArbiterGetRestitution(arbiter); }
         void setRestitution(cpFloat value) { cpArbiterSetRestitution(arbiter, value); }
@@ -41,4 +40,6 @@ namespace cp
     };
 }
 
+#include "Body.h"
+
 #endif /* CHIPMUNK_ARBITER_H */
@@ -4,14 +4,14 @@
 #include <chipmunk/chipmunk.h>
 #include <memory>
 #include <functional>
+#include "Arbiter.h"
 
 namespace cp
 {
     class Shape;
     class Space;
-    class Arbiter;
     
-    class Body
+    class Body : public std::enable_shared_from_this<Body>
     {
     public:
         static const struct StaticTag {} Static;
@@ -25,6 +25,9 @@ namespace cp
         ~Body();
         operator cpBody*() const;
 
+        /// The wrapper of a Chipmunk body, which keeps a pointer back to it in its user data.
+        static inline Body* of(const cpBody* body) { return body ? static_cast<Body*>(cpBodyGetUserData(body)) : nullptr; };
+
         /// Wake up a sleeping or idle body.
         inline void activate() { cpBodyActivate(_body); };
         /// Wake up any sleeping or idle bodies touching a static body.
@@ -92,9 +95,9 @@ namespace cp
         inline cpVect getRotation() const { return cpBodyGetRotation(_body); };
         
         /// Get the user data pointer assigned to the body.
-        inline cpDataPointer getUserData() const { return cpBodyGetUserData(_body); }
+        inline cpDataPointer getUserData() const { return _userData; }
         /// Set the user data pointer assigned to the body.
-        inline void setUserData(cpDataPointer data) { cpBodySetUserData(_body, data); }
+        inline void setUserData(cpDataPointer data) { _userData = data; }
 
         /// Default velocity integration function..
         void updateVelocity(cpVect gravity, cpFloat damping, cpFloat dt) { cpBodyUpdateVelocity(_body, gravity, damping, dt); };
@@ -125,10 +128,18 @@ namespace cp
         inline cpFloat kineticEnergy() { return cpBodyKineticEnergy(_body); };
 
         /// Iterate through all arbiters
-        void eachArbiter(std::function<void(Arbiter)> func);
+        template <typename Func>
+        void eachArbiter(Func func)
+        {
+            cpBodyEachArbiter(_body, [](cpBody* body, cpArbiter* arbiter, void* data)
+            {
+                (*(Func*)data)(Arbiter(arbiter));
+            }, (void*)&func);
+        }
 
     protected:
         cpBody* _body;
+        cpDataPointer _userData;
         bool _dirty;
         
     private:
@@ -10,11 +10,14 @@ namespace cp
     class Space;
     class BoundingBox;
     
-    class Shape
+    class Shape : public std::enable_shared_from_this<Shape>
     {
     public:
         virtual ~Shape();
         operator cpShape*() const;
+
+        /// The wrapper of a Chipmunk shape, which keeps a pointer back to it in its user data.
+        static inline Shape* of(const cpShape* shape) { return shape ? static_cast<Shape*>(cpShapeGetUserData(shape)) : nullptr; };
         
         /// Update, cache and return the bounding box of a shape based on the body it's attached to.
         BoundingBox cacheBoundingBox();
@@ -79,9 +82,9 @@ namespace cp
         inline void setSurfaceVelocity(cpVect surfaceVelocity) { cpShapeSetSurfaceVelocity(_shape, surfaceVelocity); }
 
         /// Get the user definable data pointer of this shape.
-        inline cpDataPointer getUserData() { return cpShapeGetUserData(_shape); };
+        inline cpDataPointer getUserData() { return _userData; };
         /// Set the user definable data pointer of this shape.
-        inline void setUserData(cpDataPointer data) { cpShapeSetUserData(_shape, data); };
+        inline void setUserData(cpDataPointer data) { _userData = data; };
 
         /// Set the collision type of this shape.
         inline cpCollisionType getCollisionType() const { return cpShapeGetCollisionType(_shape); };
@@ -98,6 +101,7 @@ namespace cp
         cpShape* _shape;
         
         std::shared_ptr<Body> _body;
+        cpDataPointer _userData;
     private:
         Shape(const Shape&);
         const Shape& operator=(const Shape&);
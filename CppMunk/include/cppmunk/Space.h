@@ -3,6 +3,7 @@
 
 #include <chipmunk/chipmunk.h>
 #include "LayerMask.h"
+#include "Arbiter.h"
 #include <functional>
 #include <memory>
 #include <vector>
@@ -12,7 +13,6 @@
 namespace cp
 {
     class Body;
-    class Arbiter;
 
     class Constraint;
     class Shape;
@@ -23,6 +23,9 @@ namespace cp
     class Space
     {
     public:
+        /// Spatial index used for the shapes attached to static bodies.
+        enum class StaticIndex { BoundingBoxTree, SpatialHash };
+        
         Space();
         explicit Space(cpSpace*);
         ~Space();
@@ -90,19 +93,25 @@ namespace cp
         inline cpBool isLocked() { return cpSpaceIsLocked(_space); };
 
         /// Create a collision handler for the specified pair of collision types.
+        /// The callbacks take (Arbiter, Space&) and can be function pointers or lambdas; they are stored
+        /// by value and called straight from Chipmunk, without going through std::function.
         /// If wildcard handlers are used with either of the collision types, it's the responibility of the custom handler to invoke the wildcard handlers.
+        template <typename Begin, typename PreSolve, typename PostSolve, typename Separate>
         void addCollisionHandler(cpCollisionType a, cpCollisionType b,
-                                 std::function<int(Arbiter, Space&)> begin,
-                                 std::function<int(Arbiter, Space&)> preSolve,
-                                 std::function<void(Arbiter, Space&)> postSolve,
-                                 std::function<void(Arbiter, Space&)> separate);
+                                 Begin begin, PreSolve preSolve, PostSolve postSolve, Separate separate)
+        {
+            setupCollisionHandler(cpSpaceAddCollisionHandler(_space, a, b), callbackDatas[std::make_pair(a, b)],
+                                  std::move(begin), std::move(preSolve), std::move(postSolve), std::move(separate));
+        }
 
         /// Create a wildcard collision handler for the specified collision type.
+        template <typename Begin, typename PreSolve, typename PostSolve, typename Separate>
         void addWildcardCollisionHandler(cpCollisionType a,
-                                         std::function<int(Arbiter, Space&)> begin,
-                                         std::function<int(Arbiter, Space&)> preSolve,
-                                         std::function<void(Arbiter, Space&)> postSolve,
-                                         std::function<void(Arbiter, Space&)> separate);
+                                         Begin begin, PreSolve preSolve, PostSolve postSolve, Separate separate)
+        {
+            setupCollisionHandler(cpSpaceAddWildcardHandler(_space, a), wildcardCallbackDatas[a],
+                                  std::move(begin), std::move(preSolve), std::move(postSolve), std::move(separate));
+        }
         
         /// Add a collision shape to the simulation.
         /// If the shape is attached to a static body, it will be added as a static shape.
@@ -111,13 +120,19 @@ namespace cp
         void add(std::shared_ptr<Body>);
         /// Add a constraint to the simulation.
         void add(std::shared_ptr<Constraint>);
+        /// Add a batch of collision shapes to the simulation.
+        /// If any of them is static and the static index is a tree, the tree is rebuilt once at the end.
+        void add(const std::vector<std::shared_ptr<Shape>>&);
 
         /// Remove a collision shape from the simulation.
+        /// Static shapes are taken out of the static index directly, there is no need to reindex their body.
         void remove(std::shared_ptr<Shape>);
         /// Remove a rigid body from the simulation.
         void remove(std::shared_ptr<Body>);
         /// Remove a constraint from the simulation.
         void remove(std::shared_ptr<Constraint>);
+        /// Remove a batch of collision shapes from the simulation.
+        void remove(const std::vector<std::shared_ptr<Shape>>&);
 
         bool contains(std::shared_ptr<Shape>);
         bool contains(std::shared_ptr<Body>);
@@ -133,6 +148,12 @@ namespace cp
         /// Perform a directed line segment query (like a raycast) against the space and return the first shape hit. Returns NULL if no shapes were hit.
         std::shared_ptr<Shape> segmentQueryFirst(cpVect a, cpVect b, LayerMask, cpGroup, cpSegmentQueryInfo* = nullptr) const;
 
+        /// Replace the index of the static shapes, keeping the shapes already in it.
+        /// A spatial hash suits uniform geometry like tiles: @c cellSize should be about the size of a tile
+        /// and @c count about the number of static shapes. Both are ignored by the bounding box tree.
+        void useStaticIndex(StaticIndex index, cpFloat cellSize = 0, int count = 0);
+        inline StaticIndex getStaticIndex() const { return _staticIndex; };
+
         /// Update the collision detection info for the static shapes in the space.
         void reindexStatic() { cpSpaceReindexStatic(_space); };
         /// Update the collision detection data for a specific shape in the space.
@@ -166,30 +187,72 @@ namespace cp
         std::unordered_map<cpShape*, std::shared_ptr<Shape>> _shapes;
         std::unordered_map<cpBody*, std::shared_ptr<Body>> _bodies;
         std::unordered_map<cpConstraint*, std::shared_ptr<Constraint>> _constraints;
+        StaticIndex _staticIndex;
+
+        struct CallbackDataBase
+        {
+            virtual ~CallbackDataBase() {}
+        };
 
-        struct CallbackData
+        // Chipmunk's handler gets a pointer to this as its user data and calls the static helpers,
+        // which know the types of the callbacks
+        template <typename Begin, typename PreSolve, typename PostSolve, typename Separate>
+        struct CallbackData final : CallbackDataBase
         {
-            std::function<int(Arbiter, Space&)> begin;
-            std::function<int(Arbiter, Space&)> preSolve;
-            std::function<void(Arbiter, Space&)> postSolve;
-            std::function<void(Arbiter, Space&)> separate;
+            Begin begin;
+            PreSolve preSolve;
+            PostSolve postSolve;
+            Separate separate;
             Space* self;
             
-            CallbackData(std::function<int(Arbiter, Space&)> begin, std::function<int(Arbiter, Space&)> preSolve,
-                         std::function<void(Arbiter, Space&)> postSolve, std::function<void(Arbiter, Space&)> separate,
-                         Space& self)
-            : begin(begin), preSolve(preSolve), postSolve(postSolve), separate(separate), self(&self)
+            CallbackData(Begin begin, PreSolve preSolve, PostSolve postSolve, Separate separate, Space& self)
+            : begin(std::move(begin)), preSolve(std::move(preSolve)), postSolve(std::move(postSolve)),
+            separate(std::move(separate)), self(&self)
             {}
-            CallbackData() {}
+            
+            static cpBool helperBegin(cpArbiter* arb, cpSpace* s, void* d)
+            {
+                auto& data = *static_cast<CallbackData*>(d);
+                return data.begin(Arbiter(arb), *data.self);
+            }
+            
+            static cpBool helperPreSolve(cpArbiter* arb, cpSpace* s, void* d)
+            {
+                auto& data = *static_cast<CallbackData*>(d);
+                return data.preSolve(Arbiter(arb), *data.self);
+            }
+            
+            static void helperPostSolve(cpArbiter* arb, cpSpace* s, void* d)
+            {
+                auto& data = *static_cast<CallbackData*>(d);
+                data.postSolve(Arbiter(arb), *data.self);
+            }
+            
+            static void helperSeparate(cpArbiter* arb, cpSpace* s, void* d)
+            {
+                auto& data = *static_cast<CallbackData*>(d);
+                data.separate(Arbiter(arb), *data.self);
+            }
         };
         
-        std::map<std::pair<cpCollisionType, cpCollisionType>, CallbackData> callbackDatas;
-        std::map<cpCollisionType, CallbackData> wildcardCallbackDatas;
+        // Chipmunk hands back the same handler when a pair is registered again, so the data is replaced
+        std::map<std::pair<cpCollisionType, cpCollisionType>, std::unique_ptr<CallbackDataBase>> callbackDatas;
+        std::map<cpCollisionType, std::unique_ptr<CallbackDataBase>> wildcardCallbackDatas;
         
-        static cpBool helperBegin(cpArbiter* arb, cpSpace* s, void* d);
-        static cpBool helperPreSolve(cpArbiter* arb, cpSpace* s, void* d);
-        static void helperPostSolve(cpArbiter* arb, cpSpace* s, void* d);
-        static void helperSeparate(cpArbiter* arb, cpSpace* s, void* d);
+        template <typename Begin, typename PreSolve, typename PostSolve, typename Separate>
+        void setupCollisionHandler(cpCollisionHandler* handler, std::unique_ptr<CallbackDataBase>& slot,
+                                   Begin begin, PreSolve preSolve, PostSolve postSolve, Separate separate)
+        {
+            using Data = CallbackData<Begin, PreSolve, PostSolve, Separate>;
+            auto data = std::make_unique<Data>(std::move(begin), std::move(preSolve),
+                                               std::move(postSolve), std::move(separate), *this);
+            handler->beginFunc = Data::helperBegin;
+            handler->preSolveFunc = Data::helperPreSolve;
+            handler->postSolveFunc = Data::helperPostSolve;
+            handler->separateFunc = Data::helperSeparate;
+            handler->userData = data.get();
+            slot = std::move(data);
+        }
     };
 }
 
@@ -8,28 +8,40 @@ namespace cp
     const Body::KinematicTag Body::Kinematic {};
     
     Body::Body(cpFloat mass, cpFloat inertia) :
-    _body(cpBodyNew(mass, inertia))
-    { }
+    _body(cpBodyNew(mass, inertia)),
+    _userData(nullptr)
+    {
+        cpBodySetUserData(_body, this);
+    }
     
     Body::Body(Body&& other) :
-    _body(other._body)
+    _body(other._body),
+    _userData(other._userData)
     {
         other._body = nullptr;
+        if (_body) cpBodySetUserData(_body, this);
     }
 
     Body::Body(StaticTag) :
-    _body(cpBodyNewStatic())
-    { }
+    _body(cpBodyNewStatic()),
+    _userData(nullptr)
+    {
+        cpBodySetUserData(_body, this);
+    }
 
     Body::Body(KinematicTag) :
-    _body(cpBodyNewKinematic())
+    _body(cpBodyNewKinematic()),
+    _userData(nullptr)
     {
-        
+        cpBodySetUserData(_body, this);
     }
     
     Body::Body(cpBody* body) :
-    _body(body)
-    { }
+    _body(body),
+    _userData(nullptr)
+    {
+        cpBodySetUserData(_body, this);
+    }
     
     Body::operator cpBody*() const
     {
@@ -43,12 +55,4 @@ namespace cp
     }
     
     void Body::activateStatic(std::shared_ptr<Shape> filter) { cpBodyActivateStatic(_body, *filter); };
-
-    void Body::eachArbiter(std::function<void(Arbiter)> func)
-    {
-        cpBodyEachArbiter(_body, [](cpBody* body, cpArbiter* arbiter, void* data)
-        {
-            (*(std::function<void(Arbiter)>*)data)(Arbiter(arbiter));
-        }, (void*)&func);
-    }
 }
@@ -5,9 +5,12 @@
 namespace cp
 {
     Shape::Shape(cpShape* s, std::shared_ptr<Body> b) :
+    _shape(s),
     _body(b),
-    _shape(s)
-    { }
+    _userData(nullptr)
+    {
+        cpShapeSetUserData(_shape, this);
+    }
     
     Shape::~Shape()
     {
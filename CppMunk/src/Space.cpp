@@ -4,6 +4,8 @@
 #include "Constraint.h"
 #include "Arbiter.h"
 
+#include <chipmunk/chipmunk_structs.h>
+
 #include <algorithm>
 #include <cassert>
 
@@ -11,7 +13,8 @@ namespace cp
 {
     Space::Space() :
     _space(cpSpaceNew()),
-    _staticBody(std::make_shared<Body>(cpSpaceGetStaticBody(_space)))
+    _staticBody(std::make_shared<Body>(cpSpaceGetStaticBody(_space))),
+    _staticIndex(StaticIndex::BoundingBoxTree)
     { }
     
     Space::~Space()
@@ -52,6 +55,23 @@ namespace cp
         _constraints.emplace(*constraint, constraint);
     }
 
+    void Space::add(const std::vector<std::shared_ptr<Shape>>& shapes)
+    {
+        _shapes.reserve(_shapes.size() + shapes.size());
+        
+        bool addedStatic = false;
+        for (const auto& shape : shapes)
+        {
+            cpSpaceAddShape(_space, *shape);
+            _shapes.emplace(*shape, shape);
+            addedStatic |= cpBodyGetType(cpShapeGetBody(*shape)) == CP_BODY_TYPE_STATIC;
+        }
+        
+        // the tree grew one leaf at a time, a top-down rebuild gives it a better layout for queries
+        if (addedStatic && _staticIndex == StaticIndex::BoundingBoxTree)
+            cpBBTreeOptimize(_space->staticShapes);
+    }
+
     bool Space::contains(std::shared_ptr<Shape> shape)
     {
         return cpSpaceContainsShape(_space, *shape);
@@ -73,6 +93,15 @@ namespace cp
         _shapes.erase(*shape);
     }
     
+    void Space::remove(const std::vector<std::shared_ptr<Shape>>& shapes)
+    {
+        for (const auto& shape : shapes)
+        {
+            cpSpaceRemoveShape(_space, *shape);
+            _shapes.erase(*shape);
+        }
+    }
+    
     void Space::remove(std::shared_ptr<Body> body)
     {
         cpSpaceRemoveBody(_space, *body);
@@ -88,16 +117,15 @@ namespace cp
     std::shared_ptr<Shape> Space::findShape(cpShape* shape) const
     {
         if (!shape) return std::shared_ptr<Shape>();
-        auto it = _shapes.find(shape);
-        assert(it != _shapes.end());
-        return it->second;
+        assert(_shapes.find(shape) != _shapes.end());
+        return Shape::of(shape)->shared_from_this();
     }
     
     std::shared_ptr<Body> Space::findBody(cpBody* body) const
     {
         if (!body) return std::shared_ptr<Body>();
-        auto it = _bodies.find(body);
-        return it->second;
+        assert(_bodies.find(body) != _bodies.end());
+        return Body::of(body)->shared_from_this();
     }
     
     std::shared_ptr<Constraint> Space::findConstraint(cpConstraint* constraint) const
@@ -178,61 +206,29 @@ namespace cp
         return findShape(cpSpacePointQueryNearest(_space, p, 100, filter, &i));
     }
     
-    cpBool Space::helperBegin(cpArbiter* arb, cpSpace* s, void* d)
-    {
-        CallbackData& data = *reinterpret_cast<CallbackData*>(d);
-        return data.begin(arb, *data.self);
-    }
-    
-    cpBool Space::helperPreSolve(cpArbiter* arb, cpSpace* s, void* d)
+    void Space::useStaticIndex(StaticIndex index, cpFloat cellSize, int count)
     {
-        CallbackData& data = *reinterpret_cast<CallbackData*>(d);
-        return data.preSolve(arb, *data.self);
-    }
-    
-    void Space::helperPostSolve(cpArbiter* arb, cpSpace* s, void* d)
-    {
-        CallbackData& data = *reinterpret_cast<CallbackData*>(d);
-        return data.postSolve(arb, *data.self);
-    }
-    
-    void Space::helperSeparate(cpArbiter* arb, cpSpace* s, void* d)
-    {
-        CallbackData& data = *reinterpret_cast<CallbackData*>(d);
-        return data.separate(arb, *data.self);
-    }
-    
-    void Space::addCollisionHandler(cpCollisionType a,
-                                    cpCollisionType b,
-                                    std::function<int(Arbiter, Space&)> begin,
-                                    std::function<int(Arbiter, Space&)> preSolve,
-                                    std::function<void(Arbiter, Space&)> postSolve,
-                                    std::function<void(Arbiter, Space&)> separate)
-    {
-        auto it = callbackDatas.emplace(std::make_pair(a, b),
-            CallbackData(begin, preSolve, postSolve, separate, *this)).first;
-        cpCollisionHandler* handler = cpSpaceAddCollisionHandler(_space, a, b);
-        handler->beginFunc = begin == nullptr ? nullptr : helperBegin;
-        handler->preSolveFunc = preSolve == nullptr ? nullptr : helperPreSolve;
-        handler->postSolveFunc = postSolve == nullptr ? nullptr : helperPostSolve;
-        handler->separateFunc = separate == nullptr ? nullptr : helperSeparate;
-        handler->userData = &it->second;
-    }
-
-    void Space::addWildcardCollisionHandler(cpCollisionType a,
-                                            std::function<int(Arbiter, Space&)> begin,
-                                            std::function<int(Arbiter, Space&)> preSolve,
-                                            std::function<void(Arbiter, Space&)> postSolve,
-                                            std::function<void(Arbiter, Space&)> separate)
-    {
-        auto it = wildcardCallbackDatas.emplace(a,
-            CallbackData(begin, preSolve, postSolve, separate, *this)).first;
-        cpCollisionHandler* handler = cpSpaceAddWildcardHandler(_space, a);
-        handler->beginFunc = begin == nullptr ? nullptr : helperBegin;
-        handler->preSolveFunc = preSolve == nullptr ? nullptr : helperPreSolve;
-        handler->postSolveFunc = postSolve == nullptr ? nullptr : helperPostSolve;
-        handler->separateFunc = separate == nullptr ? nullptr : helperSeparate;
-        handler->userData = &it->second;
+        assert(!cpSpaceIsLocked(_space));
+        assert(index != StaticIndex::SpatialHash || cellSize > 0);
+        
+        auto bbFunc = (cpSpatialIndexBBFunc)cpShapeGetBB;
+        cpSpatialIndex* oldIndex = _space->staticShapes;
+        cpSpatialIndex* newIndex = index == StaticIndex::SpatialHash ?
+            cpSpaceHashNew(cellSize, count, bbFunc, nullptr) : cpBBTreeNew(bbFunc, nullptr);
+        
+        cpSpatialIndexEach(oldIndex, [](void* obj, void* data)
+        {
+            auto shape = (cpShape*)obj;
+            cpSpatialIndexInsert((cpSpatialIndex*)data, shape, shape->hashid);
+        }, newIndex);
+        
+        // the dynamic index keeps a pointer to the static one to collide against it
+        _space->dynamicShapes->staticIndex = newIndex;
+        newIndex->dynamicIndex = _space->dynamicShapes;
+        _space->staticShapes = newIndex;
+        cpSpatialIndexFree(oldIndex);
+        
+        _staticIndex = index;
     }
 
     void Space::reindexShapesForBody(std::shared_ptr<Body> body)
@@ -0,0 +1,417 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include "tinyxml2.h"
+#include "varlength.hpp"
+#include "dependencies.hpp"
+
+using namespace std;
+using namespace tinyxml2;
+namespace fs = std::filesystem;
+
+// Glyphs are rendered at this multiple of the bake size and their distance
+// field is averaged down, which keeps the edges of the field accurate
+constexpr int Upscale = 4;
+constexpr float Infinity = 1e20f;
+
+struct BakedGlyph
+{
+    uint32_t index;
+    float advance;
+    float left, top;
+    size_t width, height;
+    vector<uint8_t> distances;
+    size_t atlasX, atlasY;
+};
+
+static bool readFile(const fs::path& path, string& contents)
+{
+    noteDependency(path.string());
+    ifstream in(path, ios::in | ios::binary);
+    if (!in) return false;
+
+    ostringstream stream;
+    stream << in.rdbuf();
+    contents = stream.str();
+    return true;
+}
+
+static void collectCodePoints(const string& text, set<uint32_t>& codePoints)
+{
+    for (size_t i = 0; i < text.size();)
+    {
+        uint8_t c = text[i];
+        size_t length = c < 0x80 ? 1 : c < 0xE0 ? 2 : c < 0xF0 ? 3 : 4;
+        uint32_t codePoint = length == 1 ? c : length == 2 ? c & 0x1F : length == 3 ? c & 0x0F : c & 0x07;
+
+        for (size_t k = 1; k < length && i + k < text.size(); k++)
+            codePoint = (codePoint << 6) | (text[i+k] & 0x3F);
+
+        if (codePoint >= 0x20) codePoints.insert(codePoint);
+        i += length;
+    }
+}
+
+// Takes every character of a language source, following its <import-from> files
+static bool collectLanguageCodePoints(const fs::path& path, set<uint32_t>& codePoints, set<fs::path>& visited)
+{
+    if (!visited.insert(fs::absolute(path)).second) return true;
+
+    string contents;
+    if (!readFile(path, contents))
+    {
+        cout << "Error while trying to read language file " << path.string() << "." << endl;
+        return false;
+    }
+
+    collectCodePoints(contents, codePoints);
+
+    XMLDocument doc;
+    if (doc.Parse(contents.data(), contents.size()) != XML_SUCCESS)
+    {
+        cout << "Error while trying to parse language file " << path.string() << ": " << doc.ErrorName() << "." << endl;
+        return false;
+    }
+
+    auto language = doc.FirstChildElement("language");
+    if (!language) return true;
+
+    for (auto import = language->FirstChildElement("import-from"); import; import = import->NextSiblingElement("import-from"))
+    {
+        auto file = import->Attribute("file");
+        if (file && !collectLanguageCodePoints(path.parent_path() / file, codePoints, visited))
+            return false;
+    }
+
+    return true;
+}
+
+// Felzenszwalb-Huttenlocher squared distance transform of a sampled function,
+// reading f contiguously and writing d every stride elements
+static void distanceTransform1D(const float* f, float* d, size_t n, size_t stride, vector<int>& v, vector<float>& z)
+{
+    int k = 0;
+    v[0] = 0;
+    z[0] = -Infinity;
+    z[1] = Infinity;
+
+    for (int q = 1; q < (int)n; q++)
+    {
+        auto intersection = [&](int p) { return ((f[q] + q*q) - (f[p] + p*p)) / (2*q - 2*p); };
+
+        float s = intersection(v[k]);
+        while (s <= z[k]) s = intersection(v[--k]);
+
+        k++;
+        v[k] = q;
+        z[k] = s;
+        z[k+1] = Infinity;
+    }
+
+    k = 0;
+    for (int q = 0; q < (int)n; q++)
+    {
+        while (z[k+1] < q) k++;
+        int p = v[k];
+        d[q*stride] = (q - p) * (q - p) + f[p];
+    }
+}
+
+// Squared distance of every pixel to the nearest pixel whose coverage equals target
+static vector<float> distanceTransform(const vector<uint8_t>& inside, size_t width, size_t height, bool target)
+{
+    vector<float> grid(width * height), temp(max(width, height));
+    for (size_t i = 0; i < grid.size(); i++)
+        grid[i] = (bool)inside[i] == target ? 0 : Infinity;
+
+    vector<int> v(max(width, height));
+    vector<float> z(max(width, height) + 1);
+
+    for (size_t x = 0; x < width; x++)
+    {
+        for (size_t y = 0; y < height; y++) temp[y] = grid[y*width + x];
+        distanceTransform1D(temp.data(), &grid[x], height, width, v, z);
+    }
+
+    for (size_t y = 0; y < height; y++)
+    {
+        copy(&grid[y*width], &grid[y*width] + width, temp.begin());
+        distanceTransform1D(temp.data(), &grid[y*width], width, 1, v, z);
+    }
+
+    return grid;
+}
+
+static bool bakeGlyph(FT_Face face, uint32_t index, float spread, BakedGlyph& glyph)
+{
+    if (FT_Load_Glyph(face, index, FT_LOAD_NO_HINTING) != 0) return false;
+    if (FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL) != 0) return false;
+
+    const auto& bitmap = face->glyph->bitmap;
+    glyph.index = index;
+    glyph.advance = face->glyph->advance.x / 64.0f / Upscale;
+    glyph.width = glyph.height = 0;
+
+    if (bitmap.width == 0 || bitmap.rows == 0) return true;
+
+    // The field extends spread pixels around the glyph, and the high resolution
+    // grid must be a whole number of output texels
+    size_t pad = (size_t)ceil(spread) * Upscale;
+    size_t width = (bitmap.width + 2*pad + Upscale - 1) / Upscale * Upscale;
+    size_t height = (bitmap.rows + 2*pad + Upscale - 1) / Upscale * Upscale;
+
+    vector<uint8_t> inside(width * height, 0);
+    for (size_t y = 0; y < bitmap.rows; y++)
+        for (size_t x = 0; x < bitmap.width; x++)
+            inside[(y + pad) * width + x + pad] = bitmap.buffer[y * bitmap.pitch + x] >= 128;
+
+    auto outsideDistances = distanceTransform(inside, width, height, true);
+    auto insideDistances = distanceTransform(inside, width, height, false);
+
+    glyph.width = width / Upscale;
+    glyph.height = height / Upscale;
+    glyph.left = ((float)face->glyph->bitmap_left - pad) / Upscale;
+    glyph.top = (-(float)face->glyph->bitmap_top - pad) / Upscale;
+    glyph.distances.resize(glyph.width * glyph.height);
+
+    for (size_t j = 0; j < glyph.height; j++)
+        for (size_t i = 0; i < glyph.width; i++)
+        {
+            float sum = 0;
+            for (size_t y = j*Upscale; y < (j+1)*Upscale; y++)
+                for (size_t x = i*Upscale; x < (i+1)*Upscale; x++)
+                {
+                    size_t p = y*width + x;
+                    sum += sqrtf(outsideDistances[p]) - sqrtf(insideDistances[p]);
+                }
+
+            // 0.5 on the edge, growing towards the inside of the glyph
+            float distance = sum / (Upscale * Upscale) / Upscale;
+            float value = 0.5f - distance / (2 * spread);
+            glyph.distances[j * glyph.width + i] = (uint8_t)lroundf(255 * min(max(value, 0.0f), 1.0f));
+        }
+
+    return true;
+}
+
+// Shelf packing, tallest glyphs first; returns the atlas height
+static size_t packGlyphs(vector<BakedGlyph>& glyphs, size_t atlasWidth)
+{
+    vector<BakedGlyph*> order;
+    for (auto& glyph : glyphs) if (glyph.width > 0) order.push_back(&glyph);
+    stable_sort(order.begin(), order.end(), [](auto a, auto b) { return a->height > b->height; });
+
+    size_t x = 0, y = 0, shelfHeight = 0;
+    for (auto glyph : order)
+    {
+        if (x + glyph->width > atlasWidth)
+        {
+            x = 0;
+            y += shelfHeight + 1;
+            shelfHeight = 0;
+        }
+
+        glyph->atlasX = x;
+        glyph->atlasY = y;
+        x += glyph->width + 1;
+        shelfHeight = max(shelfHeight, glyph->height);
+    }
+
+    return y + shelfHeight;
+}
+
+static void write_float(ostream& out, float value)
+{
+    out.write((const char*)&value, sizeof(float));
+}
+
+int bakeFont(string inFile, string outFile)
+{
+    XMLDocument doc;
+    if (doc.LoadFile(inFile.c_str()) != XML_SUCCESS)
+    {
+        cout << "Error while trying to read file " << inFile << ": " << doc.ErrorName() << "." << endl;
+        return -1;
+    }
+
+    auto root = doc.FirstChildElement("sdf-font");
+    if (!root || !root->Attribute("font"))
+    {
+        cout << "File " << inFile << " must have a root sdf-font element with a font attribute!" << endl;
+        return -1;
+    }
+
+    fs::path directory = fs::path(inFile).parent_path();
+    fs::path fontPath = directory / root->Attribute("font");
+    float bakeSize = root->FloatAttribute("size", 48);
+    float spread = root->FloatAttribute("spread", 6);
+    bool allGlyphs = root->BoolAttribute("all-glyphs");
+
+    if (bakeSize < 8 || spread <= 0)
+    {
+        cout << "The bake size must be at least 8 and the spread must be positive!" << endl;
+        return -1;
+    }
+
+    set<uint32_t> codePoints;
+    set<fs::path> visited;
+    for (auto language = root->FirstChildElement("language"); language; language = language->NextSiblingElement("language"))
+    {
+        auto file = language->Attribute("file");
+        if (file && !collectLanguageCodePoints(directory / file, codePoints, visited)) return -1;
+    }
+
+    for (auto range = root->FirstChildElement("range"); range; range = range->NextSiblingElement("range"))
+    {
+        // Accepts both decimal and hexadecimal code points
+        auto beginAttr = range->Attribute("begin"), endAttr = range->Attribute("end");
+        if (!beginAttr) continue;
+
+        uint32_t begin = strtoul(beginAttr, nullptr, 0);
+        uint32_t end = endAttr ? strtoul(endAttr, nullptr, 0) : begin;
+        for (uint32_t c = begin; c <= end; c++) codePoints.insert(c);
+    }
+
+    string fontData;
+    if (!readFile(fontPath, fontData))
+    {
+        cout << "Error while trying to read font " << fontPath.string() << "." << endl;
+        return -1;
+    }
+
+    FT_Library library;
+    FT_Face face;
+    if (FT_Init_FreeType(&library) != 0) return -1;
+    if (FT_New_Memory_Face(library, (const FT_Byte*)fontData.data(), fontData.size(), 0, &face) != 0)
+    {
+        cout << "Error while trying to load font " << fontPath.string() << "." << endl;
+        FT_Done_FreeType(library);
+        return -1;
+    }
+
+    FT_Set_Pixel_Sizes(face, 0, (FT_UInt)bakeSize);
+    float ascent = -face->size->metrics.ascender / 64.0f;
+    float descent = -face->size->metrics.descender / 64.0f;
+    float lineSpacing = face->size->metrics.height / 64.0f;
+
+    // The game shapes with HarfBuzz, so glyphs are baked and found by index;
+    // the character map is only kept for the characters baked
+    map<uint32_t,uint32_t> characterMap;
+    set<uint32_t> glyphIndices { 0 };
+    for (uint32_t c : codePoints)
+        if (auto index = FT_Get_Char_Index(face, c))
+        {
+            characterMap.emplace(c, index);
+            glyphIndices.insert(index);
+        }
+
+    // Complex scripts are shaped into glyphs no character maps to
+    if (allGlyphs)
+        for (FT_Long i = 0; i < face->num_glyphs; i++) glyphIndices.insert((uint32_t)i);
+
+    FT_Set_Pixel_Sizes(face, 0, (FT_UInt)(bakeSize * Upscale));
+
+    vector<BakedGlyph> glyphs;
+    glyphs.reserve(glyphIndices.size());
+    for (uint32_t index : glyphIndices)
+    {
+        glyphs.emplace_back();
+        if (!bakeGlyph(face, index, spread, glyphs.back()))
+        {
+            cout << "Could not render glyph " << index << " of font " << fontPath.string() << "." << endl;
+            glyphs.pop_back();
+        }
+    }
+
+    FT_Done_Face(face);
+    FT_Done_FreeType(library);
+
+    size_t area = 0;
+    for (const auto& glyph : glyphs) area += (glyph.width + 1) * (glyph.height + 1);
+
+    size_t atlasWidth = 256;
+    while (atlasWidth < 4096 && atlasWidth * atlasWidth < area * 5 / 4) atlasWidth *= 2;
+    size_t atlasHeight = packGlyphs(glyphs, atlasWidth);
+
+    vector<uint8_t> atlas(atlasWidth * atlasHeight, 0);
+    for (const auto& glyph : glyphs)
+        for (size_t y = 0; y < glyph.height; y++)
+            copy_n(&glyph.distances[y * glyph.width], glyph.width, &atlas[(glyph.atlasY + y) * atlasWidth + glyph.atlasX]);
+
+    ofstream out(outFile, ios::out | ios::binary);
+    out.write("SDFF", 4);
+
+    write_float(out, bakeSize);
+    write_float(out, spread);
+    write_float(out, ascent);
+    write_float(out, descent);
+    write_float(out, lineSpacing);
+
+    write_varlength(out, atlasWidth);
+    write_varlength(out, atlasHeight);
+    out.write((const char*)atlas.data(), atlas.size());
+
+    write_varlength(out, glyphs.size());
+    for (const auto& glyph : glyphs)
+    {
+        write_varlength(out, glyph.index);
+        write_float(out, glyph.advance);
+        write_float(out, glyph.left);
+        write_float(out, glyph.top);
+        write_varlength(out, glyph.width);
+        write_varlength(out, glyph.height);
+        write_varlength(out, glyph.width > 0 ? glyph.atlasX : 0);
+        write_varlength(out, glyph.width > 0 ? glyph.atlasY : 0);
+    }
+
+    write_varlength(out, characterMap.size());
+    for (const auto& pair : characterMap)
+    {
+        write_varlength(out, pair.first);
+        write_varlength(out, pair.second);
+    }
+
+    // HarfBuzz shapes with the shipped font, which is only referenced by name
+    auto fontName = fontPath.filename().string();
+    write_varlength(out, fontName.size());
+    out.write(fontName.data(), fontName.size());
+
+    cout << "Baked " << glyphs.size() << " glyphs of " << fontPath.filename().string() << " into a "
+        << atlasWidth << "x" << atlasHeight << " atlas." << endl;
+    return 0;
+}
@@ -0,0 +1,387 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <filesystem>
+#include <cinttypes>
+#include <PerfectHash.hpp>
+#include "dependencies.hpp"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+int tmxToMap(string, string);
+int lvxToLvl(string, string);
+int tsxToTs(string, string);
+int pexToPe(string, string);
+int bakeFont(string, string);
+int exportLanguage(string, string);
+
+extern bool exportLegacyFormat;
+extern const char* exportToolsExecutable;
+
+// Bump when the cache file changes meaning
+constexpr uint32_t BatchCacheVersion = 1;
+
+struct batch_tool
+{
+    const char* inputExtension;
+    const char* outputExtension;
+    int (*tool)(string, string);
+};
+
+const batch_tool batchTools[] =
+{
+    { ".tmx", ".map", tmxToMap },
+    { ".tsx", ".ts", tsxToTs },
+    { ".lvx", ".lvl", lvxToLvl },
+    { ".pex", ".pe", pexToPe },
+    { ".sdfx", ".sdf", bakeFont },
+    { ".lnx", ".lang", exportLanguage },
+};
+
+struct batch_job
+{
+    fs::path input, output;
+    const batch_tool* tool;
+
+    vector<string> dependencies; // every file read, the input included
+    uint64_t hash = 0;
+    enum { Pending, UpToDate, Exported, Failed } status = Pending;
+};
+
+struct cache_entry
+{
+    uint64_t hash;
+    vector<string> dependencies;
+};
+
+static thread_local vector<string>* currentDependencies = nullptr;
+
+// Collects what the tools print into the output of the job running on the calling
+// thread, so the lines of parallel jobs don't interleave; other threads go straight through
+class job_output_router final : public streambuf
+{
+    ostream& stream;
+    streambuf* target;
+
+public:
+    static thread_local string* currentOutput;
+
+    job_output_router(ostream& stream) : stream(stream), target(stream.rdbuf(this)) {}
+    ~job_output_router() { stream.rdbuf(target); }
+
+protected:
+    virtual int_type overflow(int_type ch) override
+    {
+        if (traits_type::eq_int_type(ch, traits_type::eof())) return traits_type::not_eof(ch);
+        if (!currentOutput) return target->sputc(traits_type::to_char_type(ch));
+
+        currentOutput->push_back(traits_type::to_char_type(ch));
+        return ch;
+    }
+
+    virtual streamsize xsputn(const char* str, streamsize count) override
+    {
+        if (!currentOutput) return target->sputn(str, count);
+
+        currentOutput->append(str, count);
+        return count;
+    }
+
+    virtual int sync() override { return currentOutput ? 0 : target->pubsync(); }
+};
+
+thread_local string* job_output_router::currentOutput = nullptr;
+
+void noteDependency(const string& path)
+{
+    if (currentDependencies) currentDependencies->push_back(path);
+}
+
+static bool hashFile(const fs::path& path, uint64_t& hash)
+{
+    ifstream in(path, ios::in | ios::binary);
+    if (!in) return false;
+
+    ostringstream stream;
+    stream << in.rdbuf();
+    auto contents = stream.str();
+    hash = util::fnv1a64(contents.data(), contents.size());
+    return true;
+}
+
+static uint64_t combineHash(uint64_t hash, uint64_t value)
+{
+    return util::mixHash(hash ^ (value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2)));
+}
+
+static uint64_t hashString(const string& str) { return util::fnv1a64(str.data(), str.size()); }
+
+// The hash covers the tool binary and flags, then every file the job read; a file
+// that cannot be read anymore makes the job stale
+static bool hashJob(const batch_job& job, uint64_t toolHash, const vector<string>& dependencies, uint64_t& hash)
+{
+    hash = combineHash(toolHash, hashString(job.tool->inputExtension));
+    for (const auto& dependency : dependencies)
+    {
+        uint64_t fileHash;
+        if (!hashFile(dependency, fileHash)) return false;
+        hash = combineHash(combineHash(hash, hashString(dependency)), fileHash);
+    }
+
+    return true;
+}
+
+static const batch_tool* findTool(const fs::path& input)
+{
+    auto extension = input.extension().string();
+    for (const auto& tool : batchTools)
+        if (extension == tool.inputExtension) return &tool;
+    return nullptr;
+}
+
+// A manifest lists one input per line, relative to the manifest's directory
+static bool collectInputs(const fs::path& source, vector<fs::path>& inputs)
+{
+    if (fs::is_directory(source))
+    {
+        error_code ec;
+        for (fs::directory_iterator it(source, ec), end; it != end; it.increment(ec))
+            if (it->is_regular_file() && findTool(it->path())) inputs.push_back(it->path());
+
+        if (ec)
+        {
+            cout << "Error while listing directory " << source << ": " << ec.message() << "." << endl;
+            return false;
+        }
+    }
+    else
+    {
+        ifstream in(source);
+        if (!in)
+        {
+            cout << "Error while trying to read manifest " << source << "." << endl;
+            return false;
+        }
+
+        string line;
+        while (getline(in, line))
+        {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty()) continue;
+
+            auto path = source.parent_path() / line;
+            if (!findTool(path))
+            {
+                cout << "No tool converts " << line << " listed in " << source << "." << endl;
+                return false;
+            }
+            inputs.push_back(path);
+        }
+    }
+
+    sort(inputs.begin(), inputs.end());
+    return true;
+}
+
+// One line per output: name, hash and the files it was built from, separated by tabs
+static unordered_map<string,cache_entry> readCache(const fs::path& path)
+{
+    unordered_map<string,cache_entry> cache;
+
+    ifstream in(path);
+    string line;
+    if (!getline(in, line) || line != "export-cache " + to_string(BatchCacheVersion)) return cache;
+
+    while (getline(in, line))
+    {
+        vector<string> fields;
+        istringstream stream(line);
+        for (string field; getline(stream, field, '\t');) fields.push_back(field);
+        if (fields.size() < 2) continue;
+
+        cache_entry entry;
+        entry.hash = strtoull(fields[1].c_str(), nullptr, 16);
+        entry.dependencies.assign(fields.begin() + 2, fields.end());
+        cache.emplace(fields[0], move(entry));
+    }
+
+    return cache;
+}
+
+static void writeCache(const fs::path& path, const vector<batch_job>& jobs)
+{
+    ofstream out(path);
+    out << "export-cache " << BatchCacheVersion << '\n';
+
+    for (const auto& job : jobs)
+    {
+        if (job.status == batch_job::Failed) continue;
+
+        char hash[17];
+        snprintf(hash, sizeof(hash), "%016" PRIx64, job.hash);
+        out << job.output.filename().string() << '\t' << hash;
+        for (const auto& dependency : job.dependencies) out << '\t' << dependency;
+        out << '\n';
+    }
+}
+
+static string escapeDependency(const string& path)
+{
+    string result;
+    for (char c : path)
+    {
+        if (c == ' ' || c == '#') result += '\\';
+        else if (c == '$') result += '$';
+        result += c;
+    }
+    return result;
+}
+
+// Make-style, so CMake and Ninja rerun the batch when any file an output was built from changes
+static void writeDepfile(const fs::path& path, const vector<batch_job>& jobs)
+{
+    set<string> dependencies;
+    for (const auto& job : jobs)
+        dependencies.insert(job.dependencies.begin(), job.dependencies.end());
+
+    ofstream out(path);
+    for (const auto& job : jobs) out << escapeDependency(job.output.generic_string()) << ' ';
+    out << ':';
+    for (const auto& dependency : dependencies) out << " \\\n  " << escapeDependency(dependency);
+    out << '\n';
+}
+
+static uint64_t hashTool()
+{
+    uint64_t hash = combineHash(BatchCacheVersion, exportLegacyFormat);
+
+    uint64_t binaryHash = 0;
+    if (exportToolsExecutable && hashFile(exportToolsExecutable, binaryHash))
+        hash = combineHash(hash, binaryHash);
+    else cout << "Could not read the ExportTools binary, the cache will not notice when it changes." << endl;
+
+    return hash;
+}
+
+int batchExport(string inFile, string outFile)
+{
+    vector<fs::path> inputs;
+    if (!collectInputs(inFile, inputs)) return -1;
+
+    error_code ec;
+    fs::path outDir = fs::absolute(outFile);
+    fs::create_directories(outDir, ec);
+    if (ec)
+    {
+        cout << "Error while creating directory " << outDir << ": " << ec.message() << "." << endl;
+        return -1;
+    }
+
+    vector<batch_job> jobs;
+    for (const auto& input : inputs)
+    {
+        auto tool = findTool(input);
+        auto output = outDir / input.filename().replace_extension(tool->outputExtension);
+        jobs.push_back({ fs::absolute(input).lexically_normal(), output, tool, {} });
+    }
+
+    auto cachePath = outDir / "export.cache";
+    auto cache = readCache(cachePath);
+    auto toolHash = hashTool();
+
+    mutex outputMutex;
+    atomic<size_t> nextJob(0);
+    job_output_router router(cout);
+
+    auto worker = [&]
+    {
+        for (size_t i; (i = nextJob++) < jobs.size();)
+        {
+            auto& job = jobs[i];
+
+            auto it = cache.find(job.output.filename().string());
+            uint64_t hash;
+            if (it != cache.end() && fs::exists(job.output) &&
+                hashJob(job, toolHash, it->second.dependencies, hash) && hash == it->second.hash)
+            {
+                job.dependencies = it->second.dependencies;
+                job.hash = hash;
+                job.status = batch_job::UpToDate;
+
+                // bring it past its dependencies, or make would keep rerunning the batch for it
+                error_code ec;
+                fs::last_write_time(job.output, fs::file_time_type::clock::now(), ec);
+                continue;
+            }
+
+            string output;
+            vector<string> dependencies{ job.input.generic_string() };
+            currentDependencies = &dependencies;
+            job_output_router::currentOutput = &output;
+            int result = job.tool->tool(job.input.string(), job.output.string());
+            job_output_router::currentOutput = nullptr;
+            currentDependencies = nullptr;
+
+            for (auto& dependency : dependencies)
+                dependency = fs::absolute(dependency).lexically_normal().generic_string();
+            sort(dependencies.begin() + 1, dependencies.end());
+            dependencies.erase(unique(dependencies.begin() + 1, dependencies.end()), dependencies.end());
+
+            job.dependencies = move(dependencies);
+            bool success = result == 0 && hashJob(job, toolHash, job.dependencies, job.hash);
+            job.status = success ? batch_job::Exported : batch_job::Failed;
+
+            lock_guard<mutex> lock(outputMutex);
+            cout << output << (success ? "Exported " : "Failed to export ") << job.input.filename().string() << endl;
+        }
+    };
+
+    size_t numThreads = max<size_t>(1, min<size_t>(thread::hardware_concurrency(), jobs.size()));
+    vector<thread> threads;
+    for (size_t i = 1; i < numThreads; i++) threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads) thread.join();
+
+    writeCache(cachePath, jobs);
+    writeDepfile(outDir / "export.d", jobs);
+
+    size_t upToDate = count_if(jobs.begin(), jobs.end(), [](const auto& job) { return job.status == batch_job::UpToDate; });
+    size_t failed = count_if(jobs.begin(), jobs.end(), [](const auto& job) { return job.status == batch_job::Failed; });
+    cout << jobs.size() << " inputs: " << jobs.size() - upToDate - failed << " exported, " << upToDate
+        << " up to date, " << failed << " failed, on " << numThreads << " threads." << endl;
+
+    return failed == 0 ? 0 : -1;
+}
@@ -33,9 +33,12 @@
 #include <cstdlib>
 #include <memory>
 #include <regex>
+#include <numeric>
+#include <PerfectHash.hpp>
 #include "tinyxml2.h"
 #include "expression-tree-compiler.hpp"
 #include "varlength.hpp"
+#include "dependencies.hpp"
 
 using namespace std;
 using namespace tinyxml2;
@@ -237,6 +240,117 @@ void write_str(ostream& out, const std::string& str)
     out.write(str.data(), str.size() * sizeof(char));
 }
 
+uint64_t hashLangID(const string& str)
+{
+    return util::fnv1a64(str.data(), str.size());
+}
+
+void write_langid(ostream& out, const string& str)
+{
+    uint64_t hash = hashLangID(str);
+    out.write((const char*)&hash, sizeof(uint64_t));
+}
+
+// Finds, for every bucket, the first displacement that puts all of its keys
+// in free slots; the biggest buckets are placed first, while the table is empty
+bool buildPerfectHash(const vector<uint64_t>& keys, vector<uint32_t>& displacements, vector<size_t>& slots)
+{
+    constexpr uint32_t MaxDisplacement = 1 << 24;
+    
+    size_t numBuckets = keys.size() / 2 + 1;
+    vector<vector<size_t>> buckets(numBuckets);
+    for (size_t i = 0; i < keys.size(); i++)
+        buckets[util::perfectHashBucket(keys[i], numBuckets)].push_back(i);
+    
+    vector<size_t> order(numBuckets);
+    iota(order.begin(), order.end(), 0);
+    stable_sort(order.begin(), order.end(),
+        [&] (size_t a, size_t b) { return buckets[a].size() > buckets[b].size(); });
+    
+    displacements.assign(numBuckets, 0);
+    slots.assign(keys.size(), 0);
+    vector<bool> taken(keys.size(), false);
+    vector<size_t> bucketSlots;
+    
+    for (size_t b : order)
+    {
+        const auto& bucket = buckets[b];
+        if (bucket.empty()) break;
+        
+        uint32_t d;
+        for (d = 0; d < MaxDisplacement; d++)
+        {
+            bucketSlots.clear();
+            for (size_t k : bucket)
+            {
+                size_t slot = util::perfectHashSlot(keys[k], d, keys.size());
+                if (taken[slot] || find(bucketSlots.begin(), bucketSlots.end(), slot) != bucketSlots.end())
+                    break;
+                bucketSlots.push_back(slot);
+            }
+            
+            if (bucketSlots.size() == bucket.size()) break;
+        }
+        
+        if (d == MaxDisplacement) return false;
+        
+        displacements[b] = d;
+        for (size_t i = 0; i < bucket.size(); i++)
+        {
+            taken[bucketSlots[i]] = true;
+            slots[bucket[i]] = bucketSlots[i];
+        }
+    }
+    
+    return true;
+}
+
+template <typename T, typename Writer>
+bool writeLangIDTable(ostream& out, const map<string,T>& entries, const char* kind, Writer writeEntry)
+{
+    vector<uint64_t> keys;
+    vector<typename map<string,T>::const_iterator> iterators;
+    map<uint64_t,string> seenKeys;
+    
+    for (auto it = entries.begin(); it != entries.end(); ++it)
+    {
+        uint64_t key = hashLangID(it->first);
+        auto result = seenKeys.emplace(key, it->first);
+        if (key == 0 || !result.second)
+        {
+            cout << "Hash collision between " << kind << " ids " << result.first->second
+                << " and " << it->first << "! Rename one of them." << endl;
+            return false;
+        }
+        
+        keys.push_back(key);
+        iterators.push_back(it);
+    }
+    
+    vector<uint32_t> displacements;
+    vector<size_t> slots;
+    if (!buildPerfectHash(keys, displacements, slots))
+    {
+        cout << "Failed to build the perfect hash for the " << kind << " table!" << endl;
+        return false;
+    }
+    
+    vector<size_t> entryForSlot(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) entryForSlot[slots[i]] = i;
+    
+    write_varlength(out, displacements.size());
+    out.write((const char*)displacements.data(), displacements.size() * sizeof(uint32_t));
+    
+    write_varlength(out, keys.size());
+    for (size_t i : entryForSlot)
+    {
+        out.write((const char*)&keys[i], sizeof(uint64_t));
+        writeEntry(iterators[i]->first, iterators[i]->second);
+    }
+    
+    return true;
+}
+
 bool parseLanguage(XMLDocument& doc, const string& inFile, map<string,PluralForm>& pluralForms,
     map<string,VariantForm>& variantForms, map<string,Pterm>& pterms, map<string,Vterm>& vterms,
     map<string,Pvterm>& pvterms, map<string,LangString>& strings, map<string,Formatter>& formatters)
@@ -254,6 +368,7 @@ bool parseLanguage(XMLDocument& doc, const string& inFile, map<string,PluralForm
             file = inFile.substr(0, pos+1) + file;
 
         XMLDocument subDoc;
+        noteDependency(file);
         if (subDoc.LoadFile(file.c_str()) != XML_SUCCESS)
         {
             cout << "Error while trying to read file " << file;
@@ -1122,38 +1237,54 @@ int exportLanguage(string inFile, string outFile)
         return -1;
     }
         
-    write_varlength(out, strings.size());
+    // All the strings go in a single blob, which the game keeps as-is and
+    // hands out views into; identical strings share the same bytes
+    string stringData;
+    map<string,size_t> stringOffsets;
+    map<string,pair<size_t,size_t>> stringRanges;
     for (const auto& string : strings)
     {
-        write_str(out, string.first);
-        write_str(out, string.second.str);
-        write_varlength(out, string.second.vcategoryAssociations.size());
-        for (const auto& pair : string.second.vcategoryAssociations)
+        const auto& str = string.second.str;
+        auto result = stringOffsets.emplace(str, stringData.size());
+        if (result.second) stringData += str;
+        stringRanges.emplace(string.first, make_pair(result.first->second, str.size()));
+    }
+    
+    write_str(out, stringData);
+    bool stringsWritten = writeLangIDTable(out, strings, "string", [&] (const string& name, const LangString& string)
+    {
+        const auto& range = stringRanges.at(name);
+        write_varlength(out, range.first);
+        write_varlength(out, range.second);
+        write_varlength(out, string.vcategoryAssociations.size());
+        for (const auto& pair : string.vcategoryAssociations)
         {
             write_varlength(out, pair.first);
             write_varlength(out, pair.second);
         }
-    }
+    });
     
-    write_varlength(out, formatters.size());
-    for (const auto& formatter : formatters)
+    if (!stringsWritten) return -1;
+    
+    bool formattersWritten = writeLangIDTable(out, formatters, "formatter", [&] (const string&, const Formatter& formatter)
     {
-        write_str(out, formatter.first);
-        write_str(out, formatter.second.modelString);
-        write_varlength(out, formatter.second.specifiers.size());
+        write_str(out, formatter.modelString);
+        write_varlength(out, formatter.specifiers.size());
         
-        for (const auto& specifier : formatter.second.specifiers)
+        for (const auto& specifier : formatter.specifiers)
         {
             write_varlength(out, specifier.byteLocation);
             out.write((const char*)&specifier.type, sizeof(uint8_t));
             
             if (specifier.type >= 2) write_varlength(out, specifier.term);
             
-            write_str(out, specifier.specifier1);
+            write_langid(out, specifier.specifier1);
             if (specifier.type == 4)
-                write_str(out, specifier.specifier2);
+                write_langid(out, specifier.specifier2);
         }
-    }
+    });
+    
+    if (!formattersWritten) return -1;
     
     write_varlength(out, pluralForms.size());
     for (const auto& pluralForm : pluralForms)
@@ -1168,6 +1299,18 @@ int exportLanguage(string inFile, string outFile)
                 write_varlength(out, 16);
             }
         }
+
+        // the unit each number picks, so the game only interprets the rules when they never repeat
+        vector<const ExpressionTree*> units;
+        for (const auto& p : pluralForm.second.pluralUnits) units.push_back(p.second.get());
+
+        vector<size_t> table;
+        size_t period = 0;
+        if (!compilePluralTable(units, table, period)) table.clear(), period = 0;
+
+        write_varlength(out, period);
+        write_varlength(out, table.size());
+        for (auto i : table) write_varlength(out, i);
     }
     
     write_varlength(out, pterms.size());
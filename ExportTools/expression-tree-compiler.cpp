@@ -27,6 +27,7 @@
 #include <stdexcept>
 #include <algorithm>
 #include <cstdlib>
+#include <numeric>
 #include "varlength.hpp"
 
 #define PRED(expr) ([] (auto c) { return (expr); })
@@ -427,3 +428,160 @@ void writeExpressionTree(std::ostream& out, const ExpressionTree& tree)
     write_varlength(out, opcodes.size());
     for (auto opcode : opcodes) write_varlength(out, opcode);
 }
+
+// How a subtree behaves as x grows: a constant, a*x + b with a >= 0, or a value that repeats
+// every `period` once x reaches `threshold`; anything else cannot be folded into a table
+struct TreeBehavior
+{
+    enum Kind { Constant, Affine, Periodic, Unknown } kind;
+    intmax_t a = 0, b = 0;
+    intmax_t threshold = 0, period = 1;
+};
+
+constexpr intmax_t MaxPluralTableSize = 1024;
+
+static bool evaluateTree(const ExpressionTree& tree, intmax_t x, intmax_t& result);
+
+static TreeBehavior unknownBehavior() { return { TreeBehavior::Unknown }; }
+
+static TreeBehavior affineBehavior(intmax_t a, intmax_t b)
+{
+    if (a == 0) return { TreeBehavior::Constant, 0, b };
+    return { TreeBehavior::Affine, a, b };
+}
+
+static TreeBehavior periodicBehavior(intmax_t threshold, intmax_t period)
+{
+    if (threshold + period > MaxPluralTableSize) return unknownBehavior();
+    return { TreeBehavior::Periodic, 0, 0, threshold, period };
+}
+
+static TreeBehavior analyzeTree(const ExpressionTree& tree)
+{
+    using Type = ExpressionTree::Type;
+
+    if (tree.getType() == Type::Number) return { TreeBehavior::Constant, 0, tree.getNumber() };
+    if (tree.getType() == Type::Letter) return { TreeBehavior::Affine, 1, 0 };
+
+    auto left = analyzeTree(*tree.getTreeNodeLeft()), right = analyzeTree(*tree.getTreeNodeRight());
+    if (left.kind == TreeBehavior::Unknown || right.kind == TreeBehavior::Unknown) return unknownBehavior();
+
+    auto type = tree.getType();
+    bool isDivision = type == Type::Divide || type == Type::Modulo;
+    bool isComparison = type >= Type::Equal && type <= Type::GreaterEqual;
+
+    // a division by zero makes the whole rule fail, so only fold constant divisors
+    if (isDivision && (right.kind != TreeBehavior::Constant || right.b == 0)) return unknownBehavior();
+
+    if (left.kind == TreeBehavior::Constant && right.kind == TreeBehavior::Constant)
+    {
+        intmax_t value;
+        evaluateTree(tree, 0, value);
+        return { TreeBehavior::Constant, 0, value };
+    }
+
+    if (left.kind == TreeBehavior::Affine || right.kind == TreeBehavior::Affine)
+    {
+        if (left.kind == TreeBehavior::Periodic || right.kind == TreeBehavior::Periodic) return unknownBehavior();
+
+        switch (type)
+        {
+            case Type::Add: return affineBehavior(left.a + right.a, left.b + right.b);
+            case Type::Subtract:
+                if (left.a < right.a) return unknownBehavior();
+                return affineBehavior(left.a - right.a, left.b - right.b);
+            case Type::Multiply:
+            {
+                if (left.a != 0 && right.a != 0) return unknownBehavior();
+                const auto& affine = left.a != 0 ? left : right;
+                intmax_t factor = left.a != 0 ? right.b : left.b;
+                if (factor < 0 || affine.a * factor > MaxPluralTableSize) return unknownBehavior();
+                return affineBehavior(affine.a * factor, affine.b * factor);
+            }
+            case Type::Modulo:
+            {
+                // a*x + b mod m repeats every m steps once a*x + b stops being negative
+                intmax_t threshold = left.b >= 0 ? 0 : (-left.b + left.a - 1) / left.a;
+                return periodicBehavior(threshold, right.b < 0 ? -right.b : right.b);
+            }
+            default:
+            {
+                if (!isComparison || (left.a != 0 && right.a != 0)) return unknownBehavior();
+
+                // the affine side stays strictly greater than the other once x passes this point
+                const auto& affine = left.a != 0 ? left : right;
+                const auto& constant = left.a != 0 ? right : left;
+                intmax_t difference = constant.b - affine.b;
+                return periodicBehavior(difference < 0 ? 0 : difference / affine.a + 1, 1);
+            }
+        }
+    }
+
+    return periodicBehavior(std::max(left.threshold, right.threshold), std::lcm(left.period, right.period));
+}
+
+// Same semantics as runExpression in the game: a division by zero fails the whole rule
+static bool evaluateTree(const ExpressionTree& tree, intmax_t x, intmax_t& result)
+{
+    using Type = ExpressionTree::Type;
+
+    if (tree.getType() == Type::Number) { result = tree.getNumber(); return true; }
+    if (tree.getType() == Type::Letter) { result = x; return true; }
+
+    intmax_t a, b;
+    if (!evaluateTree(*tree.getTreeNodeLeft(), x, a) || !evaluateTree(*tree.getTreeNodeRight(), x, b)) return false;
+
+    switch (tree.getType())
+    {
+        case Type::Add: result = a + b; break;
+        case Type::Subtract: result = a - b; break;
+        case Type::Multiply: result = a * b; break;
+        case Type::Divide: if (b == 0) return false; result = a / b; break;
+        case Type::Modulo: if (b == 0) return false; result = a % b; break;
+        case Type::Equal: result = a == b; break;
+        case Type::NotEqual: result = a != b; break;
+        case Type::Less: result = a < b; break;
+        case Type::Greater: result = a > b; break;
+        case Type::LessEqual: result = a <= b; break;
+        case Type::GreaterEqual: result = a >= b; break;
+        case Type::And: result = a && b; break;
+        case Type::Or: result = a || b; break;
+        case Type::Xor: result = (a != 0) != (b != 0); break;
+        default: return false;
+    }
+
+    return true;
+}
+
+bool compilePluralTable(const std::vector<const ExpressionTree*>& units, std::vector<size_t>& table, size_t& period)
+{
+    intmax_t threshold = 0, commonPeriod = 1;
+    for (auto unit : units)
+    {
+        if (!unit) continue;
+
+        auto behavior = analyzeTree(*unit);
+        if (behavior.kind == TreeBehavior::Unknown || behavior.kind == TreeBehavior::Affine) return false;
+        if (behavior.kind == TreeBehavior::Constant) continue;
+
+        auto merged = periodicBehavior(std::max(threshold, behavior.threshold), std::lcm(commonPeriod, behavior.period));
+        if (merged.kind == TreeBehavior::Unknown) return false;
+        threshold = merged.threshold;
+        commonPeriod = merged.period;
+    }
+
+    table.clear();
+    for (intmax_t x = 0; x < threshold + commonPeriod; x++)
+    {
+        size_t i;
+        for (i = 0; i < units.size(); i++)
+        {
+            intmax_t result;
+            if (!units[i] || (evaluateTree(*units[i], x, result) && result)) break;
+        }
+        table.push_back(i);
+    }
+
+    period = commonPeriod;
+    return true;
+}
@@ -26,6 +26,7 @@
 #include <memory>
 #include <string>
 #include <iostream>
+#include <vector>
 
 class ExpressionTree final
 {
@@ -59,3 +60,7 @@ std::unique_ptr<ExpressionTree> compileExpression(std::string expr);
 void printTree(const ExpressionTree& tree);
 void writeExpressionTree(std::ostream& out, const ExpressionTree& tree);
 
+// Folds the rules of a plural form (null ones always match) into the unit picked for each x below
+// table.size(), with larger x repeating the last `period` entries; fails if some rule never repeats
+bool compilePluralTable(const std::vector<const ExpressionTree*>& units, std::vector<size_t>& table, size_t& period);
+
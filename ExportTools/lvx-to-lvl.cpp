@@ -27,12 +27,37 @@
 #include <cstdint>
 #include <cstdlib>
 #include <string>
-#include <memory>
+#include <vector>
 #include "tinyxml2.h"
 #include "varlength.hpp"
 
+#include <FlatLayouts.hpp>
+
 using namespace std;
 using namespace tinyxml2; 
+using namespace util;
+
+extern bool exportLegacyFormat;
+
+static void writeFlatLevel(ostream& out, uint16_t number, uint16_t startingRoom, uint32_t color,
+    const char* songName, const vector<const char*>& names)
+{
+    flat_writer writer("LEVEL");
+
+    flat_level_info info{};
+    info.levelNumber = number;
+    info.startingRoom = startingRoom;
+    memcpy(info.mapColor, &color, sizeof(uint32_t));
+    info.songName = writer.addString(songName);
+    writer.addSection(FlatLevelInfo, vector<flat_level_info>{ info });
+
+    vector<flat_string> roomNames;
+    for (auto name : names)
+        roomNames.push_back(writer.addString(name ? name : ""));
+    writer.addSection(FlatLevelRoomNames, roomNames);
+
+    writer.write(out);
+}
 
 int lvxToLvl(string inFile, string outFile)
 {
@@ -45,20 +70,13 @@ int lvxToLvl(string inFile, string outFile)
 
 	XMLHandle docHandle(doc);
 
-	ofstream out(outFile, ios::out | ios::binary);
-	out.write("LEVEL", 5);
-
     auto lvl = docHandle.FirstChildElement("level");
     
     uint16_t number = lvl.ToElement()->UnsignedAttribute("number");
     auto songName = lvl.ToElement()->Attribute("song");
     uint32_t songNameS = strlen(songName);
 
-    out.write((const char*)&number, sizeof(uint16_t));
-
     uint16_t startingRoom = (uint16_t)-1;
-    auto startingRoomPos = out.tellp();
-    out.write((const char*)&startingRoom, sizeof(uint16_t));
 
     auto colorVal = lvl.ToElement()->Attribute("map-color");
     if (colorVal == nullptr)
@@ -77,10 +95,6 @@ int lvxToLvl(string inFile, string outFile)
     uint32_t red = color & 0xFF0000;
     uint32_t blue = color & 0xFF;
     color = (color & 0xFF00FF00) | 0xFF000000 | (red >> 16) | (blue << 16);
-    out.write((const char*)&color, sizeof(uint32_t));
-
-    write_varlength(out, songNameS);
-    out.write(songName, songNameS * sizeof(char));
 
     uint32_t maxId = 0;
     for (auto rm = lvl.FirstChildElement("room"); rm.ToElement(); rm = rm.NextSiblingElement("room"))
@@ -90,9 +104,7 @@ int lvxToLvl(string inFile, string outFile)
     }
 
     maxId++;
-    write_varlength(out, maxId);  
-
-    unique_ptr<const char*[]> names{ new const char*[maxId] };
+    vector<const char*> names(maxId, nullptr);
 
     for (auto rm = lvl.FirstChildElement("room"); rm.ToElement(); rm = rm.NextSiblingElement("room"))
     {
@@ -103,6 +115,22 @@ int lvxToLvl(string inFile, string outFile)
             startingRoom = id;
     }
 
+    ofstream out(outFile, ios::out | ios::binary);
+    if (!exportLegacyFormat)
+    {
+        writeFlatLevel(out, number, startingRoom, color, songName, names);
+        return 0;
+    }
+
+    out.write("LEVEL", 5);
+    out.write((const char*)&number, sizeof(uint16_t));
+    out.write((const char*)&startingRoom, sizeof(uint16_t));
+    out.write((const char*)&color, sizeof(uint32_t));
+
+    write_varlength(out, songNameS);
+    out.write(songName, songNameS * sizeof(char));
+
+    write_varlength(out, maxId);
     for (uint32_t i = 0; i < maxId; i++)
     {
         const char* name = names[i];
@@ -118,8 +146,5 @@ int lvxToLvl(string inFile, string outFile)
 
     write_varlength(out, 0);
 
-    out.seekp(startingRoomPos);
-    out.write((const char*)&startingRoom, sizeof(uint16_t));
-
     return 0;
 }
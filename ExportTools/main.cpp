@@ -38,7 +38,10 @@ int tmxToMap(std::string, std::string);
 int lvxToLvl(std::string, std::string);
 int tsxToTs(std::string, std::string);
 int pexToPe(std::string, std::string);
+int bakeFont(std::string, std::string);
 int exportLanguage(std::string, std::string);
+int packResources(std::string, std::string);
+int batchExport(std::string, std::string);
 
 const std::map<std::string,Descriptor> toolList =
 {
@@ -46,9 +49,19 @@ const std::map<std::string,Descriptor> toolList =
     { "lvxToLvl", { lvxToLvl, "converts a XML document describing a level into a form accessible by the engine" } },
     { "tsxToTs", { tsxToTs, "converts a XML document describing a tileset into a form accessible by the engine" } },
     { "pexToPe", { pexToPe, "converts a XML document describing a particle emitter into a form accessible by the engine" } },
+    { "bakeFont", { bakeFont, "bakes the glyphs used by a set of languages into a signed distance field font" } },
     { "exportLanguage", { exportLanguage, "converts a language descriptor file into a binary form" } },
+    { "packResources", { packResources, "packs a directory or a manifest of exported resources into a single archive" } },
+    { "batch", { batchExport, "exports every source in a directory or a manifest in parallel, skipping the ones that did not change" } },
 };
 
+// Rooms, tilesets, levels and particle emitters are exported in the flat layout unless
+// the old stream format is requested, which the game still reads
+bool exportLegacyFormat = false;
+
+// Batch mode hashes the toolkit itself, so a rebuilt toolkit exports everything again
+const char* exportToolsExecutable = nullptr;
+
 void printAllTools()
 {
     std::cout << "List of current tools on the toolkit:" << std::endl;
@@ -61,7 +74,7 @@ int main(int argc, char **argv)
 {
     if (argc < 4)
     {
-        std::cout << "Usage: " << argv[0] << " <tool> <input> <output>" << std::endl;
+        std::cout << "Usage: " << argv[0] << " <tool> <input> <output> [--legacy-format]" << std::endl;
         return -1;
     }
 
@@ -100,5 +113,9 @@ int main(int argc, char **argv)
         return -1;
     }
 
+    if (argc > 4 && std::string(argv[4]) == "--legacy-format")
+        exportLegacyFormat = true;
+
+    exportToolsExecutable = argv[0];
     return it->second.tool(argv[2], argv[3]);
 }
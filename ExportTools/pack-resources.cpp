@@ -0,0 +1,179 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <filesystem>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+// Keep in sync with MainGame/resources/PackResourceLocator.hpp
+#pragma pack(push, 1)
+struct pack_header
+{
+    char magic[4];
+    uint32_t version, entryCount, nameBlobSize;
+};
+
+struct pack_entry
+{
+    uint64_t offset, size;
+    uint32_t nameOffset, nameLength;
+};
+#pragma pack(pop)
+
+constexpr uint32_t PackVersion = 1;
+constexpr uint64_t PackDataAlignment = 16;
+
+struct pack_input
+{
+    string name;
+    fs::path path;
+};
+
+static bool collectDirectory(const fs::path& dir, vector<pack_input>& inputs)
+{
+    error_code ec;
+    for (fs::recursive_directory_iterator it(dir, ec), end; it != end; it.increment(ec))
+    {
+        if (ec) break;
+        if (!it->is_regular_file()) continue;
+        inputs.push_back({ fs::relative(it->path(), dir).generic_string(), it->path() });
+    }
+
+    if (ec)
+    {
+        cout << "Error while listing directory " << dir << ": " << ec.message() << "." << endl;
+        return false;
+    }
+
+    return true;
+}
+
+// A manifest lists one file per line, relative to the manifest's directory
+static bool collectManifest(const fs::path& manifest, vector<pack_input>& inputs)
+{
+    ifstream in(manifest);
+    if (!in)
+    {
+        cout << "Error while trying to read manifest " << manifest << "." << endl;
+        return false;
+    }
+
+    auto base = manifest.parent_path();
+    string line;
+    while (getline(in, line))
+    {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+        inputs.push_back({ fs::path(line).generic_string(), base / line });
+    }
+
+    return true;
+}
+
+int packResources(string inFile, string outFile)
+{
+    vector<pack_input> inputs;
+
+    bool success = fs::is_directory(inFile) ? collectDirectory(inFile, inputs) : collectManifest(inFile, inputs);
+    if (!success) return -1;
+
+    // the runtime binary searches the index, so it must be sorted by name
+    sort(inputs.begin(), inputs.end(), [](const auto& a, const auto& b) { return a.name < b.name; });
+    auto dup = adjacent_find(inputs.begin(), inputs.end(), [](const auto& a, const auto& b) { return a.name == b.name; });
+    if (dup != inputs.end())
+    {
+        cout << "Error: resource " << dup->name << " appears more than once in " << inFile << "." << endl;
+        return -1;
+    }
+
+    vector<pack_entry> entries(inputs.size());
+    string nameBlob;
+
+    uint64_t headerSize = sizeof(pack_header) + inputs.size() * sizeof(pack_entry);
+    for (const auto& input : inputs) headerSize += input.name.size();
+
+    auto align = [](uint64_t val) { return (val + PackDataAlignment - 1) & ~(PackDataAlignment - 1); };
+    uint64_t curOffset = align(headerSize);
+
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        error_code ec;
+        auto size = fs::file_size(inputs[i].path, ec);
+        if (ec)
+        {
+            cout << "Error while trying to read file " << inputs[i].path << ": " << ec.message() << "." << endl;
+            return -1;
+        }
+
+        entries[i].offset = curOffset;
+        entries[i].size = size;
+        entries[i].nameOffset = (uint32_t)nameBlob.size();
+        entries[i].nameLength = (uint32_t)inputs[i].name.size();
+        nameBlob += inputs[i].name;
+
+        curOffset = align(curOffset + size);
+    }
+
+    ofstream out(outFile, ios::out | ios::binary);
+    if (!out)
+    {
+        cout << "Error while trying to open " << outFile << " for writing." << endl;
+        return -1;
+    }
+
+    pack_header header;
+    memcpy(header.magic, "RPAK", 4);
+    header.version = PackVersion;
+    header.entryCount = (uint32_t)entries.size();
+    header.nameBlobSize = (uint32_t)nameBlob.size();
+
+    out.write((const char*)&header, sizeof(pack_header));
+    out.write((const char*)entries.data(), entries.size() * sizeof(pack_entry));
+    out.write(nameBlob.data(), nameBlob.size());
+
+    vector<char> buffer;
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        while ((uint64_t)out.tellp() < entries[i].offset) out.put(0);
+
+        ifstream in(inputs[i].path, ios::in | ios::binary);
+        buffer.resize(entries[i].size);
+        if (!in.read(buffer.data(), buffer.size()))
+        {
+            cout << "Error while trying to read file " << inputs[i].path << "." << endl;
+            return -1;
+        }
+
+        out.write(buffer.data(), buffer.size());
+    }
+
+    return out ? 0 : -1;
+}
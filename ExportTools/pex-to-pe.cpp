@@ -34,6 +34,8 @@
 #include "tinyxml2.h"
 #include "varlength.hpp"
 
+#include <FlatLayouts.hpp>
+
 #if _WIN32
 #define strcasecmp _stricmp
 #define strncasecmp _strnicmp
@@ -41,6 +43,9 @@
 
 using namespace std;
 using namespace tinyxml2;
+using namespace util;
+
+extern bool exportLegacyFormat;
 
 #pragma pack(push, 1)
 template <typename T>
@@ -64,6 +69,8 @@ struct ParticleEmitterStruct
 };
 #pragma pack(pop)
 
+static_assert(sizeof(ParticleEmitterStruct) == sizeof(flat_particle_emitter), "Particle emitter layouts differ!");
+
 static bool read(XMLElement* el, float& val)
 {
     return el->QueryFloatAttribute("value", &val) == XML_SUCCESS;
@@ -164,9 +171,6 @@ int pexToPe(string inFile, string outFile)
 
     XMLHandle docHandle(doc);
 
-    ofstream out(outFile, ios::out | ios::binary);
-    out.write("PEMIT", 5);
-
     unordered_map<std::string,ParticleEmitterStruct> emitters;
     emitters.emplace("", ParticleEmitterStruct());
 
@@ -204,6 +208,26 @@ int pexToPe(string inFile, string outFile)
         readParam(emitter, "generate-hsv", name, extends, &ParticleEmitterStruct::generateHSV);
     }
 
+    ofstream out(outFile, ios::out | ios::binary);
+    if (!exportLegacyFormat)
+    {
+        flat_writer writer("PEMIT");
+        vector<flat_string> names;
+        vector<flat_particle_emitter> records;
+        for (const auto& pair : emitters)
+        {
+            names.push_back(writer.addString(pair.first));
+            records.emplace_back();
+            memcpy(&records.back(), &pair.second, sizeof(flat_particle_emitter));
+        }
+
+        writer.addSection(FlatEmitterNames, names);
+        writer.addSection(FlatEmitters, records);
+        writer.write(out);
+        return 0;
+    }
+
+    out.write("PEMIT", 5);
     write_varlength(out, emitters.size());
     for (const auto& pair : emitters)
     {
@@ -0,0 +1,266 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+
+#include "room-shapes.hpp"
+
+#include <utility>
+#include "varlength.hpp"
+#include "RoomSegments.hpp"
+
+using namespace std;
+
+// Mirrors TileSet::TileType, TileSet::Attribute and TileSet::SingleObject::ShapeType in the game
+enum TileType : uint8_t
+{
+    None, TerrainUpperLeft, TerrainUp, TerrainUpperRight, TerrainLeft,
+    TerrainCenter, TerrainRight, TerrainLowerLeft, TerrainDown, TerrainLowerRight,
+    SemiTerrain1, SemiTerrain2, SemiTerrain3, SingleObjectTile
+};
+
+enum Attribute : uint8_t { AttrNone, Solid, NoWalljump, Spike, Crumbling,
+    LeftSolid, RightSolid, UpSolid, DownSolid, LeftNoWalljump, RightNoWalljump };
+
+enum ObjectShapeType : uint8_t { ObjectTile, ObjectCircle, ObjectSegment, ObjectPolygon, ObjectBox };
+
+// The shape kinds written to the room file
+enum RoomShapeType : uint8_t { ShapeSegment, ShapeCircle, ShapePolygon };
+
+constexpr float DefaultTileSize = 32;
+
+template <typename T, typename... Ts>
+static constexpr bool isContained(T comp, Ts... values)
+{
+    return ((comp == (T)values) || ...);
+}
+
+static bool isTerrain(uint8_t type) { return type >= TerrainUpperLeft && type <= TerrainLowerRight; }
+static bool isSemiTerrain(uint8_t type) { return type >= SemiTerrain1 && type <= SemiTerrain3; }
+static bool isSingleObject(uint8_t type) { return type == SingleObjectTile; }
+
+static bool refersToSame(const tile_params& t1, const tile_params& t2)
+{
+    if (t1.type == None) return t2.type == None;
+    if (t2.type == None) return false;
+
+    if (!(isTerrain(t1.type) && isTerrain(t2.type)) &&
+        !(isSemiTerrain(t1.type) && isSemiTerrain(t2.type)) &&
+        !(isSingleObject(t1.type) && isSingleObject(t2.type)))
+        return false;
+
+    return t1.id == t2.id;
+}
+
+namespace
+{
+    // Gives util::generateRoomSegments the same view of the tileset the game has
+    struct indexed_tileset
+    {
+        using TileType = ::TileType;
+        using Attribute = ::Attribute;
+
+        const tileset_params& params;
+        vector<const terrain_params*> terrains;
+        vector<const single_object_params*> singleObjects;
+
+        indexed_tileset(const tileset_params& params) : params(params)
+        {
+            for (const auto& pair : params.terrains) terrains.push_back(&pair.second);
+            for (const auto& pair : params.singleObjects) singleObjects.push_back(&pair.second);
+        }
+
+        const tile_params& identity(uint8_t tile) const
+        {
+            static const tile_params none;
+            return tile < params.tiles.size() ? params.tiles[tile] : none;
+        }
+
+        uint8_t attribute(uint8_t tile) const
+        {
+            const auto& id = identity(tile);
+            if (isTerrain(id.type)) return terrains[id.id]->attribute;
+            else if (isSemiTerrain(id.type)) return LeftSolid + id.id;
+            else if (isSingleObject(id.type)) return singleObjects[id.id]->attribute;
+            else return AttrNone;
+        }
+
+        static bool isTerrain(uint8_t type) { return ::isTerrain(type); }
+        static bool isSemiTerrain(uint8_t type) { return ::isSemiTerrain(type); }
+        static bool isIdHorizontalSemiTerrain(size_t id) { return isContained(id, 0, 1, 4, 5); }
+        static bool isIdVerticalSemiTerrain(size_t id) { return isContained(id, 2, 3); }
+        static bool refersToSame(const tile_params& t1, const tile_params& t2) { return ::refersToSame(t1, t2); }
+    };
+}
+
+template <bool Vertical>
+static void convertSegments(vector<room_shape>& shapes, const indexed_tileset& tileSet,
+    const vector<util::RoomSegment>& segments)
+{
+    // pair::first is the x coordinate, so i runs along it on horizontal segments
+    auto pi = Vertical ? &pair<float,float>::second : &pair<float,float>::first;
+    auto pj = Vertical ? &pair<float,float>::first : &pair<float,float>::second;
+
+    for (const util::RoomSegment& segment : segments)
+    {
+        // Semi-terrains use the default physical parameters
+        int16_t defaultParams[5] = { 0, 0, 0, 0, 1 };
+        const int16_t* physParams = segment.isSemiTerrain ? defaultParams : tileSet.terrains[segment.terrain]->physParams;
+
+        float cornerRadius = physParams[4];
+        auto coords = util::getRoomSegmentCoordinates<Vertical>(segment, DefaultTileSize,
+            physParams[0], physParams[1], physParams[2], physParams[3], cornerRadius);
+
+        pair<float,float> endPoint1, endPoint2;
+        endPoint1.*pj = endPoint2.*pj = coords.j;
+        endPoint1.*pi = coords.i1;
+        endPoint2.*pi = coords.i2;
+
+        room_shape shape;
+        shape.attribute = segment.isSemiTerrain ? LeftSolid + segment.terrain :
+            tileSet.terrains[segment.terrain]->attribute;
+        shape.radius = cornerRadius;
+        shape.object = nullptr;
+
+        if (cornerRadius > DefaultTileSize/4)
+        {
+            shape.type = ShapeSegment;
+            shape.points = { endPoint1, endPoint2 };
+        }
+        else
+        {
+            shape.type = ShapePolygon;
+            shape.points = { endPoint1, endPoint2, endPoint2, endPoint1 };
+
+            float thickness = segment.isOtherEnd ? -DefaultTileSize/2 : DefaultTileSize/2;
+            shape.points[2].*pj += thickness;
+            shape.points[3].*pj += thickness;
+
+            if (Vertical != segment.isOtherEnd)
+                swap(shape.points[1], shape.points[3]);
+        }
+
+        shapes.push_back(move(shape));
+    }
+}
+
+static void convertSingleObjects(vector<room_shape>& shapes, const indexed_tileset& tileSet, const room_layer& layer)
+{
+    for (size_t y = 0; y < layer.height; y++)
+        for (size_t x = 0; x < layer.width; x++)
+        {
+            const auto& identity = tileSet.identity(layer(x, y));
+            if (!isSingleObject(identity.type)) continue;
+
+            const auto& object = *tileSet.singleObjects[identity.id];
+            float dx = x * DefaultTileSize, dy = y * DefaultTileSize;
+
+            for (const auto& shp : object.shapes)
+            {
+                room_shape shape;
+                shape.attribute = object.attribute;
+                shape.radius = shp.radius;
+                shape.object = &object;
+                shape.x = x;
+                shape.y = y;
+
+                switch (shp.type)
+                {
+                    case ObjectTile:
+                    {
+                        float width = DefaultTileSize - shp.radius;
+                        float height = DefaultTileSize - shp.radius;
+                        shape.type = ShapePolygon;
+                        shape.points = { { dx, dy }, { dx+width, dy }, { dx+width, dy+height }, { dx, dy+height } };
+                    } break;
+                    case ObjectCircle:
+                        shape.type = ShapeCircle;
+                        shape.points = { { dx, dy } };
+                        break;
+                    case ObjectSegment:
+                        shape.type = ShapeSegment;
+                        shape.points = { { dx + shp.points[0], dy + shp.points[1] },
+                                         { dx + shp.points[2], dy + shp.points[3] } };
+                        break;
+                    case ObjectPolygon:
+                        shape.type = ShapePolygon;
+                        for (size_t i = 0; i+1 < shp.points.size(); i += 2)
+                            shape.points.emplace_back(dx + shp.points[i], dy + shp.points[i+1]);
+                        break;
+                    case ObjectBox:
+                    {
+                        // boxes are stored as polygons in the tileset
+                        auto& pts = shp.points;
+                        shape.type = ShapePolygon;
+                        shape.points = { { dx + pts[0], dy + pts[1] }, { dx + pts[2], dy + pts[1] },
+                                         { dx + pts[2], dy + pts[3] }, { dx + pts[0], dy + pts[3] } };
+                    } break;
+                }
+
+                shapes.push_back(move(shape));
+            }
+        }
+}
+
+vector<room_shape> generateRoomShapes(const room_layer& layer, const tileset_params& tileset)
+{
+    indexed_tileset tileSet(tileset);
+
+    vector<util::RoomSegment> horizontalSegments, verticalSegments;
+    util::generateRoomSegments<false>(horizontalSegments, tileSet, layer, layer.width, layer.height);
+    util::generateRoomSegments<true>(verticalSegments, tileSet, layer, layer.width, layer.height);
+
+    vector<room_shape> shapes;
+    convertSegments<false>(shapes, tileSet, horizontalSegments);
+    convertSegments<true>(shapes, tileSet, verticalSegments);
+    convertSingleObjects(shapes, tileSet, layer);
+
+    return shapes;
+}
+
+void writeRoomShapes(ostream& out, const vector<room_shape>& shapes)
+{
+    out.write("SHPS", 4);
+    write_varlength(out, shapes.size());
+    for (const auto& shape : shapes)
+    {
+        out.write((const char*)&shape.type, sizeof(uint8_t));
+        out.write((const char*)&shape.attribute, sizeof(uint8_t));
+        out.write((const char*)&shape.radius, sizeof(float));
+
+        write_varlength(out, shape.points.size());
+        for (const auto& point : shape.points)
+        {
+            out.write((const char*)&point.first, sizeof(float));
+            out.write((const char*)&point.second, sizeof(float));
+        }
+
+        if (shape.attribute == Crumbling)
+        {
+            write_varlength(out, shape.x);
+            write_varlength(out, shape.y);
+            out.write((const char*)&shape.object->waitTime, sizeof(float));
+            out.write((const char*)&shape.object->crumbleTime, sizeof(float));
+            write_varlength(out, shape.object->crumblePieceSize);
+        }
+    }
+}
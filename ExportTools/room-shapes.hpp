@@ -0,0 +1,53 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include "tileset-loader.hpp"
+
+struct room_layer
+{
+    size_t width = 0, height = 0;
+    std::vector<uint8_t> tiles;
+
+    uint8_t operator()(size_t x, size_t y) const { return tiles[y*width + x]; }
+};
+
+struct room_shape
+{
+    uint8_t type, attribute;
+    float radius;
+    std::vector<std::pair<float,float>> points;
+    const single_object_params* object; // only set for single objects
+    size_t x, y;
+};
+
+// Runs the same segmentation the game does on a room's main layer, so the game
+// only has to instantiate the resulting collision shapes
+std::vector<room_shape> generateRoomShapes(const room_layer& layer, const tileset_params& tileset);
+void writeRoomShapes(std::ostream& out, const std::vector<room_shape>& shapes);
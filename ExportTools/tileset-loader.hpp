@@ -0,0 +1,71 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#pragma pack(push, 1)
+struct terrain_params
+{
+    uint8_t attribute;
+    int16_t physParams[5];
+};
+#pragma pack(pop)
+
+struct single_object_params
+{
+    struct shape_params
+    {
+        uint8_t type;
+        int16_t radius;
+        std::vector<int16_t> points;
+    };
+
+    uint8_t attribute;
+    float waitTime, crumbleTime;
+    size_t crumblePieceSize;
+    std::vector<shape_params> shapes;
+};
+
+struct tile_params
+{
+    uint8_t type = 0;
+    size_t id = 0;
+};
+
+// Terrain and single object ids are their positions in the maps' iteration order
+struct tileset_params
+{
+    bool onlyIncludes = false;
+    std::string textureName;
+    std::unordered_map<std::string,terrain_params> terrains;
+    std::unordered_map<std::string,single_object_params> singleObjects;
+    std::vector<tile_params> tiles;
+};
+
+bool loadTileSet(std::string inFile, tileset_params& tileset);
@@ -30,8 +30,12 @@
 #include <cstdlib>
 #include <unordered_map>
 #include "object-writers-helpers.hpp"
+#include "room-shapes.hpp"
 #include "tinyxml2.h"
 #include "varlength.hpp"
+#include "dependencies.hpp"
+
+#include <FlatLayouts.hpp>
 
 #if _WIN32
 #define strcasecmp _stricmp
@@ -41,7 +45,10 @@
 using namespace std;
 using namespace tinyxml2;
 
+using namespace util;
+
 extern unordered_map<string,bool(*)(Object,ostream&)> objectWriters;
+extern bool exportLegacyFormat;
 
 auto findObjectLayer(XMLHandle map, const char* name)
 {
@@ -53,6 +60,18 @@ auto findObjectLayer(XMLHandle map, const char* name)
     return XMLHandle(nullptr);
 }
 
+struct room_object
+{
+    string klass, name;
+    string parameters;
+};
+
+static void writeString(ostream& out, const string& str)
+{
+    write_varlength(out, str.size());
+    out.write(str.data(), str.size() * sizeof(char));
+}
+
 auto nextcsv(const char* ch)
 {
     auto ptr = strchr(ch, ',');
@@ -70,9 +89,6 @@ int tmxToMap(string inFile, string outFile)
 
 	XMLHandle docHandle(doc);
 
-	ofstream out(outFile, ios::out | ios::binary);
-	out.write("ROOM", 4);
-
 	auto map = docHandle.FirstChildElement("map");
 	auto tset = map.FirstChildElement("tileset");
 
@@ -90,23 +106,16 @@ int tmxToMap(string inFile, string outFile)
         }
     }
 
-	if (tilesetName)
-	{
-        auto s = strlen(tilesetName);
-		write_varlength(out, s);
-		out.write(tilesetName, s * sizeof(char));
-	}
-    else write_varlength(out, 0);
-
 	uint32_t width, height;
+	room_layer roomLayer;
 	auto layer = map.FirstChildElement("layer");
 	if (layer.ToElement())
 	{
 		width = layer.ToElement()->UnsignedAttribute("width");
 		height = layer.ToElement()->UnsignedAttribute("height");
 
-		write_varlength(out, width);
-        write_varlength(out, height);
+		roomLayer.width = width;
+		roomLayer.height = height;
 
 		auto data = layer.FirstChildElement("data");
 		auto txt = data.FirstChild().ToText()->Value();
@@ -118,14 +127,13 @@ int tmxToMap(string inFile, string outFile)
 		{
 			uint8_t v = (uint8_t)strtoul(ch, nullptr, 10)-firstId; // NOT UB!
 			if (v > maxTile) v = maxTile;
-			out.write((const char*)&v, sizeof(uint8_t));
+			roomLayer.tiles.push_back(v);
 
 			writtenTiles++;
 		}
 	}
 
-    uint32_t objTotal = 0;
-    stringstream objects(stringstream::binary | stringstream::out);
+    vector<room_object> objects;
     
     auto objgroup = findObjectLayer(map, "object-layer");
     for (auto obj = objgroup.FirstChildElement("object"); obj.ToElement(); obj = obj.NextSiblingElement("object"))
@@ -133,14 +141,7 @@ int tmxToMap(string inFile, string outFile)
         auto elm = obj.ToElement();
 
         auto typeStr = elm->Attribute("type");
-        uint32_t tsize = strlen(typeStr);
-        write_varlength(objects, tsize);
-        objects.write(typeStr, tsize * sizeof(char));
-        
         auto nameStr = elm->Attribute("name");
-        uint32_t nsize = strlen(nameStr);
-        write_varlength(objects, nsize);
-        objects.write(nameStr, nsize * sizeof(char));
 
         stringstream curObj(stringstream::binary | stringstream::out);
 
@@ -161,14 +162,9 @@ int tmxToMap(string inFile, string outFile)
             return false;
         }
 
-        objects << curObj.str();
-        objTotal++;
+        objects.push_back({ typeStr, nameStr, curObj.str() });
     }
 
-    write_varlength(out, objTotal);
-    out << objects.str();
-    objects.clear();
-
     auto warps = findObjectLayer(map, "warp-layer");
 
     uint32_t maxId = (uint32_t)-1;
@@ -180,14 +176,7 @@ int tmxToMap(string inFile, string outFile)
     }
 
     maxId++;
-    write_varlength(out, maxId);
-    auto globalSizePos = out.tellp();
-    
-    for (uint32_t i = 0; i < maxId; i++)
-    {
-        int16_t values[4] = { -1, -1, -1, -1 };
-        out.write((const char*)values, 4*sizeof(int16_t));
-    }
+    vector<flat_room_warp> warpData(maxId, flat_room_warp{ -1, -1, (uint16_t)-1, (uint16_t)-1 });
 
     for (auto obj = warps.FirstChildElement("object"); obj.ToElement(); obj = obj.NextSiblingElement("object"))
     {
@@ -231,12 +220,107 @@ int tmxToMap(string inFile, string outFile)
             c2 = c1 + warp->IntAttribute("height");
         }
 
-        out.seekp(globalSizePos + streamoff(4*sizeof(int16_t) * id));
-        out.write((const char*)&c1, sizeof(int16_t));
-        out.write((const char*)&c2, sizeof(int16_t));
-        out.write((const char*)&roomId, sizeof(uint16_t));
-        out.write((const char*)&warpId, sizeof(uint16_t));
+        warpData[id] = { c1, c2, roomId, warpId };
+    }
+
+    // Collision shapes depend only on the layer and the tileset, so they are generated here
+    // instead of on every room load; the game still generates them for rooms without them
+    bool hasShapes = false;
+    vector<room_shape> shapes;
+    tileset_params tileset;
+    if (tilesetName && roomLayer.tiles.size() == (size_t)roomLayer.width * roomLayer.height)
+    {
+        string tilesetFile = string(tilesetName) + ".tsx";
+        auto pos = inFile.find_last_of("\\/");
+        if (pos != string::npos)
+            tilesetFile = inFile.substr(0, pos+1) + tilesetFile;
+
+        noteDependency(tilesetFile);
+        if (!loadTileSet(tilesetFile, tileset) || tileset.onlyIncludes)
+        {
+            cout << "Error while loading tileset " << tilesetFile << " requested by " << inFile << "." << endl;
+            return -1;
+        }
+
+        shapes = generateRoomShapes(roomLayer, tileset);
+        hasShapes = true;
+    }
+
+    ofstream out(outFile, ios::out | ios::binary);
+    if (exportLegacyFormat)
+    {
+        out.write("ROOM", 4);
+        writeString(out, tilesetName ? tilesetName : "");
+
+        if (layer.ToElement())
+        {
+            write_varlength(out, roomLayer.width);
+            write_varlength(out, roomLayer.height);
+            out.write((const char*)roomLayer.tiles.data(), roomLayer.tiles.size() * sizeof(uint8_t));
+        }
+
+        write_varlength(out, objects.size());
+        for (const auto& object : objects)
+        {
+            writeString(out, object.klass);
+            writeString(out, object.name);
+            out << object.parameters;
+        }
+
+        write_varlength(out, warpData.size());
+        out.write((const char*)warpData.data(), warpData.size() * sizeof(flat_room_warp));
+
+        if (hasShapes) writeRoomShapes(out, shapes);
+        return 0;
+    }
+
+    flat_writer writer("ROOM");
+    writer.addSection(FlatRoomInfo, vector<flat_room_info>
+        { { writer.addString(tilesetName ? tilesetName : ""), (uint32_t)roomLayer.width, (uint32_t)roomLayer.height } });
+    writer.addSection(FlatRoomLayer, roomLayer.tiles);
+
+    vector<flat_room_object> objectRecords;
+    string parameters;
+    for (const auto& object : objects)
+    {
+        objectRecords.push_back({ writer.addString(object.klass), writer.addString(object.name),
+            (uint32_t)parameters.size(), (uint32_t)object.parameters.size() });
+        parameters += object.parameters;
+    }
+    writer.addSection(FlatRoomObjects, objectRecords);
+    writer.addSection(FlatRoomParameters, 1, parameters.size(), parameters.data());
+    writer.addSection(FlatRoomWarps, warpData);
+
+    if (hasShapes)
+    {
+        vector<flat_room_shape> shapeRecords;
+        vector<flat_point> points;
+        for (const auto& shape : shapes)
+        {
+            flat_room_shape record{};
+            record.type = shape.type;
+            record.attribute = shape.attribute;
+            record.radius = shape.radius;
+            record.pointOffset = points.size();
+            record.numPoints = shape.points.size();
+            if (shape.object)
+            {
+                record.x = shape.x;
+                record.y = shape.y;
+                record.waitTime = shape.object->waitTime;
+                record.crumbleTime = shape.object->crumbleTime;
+                record.crumblePieceSize = shape.object->crumblePieceSize;
+            }
+
+            for (const auto& point : shape.points)
+                points.push_back({ point.first, point.second });
+            shapeRecords.push_back(record);
+        }
+
+        writer.addSection(FlatRoomShapes, shapeRecords);
+        writer.addSection(FlatRoomShapePoints, points);
     }
 
+    writer.write(out);
     return 0;
 }
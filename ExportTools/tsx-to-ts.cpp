@@ -33,6 +33,10 @@
 #include <unordered_map>
 #include "tinyxml2.h"
 #include "varlength.hpp"
+#include "tileset-loader.hpp"
+#include "dependencies.hpp"
+
+#include <FlatLayouts.hpp>
 
 #if _WIN32
 #define strcasecmp _stricmp
@@ -41,6 +45,9 @@
 
 using namespace std;
 using namespace tinyxml2;
+using namespace util;
+
+extern bool exportLegacyFormat;
 
 const unordered_map<string,size_t> Attributes =
 {
@@ -90,29 +97,6 @@ const unordered_map<string,size_t> ShapeTypes =
     { "box", 4 },
 };
 
-#pragma pack(push, 1)
-struct terrain_params
-{
-    uint8_t attribute;
-    int16_t physParams[5];
-};
-#pragma pack(pop)
-
-struct single_object_params
-{
-    struct shape_params
-    {
-        uint8_t type;
-        int16_t radius;
-        vector<int16_t> points;
-    };
-
-    uint8_t attribute;
-    float waitTime, crumbleTime;
-    size_t crumblePieceSize;
-    vector<shape_params> shapes;
-};
-
 bool loadTerrains(XMLHandle tset, string inFile, unordered_map<string,terrain_params>& terrains,
     unordered_map<string,single_object_params>& singleObjects)
 {
@@ -126,6 +110,7 @@ bool loadTerrains(XMLHandle tset, string inFile, unordered_map<string,terrain_pa
             file = inFile.substr(0, pos+1) + file;
 
         XMLDocument subDoc;
+        noteDependency(file);
         if (subDoc.LoadFile(file.c_str()) != XML_SUCCESS)
         {
             cout << "Error while trying to read file " << file;
@@ -348,89 +333,34 @@ bool loadTerrains(XMLHandle tset, string inFile, unordered_map<string,terrain_pa
     return true;
 }
 
-int tsxToTs(string inFile, string outFile)
+bool loadTileSet(string inFile, tileset_params& tileset)
 {
     XMLDocument doc;
 	if (doc.LoadFile(inFile.c_str()) != XML_SUCCESS)
 	{
 		cout << "Error while trying to read file " << inFile << ": " << doc.ErrorName() << "." << endl;
-		return -1;
+		return false;
 	}
 
     XMLHandle docHandle(doc);
 
-    ofstream out(outFile, ios::out | ios::binary);
-    out.write("TSET", 4);
-
     auto tset = docHandle.FirstChildElement("tileset");
-    if (tset.ToElement()->Attribute("only-includes", "true"))
-        return 0;
-
-    auto textureName = tset.ToElement()->Attribute("texture");
-    if (textureName)
+    if (!tset.ToElement())
     {
-        auto s = strlen(textureName);
-		write_varlength(out, s);
-		out.write(textureName, s * sizeof(char));
+        cout << "File " << inFile << " must have a root tileset element!" << endl;
+        return false;
     }
-    else write_varlength(out, 0);
 
-    unordered_map<string,terrain_params> terrains;
-    unordered_map<string,single_object_params> singleObjects;
+    tileset.onlyIncludes = tset.ToElement()->Attribute("only-includes", "true");
+    if (tileset.onlyIncludes) return true;
 
-    if (!loadTerrains(tset, inFile, terrains, singleObjects))
-    {
-        cout << "Error while parsing terrain data for " << inFile << "." << endl;
-        return -1;
-    }
-
-    write_varlength(out, terrains.size());
-    for (const auto& pair : terrains)
-        out.write((const char*)&pair.second, sizeof(terrain_params));
+    auto textureName = tset.ToElement()->Attribute("texture");
+    tileset.textureName = textureName ? textureName : "";
 
-    write_varlength(out, singleObjects.size());
-    for (const auto& pair : singleObjects)
+    if (!loadTerrains(tset, inFile, tileset.terrains, tileset.singleObjects))
     {
-        const auto& object = pair.second;
-
-        out.write((const char*)&object.attribute, sizeof(uint8_t));
-        if (object.attribute == 4)
-        {
-            out.write((const char*)&object.waitTime, sizeof(float));
-            out.write((const char*)&object.crumbleTime, sizeof(float));
-            write_varlength(out, object.crumblePieceSize);
-        }
-        
-        write_varlength(out, object.shapes.size());
-        for (const auto& shape : object.shapes)
-        {
-            uint8_t type = shape.type;
-            if (type == 4) type = 3;
-            out.write((const char*)&type, sizeof(uint8_t));
-            
-            switch (shape.type)
-            {
-                case 0: case 1: break;
-                case 2: out.write((const char*)shape.points.data(), 4*sizeof(int16_t)); break;
-                case 3:
-                    write_varlength(out, shape.points.size()/2);
-                    out.write((const char*)shape.points.data(), shape.points.size()*sizeof(int16_t));
-                    break;
-                case 4:
-                    write_varlength(out, 4);
-                    int16_t pts[8] =
-                    {
-                        shape.points[0], shape.points[1],
-                        shape.points[2], shape.points[1],
-                        shape.points[2], shape.points[3],
-                        shape.points[0], shape.points[3]
-                    };
-                    out.write((const char*)pts, sizeof(pts));
-                    break;
-            }
-
-            out.write((const char*)&shape.radius, sizeof(int16_t));
-        }
+        cout << "Error while parsing terrain data for " << inFile << "." << endl;
+        return false;
     }
 
     uint32_t maxId = 0;
@@ -442,15 +372,8 @@ int tsxToTs(string inFile, string outFile)
     }
 
     maxId++;
-    write_varlength(out, maxId);
-
-    struct tile_params
-    {
-        uint8_t type = 0;
-        size_t id = 0;
-    };
-
-    unique_ptr<tile_params[]> tileModes { new tile_params[maxId] };
+    tileset.tiles.assign(maxId, tile_params());
+    auto& tileModes = tileset.tiles;
 
     for (auto tobj = tset.FirstChildElement("tile"); tobj.ToElement(); tobj = tobj.NextSiblingElement("tile"))
     {
@@ -463,7 +386,7 @@ int tsxToTs(string inFile, string outFile)
         {
             cout << "Error: tile " << id << " must define a type";
             cout << " (" << TilesHelpStr << ")." << endl;
-            return -1;
+            return false;
         }
 
         auto typeId = TileTypes.find(type);
@@ -471,7 +394,7 @@ int tsxToTs(string inFile, string outFile)
         {
             cout << "Error: invalid type " << type << " for tile " << id;
             cout << " (valid types: " << TilesHelpStr << ")." << endl;
-            return -1;
+            return false;
         }
 
         tileModes[id].type = (uint8_t)typeId->second;
@@ -482,17 +405,17 @@ int tsxToTs(string inFile, string outFile)
             if (!name)
             {
                 cout << "Error: provide a terrain name for tile " << id << "." << endl;
-                return -1;
+                return false;
             }
 
-            auto terrain = terrains.find(name);
-            if (terrain == terrains.end())
+            auto terrain = tileset.terrains.find(name);
+            if (terrain == tileset.terrains.end())
             {
                 cout << "Error: terrain name " << name << " not found for tile " << id << "." << endl;
-                return -1;
+                return false;
             }
 
-            tileModes[id].id = distance(terrains.begin(), terrain);
+            tileModes[id].id = distance(tileset.terrains.begin(), terrain);
         }
         else if (typeId->second >= 10 && typeId->second <= 12)
         {
@@ -500,14 +423,14 @@ int tsxToTs(string inFile, string outFile)
             if (!name)
             {
                 cout << "Error: provide a semi-terrain object name for tile " << id << "." << endl;
-                return -1;
+                return false;
             }
 
             auto semiTerrainId = Attributes.find(name);
             if (semiTerrainId == Attributes.end() || !(semiTerrainId->second >= 5 || semiTerrainId->second <= 10))
             {
                 cout << "Error: invalid semi-terrain name " << name << " for tile " << id << "." << endl;
-                return -1;
+                return false;
             }
 
             tileModes[id].id = semiTerrainId->second - 5;
@@ -518,24 +441,181 @@ int tsxToTs(string inFile, string outFile)
             if (!name)
             {
                 cout << "Error: provide a single object name for tile " << id << "." << endl;
-                return -1;
+                return false;
             }
 
-            auto object = singleObjects.find(name);
-            if (object == singleObjects.end())
+            auto object = tileset.singleObjects.find(name);
+            if (object == tileset.singleObjects.end())
             {
                 cout << "Error: single object name " << name << " not found for tile " << id << "." << endl;
-                return -1;
+                return false;
             }
 
-            tileModes[id].id = distance(singleObjects.begin(), object);
+            tileModes[id].id = distance(tileset.singleObjects.begin(), object);
+        }
+    }
+
+    return true;
+}
+
+// Tilesets that only hold includes have no sections at all
+static void writeFlatTileSet(ostream& out, const tileset_params& tileset)
+{
+    flat_writer writer("TSET");
+    if (tileset.onlyIncludes)
+    {
+        writer.write(out);
+        return;
+    }
+
+    writer.addSection(FlatTileSetInfo, vector<flat_tileset_info>{ { writer.addString(tileset.textureName) } });
+
+    vector<flat_terrain> terrains;
+    for (const auto& pair : tileset.terrains)
+    {
+        flat_terrain terrain;
+        static_assert(sizeof(flat_terrain) == sizeof(terrain_params), "Terrain layouts differ!");
+        memcpy(&terrain, &pair.second, sizeof(flat_terrain));
+        terrains.push_back(terrain);
+    }
+    writer.addSection(FlatTileSetTerrains, terrains);
+
+    vector<flat_single_object> objects;
+    vector<flat_object_shape> shapes;
+    vector<flat_short_point> points;
+    for (const auto& pair : tileset.singleObjects)
+    {
+        const auto& object = pair.second;
+
+        flat_single_object record{};
+        record.attribute = object.attribute;
+        if (object.attribute == 4)
+        {
+            record.waitTime = object.waitTime;
+            record.crumbleTime = object.crumbleTime;
+            record.crumblePieceSize = object.crumblePieceSize;
+        }
+        record.shapeOffset = shapes.size();
+        record.shapeCount = object.shapes.size();
+        objects.push_back(record);
+
+        for (const auto& shape : object.shapes)
+        {
+            flat_object_shape shapeRecord{};
+            shapeRecord.type = shape.type == 4 ? 3 : shape.type;
+            shapeRecord.radius = shape.radius;
+            shapeRecord.pointOffset = points.size();
+
+            switch (shape.type)
+            {
+                case 0: case 1: break;
+                case 2: case 3:
+                    for (size_t i = 0; i+1 < shape.points.size(); i += 2)
+                        points.push_back({ shape.points[i], shape.points[i+1] });
+                    break;
+                case 4:
+                    points.push_back({ shape.points[0], shape.points[1] });
+                    points.push_back({ shape.points[2], shape.points[1] });
+                    points.push_back({ shape.points[2], shape.points[3] });
+                    points.push_back({ shape.points[0], shape.points[3] });
+                    break;
+            }
+
+            shapeRecord.pointCount = points.size() - shapeRecord.pointOffset;
+            shapes.push_back(shapeRecord);
+        }
+    }
+    writer.addSection(FlatTileSetObjects, objects);
+    writer.addSection(FlatTileSetObjectShapes, shapes);
+    writer.addSection(FlatTileSetShapePoints, points);
+
+    vector<flat_tile_identity> tiles;
+    for (const auto& tile : tileset.tiles)
+    {
+        flat_tile_identity identity{};
+        identity.type = tile.type;
+        identity.id = tile.id;
+        tiles.push_back(identity);
+    }
+    writer.addSection(FlatTileSetTiles, tiles);
+
+    writer.write(out);
+}
+
+int tsxToTs(string inFile, string outFile)
+{
+    tileset_params tileset;
+    if (!loadTileSet(inFile, tileset)) return -1;
+
+    ofstream out(outFile, ios::out | ios::binary);
+    if (!exportLegacyFormat)
+    {
+        writeFlatTileSet(out, tileset);
+        return 0;
+    }
+
+    out.write("TSET", 4);
+
+    if (tileset.onlyIncludes)
+        return 0;
+
+    write_varlength(out, tileset.textureName.size());
+    out.write(tileset.textureName.data(), tileset.textureName.size() * sizeof(char));
+
+    write_varlength(out, tileset.terrains.size());
+    for (const auto& pair : tileset.terrains)
+        out.write((const char*)&pair.second, sizeof(terrain_params));
+
+    write_varlength(out, tileset.singleObjects.size());
+    for (const auto& pair : tileset.singleObjects)
+    {
+        const auto& object = pair.second;
+
+        out.write((const char*)&object.attribute, sizeof(uint8_t));
+        if (object.attribute == 4)
+        {
+            out.write((const char*)&object.waitTime, sizeof(float));
+            out.write((const char*)&object.crumbleTime, sizeof(float));
+            write_varlength(out, object.crumblePieceSize);
+        }
+        
+        write_varlength(out, object.shapes.size());
+        for (const auto& shape : object.shapes)
+        {
+            uint8_t type = shape.type;
+            if (type == 4) type = 3;
+            out.write((const char*)&type, sizeof(uint8_t));
+            
+            switch (shape.type)
+            {
+                case 0: case 1: break;
+                case 2: out.write((const char*)shape.points.data(), 4*sizeof(int16_t)); break;
+                case 3:
+                    write_varlength(out, shape.points.size()/2);
+                    out.write((const char*)shape.points.data(), shape.points.size()*sizeof(int16_t));
+                    break;
+                case 4:
+                    write_varlength(out, 4);
+                    int16_t pts[8] =
+                    {
+                        shape.points[0], shape.points[1],
+                        shape.points[2], shape.points[1],
+                        shape.points[2], shape.points[3],
+                        shape.points[0], shape.points[3]
+                    };
+                    out.write((const char*)pts, sizeof(pts));
+                    break;
+            }
+
+            out.write((const char*)&shape.radius, sizeof(int16_t));
         }
     }
 
-    for (size_t i = 0; i < maxId; i++)
+    write_varlength(out, tileset.tiles.size());
+    for (const auto& tile : tileset.tiles)
     {
-        out.write((const char*)&tileModes[i].type, sizeof(uint8_t));
-        write_varlength(out, tileModes[i].id);
+        out.write((const char*)&tile.type, sizeof(uint8_t));
+        write_varlength(out, tile.id);
     }
 
     return 0;
@@ -27,6 +27,7 @@ class AudioManager;
 class InputManager;
 class LocalizationManager;
 class ResourceManager;
+class SaveService;
 struct Settings;
 
 struct Services
@@ -35,5 +36,6 @@ struct Services
     InputManager& inputManager;
     LocalizationManager& localizationManager;
     ResourceManager& resourceManager;
+    SaveService& saveService;
     Settings& settings;
 };
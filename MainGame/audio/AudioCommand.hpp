@@ -25,9 +25,11 @@
 
 #include "AudioInstance.hpp"
 
+class MusicStream;
+
 struct AudioCommand
 {
-    enum class Type { Play1, Play2, Update, Fade, Stop } type;
+    enum class Type { Play1, Play2, Update, Fade, Stop, PlayMusic, FadeMusic, StopMusic } type;
 
     AudioReference ref;
 
@@ -39,5 +41,7 @@ struct AudioCommand
         struct { float logPitch, balance; } play2;
         struct { UpdateData data; float newVal; } update;
         struct { size_t fadeCount; float fadeOfs; } fade;
+        struct { MusicStream* stream; float volume; } playMusic;
+        struct { size_t fadeCount; float toVolume; } fadeMusic;
     };
 };
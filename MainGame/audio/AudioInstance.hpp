@@ -41,3 +41,12 @@ struct AudioInstanceLight
     size_t curSample = 0, curSampleFractional = 0, sampleIncr = 65536, fadeCount = 0;
     float volume, fadeOfs, logPitch, balance;
 };
+
+class MusicStream;
+
+struct MusicInstanceLight
+{
+    MusicStream* stream = nullptr;
+    size_t fadeCount = 0;
+    float volume, fadeOfs;
+};
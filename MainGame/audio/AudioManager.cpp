@@ -23,36 +23,78 @@
 
 #include "AudioManager.hpp"
 #include "AudioException.hpp"
+#include "profiler/Profiler.hpp"
 #include <portaudio.h>
 #include <algorithm>
 #include <predUtils.hpp>
 #include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AUDIO_USE_SSE2 1
+#include <emmintrin.h>
+#else
+#define AUDIO_USE_SSE2 0
+#endif
 
 constexpr double CanonicalSampleRate = 44100;
 constexpr size_t BufferSize = CanonicalSampleRate / 300;
 constexpr uint32_t Scale = (int32_t)1 << 30;
+constexpr auto DecoderPeriod = std::chrono::milliseconds(20);
 
 inline void checkAndThrow(PaError error)
 {
     if (error) throw AudioException(error);
 }
 
-AudioManager::AudioManager() : commandQueue(64), audioStopQueue(64), samplesPassed(0)
+AudioManager::AudioManager(AudioBackend backend) : commandQueue(64), audioStopQueue(64), samplesPassed(0),
+    musicStopQueue(16), currentMusicStream(-1), decoderRunning(true), currentStream(nullptr)
 {
-    checkAndThrow(Pa_Initialize());
-    checkAndThrow(Pa_OpenDefaultStream(&currentStream, 0, 2, paInt32, CanonicalSampleRate, paFramesPerBufferUnspecified,
-    [](const void* in, void* out, unsigned long frameCount, const PaStreamCallbackTimeInfo* timeInfo, PaStreamCallbackFlags statusFlags,
-        void* userData) { return ((AudioManager*)userData)->audioFunction((int32_t*)out, frameCount); }, (void*)this));
-    checkAndThrow(Pa_StartStream(currentStream));
+    if (backend == AudioBackend::PortAudio)
+    {
+        checkAndThrow(Pa_Initialize());
+        checkAndThrow(Pa_OpenDefaultStream(&currentStream, 0, 2, paInt32, CanonicalSampleRate, paFramesPerBufferUnspecified,
+        [](const void* in, void* out, unsigned long frameCount, const PaStreamCallbackTimeInfo* timeInfo, PaStreamCallbackFlags statusFlags,
+            void* userData)
+        {
+            PROFILE_THREAD("Audio");
+            return ((AudioManager*)userData)->audioFunction((int32_t*)out, frameCount);
+        }, (void*)this));
+        checkAndThrow(Pa_StartStream(currentStream));
+    }
+    else nullOutput.resize(2 * size_t(CanonicalSampleRate * toSeconds<double>(UpdatePeriod)));
+
+    decoderThread = std::thread(&AudioManager::decoderFunction, this);
 }
 
 AudioManager::~AudioManager()
 {
+    decoderRunning = false;
+    decoderThread.join();
+
+    if (!currentStream) return;
     checkAndThrow(Pa_AbortStream(currentStream));
     checkAndThrow(Pa_CloseStream(currentStream));
     checkAndThrow(Pa_Terminate());
 }
 
+void AudioManager::decoderFunction()
+{
+    PROFILE_THREAD("Music decoder");
+
+    while (decoderRunning)
+    {
+        {
+            PROFILE_ZONE("MusicStream::decode");
+            std::lock_guard<std::mutex> lock(musicMutex);
+            for (auto& stream : musicStreams)
+                if (stream) stream->decode();
+        }
+
+        std::this_thread::sleep_for(DecoderPeriod);
+    }
+}
+
 AudioReference AudioManager::findEmptyInstance()
 {
     for (size_t i = 0; i < MaxSounds; i++)
@@ -156,17 +198,223 @@ void AudioManager::fadeSound(const AudioReference& ref, FrameDuration dur, float
     audioInstancesHostSide[ref].fadeOfs = fadeOfs;
 }
 
+void AudioManager::playMusic(std::shared_ptr<Music> music, FrameDuration crossfade, float volume)
+{
+    if (currentMusicStream != -1 && musicStreams[currentMusicStream]->getMusic() == music) return;
+    stopMusic(crossfade);
+
+    size_t slot = 0;
+    while (slot < MaxMusicStreams && musicStreamsUsed[slot]) slot++;
+    if (slot == MaxMusicStreams) return;
+
+    // prime the ring buffer so the first callbacks don't underrun
+    auto stream = std::make_unique<MusicStream>(music, CanonicalSampleRate);
+    stream->decode();
+
+    bool fades = crossfade > FrameDuration(0);
+
+    {
+        AudioCommand cmd;
+        cmd.type = AudioCommand::Type::PlayMusic;
+        cmd.ref = slot;
+        cmd.playMusic.stream = stream.get();
+        cmd.playMusic.volume = fades ? 0.0f : volume;
+        commandQueue.enqueue(cmd);
+    }
+
+    if (fades)
+    {
+        AudioCommand cmd;
+        cmd.type = AudioCommand::Type::FadeMusic;
+        cmd.ref = slot;
+        cmd.fadeMusic.fadeCount = toSeconds<size_t>(CanonicalSampleRate * crossfade);
+        cmd.fadeMusic.toVolume = volume;
+        commandQueue.enqueue(cmd);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(musicMutex);
+        musicStreams[slot] = std::move(stream);
+    }
+
+    musicStreamsUsed[slot] = true;
+    currentMusicStream = slot;
+}
+
+void AudioManager::stopMusic(FrameDuration fadeOut)
+{
+    if (currentMusicStream == -1) return;
+
+    AudioCommand cmd;
+    cmd.ref = currentMusicStream;
+
+    if (fadeOut > FrameDuration(0))
+    {
+        cmd.type = AudioCommand::Type::FadeMusic;
+        cmd.fadeMusic.fadeCount = toSeconds<size_t>(CanonicalSampleRate * fadeOut);
+        cmd.fadeMusic.toVolume = 0.0f;
+    }
+    else cmd.type = AudioCommand::Type::StopMusic;
+
+    commandQueue.enqueue(cmd);
+    currentMusicStream = -1;
+}
+
 inline void updateSampleIncr(AudioInstanceLight& instance)
 {
 	if (instance.sound)
 		instance.sampleIncr = 65536ULL * exp2f(instance.logPitch) * instance.sound->sampleRate / CanonicalSampleRate;
 }
 
+// Resamples up to numFrames frames of the instance into left and right, wrapping around the loop
+// point; stops early and sets ended if a non-looping sound runs out of samples
+static size_t gatherVoiceSamples(AudioInstanceLight& instance, float* left, float* right, size_t numFrames, bool& ended)
+{
+    const auto& sound = *instance.sound;
+    const float* data = sound.data.data();
+    size_t size = sound.size(), pos = instance.curSample, frac = instance.curSampleFractional, incr = instance.sampleIncr;
+    bool loops = sound.loopPoint != std::numeric_limits<size_t>::max();
+
+    auto advance = [&]
+    {
+        frac += incr;
+        pos += frac >> 16;
+        frac &= 65535ULL;
+        
+        if (pos >= size)
+        {
+            if (loops) pos -= size - sound.loopPoint;
+            else ended = true;
+        }
+    };
+
+    ended = false;
+    size_t i = 0;
+    if (sound.stereo)
+    {
+        for (; i < numFrames && !ended; i++)
+        {
+            left[i] = data[2*pos];
+            right[i] = data[2*pos+1];
+            advance();
+        }
+    }
+    else
+    {
+        for (; i < numFrames && !ended; i++)
+        {
+            left[i] = right[i] = data[pos];
+            advance();
+        }
+    }
+
+    instance.curSample = pos;
+    instance.curSampleFractional = frac;
+    return i;
+}
+
+// Adds count frames to the mix, applying the volume ramp of an ongoing fade and the balance
+static void accumulateVoice(const float* left, const float* right, float* mixLeft, float* mixRight, size_t count,
+    float volume, float fadeOfs, size_t fadeCount, float balance)
+{
+    float fadeLimit = (float)std::min(fadeCount, count);
+    size_t i = 0;
+
+#if AUDIO_USE_SSE2
+    auto vvolume = _mm_set1_ps(volume), vfadeOfs = _mm_set1_ps(fadeOfs), vfadeLimit = _mm_set1_ps(fadeLimit);
+    auto vbalanceLeft = _mm_set1_ps(0.5f - balance), vbalanceRight = _mm_set1_ps(0.5f + balance);
+    auto vindex = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f), four = _mm_set1_ps(4.0f);
+
+    for (; i+4 <= count; i += 4, vindex = _mm_add_ps(vindex, four))
+    {
+        auto gain = _mm_add_ps(vvolume, _mm_mul_ps(_mm_min_ps(vindex, vfadeLimit), vfadeOfs));
+        auto gainLeft = _mm_mul_ps(gain, vbalanceLeft), gainRight = _mm_mul_ps(gain, vbalanceRight);
+
+        _mm_storeu_ps(mixLeft+i, _mm_add_ps(_mm_loadu_ps(mixLeft+i), _mm_mul_ps(_mm_loadu_ps(left+i), gainLeft)));
+        _mm_storeu_ps(mixRight+i, _mm_add_ps(_mm_loadu_ps(mixRight+i), _mm_mul_ps(_mm_loadu_ps(right+i), gainRight)));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        float gain = volume + std::min((float)i, fadeLimit) * fadeOfs;
+        mixLeft[i] += left[i] * gain * (0.5f - balance);
+        mixRight[i] += right[i] * gain * (0.5f + balance);
+    }
+}
+
+// Scales the float mix to the output range and interleaves it, saturating instead of wrapping around
+static void convertMixToOutput(const float* mixLeft, const float* mixRight, int32_t* out, size_t count)
+{
+    // the largest float below 2^31, so the conversion never overflows
+    constexpr float MaxSample = 2147483520.0f, MinSample = -2147483648.0f;
+    size_t i = 0;
+
+#if AUDIO_USE_SSE2
+    auto scale = _mm_set1_ps((float)Scale), vmin = _mm_set1_ps(MinSample), vmax = _mm_set1_ps(MaxSample);
+
+    for (; i+4 <= count; i += 4)
+    {
+        auto left = _mm_mul_ps(_mm_loadu_ps(mixLeft+i), scale);
+        auto right = _mm_mul_ps(_mm_loadu_ps(mixRight+i), scale);
+        auto ileft = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(left, vmin), vmax));
+        auto iright = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(right, vmin), vmax));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out+2*i), _mm_unpacklo_epi32(ileft, iright));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out+2*i+4), _mm_unpackhi_epi32(ileft, iright));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        out[2*i] = (int32_t)std::min(std::max(mixLeft[i] * (float)Scale, MinSample), MaxSample);
+        out[2*i+1] = (int32_t)std::min(std::max(mixRight[i] * (float)Scale, MinSample), MaxSample);
+    }
+}
+
+bool AudioManager::mixVoice(AudioInstanceLight& instance, size_t numFrames)
+{
+    // a fade down to silence ends the sound as soon as the fade completes
+    bool fadeEnds = instance.fadeCount > 0 && instance.fadeCount <= numFrames &&
+        instance.volume + instance.fadeCount * instance.fadeOfs <= 0;
+    if (fadeEnds) numFrames = instance.fadeCount;
+
+    bool ended;
+    auto count = gatherVoiceSamples(instance, voiceLeft.data(), voiceRight.data(), numFrames, ended);
+    accumulateVoice(voiceLeft.data(), voiceRight.data(), mixLeft.data(), mixRight.data(), count,
+        instance.volume, instance.fadeOfs, instance.fadeCount, instance.balance);
+
+    size_t faded = std::min(instance.fadeCount, count);
+    instance.volume += faded * instance.fadeOfs;
+    instance.fadeCount -= faded;
+
+    return !ended && !(fadeEnds && instance.fadeCount == 0);
+}
+
+bool AudioManager::mixMusic(MusicInstanceLight& instance, size_t numFrames)
+{
+    bool fadeEnds = instance.fadeCount > 0 && instance.fadeCount <= numFrames &&
+        instance.volume + instance.fadeCount * instance.fadeOfs <= 0;
+    if (fadeEnds) numFrames = instance.fadeCount;
+
+    // an underrun leaves the rest of the block silent, but the fade keeps running
+    auto count = instance.stream->read(voiceLeft.data(), voiceRight.data(), numFrames);
+    accumulateVoice(voiceLeft.data(), voiceRight.data(), mixLeft.data(), mixRight.data(), count,
+        instance.volume, instance.fadeOfs, instance.fadeCount, 0.0f);
+
+    size_t faded = std::min(instance.fadeCount, numFrames);
+    instance.volume += faded * instance.fadeOfs;
+    instance.fadeCount -= faded;
+
+    return !instance.stream->isFinished() && !(fadeEnds && instance.fadeCount == 0);
+}
+
 int AudioManager::audioFunction(int32_t* out, size_t numFrames)
 {
+    PROFILE_ZONE("AudioManager::audioFunction");
     AudioCommand cmd;
     size_t j = 0;
-    while (commandQueue.try_dequeue(cmd) && j < 4)
+    while (j < 4 && commandQueue.try_dequeue(cmd))
     {
         switch (cmd.type)
         {
@@ -174,6 +422,9 @@ int AudioManager::audioFunction(int32_t* out, size_t numFrames)
                 audioInstancesThreadSide[cmd.ref].sound = cmd.play1.sound;
                 audioInstancesThreadSide[cmd.ref].curSample = 0;
                 audioInstancesThreadSide[cmd.ref].volume = cmd.play1.volume;
+                // the mixer always applies the ramp, so a fade left over from a stopped sound must not leak in
+                audioInstancesThreadSide[cmd.ref].fadeCount = 0;
+                audioInstancesThreadSide[cmd.ref].fadeOfs = 0.0f;
                 break;
             case AudioCommand::Type::Play2:
                 audioInstancesThreadSide[cmd.ref].curSampleFractional = 0;
@@ -202,63 +453,62 @@ int AudioManager::audioFunction(int32_t* out, size_t numFrames)
                 audioInstancesThreadSide[cmd.ref].sound = nullptr;
                 audioStopQueue.try_enqueue(cmd.ref);
                 break;
+            case AudioCommand::Type::PlayMusic:
+                musicInstancesThreadSide[cmd.ref].stream = cmd.playMusic.stream;
+                musicInstancesThreadSide[cmd.ref].volume = cmd.playMusic.volume;
+                musicInstancesThreadSide[cmd.ref].fadeCount = 0;
+                musicInstancesThreadSide[cmd.ref].fadeOfs = 0.0f;
+                break;
+            case AudioCommand::Type::FadeMusic:
+            {
+                auto& instance = musicInstancesThreadSide[cmd.ref];
+                if (!instance.stream) break;
+                instance.fadeCount = std::max<size_t>(cmd.fadeMusic.fadeCount, 1);
+                instance.fadeOfs = (cmd.fadeMusic.toVolume - instance.volume) / instance.fadeCount;
+            } break;
+            case AudioCommand::Type::StopMusic:
+                if (!musicInstancesThreadSide[cmd.ref].stream) break;
+                musicInstancesThreadSide[cmd.ref].stream = nullptr;
+                musicStopQueue.try_enqueue(cmd.ref);
+                break;
         }
 
         j++;
     }
 
     samplesPassed += numFrames;
-    std::fill_n(out, 2*numFrames, 0);
 
-    j = 0;
-    for (auto& instance : audioInstancesThreadSide)
+    for (size_t base = 0; base < numFrames; base += MixBlockSize)
     {
-        if (!instance.sound) continue;
+        size_t blockFrames = std::min(MixBlockSize, numFrames - base);
+        std::fill_n(mixLeft.begin(), blockFrames, 0.0f);
+        std::fill_n(mixRight.begin(), blockFrames, 0.0f);
 
-        for (size_t i = 0; i < numFrames; i++)
+        for (AudioReference ref = 0; ref < MaxSounds; ref++)
         {
-            if (instance.sound->stereo)
-            {
-                out[2*i] += Scale * instance.sound->data[2*instance.curSample] * instance.volume * (0.5 - instance.balance);
-                out[2*i+1] += Scale * instance.sound->data[2*instance.curSample+1] * instance.volume * (0.5 + instance.balance);
-            }
-            else
-            {
-                out[2*i] += Scale * instance.sound->data[instance.curSample] * instance.volume * (0.5 - instance.balance);
-                out[2*i+1] += Scale * instance.sound->data[instance.curSample] * instance.volume * (0.5 + instance.balance);
-            }
- 
-            instance.curSampleFractional += instance.sampleIncr;
-            instance.curSample += instance.curSampleFractional >> 16;
-            instance.curSampleFractional &= 65535ULL;
-            if (instance.curSample >= instance.sound->data.size()) break;
+            auto& instance = audioInstancesThreadSide[ref];
+            if (!instance.sound) continue;
 
-            if (instance.fadeCount > 0)
+            if (!mixVoice(instance, blockFrames))
             {
-                instance.volume += instance.fadeOfs;
-                instance.fadeCount--;
-
-                if (instance.fadeCount == 0 && instance.volume <= 0)
-                {
-                    instance.sound = nullptr;
-                    audioStopQueue.try_enqueue(j);
-                    break;
-                }
+                instance.sound = nullptr;
+                audioStopQueue.try_enqueue(ref);
             }
         }
 
-        if (instance.curSample >= instance.sound->size())
+        for (size_t slot = 0; slot < MaxMusicStreams; slot++)
         {
-            if (instance.sound->loopPoint != std::numeric_limits<size_t>::max())
-                instance.curSample -= instance.sound->size() - instance.sound->loopPoint;
-            else
+            auto& instance = musicInstancesThreadSide[slot];
+            if (!instance.stream) continue;
+
+            if (!mixMusic(instance, blockFrames))
             {
-                instance.sound = nullptr;
-                audioStopQueue.try_enqueue(j);
+                instance.stream = nullptr;
+                musicStopQueue.try_enqueue(slot);
             }
         }
 
-        j++;
+        convertMixToOutput(mixLeft.data(), mixRight.data(), out + 2*base, blockFrames);
     }
 
     return paContinue;
@@ -267,6 +517,7 @@ int AudioManager::audioFunction(int32_t* out, size_t numFrames)
 void AudioManager::update()
 {
     AudioReference audioToStop;
+    if (!currentStream) audioFunction(nullOutput.data(), nullOutput.size()/2);
 
     for (auto& instance : audioInstancesHostSide)
     {
@@ -286,4 +537,16 @@ void AudioManager::update()
         audioInstancesHostSide[audioToStop].sound = nullptr;
         instancesUsed[audioToStop] = false;
     }
+
+    size_t musicToStop;
+    while (musicStopQueue.try_dequeue(musicToStop))
+    {
+        {
+            std::lock_guard<std::mutex> lock(musicMutex);
+            musicStreams[musicToStop].reset();
+        }
+
+        musicStreamsUsed[musicToStop] = false;
+        if (currentMusicStream == musicToStop) currentMusicStream = -1;
+    }
 }
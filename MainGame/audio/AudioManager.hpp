@@ -31,11 +31,21 @@
 #include <non_copyable_movable.hpp>
 #include <chronoUtils.hpp>
 #include <atomic>
+#include <thread>
+#include <mutex>
+#include <vector>
 #include "AudioInstance.hpp"
 #include "AudioCommand.hpp"
+#include "MusicStream.hpp"
 #include "readerwriterqueue/readerwriterqueue.h"
 
 constexpr size_t MaxSounds = 64;
+constexpr size_t MixBlockSize = 256;
+constexpr size_t MaxMusicStreams = 4;
+
+// The null backend opens no device; instead, update() mixes one frame's worth of samples
+// into a scratch buffer, so the mixer still runs at its real cost
+enum class AudioBackend { PortAudio, Null };
 
 class AudioManager final : public util::non_copyable
 {
@@ -47,20 +57,47 @@ class AudioManager final : public util::non_copyable
     std::array<AudioInstanceLight, MaxSounds> audioInstancesThreadSide;
     std::atomic<size_t> samplesPassed;
 
+    // music streams are destroyed by the host only after the audio thread reports them stopped,
+    // and the mutex keeps the decoder thread off a stream while it is being created or destroyed
+    moodycamel::ReaderWriterQueue<size_t> musicStopQueue;
+    std::bitset<MaxMusicStreams> musicStreamsUsed;
+    std::array<std::unique_ptr<MusicStream>, MaxMusicStreams> musicStreams;
+    std::array<MusicInstanceLight, MaxMusicStreams> musicInstancesThreadSide;
+    size_t currentMusicStream;
+
+    std::mutex musicMutex;
+    std::atomic<bool> decoderRunning;
+    std::thread decoderThread;
+
+    // Scratch buffers for the block mixer, only touched by the audio thread
+    std::array<float, MixBlockSize> mixLeft, mixRight, voiceLeft, voiceRight;
+
     PaStream* currentStream;
+    std::vector<int32_t> nullOutput;
+
     AudioReference findEmptyInstance();
+    bool mixVoice(AudioInstanceLight& instance, size_t numFrames);
+    bool mixMusic(MusicInstanceLight& instance, size_t numFrames);
+    void decoderFunction();
     int audioFunction(int32_t* out, size_t numFrames);
 
 public:
-    AudioManager();
+    explicit AudioManager(AudioBackend backend = AudioBackend::PortAudio);
     ~AudioManager();
 
     void update();
 
+    // Runs the mixer the way the device callback does; only for the null backend, which has no device calling it
+    void mixFrames(int32_t* out, size_t numFrames) { audioFunction(out, numFrames); }
+
     AudioReference playSound(std::shared_ptr<Sound> sound, float volume = 1.0f, float logPitch = 0.0f, float balance = 0.0f);
     void setSoundVolume(const AudioReference& ref, float volume);
     void setSoundLogPitch(const AudioReference& ref, float logPitch);
     void setSoundBalance(const AudioReference& ref, float balance);
     void fadeSound(const AudioReference& ref, FrameDuration dur, float toVol = 0.0f);
     void stopSound(const AudioReference& ref);
+
+    // Starts streaming the music, crossfading from the current one; playing the current music again does nothing
+    void playMusic(std::shared_ptr<Music> music, FrameDuration crossfade = FrameDuration(0), float volume = 1.0f);
+    void stopMusic(FrameDuration fadeOut = FrameDuration(0));
 };
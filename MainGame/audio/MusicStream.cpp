@@ -0,0 +1,152 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "MusicStream.hpp"
+
+#include <algorithm>
+#include <limits>
+
+// about 1.5 seconds of stereo audio at 44.1kHz
+constexpr size_t RingBufferFrames = 65536;
+constexpr size_t DecodeChunkFrames = 4096;
+
+MusicStream::MusicStream(std::shared_ptr<Music> music, double outputRate)
+    : music(music), reader{music->data.get(), music->dataSize, 0}, frames(2*RingBufferFrames), finished(false),
+    decodedFrames(0), decodedPos(0), decodedFrac(0), pcmPosition(0)
+{
+    sampleIncr = 65536ULL * music->sampleRate / outputRate;
+    fileOpen = openVorbisFile(file, reader);
+    if (!fileOpen) finished = true;
+
+    resampled.resize(2*DecodeChunkFrames);
+}
+
+MusicStream::~MusicStream()
+{
+    if (fileOpen) ov_clear(&file);
+}
+
+bool MusicStream::seekToLoopStart()
+{
+    if (ov_pcm_seek(&file, music->loopStart) != 0) return false;
+    pcmPosition = music->loopStart;
+    return true;
+}
+
+bool MusicStream::decodePacket()
+{
+    // carry the resampler position over into the new packet
+    decodedPos -= decodedFrames;
+    decodedFrames = 0;
+
+    bool justSeeked = false;
+    while (true)
+    {
+        if (pcmPosition >= music->loopEnd)
+        {
+            if (!seekToLoopStart()) return false;
+            justSeeked = true;
+        }
+
+        int maxFrames = (int)std::min<size_t>(DecodeChunkFrames, music->loopEnd - pcmPosition);
+
+        float** pcm;
+        int bitstream;
+        long count = ov_read_float(&file, &pcm, maxFrames, &bitstream);
+
+        if (count == OV_HOLE) continue;
+        if (count < 0) return false;
+        if (count == 0)
+        {
+            // end of the file; a loop that reaches it again without decoding anything is broken
+            if (justSeeked || !seekToLoopStart()) return false;
+            justSeeked = true;
+            continue;
+        }
+
+        decoded.resize(2*count);
+        const float* left = pcm[0];
+        const float* right = music->stereo ? pcm[1] : pcm[0];
+        for (long i = 0; i < count; i++)
+        {
+            decoded[2*i] = left[i];
+            decoded[2*i+1] = right[i];
+        }
+
+        pcmPosition += count;
+        decodedFrames = count;
+        return true;
+    }
+}
+
+void MusicStream::decode()
+{
+    while (!finished && frames.writeAvailable() >= 2*DecodeChunkFrames)
+    {
+        size_t produced = 0;
+        while (produced < DecodeChunkFrames)
+        {
+            if (decodedPos >= decodedFrames)
+            {
+                if (!decodePacket())
+                {
+                    finished = true;
+                    break;
+                }
+
+                continue;
+            }
+
+            resampled[2*produced] = decoded[2*decodedPos];
+            resampled[2*produced+1] = decoded[2*decodedPos+1];
+            produced++;
+
+            decodedFrac += sampleIncr;
+            decodedPos += decodedFrac >> 16;
+            decodedFrac &= 65535ULL;
+        }
+
+        frames.write(resampled.data(), 2*produced);
+    }
+}
+
+size_t MusicStream::read(float* left, float* right, size_t numFrames)
+{
+    size_t total = 0;
+    while (total < numFrames)
+    {
+        size_t count = std::min(numFrames - total, readScratch.size()/2);
+        count = frames.read(readScratch.data(), 2*count) / 2;
+        if (count == 0) break;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            left[total+i] = readScratch[2*i];
+            right[total+i] = readScratch[2*i+1];
+        }
+
+        total += count;
+    }
+
+    return total;
+}
@@ -0,0 +1,69 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <array>
+#include <atomic>
+#include <non_copyable_movable.hpp>
+#include "Music.hpp"
+#include "SampleRingBuffer.hpp"
+#include "readVorbis.hpp"
+
+// One playback of a Music: the decoder thread keeps a bounded ring of frames, already resampled
+// to the output rate, topped up, and the audio thread drains it
+class MusicStream final : util::non_copyable
+{
+    std::shared_ptr<Music> music;
+    VorbisMemoryReader reader;
+    OggVorbis_File file;
+    bool fileOpen;
+
+    SampleRingBuffer frames;
+    std::atomic<bool> finished;
+
+    // decoder thread state
+    std::vector<float> decoded, resampled;
+    size_t decodedFrames, decodedPos, decodedFrac, sampleIncr, pcmPosition;
+
+    // audio thread state
+    std::array<float, 512> readScratch;
+
+    bool decodePacket();
+    bool seekToLoopStart();
+
+public:
+    MusicStream(std::shared_ptr<Music> music, double outputRate);
+    ~MusicStream();
+
+    // Called from the decoder thread
+    void decode();
+
+    // Called from the audio thread; returns fewer frames than asked on an underrun
+    size_t read(float* left, float* right, size_t numFrames);
+    bool isFinished() const { return finished && frames.readAvailable() == 0; }
+
+    const auto& getMusic() const { return music; }
+};
@@ -0,0 +1,91 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <cstddef>
+#include <non_copyable_movable.hpp>
+
+// Lock-free single-producer single-consumer ring of samples; the producer only calls
+// write and writeAvailable, the consumer only calls read and readAvailable
+class SampleRingBuffer final : util::non_copyable
+{
+    std::unique_ptr<float[]> buffer;
+    size_t mask;
+    std::atomic<size_t> readPos, writePos;
+
+    static size_t roundUpToPowerOfTwo(size_t val)
+    {
+        size_t result = 1;
+        while (result < val) result <<= 1;
+        return result;
+    }
+
+public:
+    explicit SampleRingBuffer(size_t minCapacity)
+        : mask(roundUpToPowerOfTwo(minCapacity)-1), readPos(0), writePos(0)
+    {
+        buffer.reset(new float[mask+1]);
+    }
+
+    size_t capacity() const { return mask+1; }
+
+    size_t readAvailable() const
+    {
+        return writePos.load(std::memory_order_acquire) - readPos.load(std::memory_order_relaxed);
+    }
+
+    size_t writeAvailable() const
+    {
+        return capacity() - (writePos.load(std::memory_order_relaxed) - readPos.load(std::memory_order_acquire));
+    }
+
+    size_t write(const float* data, size_t count)
+    {
+        count = std::min(count, writeAvailable());
+        auto pos = writePos.load(std::memory_order_relaxed);
+
+        auto first = std::min(count, capacity() - (pos & mask));
+        std::copy_n(data, first, buffer.get() + (pos & mask));
+        std::copy_n(data + first, count - first, buffer.get());
+
+        writePos.store(pos + count, std::memory_order_release);
+        return count;
+    }
+
+    size_t read(float* data, size_t count)
+    {
+        count = std::min(count, readAvailable());
+        auto pos = readPos.load(std::memory_order_relaxed);
+
+        auto first = std::min(count, capacity() - (pos & mask));
+        std::copy_n(buffer.get() + (pos & mask), first, data);
+        std::copy_n(buffer.get(), count - first, data + first);
+
+        readPos.store(pos + count, std::memory_order_release);
+        return count;
+    }
+};
@@ -25,10 +25,93 @@
 
 #include <streamReaders.hpp>
 #include <limits>
-#include "Sound.hpp"
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include "Music.hpp"
+#include "resources/MappedInputStream.hpp"
 
+static size_t vorbisRead(void* ptr, size_t size, size_t nmemb, void* source)
+{
+    auto& reader = *static_cast<VorbisMemoryReader*>(source);
+    size_t count = std::min(nmemb, (reader.size - reader.offset) / size);
+
+    memcpy(ptr, reader.data + reader.offset, count * size);
+    reader.offset += count * size;
+    return count;
+}
+
+static int vorbisSeek(void* source, ogg_int64_t offset, int whence)
+{
+    auto& reader = *static_cast<VorbisMemoryReader*>(source);
+
+    ogg_int64_t base;
+    switch (whence)
+    {
+        case SEEK_SET: base = 0; break;
+        case SEEK_CUR: base = reader.offset; break;
+        case SEEK_END: base = reader.size; break;
+        default: return -1;
+    }
+
+    if (base + offset < 0 || base + offset > (ogg_int64_t)reader.size) return -1;
+    reader.offset = base + offset;
+    return 0;
+}
+
+static long vorbisTell(void* source)
+{
+    return static_cast<VorbisMemoryReader*>(source)->offset;
+}
+
+bool openVorbisFile(OggVorbis_File& file, VorbisMemoryReader& reader)
+{
+    ov_callbacks callbacks = { vorbisRead, vorbisSeek, nullptr, vorbisTell };
+    return ov_open_callbacks(&reader, &file, nullptr, 0, callbacks) == 0;
+}
+
+static size_t readLoopComment(OggVorbis_File& file, const char* tag, size_t defaultValue)
+{
+    auto value = vorbis_comment_query(ov_comment(&file, -1), tag, 0);
+    return value ? strtoull(value, nullptr, 10) : defaultValue;
+}
 
 util::generic_shared_ptr loadVorbisFile(std::unique_ptr<sf::InputStream>& stream)
 {
-	return util::generic_shared_ptr{};
+    using namespace util;
+
+    auto music = std::make_shared<Music>();
+
+    // keep the compressed bytes only, sharing them with the resource pack when possible
+    if (auto mapped = dynamic_cast<MappedInputStream*>(stream.get()))
+    {
+        music->data = std::shared_ptr<const char>(mapped->getOwner(), mapped->getData());
+        music->dataSize = mapped->getDataSize();
+    }
+    else
+    {
+        auto size = stream->getSize();
+        if (size <= 0) return generic_shared_ptr{};
+
+        std::shared_ptr<char> data(new char[size], std::default_delete<char[]>());
+        if (stream->seek(0) != 0 || stream->read(data.get(), size) != size) return generic_shared_ptr{};
+
+        music->data = data;
+        music->dataSize = size;
+    }
+
+    VorbisMemoryReader reader{music->data.get(), music->dataSize, 0};
+    OggVorbis_File file;
+    if (!openVorbisFile(file, reader)) return generic_shared_ptr{};
+
+    auto info = ov_info(&file, -1);
+    music->stereo = info->channels >= 2;
+    music->sampleRate = info->rate;
+
+    music->loopStart = readLoopComment(file, "LOOPSTART", 0);
+    auto loopLength = readLoopComment(file, "LOOPLENGTH", 0);
+    music->loopEnd = loopLength > 0 ? music->loopStart + loopLength : std::numeric_limits<size_t>::max();
+
+    ov_clear(&file);
+    return generic_shared_ptr{music};
 }
@@ -25,5 +25,16 @@
 
 #include <SFML/System.hpp>
 #include <generic_ptrs.hpp>
+#define OV_EXCLUDE_STATIC_CALLBACKS
+#include <vorbis/vorbisfile.h>
+
+struct VorbisMemoryReader
+{
+    const char* data;
+    size_t size, offset;
+};
+
+// Opens a Vorbis decoder reading from memory; the reader must outlive the file
+bool openVorbisFile(OggVorbis_File& file, VorbisMemoryReader& reader);
 
 util::generic_shared_ptr loadVorbisFile(std::unique_ptr<sf::InputStream>& stream);
@@ -25,45 +25,215 @@
 
 #include <streamReaders.hpp>
 #include <limits>
+#include <vector>
+#include <cstring>
 #include "Sound.hpp"
+#include "resources/MappedInputStream.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WAVE_USE_SSE2 1
+#include <emmintrin.h>
+#else
+#define WAVE_USE_SSE2 0
+#endif
+
+enum WaveFormat : uint16_t { PCM = 1, IEEEFloat = 3, Extensible = 0xFFFE };
+
+// Interleaved samples of any channel count map one to one to the samples of a Sound,
+// so the conversions only care about the sample encoding
+static void convertUnsigned8(const uint8_t* in, float* out, size_t count)
+{
+    size_t i = 0;
+#if WAVE_USE_SSE2
+    auto zero = _mm_setzero_si128(), bias = _mm_set1_epi16(128);
+    auto scale = _mm_set1_ps(1.0f / 128.0f);
+    for (; i+16 <= count; i += 16)
+    {
+        auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in+i));
+        auto low = _mm_sub_epi16(_mm_unpacklo_epi8(bytes, zero), bias);
+        auto high = _mm_sub_epi16(_mm_unpackhi_epi8(bytes, zero), bias);
+
+        _mm_storeu_ps(out+i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(low, low), 16)), scale));
+        _mm_storeu_ps(out+i+4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(low, low), 16)), scale));
+        _mm_storeu_ps(out+i+8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(high, high), 16)), scale));
+        _mm_storeu_ps(out+i+12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(high, high), 16)), scale));
+    }
+#endif
+    for (; i < count; i++) out[i] = (in[i] - 128) / 128.0f;
+}
+
+static void convertSigned16(const uint8_t* in, float* out, size_t count)
+{
+    size_t i = 0;
+#if WAVE_USE_SSE2
+    auto scale = _mm_set1_ps(1.0f / 32768.0f);
+    for (; i+8 <= count; i += 8)
+    {
+        auto samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in+2*i));
+        _mm_storeu_ps(out+i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16)), scale));
+        _mm_storeu_ps(out+i+4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16)), scale));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        int16_t sample;
+        memcpy(&sample, in+2*i, sizeof(int16_t));
+        out[i] = sample / 32768.0f;
+    }
+}
+
+// 24-bit samples are moved to the top of an int32, so they share the 32-bit scale
+static void convertSigned24(const uint8_t* in, float* out, size_t count)
+{
+    auto load = [in](size_t i)
+    {
+        return (int32_t)((uint32_t)in[3*i] << 8 | (uint32_t)in[3*i+1] << 16 | (uint32_t)in[3*i+2] << 24);
+    };
+
+    size_t i = 0;
+#if WAVE_USE_SSE2
+    auto scale = _mm_set1_ps(1.0f / 2147483648.0f);
+    for (; i+4 <= count; i += 4)
+    {
+        auto samples = _mm_setr_epi32(load(i), load(i+1), load(i+2), load(i+3));
+        _mm_storeu_ps(out+i, _mm_mul_ps(_mm_cvtepi32_ps(samples), scale));
+    }
+#endif
+    for (; i < count; i++) out[i] = load(i) / 2147483648.0f;
+}
+
+static void convertSigned32(const uint8_t* in, float* out, size_t count)
+{
+    size_t i = 0;
+#if WAVE_USE_SSE2
+    auto scale = _mm_set1_ps(1.0f / 2147483648.0f);
+    for (; i+4 <= count; i += 4)
+    {
+        auto samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in+4*i));
+        _mm_storeu_ps(out+i, _mm_mul_ps(_mm_cvtepi32_ps(samples), scale));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        int32_t sample;
+        memcpy(&sample, in+4*i, sizeof(int32_t));
+        out[i] = sample / 2147483648.0f;
+    }
+}
+
+static void convertFloat32(const uint8_t* in, float* out, size_t count)
+{
+    memcpy(out, in, count * sizeof(float));
+}
+
+static void convertFloat64(const uint8_t* in, float* out, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        double sample;
+        memcpy(&sample, in+8*i, sizeof(double));
+        out[i] = (float)sample;
+    }
+}
+
+using ConvertFunction = void(*)(const uint8_t*, float*, size_t);
+
+static ConvertFunction getConvertFunction(uint16_t format, uint16_t bitsPerSample)
+{
+    if (format == PCM)
+    {
+        switch (bitsPerSample)
+        {
+            case 8: return convertUnsigned8;
+            case 16: return convertSigned16;
+            case 24: return convertSigned24;
+            case 32: return convertSigned32;
+        }
+    }
+    else if (format == IEEEFloat)
+    {
+        switch (bitsPerSample)
+        {
+            case 32: return convertFloat32;
+            case 64: return convertFloat64;
+        }
+    }
+
+    return nullptr;
+}
+
+static bool skipChunk(sf::InputStream& stream, uint32_t size)
+{
+    // chunks are padded to an even size
+    auto position = stream.tell() + size + (size & 1);
+    return stream.seek(position) == position;
+}
 
 util::generic_shared_ptr loadWaveFile(std::unique_ptr<sf::InputStream>& stream)
 {
     using namespace util;
 
-    uint32_t dummy, chunkSize;
-    if (!checkMagic(*stream, "RIFF") || !readFromStream(*stream, dummy) ||
-        !checkMagic(*stream, "WAVEfmt ") || !readFromStream(*stream, chunkSize)) return generic_shared_ptr{};
-    if (chunkSize != 16) return generic_shared_ptr{};
+    uint32_t dummy;
+    if (!checkMagic(*stream, "RIFF") || !readFromStream(*stream, dummy) || !checkMagic(*stream, "WAVE"))
+        return generic_shared_ptr{};
+
+    uint16_t audioFormat = 0, numChannels = 0, blockAlign = 0, bitsPerSample = 0;
+    uint32_t sampleRate = 0;
+
+    // other chunks (LIST, fact, cue...) may come before or between the two we need
+    char chunkId[4];
+    uint32_t chunkSize;
+    while (true)
+    {
+        if (stream->read(chunkId, 4) != 4 || !readFromStream(*stream, chunkSize)) return generic_shared_ptr{};
+
+        if (!memcmp(chunkId, "fmt ", 4))
+        {
+            if (chunkSize < 16) return generic_shared_ptr{};
+            if (!readFromStream(*stream, audioFormat, numChannels, sampleRate, dummy, blockAlign, bitsPerSample))
+                return generic_shared_ptr{};
+
+            // the actual format is in the first two bytes of the subformat GUID
+            uint32_t readSize = 16;
+            if (audioFormat == Extensible && chunkSize >= 40)
+            {
+                uint16_t extensionSize, validBits;
+                uint32_t channelMask;
+                if (!readFromStream(*stream, extensionSize, validBits, channelMask, audioFormat))
+                    return generic_shared_ptr{};
+                readSize = 26;
+            }
+
+            if (!skipChunk(*stream, chunkSize - readSize)) return generic_shared_ptr{};
+        }
+        else if (!memcmp(chunkId, "data", 4)) break;
+        else if (!skipChunk(*stream, chunkSize)) return generic_shared_ptr{};
+    }
 
-    uint16_t audioFormat, numChannels, bitsPerSample, dummy16;
-    uint32_t sampleRate;
-    if (!readFromStream(*stream, audioFormat, numChannels, sampleRate, dummy, dummy16, bitsPerSample)) return generic_shared_ptr{};
-    if (audioFormat != 1 || numChannels != 1) return generic_shared_ptr{};
+    auto convert = getConvertFunction(audioFormat, bitsPerSample);
+    if (!convert || numChannels == 0 || numChannels > 2 || sampleRate == 0) return generic_shared_ptr{};
+    if (blockAlign != numChannels * bitsPerSample / 8) return generic_shared_ptr{};
 
-    uint32_t totalSoundSize;
-    if (!checkMagic(*stream, "data") || !readFromStream(*stream, totalSoundSize)) return generic_shared_ptr{};
+    // some writers leave the size of streamed files unset, so trust the stream over it
+    sf::Int64 dataSize = chunkSize, available = stream->getSize() - stream->tell();
+    if (available >= 0 && dataSize > available) dataSize = available;
+    size_t numSamples = dataSize / blockAlign * numChannels;
 
     auto snd = std::make_shared<Sound>();
-    snd->stereo = false;
+    snd->stereo = numChannels == 2;
     snd->sampleRate = sampleRate;
     snd->loopPoint = std::numeric_limits<size_t>::max();
-    snd->data.resize(totalSoundSize * 8 / bitsPerSample);
+    snd->data.resize(numSamples);
 
-    for (float& val : snd->data)
+    // mapped files are converted in place, the others take a single read
+    size_t rawSize = numSamples * bitsPerSample / 8;
+    if (auto mapped = dynamic_cast<MappedInputStream*>(stream.get()))
+        convert(reinterpret_cast<const uint8_t*>(mapped->getData() + mapped->tell()), snd->data.data(), numSamples);
+    else
     {
-        if (bitsPerSample == 8)
-        {
-            uint8_t sample;
-            if (!readFromStream(*stream, sample)) return generic_shared_ptr{};
-            val = (sample - 128) / 128.0f;
-        }
-        else
-        {
-            int16_t sample;
-            if (!readFromStream(*stream, sample)) return generic_shared_ptr{};
-            val = sample / 32768.0f;
-        }
+        std::vector<uint8_t> raw(rawSize);
+        if (stream->read(raw.data(), rawSize) != (sf::Int64)rawSize) return generic_shared_ptr{};
+        convert(raw.data(), snd->data.data(), numSamples);
     }
 
     return generic_shared_ptr{snd};
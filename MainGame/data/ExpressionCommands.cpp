@@ -40,40 +40,43 @@ intmax_t runExpression(const ExpressionCommands& cmds, size_t x)
 {
     if (cmds.opcodes.empty()) return 0;
     
-    // This is to preserve memory and make execution faster
-    static std::vector<intmax_t> stack;
-    stack.clear();
+    // A local stack keeps this reentrant and free of allocations
+    intmax_t stack[ExpressionCommands::MaxStackDepth];
+    size_t size = 0;
     
     for (auto opcode : cmds.opcodes)
     {
-        if (opcode >= 15) stack.push_back(opcode - 15);
-        else if (opcode == 14) stack.push_back(x);
+        if (opcode >= 14)
+        {
+            if (size == ExpressionCommands::MaxStackDepth) return 0;
+            stack[size++] = opcode == 14 ? (intmax_t)x : (intmax_t)(opcode - 15);
+        }
         else
         {
-            if (stack.size() <= 1) return 0;
+            if (size <= 1) return 0;
             
-            intmax_t a = stack[stack.size()-2];
-            intmax_t b = stack[stack.size()-1];
-            stack.pop_back();
+            intmax_t a = stack[size-2];
+            intmax_t b = stack[size-1];
+            intmax_t& result = stack[--size - 1];
             
             switch (opcode)
             {
-                case 0: stack.back() = a + b; break;
-                case 1: stack.back() = a - b; break;
-                case 2: stack.back() = a * b; break;
-                case 3: if (b != 0) stack.back() = a / b;
+                case 0: result = a + b; break;
+                case 1: result = a - b; break;
+                case 2: result = a * b; break;
+                case 3: if (b != 0) result = a / b;
                     else return 0; break;
-                case 4: if (b != 0) stack.back() = a % b;
+                case 4: if (b != 0) result = a % b;
                     else return 0; break;
-                case 5: stack.back() = a == b; break;
-                case 6: stack.back() = a != b; break;
-                case 7: stack.back() = a < b; break;
-                case 8: stack.back() = a > b; break;
-                case 9: stack.back() = a <= b; break;
-                case 10: stack.back() = a >= b; break;
-                case 11: stack.back() = a && b; break;
-                case 12: stack.back() = a || b; break;
-                case 13: stack.back() = (a != 0) != (b != 0); break;
+                case 5: result = a == b; break;
+                case 6: result = a != b; break;
+                case 7: result = a < b; break;
+                case 8: result = a > b; break;
+                case 9: result = a <= b; break;
+                case 10: result = a >= b; break;
+                case 11: result = a && b; break;
+                case 12: result = a || b; break;
+                case 13: result = (a != 0) != (b != 0); break;
             }
         }
     }
@@ -28,6 +28,9 @@
 
 struct ExpressionCommands final
 {
+    // Deeper expressions evaluate to 0; plural rules never come close
+    static constexpr size_t MaxStackDepth = 32;
+    
     std::vector<size_t> opcodes;
     
     #ifndef NDEBUG
@@ -24,6 +24,8 @@
 #include "LevelData.hpp"
 
 #include <algorithm>
+#include <FlatLayouts.hpp>
+#include "resources/FlatResourceData.hpp"
 
 #include "language/LocalizationManager.hpp"
 #include "language/LangID.hpp"
@@ -91,6 +93,31 @@ bool readFromStream(sf::InputStream& stream, LevelData& level)
         level.songResourceName, level.roomResourceNames, level.roomMaps);
 }
 
+// The exporter never fills the maps in; once they are generated, the level is
+// written back in the stream format, which the loader still understands
+bool readFromFlat(const FlatResourceData& data, LevelData& level)
+{
+    using namespace util;
+    const auto& reader = data.getReader();
+
+    flat_view<flat_level_info> info;
+    flat_view<flat_string> roomNames;
+    if (!reader.get(FlatLevelInfo, info) || info.size() != 1 || !reader.get(FlatLevelRoomNames, roomNames))
+        return false;
+
+    level.levelNumber = info[0].levelNumber;
+    level.startingRoom = info[0].startingRoom;
+    level.mapColor = sf::Color(info[0].mapColor[0], info[0].mapColor[1], info[0].mapColor[2], info[0].mapColor[3]);
+    if (!reader.get(info[0].songName, level.songResourceName)) return false;
+
+    level.roomResourceNames.resize(roomNames.size());
+    for (size_t i = 0; i < roomNames.size(); i++)
+        if (!reader.get(roomNames[i], level.roomResourceNames[i])) return false;
+
+    level.roomMaps.clear();
+    return true;
+}
+
 bool writeRLGrid(OutputStream& stream, const util::grid<bool>& grid)
 {
     if (!writeToStream(stream, varLength(grid.width()), varLength(grid.height()))) return false;
@@ -152,5 +179,5 @@ std::string getLevelNameForNumber(LocalizationManager& lm, size_t number)
 {
     if (number <= 10)
         return lm.getFormattedString("level-name", {}, { { "n", number } }, {});
-    else return lm.getString("level-name-final-boss");
+    else return std::string(lm.getString("level-name-final-boss"));
 }
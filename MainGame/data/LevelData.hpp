@@ -34,6 +34,7 @@
 #include <SFML/Graphics.hpp>
 
 class LocalizationManager;
+class FlatResourceData;
 
 class LevelData final
 {
@@ -59,6 +60,7 @@ bool readRLGrid(sf::InputStream& stream, util::grid<bool>& grid);
 bool readBinaryGrid(sf::InputStream& stream, util::grid<bool>& grid);
 bool readFromStream(sf::InputStream& stream, LevelData::MapData& map);
 bool readFromStream(sf::InputStream& stream, LevelData& level);
+bool readFromFlat(const FlatResourceData& data, LevelData& level);
 
 bool writeRLGrid(OutputStream& stream, const util::grid<bool>& grid);
 bool writeBinaryGrid(OutputStream& stream, const util::grid<bool>& grid);
@@ -24,16 +24,176 @@
 #include "RoomData.hpp"
 
 #include <streamReaders.hpp>
+#include <FlatLayouts.hpp>
+#include <algorithm>
+#include <cstddef>
 #include "objects/GameObject.hpp"
+#include "data/TileSet.hpp"
+#include "resources/FlatResourceData.hpp"
 
-bool readFromStream(sf::InputStream& stream, GameObjectDescriptor& descriptor)
+static_assert(sizeof(RoomShape) == sizeof(util::flat_room_shape) &&
+    offsetof(RoomShape, radius) == offsetof(util::flat_room_shape, radius) &&
+    offsetof(RoomShape, pointOffset) == offsetof(util::flat_room_shape, pointOffset) &&
+    offsetof(RoomShape, x) == offsetof(util::flat_room_shape, x) &&
+    offsetof(RoomShape, crumblePieceSize) == offsetof(util::flat_room_shape, crumblePieceSize),
+    "RoomShape must have the layout of flat_room_shape!");
+
+namespace
 {
-    if (!readFromStream(stream, descriptor.klass, descriptor.name)) return false;
-    descriptor.parameters = readParametersFromStream(stream, descriptor.klass);
-    return !descriptor.parameters.empty();
+    // Rooms in the stream format own their arrays and strings here
+    struct RoomStorage
+    {
+        util::grid<uint8_t> mainLayer;
+        std::string tilesetName;
+        std::vector<std::pair<std::string,std::string>> objectNames;
+        std::vector<WarpData> warps;
+        std::vector<RoomShape> shapes;
+        std::vector<sf::Vector2f> shapePoints;
+    };
+}
+
+static bool isShapeValid(const RoomShape& shape)
+{
+    if (shape.type > RoomShape::Type::Polygon || !TileSet::isAttributeValid((TileSet::Attribute)shape.attribute))
+        return false;
+
+    size_t minPoints = shape.type == RoomShape::Type::Segment ? 2 : 1;
+    return shape.numPoints >= minPoints;
+}
+
+bool readFromStream(sf::InputStream& stream, RoomShape& shape, std::vector<sf::Vector2f>& points)
+{
+    size_t numPoints;
+    if (!readFromStream(stream, shape.type, shape.attribute, shape.radius, varLength(numPoints)))
+        return false;
+
+    shape.pointOffset = points.size();
+    shape.numPoints = numPoints;
+    if (shape.numPoints != numPoints || !isShapeValid(shape)) return false;
+
+    points.resize(points.size() + shape.numPoints);
+
+    auto size = (sf::Int64)(shape.numPoints * sizeof(sf::Vector2f));
+    if (stream.read(points.data() + shape.pointOffset, size) != size) return false;
+
+    if ((TileSet::Attribute)shape.attribute == TileSet::Attribute::Crumbling)
+    {
+        size_t x, y, crumblePieceSize;
+        if (!readFromStream(stream, varLength(x), varLength(y), shape.waitTime, shape.crumbleTime,
+            varLength(crumblePieceSize))) return false;
+
+        shape.x = x;
+        shape.y = y;
+        shape.crumblePieceSize = crumblePieceSize;
+    }
+
+    return true;
 }
 
 bool readFromStream(sf::InputStream &stream, RoomData& room)
 {
-    return readFromStream(stream, room.tilesetName, room.mainLayer, room.gameObjectDescriptors, room.warps);
+    auto storage = std::make_shared<RoomStorage>();
+
+    size_t numObjects;
+    if (!readFromStream(stream, storage->tilesetName, storage->mainLayer, varLength(numObjects))) return false;
+
+    std::vector<util::generic_shared_ptr> parameters(numObjects);
+    storage->objectNames.resize(numObjects);
+    for (size_t i = 0; i < numObjects; i++)
+    {
+        auto& names = storage->objectNames[i];
+        if (!readFromStream(stream, names.first, names.second)) return false;
+
+        parameters[i] = readParametersFromStream(stream, names.first);
+        if (parameters[i].empty()) return false;
+    }
+
+    if (!readFromStream(stream, storage->warps)) return false;
+
+    // the shape section is optional, older rooms end right after the warps
+    bool hasShapes = checkMagic(stream, "SHPS");
+    if (hasShapes)
+    {
+        size_t numShapes;
+        if (!readFromStream(stream, varLength(numShapes))) return false;
+
+        storage->shapes.resize(numShapes);
+        for (auto& shape : storage->shapes)
+            if (!readFromStream(stream, shape, storage->shapePoints)) return false;
+    }
+
+    // the storage is complete, nothing moves anymore
+    room.mainLayer = storage->mainLayer;
+    room.tilesetName = storage->tilesetName;
+    room.gameObjectDescriptors.resize(numObjects);
+    for (size_t i = 0; i < numObjects; i++)
+        room.gameObjectDescriptors[i] = { storage->objectNames[i].first, storage->objectNames[i].second,
+            std::move(parameters[i]) };
+
+    room.warps = { storage->warps.data(), storage->warps.size() };
+    room.hasPrecomputedShapes = hasShapes;
+    room.shapes = { storage->shapes.data(), storage->shapes.size() };
+    room.shapePoints = { storage->shapePoints.data(), storage->shapePoints.size() };
+    room.storage = std::move(storage);
+    return true;
+}
+
+bool readFromFlat(const FlatResourceData& data, RoomData& room)
+{
+    using namespace util;
+    const auto& reader = data.getReader();
+
+    flat_view<flat_room_info> info;
+    flat_view<uint8_t> layer;
+    flat_view<flat_room_object> objects;
+    flat_view<char> parameters;
+    flat_view<WarpData> warps;
+    if (!reader.get(FlatRoomInfo, info) || info.size() != 1 || !reader.get(FlatRoomLayer, layer) ||
+        !reader.get(FlatRoomObjects, objects) || !reader.get(FlatRoomParameters, parameters) ||
+        !reader.get(FlatRoomWarps, warps)) return false;
+
+    if (!reader.get(info[0].tilesetName, room.tilesetName)) return false;
+    if (layer.size() != (size_t)info[0].width * info[0].height) return false;
+
+    room.mainLayer = grid_view<uint8_t>(layer.data(), info[0].width, info[0].height);
+
+    room.gameObjectDescriptors.resize(objects.size());
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+        const auto& object = objects[i];
+        auto& descriptor = room.gameObjectDescriptors[i];
+        if (!reader.get(object.klass, descriptor.klass) || !reader.get(object.name, descriptor.name)) return false;
+
+        if (object.parametersOffset > parameters.size() ||
+            object.parametersLength > parameters.size() - object.parametersOffset) return false;
+
+        sf::MemoryInputStream stream;
+        stream.open(parameters.data() + object.parametersOffset, object.parametersLength);
+        descriptor.parameters = readParametersFromStream(stream, std::string(descriptor.klass));
+        if (descriptor.parameters.empty()) return false;
+    }
+
+    room.warps = warps;
+    room.storage = data.getOwner();
+
+    room.hasPrecomputedShapes = false;
+    room.shapes = {};
+    room.shapePoints = {};
+    if (!reader.has(FlatRoomShapes)) return true;
+
+    flat_view<RoomShape> shapes;
+    flat_view<sf::Vector2f> points;
+    if (!reader.get(FlatRoomShapes, shapes) || !reader.get(FlatRoomShapePoints, points)) return false;
+
+    for (const auto& shape : shapes)
+    {
+        if (shape.pointOffset > points.size() || shape.numPoints > points.size() - shape.pointOffset)
+            return false;
+        if (!isShapeValid(shape)) return false;
+    }
+
+    room.shapes = shapes;
+    room.shapePoints = points;
+    room.hasPrecomputedShapes = true;
+    return true;
 }
@@ -24,18 +24,21 @@
 #pragma once
 
 #include <grid.hpp>
+#include <FlatResource.hpp>
 #include <generic_ptrs.hpp>
 #include <non_copyable_movable.hpp>
 #include "resources/Memory.hpp"
 
 #include <vector>
+#include <memory>
+#include <string_view>
 #include <SFML/System.hpp>
 
 template <size_t size> struct Print;
 
 struct GameObjectDescriptor final
 {
-    std::string klass, name;
+    std::string_view klass, name; // into the RoomData's storage
     util::generic_shared_ptr parameters;
 };
 
@@ -64,15 +67,44 @@ struct WarpData final
 #pragma pack(pop)
 static_assert(sizeof(WarpData) == 8*sizeof(char), "WarpData was not correctly packed by the compiler!");
 
+// A collision shape generated from the main layer at export time, laid out
+// like util::flat_room_shape so the shapes of flat rooms are used in place
+struct RoomShape final
+{
+    enum class Type : uint8_t { Segment, Circle, Polygon };
+
+    Type type;
+    uint8_t attribute, padding[2];
+    float radius;
+    uint32_t pointOffset, numPoints; // into RoomData::shapePoints
+
+    // Only meaningful for crumbling shapes
+    uint32_t x, y;
+    float waitTime, crumbleTime;
+    uint32_t crumblePieceSize;
+};
+
+// The arrays and strings are views into storage, which is the flat resource itself,
+// usually the pack mapping, or what the stream reader read for rooms in the old format
 struct RoomData final
 {
-    util::grid<uint8_t> mainLayer;
-    std::string tilesetName;
+    std::shared_ptr<const void> storage;
+
+    util::grid_view<uint8_t> mainLayer;
+    std::string_view tilesetName;
     std::vector<GameObjectDescriptor> gameObjectDescriptors;
-    std::vector<WarpData> warps;
+    util::flat_view<WarpData> warps;
+
+    // Rooms exported before the shapes were precomputed have to generate them on load
+    bool hasPrecomputedShapes = false;
+    util::flat_view<RoomShape> shapes;
+    util::flat_view<sf::Vector2f> shapePoints;
 
     static constexpr auto ReadMagic = "ROOM";
 };
 
+class FlatResourceData;
+
 bool readFromStream(sf::InputStream &stream, RoomData& room);
+bool readFromFlat(const FlatResourceData& data, RoomData& room);
 
@@ -24,7 +24,11 @@
 #include "TileSet.hpp"
 
 #include <streamReaders.hpp>
+#include <FlatLayouts.hpp>
 #include <algorithm>
+#include <cstring>
+#include <cstddef>
+#include "resources/FlatResourceData.hpp"
 
 template <typename T>
 bool readFromStream(sf::InputStream& stream, sf::Vector2<T> &vec)
@@ -64,17 +68,104 @@ bool readFromStream(sf::InputStream& stream, TileSet::SingleObject& object)
     return TileSet::isAttributeValid(object.objectAttribute);
 }
 
+namespace
+{
+    // Tilesets in the stream format own their name and tiles here
+    struct TileSetStorage
+    {
+        std::string textureName;
+        std::vector<TileSet::TileIdentity> tileIdentities;
+    };
+}
+
+static_assert(sizeof(TileSet::TileIdentity) == sizeof(util::flat_tile_identity) &&
+    offsetof(TileSet::TileIdentity, id) == offsetof(util::flat_tile_identity, id),
+    "TileIdentity must have the layout of flat_tile_identity!");
+
 bool readFromStream(sf::InputStream& stream, TileSet& tileSet)
 {
-    if (!readFromStream(stream, tileSet.textureName, tileSet.terrains, tileSet.singleObjects)) return false;
+    auto storage = std::make_shared<TileSetStorage>();
+    if (!readFromStream(stream, storage->textureName, tileSet.terrains, tileSet.singleObjects)) return false;
 
     size_t size;
     if (!readFromStream(stream, varLength(size))) return false;
-    tileSet.tileIdentities.resize(size);
+    storage->tileIdentities.resize(size);
+
+    for (auto& identity : storage->tileIdentities)
+    {
+        size_t id;
+        if (!readFromStream(stream, identity.type, varLength(id))) return false;
+        identity.id = id;
+    }
+
+    tileSet.textureName = storage->textureName;
+    tileSet.tileIdentities = { storage->tileIdentities.data(), storage->tileIdentities.size() };
+    tileSet.storage = std::move(storage);
+    return true;
+}
+
+bool readFromFlat(const FlatResourceData& data, TileSet& tileSet)
+{
+    using namespace util;
+    const auto& reader = data.getReader();
+
+    flat_view<flat_tileset_info> info;
+    flat_view<flat_terrain> terrains;
+    flat_view<flat_single_object> objects;
+    flat_view<flat_object_shape> shapes;
+    flat_view<sf::Vector2<int16_t>> points;
+    flat_view<TileSet::TileIdentity> tiles;
+    if (!reader.get(FlatTileSetInfo, info) || info.size() != 1 || !reader.get(FlatTileSetTerrains, terrains) ||
+        !reader.get(FlatTileSetObjects, objects) || !reader.get(FlatTileSetObjectShapes, shapes) ||
+        !reader.get(FlatTileSetShapePoints, points) || !reader.get(FlatTileSetTiles, tiles)) return false;
+
+    if (!reader.get(info[0].textureName, tileSet.textureName)) return false;
+
+    tileSet.terrains.resize(terrains.size());
+    for (size_t i = 0; i < terrains.size(); i++)
+    {
+        auto& terrain = tileSet.terrains[i];
+        terrain.terrainAttribute = (TileSet::Attribute)terrains[i].attribute;
+        static_assert(sizeof(TileSet::PhysicalParameters) == sizeof(flat_terrain::physicalParameters), "Terrain layouts differ!");
+        memcpy(&terrain.physicalParameters, terrains[i].physicalParameters, sizeof(TileSet::PhysicalParameters));
+        if (!terrain.isValid()) return false;
+    }
+
+    tileSet.singleObjects.resize(objects.size());
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+        const auto& record = objects[i];
+        auto& object = tileSet.singleObjects[i];
+        object.objectAttribute = (TileSet::Attribute)record.attribute;
+        object.waitTime = record.waitTime;
+        object.crumbleTime = record.crumbleTime;
+        object.crumblePieceSize = record.crumblePieceSize;
+        if (!TileSet::isAttributeValid(object.objectAttribute)) return false;
+
+        if (record.shapeOffset > shapes.size() || record.shapeCount > shapes.size() - record.shapeOffset)
+            return false;
+
+        object.shapes.resize(record.shapeCount);
+        for (size_t j = 0; j < record.shapeCount; j++)
+        {
+            const auto& shapeRecord = shapes[record.shapeOffset + j];
+            auto& shape = object.shapes[j];
+            shape.type = (TileSet::SingleObject::ShapeType)shapeRecord.type;
+            shape.radius = shapeRecord.radius;
+
+            if (shape.type > TileSet::SingleObject::ShapeType::Polygon) return false;
+            if (shape.type == TileSet::SingleObject::ShapeType::Segment && shapeRecord.pointCount != 2) return false;
+            if (shapeRecord.pointOffset > points.size() || shapeRecord.pointCount > points.size() - shapeRecord.pointOffset)
+                return false;
+
+            auto begin = points.begin() + shapeRecord.pointOffset;
+            shape.points.assign(begin, begin + shapeRecord.pointCount);
+        }
+    }
+
+    tileSet.tileIdentities = tiles;
+    tileSet.storage = data.getOwner();
 
-    for (auto& id : tileSet.tileIdentities)
-        if (!readFromStream(stream, id.type, varLength(id.id))) return false;
-    
     return true;
 }
 
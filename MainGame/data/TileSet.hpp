@@ -24,7 +24,10 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
+#include <memory>
+#include <FlatResource.hpp>
 #include <unordered_set>
 #include <SFML/System.hpp>
 
@@ -139,7 +142,8 @@ struct TileSet final
         return attrs[id];
     }
 
-    struct TileIdentity { TileType type; size_t id; };
+    // Laid out like util::flat_tile_identity, so flat tilesets are used in place
+    struct TileIdentity { TileType type; uint8_t padding[3]; uint32_t id; };
 
     static bool refersToSame(const TileIdentity& t1, const TileIdentity& t2)
     {
@@ -154,15 +158,21 @@ struct TileSet final
         return t1.id == t2.id;
     }
     
-    std::string textureName;
+    // The name and the tiles are views into storage, the flat resource itself or
+    // what the stream reader read for tilesets in the old format
+    std::shared_ptr<const void> storage;
+    std::string_view textureName;
     std::vector<Terrain> terrains;
     std::vector<SingleObject> singleObjects;
 
-    std::vector<TileIdentity> tileIdentities;
+    util::flat_view<TileIdentity> tileIdentities;
 
     Attribute getTileAttribute(size_t id) const;
 
     static constexpr auto ReadMagic = "TSET";
 };
 
+class FlatResourceData;
+
 bool readFromStream(sf::InputStream &stream, TileSet& tileSet);
+bool readFromFlat(const FlatResourceData& data, TileSet& tileSet);
@@ -27,6 +27,20 @@
 #include <cmath>
 #include <predUtils.hpp>
 #include "unicode/UnicodeUtils.hpp"
+#include <assert.hpp>
+
+constexpr auto SdfFragmentShader = R"fragment(
+uniform sampler2D tex;
+uniform float threshold;
+
+void main()
+{
+    float distance = texture2D(tex, gl_TexCoord[0].xy).a;
+    float width = fwidth(distance);
+    float alpha = smoothstep(threshold - width, threshold + width, distance);
+    gl_FragColor = vec4(gl_Color.rgb, gl_Color.a * alpha);
+}
+)fragment";
 
 bool isGraphemeClusterBoundary(sf::Uint32 c1, sf::Uint32 c2)
 {
@@ -123,23 +137,88 @@ inline static auto addGlyphQuad(sf::VertexArray& dest, sf::Vector2f position, sf
     return std::make_pair(s, s+6);
 }
 
+sf::Shader& TextDrawable::getSdfShader()
+{
+    static sf::Shader shader;
+    static bool shaderLoaded = false;
+
+    if (!shaderLoaded)
+    {
+        ASSERT(shader.loadFromMemory(SdfFragmentShader, sf::Shader::Fragment));
+        shader.setUniform("tex", sf::Shader::CurrentTexture);
+        shaderLoaded = true;
+    }
+
+    return shader;
+}
+
 float TextDrawable::getLineSpacing() const
 {
-    return fontHandler->getFont().getLineSpacing(fontSize);
+    return fontHandler->getLineSpacing(fontSize);
 }
 
 float TextDrawable::getHeightForLineNumber(size_t lines) const
 {
-    const auto& font = fontHandler->getFont();
-
     if (lines == 0) return 0;
-    return font.getDescent(fontSize) - font.getAscent(fontSize) + (lines-1) * font.getLineSpacing(fontSize);
+    return fontHandler->getDescent(fontSize) - fontHandler->getAscent(fontSize)
+        + (lines-1) * fontHandler->getLineSpacing(fontSize);
 }
 
 void TextDrawable::buildGeometry()
 {
-    if (!needsUpdateGeometry) return;
+    if (needsUpdateGeometry) layoutText();
+    else
+    {
+        if (needsUpdateColors) updateColors();
+        if (needsUpdateAnchor) updateAnchor();
+    }
+}
+
+void TextDrawable::updateColors()
+{
+    for (size_t i = 0; i < vertices.getVertexCount(); i++)
+        vertices[i].color = defaultColor;
+    for (size_t i = 0; i < verticesOutline.getVertexCount(); i++)
+        verticesOutline[i].color = defaultOutlineColor;
+
+    needsUpdateColors = false;
+}
+
+void TextDrawable::updateAnchor()
+{
+    // bounds and vertices are already displaced by the previous anchor's offset
+    sf::Vector2f base(bounds.left + anchorOffset.x, bounds.top + anchorOffset.y);
+
+    sf::Vector2f revert;
+    switch (horizontalAnchor)
+    {
+        case HorAnchor::Left: revert.x = base.x; break;
+        case HorAnchor::Center: revert.x = floorf(base.x + bounds.width/2); break;
+        case HorAnchor::Right: revert.x = base.x + bounds.width; break;
+    }
+    switch (verticalAnchor)
+    {
+        case VertAnchor::Top: revert.y = base.y; break;
+        case VertAnchor::Center: revert.y = floorf(base.y + bounds.height/2); break;
+        case VertAnchor::Bottom: revert.y = base.y + bounds.height; break;
+        case VertAnchor::Baseline: break;
+    }
 
+    auto delta = revert - anchorOffset;
+    bounds.left -= delta.x;
+    bounds.top -= delta.y;
+
+    for (size_t i = 0; i < vertices.getVertexCount(); i++)
+        vertices[i].position -= delta;
+    for (size_t i = 0; i < verticesOutline.getVertexCount(); i++)
+        verticesOutline[i].position -= delta;
+
+    anchorOffset = revert;
+    needsUpdateAnchor = false;
+}
+
+void TextDrawable::layoutText()
+{
     vertices.clear();
     verticesOutline.clear();
     graphemeClusters.clear();
@@ -155,6 +234,7 @@ void TextDrawable::buildGeometry()
 #endif
 
     sf::Font& font = fontHandler->getFont();
+    const auto& sdfFont = fontHandler->getSdfFont();
     HarfBuzzWrapper& wrapper = fontHandler->getHBWrapper();
     wrapper.setFontSize(fontSize);
 
@@ -194,21 +274,32 @@ void TextDrawable::buildGeometry()
         size_t curGraphemeBegin = graphemeClusters.size();
         sf::Vector2f position;
 
-        auto prop = wrapper.shape(curPos, nextWordPos - curPos);
+        const auto& prop = wrapper.shape(curPos, nextWordPos - curPos);
         for (const auto& glyphData : prop.glyphs)
         {
             uint32_t c = glyphData.codepoint;
             size_t cluster = glyphData.cluster;
 
-            if (outline)
+            std::pair<size_t,size_t> p;
+            if (sdfFont)
             {
-                auto tempPos = position + glyphData.offset - sf::Vector2f(outlineThickness, outlineThickness);
-                const auto& glyph = font.getGlyphId(c, fontSize, false, outlineThickness);
-                addGlyphQuad(verticesOutline, tempPos, defaultOutlineColor, glyph);
+                // the outline is drawn from the same quad, with a lower distance threshold
+                auto glyph = sdfFont->getGlyph(c, fontSize);
+                if (outline) addGlyphQuad(verticesOutline, position + glyphData.offset, defaultOutlineColor, glyph);
+                p = addGlyphQuad(vertices, position + glyphData.offset, defaultColor, glyph);
             }
+            else
+            {
+                if (outline)
+                {
+                    auto tempPos = position + glyphData.offset - sf::Vector2f(outlineThickness, outlineThickness);
+                    const auto& glyph = font.getGlyphId(c, fontSize, false, outlineThickness);
+                    addGlyphQuad(verticesOutline, tempPos, defaultOutlineColor, glyph);
+                }
 
-            const auto& glyph = font.getGlyphId(c, fontSize, false);
-            auto p = addGlyphQuad(vertices, position + glyphData.offset, defaultColor, glyph);
+                const auto& glyph = font.getGlyphId(c, fontSize, false);
+                p = addGlyphQuad(vertices, position + glyphData.offset, defaultColor, glyph);
+            }
 
             position += glyphData.advance;
 
@@ -259,7 +350,7 @@ void TextDrawable::buildGeometry()
             bounds.width = 0;
         }
 
-        bounds.top = font.getAscent(fontSize);
+        bounds.top = fontHandler->getAscent(fontSize);
 
         const Word* lastBegin = &words.front();
         float curLineWidth = 0;
@@ -281,7 +372,7 @@ void TextDrawable::buildGeometry()
                     lastBegin = &word;
 
                     curPos.x = 0;
-                    curPos.y += font.getLineSpacing(fontSize);
+                    curPos.y += fontHandler->getLineSpacing(fontSize);
                 }
             }
 
@@ -307,20 +398,21 @@ void TextDrawable::buildGeometry()
                     lastBegin = &words[i+1];
 
                     curPos.x = 0;
-                    curPos.y += font.getLineSpacing(fontSize);
+                    curPos.y += fontHandler->getLineSpacing(fontSize);
                 }
                 else if (!unicode::isCharacterZeroWidth(word.nextCharacter))
                 {
-                    const auto& glyph = font.getGlyph(word.nextCharacter, fontSize, false);
-                    if (rtl) curPos.x -= glyph.advance;
-                    else curPos.x += glyph.advance;
+                    float advance = fontHandler->getCharacterAdvance(word.nextCharacter, fontSize);
+                    if (rtl) curPos.x -= advance;
+                    else curPos.x += advance;
                 }
             }
         }
 
         bounds = rectUnionWithLineX(bounds, curLineWidth);
         lines.push_back({ lastBegin->vertexBegin, words.back().vertexEnd, words.back().graphemeClusterEnd, curLineWidth });
-        bounds.height = (lines.size() - 1) * font.getLineSpacing(fontSize) + font.getDescent(fontSize) - bounds.top;
+        bounds.height = (lines.size() - 1) * fontHandler->getLineSpacing(fontSize)
+            + fontHandler->getDescent(fontSize) - bounds.top;
 
         lineBoundaries.clear();
         for (const auto& line : lines)
@@ -343,31 +435,11 @@ void TextDrawable::buildGeometry()
         }
     }
 
-    sf::Vector2f revert;
-    switch (horizontalAnchor)
-    {
-        case HorAnchor::Left: revert.x = bounds.left; break;
-        case HorAnchor::Center: revert.x = floorf(bounds.left + bounds.width/2); break;
-        case HorAnchor::Right: revert.x = bounds.left + bounds.width; break;
-    }
-    switch (verticalAnchor)
-    {
-        case VertAnchor::Top: revert.y = bounds.top; break;
-        case VertAnchor::Center: revert.y = floorf(bounds.top + bounds.height/2); break;
-        case VertAnchor::Bottom: revert.y = bounds.top + bounds.height; break;
-        case VertAnchor::Baseline: break;
-    }
-
-    bounds.left -= revert.x;
-    bounds.top -= revert.y;
-
-    for (size_t i = 0; i < vertices.getVertexCount(); i++)
-    {
-        vertices[i].position -= revert;
-        if (outline) verticesOutline[i].position -= revert;
-    }
+    anchorOffset = sf::Vector2f();
+    updateAnchor();
 
     needsUpdateGeometry = false;
+    needsUpdateColors = false;
 }
 
 TextDrawable::GraphemeRange TextDrawable::getGraphemeClusterInterval(size_t begin, size_t end, bool outline)
@@ -435,6 +507,24 @@ TextDrawable::GraphemeRange TextDrawable::getAllVertices(bool outline)
 
 void TextDrawable::draw(sf::RenderTarget& target, sf::RenderStates states) const
 {
+    const auto& sdfFont = fontHandler ? fontHandler->getSdfFont() : nullptr;
+    if (!needsUpdateGeometry && sdfFont)
+    {
+        auto& shader = getSdfShader();
+        states.texture = &sdfFont->getTexture();
+        states.shader = &shader;
+
+        if (verticesOutline.getVertexCount() > 0)
+        {
+            shader.setUniform("threshold", sdfFont->getEdgeThreshold(fontSize, outlineThickness));
+            target.draw(verticesOutline, states);
+        }
+
+        shader.setUniform("threshold", 0.5f);
+        target.draw(vertices, states);
+        return;
+    }
+
     if (!needsUpdateGeometry)
         states.texture = &fontHandler->getFont().getTexture(fontSize);
 
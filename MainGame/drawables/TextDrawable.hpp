@@ -28,6 +28,7 @@
 #include <vector>
 #include <utility>
 #include <string>
+#include <string_view>
 #include <map>
 #include <functional>
 #include <rectUtils.hpp>
@@ -72,9 +73,11 @@ private:
     
     bool rtl = false;
     bool needsUpdateGeometry = false;
+    bool needsUpdateColors = false, needsUpdateAnchor = false;
     sf::VertexArray vertices, verticesOutline;
     
     sf::FloatRect bounds;
+    sf::Vector2f anchorOffset;
 
     std::vector<GraphemeClusterData> graphemeClusters;
     std::vector<size_t> lineBoundaries;
@@ -87,16 +90,16 @@ public:
     void setFontHandler(std::shared_ptr<FontHandler> handler) { fontHandler = handler; }
     
     const auto& getString() const { return utf8String; }
-    void setString(std::string str) { utf8String = str; needsUpdateGeometry = true; }
+    void setString(std::string_view str) { utf8String.assign(str.data(), str.size()); needsUpdateGeometry = true; }
     
     auto getFontSize() const  { return fontSize; }
     void setFontSize(unsigned int size) { fontSize = size; needsUpdateGeometry = true; }
     
     auto getDefaultColor() const  { return defaultColor; }
-    void setDefaultColor(sf::Color c) { defaultColor = c; needsUpdateGeometry = true; }
+    void setDefaultColor(sf::Color c) { defaultColor = c; needsUpdateColors = true; }
     
     auto getDefaultOutlineColor() const  { return defaultOutlineColor; }
-    void setDefaultOutlineColor(sf::Color c) { defaultOutlineColor = c; needsUpdateGeometry = true; }
+    void setDefaultOutlineColor(sf::Color c) { defaultOutlineColor = c; needsUpdateColors = true; }
     
     auto getOutlineThickness() const  { return outlineThickness; }
     void setOutlineThickness(float thickness) { outlineThickness = thickness; needsUpdateGeometry = true; }
@@ -118,16 +121,18 @@ public:
     void setWordAlignment(Alignment alignment) { wordAlignment = alignment; needsUpdateGeometry = true; }
     
     auto getHorizontalAnchor() const { return horizontalAnchor; }
-    void setHorizontalAnchor(HorAnchor anchor) { horizontalAnchor = anchor; needsUpdateGeometry = true; }
+    void setHorizontalAnchor(HorAnchor anchor) { horizontalAnchor = anchor; needsUpdateAnchor = true; }
     
     auto getVerticalAnchor() const { return verticalAnchor; }
-    void setVerticalAnchor(VertAnchor anchor) { verticalAnchor = anchor; needsUpdateGeometry = true; }
+    void setVerticalAnchor(VertAnchor anchor) { verticalAnchor = anchor; needsUpdateAnchor = true; }
     
     auto getRTL() const { return rtl; }
     void setRTL(bool isRTL) { rtl = isRTL; needsUpdateGeometry = true; }
 
     const auto& getLocalBounds() const { return bounds; }
     
+    // Only lays out the text again when the string, the font or the layout
+    // change; color and anchor changes patch the existing vertices
     void buildGeometry();
 
     GraphemeRange getGraphemeClusterInterval(size_t begin, size_t end, bool outline = false);
@@ -141,6 +146,13 @@ public:
     
     GraphemeRange getAllVertices(bool outline = false);
     
+    // Draws glyphs from distance field atlases
+    static sf::Shader& getSdfShader();
+
 private:
+    void layoutText();
+    void updateColors();
+    void updateAnchor();
+    
     virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
 };
@@ -23,106 +23,131 @@
 
 #include "Tilemap.hpp"
 #include <cmath>
+#include <algorithm>
 #include <rectUtils.hpp>
 
-void Tilemap::draw(sf::RenderTarget& target, sf::RenderStates states) const
+void Tilemap::setTexture(std::shared_ptr<sf::Texture> tex)
 {
-    mutableUpdateVertexMap(states.transform);
+    texture = tex;
 
-    if (vertexSize > 0)
-    {
-        states.texture = texture.get();
-        states.transform.translate((float)tileSize * lastPoint.x, (float)tileSize * lastPoint.y);
-        target.draw(vertices.get(), vertexSize, sf::Triangles, states);
-    }
+    // the texture coordinates depend on the texture's stride
+    for (auto& chunk : chunks) chunk.dirty = true;
 }
 
-sf::FloatRect Tilemap::getTextureRectForTile(size_t tile) const
+void Tilemap::resetChunks()
 {
-    if (tile == (uint8_t)-1) return sf::FloatRect{0, 0, 0, 0};
-    size_t stride = texture->getSize().x / tileSize;
-    size_t texS = tile % stride;
-    size_t texT = tile / stride;
+    chunksWidth = (tileData.width() + ChunkSize - 1) / ChunkSize;
+    chunksHeight = (tileData.height() + ChunkSize - 1) / ChunkSize;
+
+    chunks.clear();
+    chunks.resize(chunksWidth * chunksHeight);
+
+    for (size_t cy = 0; cy < chunksHeight; cy++)
+        for (size_t cx = 0; cx < chunksWidth; cx++)
+        {
+            auto& chunk = chunks[cy * chunksWidth + cx];
+            chunk.width = std::min(ChunkSize, tileData.width() - cx * ChunkSize);
+            chunk.height = std::min(ChunkSize, tileData.height() - cy * ChunkSize);
+            chunk.dirty = true;
+        }
+}
 
-    return sf::FloatRect{(float)tileSize * texS, (float)tileSize * texT, (float)tileSize, (float)tileSize};
+void Tilemap::setTile(size_t x, size_t y, uint8_t tile)
+{
+    tileData(x, y) = tile;
+    if (auto vertices = getTileVertices(x, y)) setTileVertices(vertices, x, y);
 }
 
-void Tilemap::mutableUpdateVertexMap(sf::Transform transform) const
+sf::Vertex* Tilemap::getTileVertices(size_t x, size_t y) const
 {
-    auto invTransform = transform.getInverse();
-    
-    sf::FloatRect tilemapFrame(0, 0, tileSize*tileData.width(), tileSize*tileData.height());
-    auto targetFrame = invTransform.transformRect(drawingFrame);
-    if (!targetFrame.intersects(tilemapFrame))
+    auto& chunk = chunks[(y / ChunkSize) * chunksWidth + (x / ChunkSize)];
+    if (chunk.dirty || !chunk.vertices) return nullptr;
+
+    return &chunk.vertices[6 * ((y % ChunkSize) * chunk.width + (x % ChunkSize))];
+}
+
+void Tilemap::setTileVertices(sf::Vertex* vertices, size_t x, size_t y) const
+{
+    if (tileData(x, y) == (uint8_t)-1)
     {
-        vertexSize = 0;
-        vertices.reset();
+        for (size_t k = 0; k < 6; k++)
+        {
+            vertices[k].color = sf::Color(0, 0, 0, 0);
+            vertices[k].position = sf::Vector2f(0, 0);
+            vertices[k].texCoords = sf::Vector2f(0, 0);
+        }
+
         return;
     }
-    
-    targetFrame = rectIntersectionWithRect(targetFrame, tilemapFrame);
 
-    size_t width = (size_t)floorf((targetFrame.left + targetFrame.width)/tileSize) -
-                   (size_t)floorf((targetFrame.left)/tileSize) + 1;
-    size_t height = (size_t)floorf((targetFrame.top + targetFrame.height)/tileSize) -
-                    (size_t)floorf((targetFrame.top)/tileSize) + 1;
+    size_t stride = texture->getSize().x / tileSize;
+    size_t data = tileData(x, y);
+    size_t texS = data % stride;
+    size_t texT = data / stride;
+
+    for (size_t k = 0; k < 6; k++)
+        vertices[k].color = sf::Color::White;
+
+    vertices[0].position = sf::Vector2f((float)x*tileSize, (float)y*tileSize);
+    vertices[1].position = sf::Vector2f((float)(x+1)*tileSize, (float)y*tileSize);
+    vertices[2].position = sf::Vector2f((float)(x+1)*tileSize, (float)(y+1)*tileSize);
+    vertices[3].position = sf::Vector2f((float)x*tileSize, (float)(y+1)*tileSize);
+    vertices[4].position = vertices[0].position;
+    vertices[5].position = vertices[2].position;
+
+    vertices[0].texCoords = (float)tileSize * sf::Vector2f(texS, texT);
+    vertices[1].texCoords = (float)tileSize * sf::Vector2f(texS+1, texT);
+    vertices[2].texCoords = (float)tileSize * sf::Vector2f(texS+1, texT+1);
+    vertices[3].texCoords = (float)tileSize * sf::Vector2f(texS, texT+1);
+    vertices[4].texCoords = vertices[0].texCoords;
+    vertices[5].texCoords = vertices[2].texCoords;
+}
 
-    bool dirty = false;
+void Tilemap::mutableBuildChunk(size_t cx, size_t cy) const
+{
+    auto& chunk = chunks[cy * chunksWidth + cx];
+    if (!chunk.vertices) chunk.vertices.reset(new sf::Vertex[6 * chunk.width * chunk.height]);
 
-    if (vertexSize != 6*width*height)
-    {
-        vertexSize = 6*width*height;
-        vertices.reset(new sf::Vertex[vertexSize]);
-        lastPoint = sf::Vector2i(0, 0);
-        dirty = true;
-    }
+    for (size_t j = 0; j < chunk.height; j++)
+        for (size_t i = 0; i < chunk.width; i++)
+            setTileVertices(&chunk.vertices[6 * (j * chunk.width + i)], cx * ChunkSize + i, cy * ChunkSize + j);
 
-    sf::Vector2i pt(size_t(targetFrame.left/tileSize), size_t(targetFrame.top/tileSize));
+    chunk.dirty = false;
+}
 
-    if (dirty || lastPoint != pt)
-    {
-        size_t stride = texture->getSize().x / tileSize;
-
-        for (size_t j = 0; j < height; j++)
-            for (size_t i = 0; i < width; i++)
-            {
-                auto cur = pt + sf::Vector2i(i, j);
-
-                if (cur.x < 0 || cur.y < 0 || cur.x >= (intmax_t)tileData.width()
-                    || cur.y >= (intmax_t)tileData.height() || tileData(cur.x, cur.y) == (uint8_t)-1)
-                {
-                    for (size_t k = 0; k < 6; k++)
-                    {
-                        vertices[(j*width+i)*6+k].color = sf::Color(0, 0, 0, 0);
-                        vertices[(j*width+i)*6+k].position = sf::Vector2f(0, 0);
-                        vertices[(j*width+i)*6+k].texCoords = sf::Vector2f(0, 0);
-                    }
-                }
-                else
-                {
-                    size_t data = tileData(cur.x, cur.y);
-                    size_t texS = data % stride;
-                    size_t texT = data / stride;
-
-                    for (size_t k = 0; k < 6; k++)
-                        vertices[(j*width+i)*6+k].color = sf::Color::White;
-
-                    vertices[(j*width+i)*6+0].position = sf::Vector2f((float)i*tileSize, (float)j*tileSize);
-                    vertices[(j*width+i)*6+1].position = sf::Vector2f((float)(i+1)*tileSize, (float)j*tileSize);
-                    vertices[(j*width+i)*6+2].position = sf::Vector2f((float)(i+1)*tileSize, (float)(j+1)*tileSize);
-                    vertices[(j*width+i)*6+3].position = sf::Vector2f((float)i*tileSize, (float)(j+1)*tileSize);
-                    vertices[(j*width+i)*6+4].position = vertices[(j*width+i)*6+0].position;
-                    vertices[(j*width+i)*6+5].position = vertices[(j*width+i)*6+2].position;
-
-                    vertices[(j*width+i)*6+0].texCoords = (float)tileSize * sf::Vector2f(texS, texT);
-                    vertices[(j*width+i)*6+1].texCoords = (float)tileSize * sf::Vector2f(texS+1, texT);
-                    vertices[(j*width+i)*6+2].texCoords = (float)tileSize * sf::Vector2f(texS+1, texT+1);
-                    vertices[(j*width+i)*6+3].texCoords = (float)tileSize * sf::Vector2f(texS, texT+1);
-                    vertices[(j*width+i)*6+4].texCoords = vertices[(j*width+i)*6+0].texCoords;
-                    vertices[(j*width+i)*6+5].texCoords = vertices[(j*width+i)*6+2].texCoords;
-                }
-            }
-
-        lastPoint = pt;
-    }
+void Tilemap::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+    if (!texture || chunks.empty()) return;
+
+    sf::FloatRect tilemapFrame(0, 0, tileSize*tileData.width(), tileSize*tileData.height());
+    auto targetFrame = states.transform.getInverse().transformRect(drawingFrame);
+    if (!targetFrame.intersects(tilemapFrame)) return;
+
+    targetFrame = rectIntersectionWithRect(targetFrame, tilemapFrame);
+
+    float chunkExtent = (float)tileSize * ChunkSize;
+    size_t cx1 = (size_t)floorf(targetFrame.left / chunkExtent);
+    size_t cy1 = (size_t)floorf(targetFrame.top / chunkExtent);
+    size_t cx2 = std::min((size_t)floorf((targetFrame.left + targetFrame.width) / chunkExtent), chunksWidth-1);
+    size_t cy2 = std::min((size_t)floorf((targetFrame.top + targetFrame.height) / chunkExtent), chunksHeight-1);
+
+    states.texture = texture.get();
+
+    for (size_t cy = cy1; cy <= cy2; cy++)
+        for (size_t cx = cx1; cx <= cx2; cx++)
+        {
+            const auto& chunk = chunks[cy * chunksWidth + cx];
+            if (chunk.dirty) mutableBuildChunk(cx, cy);
+            target.draw(chunk.vertices.get(), 6 * chunk.width * chunk.height, sf::Triangles, states);
+        }
+}
+
+sf::FloatRect Tilemap::getTextureRectForTile(size_t tile) const
+{
+    if (tile == (uint8_t)-1) return sf::FloatRect{0, 0, 0, 0};
+    size_t stride = texture->getSize().x / tileSize;
+    size_t texS = tile % stride;
+    size_t texT = tile / stride;
+
+    return sf::FloatRect{(float)tileSize * texS, (float)tileSize * texT, (float)tileSize, (float)tileSize};
 }
@@ -24,6 +24,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include <SFML/Graphics.hpp>
 #include <non_copyable_movable.hpp>
 #include <grid.hpp>
@@ -31,33 +32,51 @@
 
 class Tilemap final : public sf::Drawable
 {
+public:
+    static constexpr size_t ChunkSize = 16;
+
+private:
+    struct Chunk
+    {
+        std::unique_ptr<sf::Vertex[]> vertices;
+        size_t width, height;
+        bool dirty;
+    };
+
     std::shared_ptr<sf::Texture> texture;
 
-    mutable std::unique_ptr<sf::Vertex[]> vertices;
-    mutable size_t vertexSize;
-    mutable sf::Vector2i lastPoint;
+    mutable std::vector<Chunk> chunks;
+    size_t chunksWidth, chunksHeight;
 
     sf::FloatRect drawingFrame;
     size_t tileSize;
 
     util::grid<uint8_t> tileData;
 
+    void resetChunks();
+    void setTileVertices(sf::Vertex* vertices, size_t x, size_t y) const;
+    sf::Vertex* getTileVertices(size_t x, size_t y) const;
+
     // "const", because it modifies mutable parameters
-    void mutableUpdateVertexMap(sf::Transform transform) const;
+    void mutableBuildChunk(size_t cx, size_t cy) const;
 
 public:
     explicit Tilemap(sf::FloatRect drawingFrame, size_t tileSize = DefaultTileSize)
-    : texture(nullptr), vertices(nullptr), vertexSize(0), drawingFrame(drawingFrame),
-      tileSize(tileSize), tileData(), lastPoint(0,0) {}
+    : texture(nullptr), chunksWidth(0), chunksHeight(0), drawingFrame(drawingFrame),
+      tileSize(tileSize), tileData() {}
     explicit Tilemap(size_t tileSize = DefaultTileSize) : Tilemap(sf::FloatRect{}, tileSize) {}
       
     virtual ~Tilemap() {}
 
     void setDrawingFrame(sf::FloatRect drawingFrame) { this->drawingFrame = drawingFrame; }
 
-    void setTexture(std::shared_ptr<sf::Texture> tex) { texture = tex;  }
-    void setTileData(const util::grid<uint8_t>& data) { tileData = data; vertexSize = 0; }
-    void setTileData(util::grid<uint8_t>&& data) { tileData = std::move(data); vertexSize = 0; }
+    void setTexture(std::shared_ptr<sf::Texture> tex);
+    void setTileData(const util::grid<uint8_t>& data) { tileData = data; resetChunks(); }
+    void setTileData(util::grid<uint8_t>&& data) { tileData = std::move(data); resetChunks(); }
+    void setTileData(util::grid_view<uint8_t> data) { setTileData(util::grid<uint8_t>(data.width(), data.height(), data.data())); }
+
+    // Patches only the geometry of the changed tile
+    void setTile(size_t x, size_t y, uint8_t tile);
     
     auto getTexture() { return texture; }
     const auto& getTileData() const { return tileData; }
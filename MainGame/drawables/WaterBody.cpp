@@ -33,9 +33,12 @@
 #include <vector>
 #include <list>
 #include <utility>
+#include <thread>
+#include <algorithm>
 #include <predUtils.hpp>
 
 #include <readerwriterqueue/readerwriterqueue.h>
+#include "profiler/Profiler.hpp"
 
 #include <iostream>
 #include <cassert>
@@ -45,6 +48,16 @@ constexpr float MaxSineWaveK = 0.08f;
 constexpr float MaxSineWaveOmega = 0.08f;
 
 constexpr float WaveSpeed = 0.92f;
+constexpr float WaveDamping = 0.99f;
+
+constexpr sf::Uint8 FreshTexels = 0x80;
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WATER_USE_SSE2 1
+#else
+#define WATER_USE_SSE2 0
+#endif
 
 constexpr auto ShaderUtilities = R"util(
 float decomposeColor(vec4 color)
@@ -126,6 +139,74 @@ sf::Shader& WaterBody::getDrawingShader()
     return shader;
 }
 
+static inline float stepColumn(float left, float center, float right, float older, float velocity)
+{
+	return WaveDamping * (2 * center - older) + WaveSpeed * WaveSpeed * (left + right - 2 * center) - velocity;
+}
+
+// low byte is the fractional part, then the integer part and the sign; the magnitude is clamped
+// to 255, so the fixed point value fits in the two low bytes
+static inline void packColumn(float output, sf::Uint8* texel)
+{
+	auto fixed = (uint32_t)(std::min(fabsf(output), 255.0f) * 256);
+	texel[0] = fixed & 255;
+	texel[1] = fixed >> 8;
+	texel[2] = 255 * (output >= 0);
+	texel[3] = 255;
+}
+
+void stepDynamicWaves(const float* previous, float* next, const float* velocities, sf::Uint8* texels, size_t width)
+{
+	if (width == 0) return;
+	if (width == 1)
+	{
+		next[0] = stepColumn(0, previous[0], 0, next[0], velocities[0]);
+		packColumn(next[0], texels);
+		return;
+	}
+
+	// the edge columns see zero beyond the surface, so they are peeled off the main loop
+	next[0] = stepColumn(0, previous[0], previous[1], next[0], velocities[0]);
+	packColumn(next[0], texels);
+
+	size_t i = 1;
+#if WATER_USE_SSE2
+	const __m128 damping = _mm_set1_ps(WaveDamping), speed2 = _mm_set1_ps(WaveSpeed * WaveSpeed);
+	const __m128 signBit = _mm_set1_ps(-0.0f), maxHeight = _mm_set1_ps(255.0f), fixedScale = _mm_set1_ps(256.0f);
+	const __m128i signChannel = _mm_set1_epi32(0x00FF0000), alphaChannel = _mm_set1_epi32((int)0xFF000000);
+
+	for (; i + 4 < width; i += 4)
+	{
+		__m128 left = _mm_loadu_ps(previous + i - 1);
+		__m128 center = _mm_loadu_ps(previous + i);
+		__m128 right = _mm_loadu_ps(previous + i + 1);
+		__m128 older = _mm_loadu_ps(next + i);
+		__m128 twice = _mm_add_ps(center, center);
+
+		__m128 output = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(damping, _mm_sub_ps(twice, older)),
+			_mm_mul_ps(speed2, _mm_sub_ps(_mm_add_ps(left, right), twice))), _mm_loadu_ps(velocities + i));
+		_mm_storeu_ps(next + i, output);
+
+		// same layout as packColumn, four little-endian texels at once
+		__m128 height = _mm_min_ps(_mm_andnot_ps(signBit, output), maxHeight);
+		__m128i fixed = _mm_cvttps_epi32(_mm_mul_ps(height, fixedScale));
+		__m128i sign = _mm_and_si128(_mm_castps_si128(_mm_cmpge_ps(output, _mm_setzero_ps())), signChannel);
+		_mm_storeu_si128((__m128i*)(texels + 4 * i), _mm_or_si128(_mm_or_si128(fixed, sign), alphaChannel));
+	}
+#endif
+
+	for (; i < width - 1; i++)
+	{
+		next[i] = stepColumn(previous[i - 1], previous[i], previous[i + 1], next[i], velocities[i]);
+		packColumn(next[i], texels + 4 * i);
+	}
+
+	next[i] = stepColumn(previous[i - 1], previous[i], 0, next[i], velocities[i]);
+	packColumn(next[i], texels + 4 * i);
+}
+
+void dynamicWaveUpdateThread(void* ptr);
+
 struct DynamicUpdateThreadInfo
 {
 	struct Command
@@ -135,64 +216,69 @@ struct DynamicUpdateThreadInfo
 	};
 
 	moodycamel::BlockingReaderWriterQueue<Command> dynamicUpdateQueue;
+	std::vector<WaterBody::DynamicWaveProperties*> pendingUpdates;
 	std::thread dynamicUpdateThread;
 
 	DynamicUpdateThreadInfo() : dynamicUpdateThread(dynamicWaveUpdateThread, this) {}
 	~DynamicUpdateThreadInfo() { dynamicUpdateQueue.enqueue({ Command::Type::Final, nullptr }); dynamicUpdateThread.join(); }
+
+	void stepPendingBodies()
+	{
+		if (pendingUpdates.empty()) return;
+		PROFILE_ZONE("WaterBody::dynamicWaveUpdate");
+
+		for (auto dynamicWaveProperties : pendingUpdates)
+		{
+			auto& props = *dynamicWaveProperties;
+			auto& velocities = props.velocities[props.velocityReadIndex];
+			auto& next = props.frames[props.newestFrame ^ 1];
+
+			stepDynamicWaves(props.frames[props.newestFrame].data(), next.data(), velocities.data(),
+				props.texBuffers[props.solverTexBuffer].data(), props.width);
+			std::fill(velocities.begin(), velocities.end(), 0.0f);
+			props.newestFrame ^= 1;
+			props.velocityReadIndex ^= 1;
+
+			props.solverTexBuffer = props.readyTexBuffer.exchange(props.solverTexBuffer | FreshTexels,
+				std::memory_order_acq_rel) & ~FreshTexels;
+			props.stepPending.store(false, std::memory_order_release);
+		}
+
+		pendingUpdates.clear();
+	}
 };
 
 std::unique_ptr<DynamicUpdateThreadInfo> threadInfo;
 
 // type erasure at its finest
-static void dynamicWaveUpdateThread(void* ptr)
+void dynamicWaveUpdateThread(void* ptr)
 {
 	DynamicUpdateThreadInfo& threadInfo = *(DynamicUpdateThreadInfo*)ptr;
 	DynamicUpdateThreadInfo::Command dynamicUpdateCommand;
+	PROFILE_THREAD("Water");
 
 	for (;;)
 	{
+		// every body that asked for a step since the last wakeup is stepped in a single pass
 		threadInfo.dynamicUpdateQueue.wait_dequeue(dynamicUpdateCommand);
-		WaterBody::DynamicWaveProperties* dynamicWaveProperties = dynamicUpdateCommand.dynamicWaveProperties;
-
-		switch (dynamicUpdateCommand.cmd)
+		do
 		{
-		case DynamicUpdateThreadInfo::Command::Type::Update:
+			WaterBody::DynamicWaveProperties* dynamicWaveProperties = dynamicUpdateCommand.dynamicWaveProperties;
+
+			switch (dynamicUpdateCommand.cmd)
 			{
-				std::vector<float> newVelocity;
-
-				{
-					std::lock_guard<std::mutex> lock(dynamicWaveProperties->velocityMutex);
-					newVelocity.resize(dynamicWaveProperties->newVelocity.size());
-					newVelocity.swap(dynamicWaveProperties->newVelocity);
-				}
-
-				std::lock_guard<std::mutex> lock(dynamicWaveProperties->updateMutex);
-				dynamicWaveProperties->previousFrame2.swap(dynamicWaveProperties->previousFrame);
-				dynamicWaveProperties->previousFrame.swap(dynamicWaveProperties->curFrame);
-
-				for (size_t i = 0; i < dynamicWaveProperties->width; i++)
-				{
-					float fxt = dynamicWaveProperties->previousFrame[i];
-					float fxnt = i > 0 ? dynamicWaveProperties->previousFrame[i - 1] : 0;
-					float fxpt = i < dynamicWaveProperties->width - 1 ? dynamicWaveProperties->previousFrame[i + 1] : 0;
-					float fxtn = dynamicWaveProperties->previousFrame2[i];
-					float vel = newVelocity[i];
-
-					float output = 0.99f*(2 * fxt - fxtn) + WaveSpeed * WaveSpeed *(fxnt + fxpt - 2.0*fxt) - vel;
-					dynamicWaveProperties->curFrame[i] = output;
-
-					if (output > 255) output = 255;
-					else if (output < -255) output = -255;
-
-					dynamicWaveProperties->texBuffer[4 * i] = floorf(fmodf(fabsf(output) * 256, 256));
-					dynamicWaveProperties->texBuffer[4 * i + 1] = floorf(fabsf(output));
-					dynamicWaveProperties->texBuffer[4 * i + 2] = 255 * (output >= 0);
-					dynamicWaveProperties->texBuffer[4 * i + 3] = 255;
-				}
-			} break;
-		case DynamicUpdateThreadInfo::Command::Type::Delete: delete dynamicWaveProperties; break;
-		case DynamicUpdateThreadInfo::Command::Type::Final: return;
-		}
+			case DynamicUpdateThreadInfo::Command::Type::Update:
+				threadInfo.pendingUpdates.push_back(dynamicWaveProperties);
+				break;
+			case DynamicUpdateThreadInfo::Command::Type::Delete:
+				threadInfo.stepPendingBodies();
+				delete dynamicWaveProperties;
+				break;
+			case DynamicUpdateThreadInfo::Command::Type::Final: return;
+			}
+		} while (threadInfo.dynamicUpdateQueue.try_dequeue(dynamicUpdateCommand));
+
+		threadInfo.stepPendingBodies();
 	}
 }
 
@@ -257,14 +343,20 @@ void WaterBody::resetSimulationVectors()
 		threadInfo->dynamicUpdateQueue.enqueue({ DynamicUpdateThreadInfo::Command::Type::Delete, dynamicWaveProperties });
 		dynamicWaveProperties = new DynamicWaveProperties();
 
-		dynamicWaveProperties->width = drawingSize.x;
-		ASSERT(dynamicWaveProperties->texture.create(dynamicWaveProperties->width, 1));
+		auto& props = *dynamicWaveProperties;
+		props.width = drawingSize.x;
+		ASSERT(props.texture.create(props.width, 1));
 
-		dynamicWaveProperties->previousFrame2.resize(dynamicWaveProperties->width);
-		dynamicWaveProperties->previousFrame.resize(dynamicWaveProperties->width);
-		dynamicWaveProperties->curFrame.resize(dynamicWaveProperties->width);
-		dynamicWaveProperties->newVelocity.resize(dynamicWaveProperties->width);
-		dynamicWaveProperties->texBuffer.resize(4 * dynamicWaveProperties->width);
+		for (auto& frame : props.frames) frame.resize(props.width);
+		for (auto& velocities : props.velocities) velocities.resize(props.width);
+		for (auto& texBuffer : props.texBuffers) texBuffer.resize(4 * props.width);
+
+		props.newestFrame = props.velocityReadIndex = props.velocityWriteIndex = 0;
+		props.solverTexBuffer = 0;
+		props.drawTexBuffer = 1;
+		props.readyTexBuffer = 2;
+		props.stepPending = false;
+		props.texture.update(props.texBuffers[props.drawTexBuffer].data());
     }
 	else threadInfo->dynamicUpdateQueue.enqueue({ DynamicUpdateThreadInfo::Command::Type::Delete, dynamicWaveProperties });
 }
@@ -285,13 +377,22 @@ void WaterBody::update(FrameTime curTime)
 void WaterBody::updateSimulation()
 {
     if (haltSimulation) return;
+	auto& props = *dynamicWaveProperties;
+
+	if (props.readyTexBuffer.load(std::memory_order_relaxed) & FreshTexels)
+	{
+		props.drawTexBuffer = props.readyTexBuffer.exchange(props.drawTexBuffer, std::memory_order_acq_rel) & ~FreshTexels;
+		props.texture.update(props.texBuffers[props.drawTexBuffer].data());
+	}
 
+	// a body whose last step is still running skips this one, keeping its velocities for the next
+	if (!props.stepPending.load(std::memory_order_acquire))
 	{
-		std::lock_guard<std::mutex> lock(dynamicWaveProperties->updateMutex);
-		dynamicWaveProperties->texture.update(dynamicWaveProperties->texBuffer.data());
+		props.stepPending.store(true, std::memory_order_relaxed);
+		props.velocityWriteIndex ^= 1;
+		threadInfo->dynamicUpdateQueue.enqueue({ DynamicUpdateThreadInfo::Command::Type::Update, dynamicWaveProperties });
 	}
 
-	threadInfo->dynamicUpdateQueue.enqueue({ DynamicUpdateThreadInfo::Command::Type::Update, dynamicWaveProperties });
     haltSimulation = true;
 }
 
@@ -300,8 +401,7 @@ void WaterBody::setVelocity(float point, float newVel)
     if (topHidden) return;
 	if (point < 0 || point >= dynamicWaveProperties->width) return;
 
-	std::lock_guard<std::mutex> lock(dynamicWaveProperties->velocityMutex);
-	dynamicWaveProperties->newVelocity[point] = newVel;
+	dynamicWaveProperties->velocities[dynamicWaveProperties->velocityWriteIndex][point] = newVel;
 }
 
 void WaterBody::draw(sf::RenderTarget& target, sf::RenderStates states) const
@@ -26,7 +26,8 @@
 #include <SFML/Graphics.hpp>
 #include <chronoUtils.hpp>
 #include <memory>
-#include <mutex>
+#include <vector>
+#include <atomic>
 
 class WaterBody final : public sf::Drawable
 {
@@ -48,10 +49,23 @@ class WaterBody final : public sf::Drawable
 	struct DynamicWaveProperties
 	{
 		size_t width;
-		std::vector<float> previousFrame2, previousFrame, curFrame, newVelocity;
-		std::vector<sf::Uint8> texBuffer;
+
+		// Solver side: the two last frames, the new one is written over the older
+		std::vector<float> frames[2];
+		size_t newestFrame, velocityReadIndex;
+		sf::Uint8 solverTexBuffer;
+
+		// Main thread side: velocities are written to one buffer while the solver consumes the other
+		std::vector<float> velocities[2];
+		size_t velocityWriteIndex;
+		sf::Uint8 drawTexBuffer;
 		sf::Texture texture;
-		std::mutex updateMutex, velocityMutex;
+
+		// Texels are triple buffered, readyTexBuffer holds the index of the one not owned by
+		// either side, tagged when it has a step the main thread didn't upload yet
+		std::vector<sf::Uint8> texBuffers[3];
+		std::atomic<sf::Uint8> readyTexBuffer;
+		std::atomic<bool> stepPending;
 	};
 
 	sf::Vector2f drawingSize;
@@ -93,3 +107,7 @@ public:
 	friend struct DynamicUpdateThreadInfo;
 	friend void dynamicWaveUpdateThread(void* ptr);
 };
+
+// Advances a water surface by one step: next holds the frame before previous and gets overwritten
+// with the new heights, and every column is packed into the texel decoded by the drawing shader
+void stepDynamicWaves(const float* previous, float* next, const float* velocities, sf::Uint8* texels, size_t width);
@@ -34,7 +34,7 @@
 #ifdef GENERATE_MAPS_IF_EMPTY
 util::grid<bool> generateMap(const RoomData& data, ResourceManager& manager)
 {
-    auto tileSet = manager.load<TileSet>(data.tilesetName + ".ts");
+    auto tileSet = manager.load<TileSet>(std::string(data.tilesetName) + ".ts");
     util::grid<bool> map(data.mainLayer.width(), data.mainLayer.height());
     
     std::transform(data.mainLayer.begin(), data.mainLayer.end(), map.begin(),
@@ -0,0 +1,145 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "RoomPrefetcher.hpp"
+
+#include "data/LevelData.hpp"
+#include "data/RoomData.hpp"
+#include "data/TileSet.hpp"
+#include "resources/ResourceLoader.hpp"
+#include "defaults.hpp"
+
+#include <algorithm>
+#include <SFML/Graphics.hpp>
+
+static cpFloat distanceToWarp(const WarpData& warp, cpVect pos, cpFloat width, cpFloat height)
+{
+    auto clampCoord = [&](cpFloat c) { return std::min<cpFloat>(std::max<cpFloat>(c, warp.c1), warp.c2); };
+
+    switch (warp.warpDir)
+    {
+        case WarpData::Dir::Right: return cpvdist(pos, cpv(width, clampCoord(pos.y)));
+        case WarpData::Dir::Down: return cpvdist(pos, cpv(clampCoord(pos.x), height));
+        case WarpData::Dir::Left: return cpvdist(pos, cpv(0, clampCoord(pos.y)));
+        case WarpData::Dir::Up: return cpvdist(pos, cpv(clampCoord(pos.x), 0));
+    }
+
+    return INFINITY;
+}
+
+void RoomPrefetcher::setCurrentRoom(std::shared_ptr<LevelData> level, std::shared_ptr<RoomData> room)
+{
+    levelData = level;
+    roomData = room;
+
+    // the old entries are only dropped after the new requests are issued, so rooms shared
+    // by both neighbourhoods are not collected in between
+    previousEntries = std::move(entries);
+    entries.clear();
+    requestsIssued = false;
+}
+
+void RoomPrefetcher::issueRequests(cpVect playerPosition)
+{
+    cpFloat width = DefaultTileSize * roomData->mainLayer.width();
+    cpFloat height = DefaultTileSize * roomData->mainLayer.height();
+
+    std::vector<std::pair<cpFloat,size_t>> rooms;
+    for (const auto& warp : roomData->warps)
+    {
+        auto distance = distanceToWarp(warp, playerPosition, width, height);
+        auto it = std::find_if(rooms.begin(), rooms.end(), [&](const auto& p) { return p.second == warp.roomId; });
+
+        if (it == rooms.end()) rooms.emplace_back(distance, warp.roomId);
+        else it->first = std::min(it->first, distance);
+    }
+
+    // the loader serves prefetches in FIFO order, so the nearest warps are decoded first
+    std::sort(rooms.begin(), rooms.end());
+
+    for (const auto& room : rooms)
+    {
+        if (room.second >= levelData->roomResourceNames.size()) continue;
+
+        auto name = levelData->roomResourceNames[room.second] + ".map";
+        entries.push_back(Entry{ Entry::Stage::Room, resourceManager.requestLoadAsync(name), {} });
+    }
+
+    previousEntries.clear();
+    requestsIssued = true;
+}
+
+void RoomPrefetcher::advanceEntry(Entry& entry)
+{
+    try
+    {
+        switch (entry.stage)
+        {
+            case Entry::Stage::Room:
+            {
+                auto room = entry.future.get<RoomData>();
+                entry.resources.emplace_back(room);
+                entry.future = resourceManager.requestLoadAsync(std::string(room->tilesetName) + ".ts");
+                entry.stage = Entry::Stage::TileSet;
+            } break;
+            case Entry::Stage::TileSet:
+            {
+                auto tileSet = entry.future.get<TileSet>();
+                entry.resources.emplace_back(tileSet);
+                entry.future = resourceManager.requestLoadAsync(std::string(tileSet->textureName));
+                entry.stage = Entry::Stage::Texture;
+            } break;
+            case Entry::Stage::Texture:
+                entry.resources.emplace_back(entry.future.get<sf::Texture>());
+                entry.future = ResourceFuture();
+                entry.stage = Entry::Stage::Done;
+                break;
+            case Entry::Stage::Done: break;
+        }
+    }
+    catch (const ResourceLoadingError&)
+    {
+        // a broken neighbour will be reported by the synchronous load, if the player ever gets there
+        entry.future = ResourceFuture();
+        entry.stage = Entry::Stage::Done;
+    }
+}
+
+void RoomPrefetcher::update(cpVect playerPosition)
+{
+    if (!levelData || !roomData) return;
+    if (!requestsIssued) issueRequests(playerPosition);
+
+    for (auto& entry : entries)
+        while (entry.stage != Entry::Stage::Done && entry.future.isReady())
+            advanceEntry(entry);
+}
+
+void RoomPrefetcher::clear()
+{
+    levelData.reset();
+    roomData.reset();
+    entries.clear();
+    previousEntries.clear();
+    requestsIssued = true;
+}
@@ -0,0 +1,61 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <chipmunk/chipmunk.h>
+#include <generic_ptrs.hpp>
+#include <non_copyable_movable.hpp>
+
+#include "resources/ResourceManager.hpp"
+
+class LevelData;
+struct RoomData;
+
+class RoomPrefetcher final : util::non_copyable
+{
+    struct Entry
+    {
+        enum class Stage : uint8_t { Room, TileSet, Texture, Done } stage;
+        ResourceFuture future;
+        std::vector<util::generic_shared_ptr> resources;
+    };
+
+    ResourceManager& resourceManager;
+    std::shared_ptr<LevelData> levelData;
+    std::shared_ptr<RoomData> roomData;
+    std::vector<Entry> entries, previousEntries;
+    bool requestsIssued;
+
+    void issueRequests(cpVect playerPosition);
+    void advanceEntry(Entry& entry);
+
+public:
+    explicit RoomPrefetcher(ResourceManager& manager) : resourceManager(manager), requestsIssued(true) {}
+
+    void setCurrentRoom(std::shared_ptr<LevelData> level, std::shared_ptr<RoomData> room);
+    void update(cpVect playerPosition);
+    void clear();
+};
@@ -0,0 +1,172 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "SaveService.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include "streams/FileOutputStream.hpp"
+#include "streams/MemoryOutputStream.hpp"
+#include "profiler/Profiler.hpp"
+#include "execDir.hpp"
+
+#if _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+static bool replaceFile(const std::string& source, const std::string& destination)
+{
+#if _WIN32
+    return MoveFileExA(source.c_str(), destination.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+    return std::rename(source.c_str(), destination.c_str()) == 0;
+#endif
+}
+
+SaveService::SaveService() : savesInFlight(0), stopping(false), savingThread(&SaveService::saveLoop, this) {}
+
+SaveService::~SaveService()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    // the requests already made are still written, only their callbacks are dropped
+    saveRequested.notify_all();
+    savingThread.join();
+}
+
+void SaveService::saveLoop()
+{
+    PROFILE_THREAD("Save writer");
+    std::unique_lock<std::mutex> lock(mutex);
+
+    for (;;)
+    {
+        saveRequested.wait(lock, [this] { return stopping || !pendingRequests.empty(); });
+        if (pendingRequests.empty()) break;
+
+        auto request = std::move(pendingRequests.front());
+        pendingRequests.pop_front();
+
+        lock.unlock();
+        SavedGame::Key key;
+        bool success;
+        {
+            PROFILE_ZONE_DETAIL("SaveService::writeSaveFile", PROFILE_INTERN(request.fileName));
+            success = writeSaveFile(request.fileName, request.snapshot, key);
+        }
+        lock.lock();
+
+        bufferPool.push_back(std::move(request.snapshot));
+        completions.push_back({ std::move(request.callbacks), success, key });
+        savesInFlight--;
+        saveFinished.notify_all();
+    }
+}
+
+bool SaveService::writeSaveFile(const std::string& fileName, const std::vector<uint8_t>& snapshot, SavedGame::Key& key)
+{
+    std::vector<uint8_t> contents;
+    if (!encodeSaveFile(snapshot, contents, key)) return false;
+
+    // the old save stays whole until the new one is completely on disk
+    auto fullName = getExecutableDirectory() + '/' + fileName;
+    auto tempName = fullName + ".tmp";
+
+    FileOutputStream stream;
+    if (!(stream.open(tempName) && stream.write(contents.data(), contents.size()) && stream.close()))
+    {
+        std::remove(tempName.c_str());
+        return false;
+    }
+
+    return replaceFile(tempName, fullName);
+}
+
+void SaveService::requestSave(const SavedGame& savedGame, std::string fileName, Callback callback)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    std::vector<uint8_t> buffer;
+    if (!bufferPool.empty())
+    {
+        buffer = std::move(bufferPool.back());
+        bufferPool.pop_back();
+    }
+    lock.unlock();
+
+    MemoryOutputStream stream(std::move(buffer));
+    bool success = writeToStream(stream, savedGame);
+    buffer = stream.takeContents();
+
+    lock.lock();
+    if (!success)
+    {
+        bufferPool.push_back(std::move(buffer));
+        completions.push_back({ { std::move(callback) }, false, SavedGame::Key() });
+        return;
+    }
+
+    auto it = std::find_if(pendingRequests.begin(), pendingRequests.end(),
+        [&](const Request& request) { return request.fileName == fileName; });
+    if (it != pendingRequests.end())
+    {
+        std::swap(it->snapshot, buffer);
+        it->callbacks.push_back(std::move(callback));
+        bufferPool.push_back(std::move(buffer));
+        return;
+    }
+
+    pendingRequests.push_back({ std::move(fileName), std::move(buffer), {} });
+    pendingRequests.back().callbacks.push_back(std::move(callback));
+    savesInFlight++;
+    saveRequested.notify_one();
+}
+
+void SaveService::update()
+{
+    std::vector<Completion> finished;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (completions.empty()) return;
+        swap(finished, completions);
+    }
+
+    for (auto& completion : finished)
+        for (auto& callback : completion.callbacks)
+            if (callback) callback(completion.success, completion.key);
+}
+
+bool SaveService::isSaving()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return savesInFlight > 0;
+}
+
+void SaveService::waitForPendingSaves()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    saveFinished.wait(lock, [this] { return savesInFlight == 0; });
+}
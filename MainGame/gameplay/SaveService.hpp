@@ -0,0 +1,85 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <non_copyable_movable.hpp>
+
+#include "SavedGame.hpp"
+
+// Writes save files on a background thread: requestSave only snapshots the game into a pooled
+// buffer, a worker scrambles, encrypts and writes it through a temporary file renamed over the
+// old one, and update() runs the callbacks of the finished saves on the caller's thread.
+// A request for a file whose previous save has not started yet replaces it, and every
+// callback of the merged requests gets the result of the single save that happens.
+class SaveService final : util::non_copyable_movable
+{
+public:
+    using Callback = std::function<void(bool success, SavedGame::Key key)>;
+
+private:
+    struct Request
+    {
+        std::string fileName;
+        std::vector<uint8_t> snapshot;
+        std::vector<Callback> callbacks;
+    };
+
+    struct Completion
+    {
+        std::vector<Callback> callbacks;
+        bool success;
+        SavedGame::Key key;
+    };
+
+    std::mutex mutex;
+    std::condition_variable saveRequested, saveFinished;
+    std::deque<Request> pendingRequests;
+    std::vector<Completion> completions;
+    std::vector<std::vector<uint8_t>> bufferPool;
+    size_t savesInFlight;
+    bool stopping;
+    std::thread savingThread;
+
+    void saveLoop();
+    static bool writeSaveFile(const std::string& fileName, const std::vector<uint8_t>& snapshot, SavedGame::Key& key);
+
+public:
+    SaveService();
+    ~SaveService();
+
+    // fileName is relative to the executable directory, like the names kept in the settings
+    void requestSave(const SavedGame& savedGame, std::string fileName, Callback callback);
+    void update();
+
+    bool isSaving();
+    void waitForPendingSaves();
+};
@@ -36,10 +36,25 @@
 #include <numeric>
 #include <chronoUtils.hpp>
 #include <thread>
-#include "streams/MemoryOutputStream.hpp"
 #include "aes/tiny-AES-c-master/aes.hpp"
+
+// AES-NI is picked at runtime, so the intrinsics are compiled for it function by function
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define SAVEDGAME_USE_AESNI 1
+#include <wmmintrin.h>
+#if _MSC_VER
+#include <intrin.h>
+#define AESNI_TARGET
+#else
+#define AESNI_TARGET __attribute__((target("aes,sse2")))
+#endif
+#else
+#define SAVEDGAME_USE_AESNI 0
+#endif
 #endif
 
+#include "streams/MemoryOutputStream.hpp"
+
 SavedGame::SavedGame() : levelInfo(0), goldenTokens{}, pickets{}, otherSecrets{}
 {
     
@@ -187,12 +202,14 @@ uint64_t getCryptoRandomKey()
 constexpr size_t ScramblerSize = 7;
 constexpr size_t EncryptRuns = 3;
 
-std::vector<size_t> bitScramblerVector(uint64_t key, size_t size)
+// The shuffle only depends on the element count, so 32-bit indices give the same
+// permutation as before with half the memory to shuffle
+std::vector<uint32_t> bitScramblerVector(uint64_t key, size_t size)
 {
-    std::vector<size_t> vec(8 * ScramblerSize * size);
+    std::vector<uint32_t> vec(8 * ScramblerSize * size);
     std::iota(vec.begin(), vec.end(), 0);
     std::shuffle(vec.begin(), vec.end(), std::mt19937_64(key));
-    for (size_t& n : vec) n /= ScramblerSize;
+    for (auto& n : vec) n /= ScramblerSize;
     
     return vec;
 }
@@ -207,6 +224,103 @@ void generateAESKey(uint64_t key, uint8_t* genKey)
         std::memcpy(genKey+i*sizeof(uint64_t), (const uint8_t*)&val, sizeof(uint64_t));
     }
 }
+
+#if SAVEDGAME_USE_AESNI
+static bool hasAESNI()
+{
+#if _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    return info[2] & (1 << 25);
+#else
+    return __builtin_cpu_supports("aes");
+#endif
+}
+
+#define AESNI_EXPAND_KEY(i, rcon) keys[i] = expandKeyStep(keys[i-1], _mm_aeskeygenassist_si128(keys[i-1], rcon))
+
+AESNI_TARGET static __m128i expandKeyStep(__m128i key, __m128i generated)
+{
+    generated = _mm_shuffle_epi32(generated, 0xff);
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    return _mm_xor_si128(key, generated);
+}
+
+AESNI_TARGET static void expandKeyAESNI(const uint8_t* key, __m128i keys[11])
+{
+    keys[0] = _mm_loadu_si128((const __m128i*)key);
+    AESNI_EXPAND_KEY(1, 0x01); AESNI_EXPAND_KEY(2, 0x02); AESNI_EXPAND_KEY(3, 0x04);
+    AESNI_EXPAND_KEY(4, 0x08); AESNI_EXPAND_KEY(5, 0x10); AESNI_EXPAND_KEY(6, 0x20);
+    AESNI_EXPAND_KEY(7, 0x40); AESNI_EXPAND_KEY(8, 0x80); AESNI_EXPAND_KEY(9, 0x1b);
+    AESNI_EXPAND_KEY(10, 0x36);
+}
+#undef AESNI_EXPAND_KEY
+
+AESNI_TARGET static void encryptCBCAESNI(const uint8_t* key, const uint8_t* iv, uint8_t* data, size_t size)
+{
+    __m128i keys[11];
+    expandKeyAESNI(key, keys);
+
+    __m128i block = _mm_loadu_si128((const __m128i*)iv);
+    for (size_t i = 0; i < size; i += 16)
+    {
+        block = _mm_xor_si128(block, _mm_loadu_si128((const __m128i*)(data + i)));
+        block = _mm_xor_si128(block, keys[0]);
+        for (size_t k = 1; k < 10; k++) block = _mm_aesenc_si128(block, keys[k]);
+        block = _mm_aesenclast_si128(block, keys[10]);
+        _mm_storeu_si128((__m128i*)(data + i), block);
+    }
+}
+
+AESNI_TARGET static void decryptCBCAESNI(const uint8_t* key, const uint8_t* iv, uint8_t* data, size_t size)
+{
+    __m128i keys[11], decryptKeys[11];
+    expandKeyAESNI(key, keys);
+
+    decryptKeys[0] = keys[10];
+    for (size_t k = 1; k < 10; k++) decryptKeys[k] = _mm_aesimc_si128(keys[10-k]);
+    decryptKeys[10] = keys[0];
+
+    // unlike encryption, every block can be deciphered independently
+    __m128i previous = _mm_loadu_si128((const __m128i*)iv);
+    for (size_t i = 0; i < size; i += 16)
+    {
+        __m128i cipher = _mm_loadu_si128((const __m128i*)(data + i));
+        __m128i block = _mm_xor_si128(cipher, decryptKeys[0]);
+        for (size_t k = 1; k < 10; k++) block = _mm_aesdec_si128(block, decryptKeys[k]);
+        block = _mm_aesdeclast_si128(block, decryptKeys[10]);
+        _mm_storeu_si128((__m128i*)(data + i), _mm_xor_si128(block, previous));
+        previous = cipher;
+    }
+}
+#endif
+
+// The key schedule takes the first half of the generated key and the IV the second one
+static void encryptCBC(const uint8_t* aesKey, uint8_t* data, size_t size)
+{
+#if SAVEDGAME_USE_AESNI
+    static const bool useAESNI = hasAESNI();
+    if (useAESNI) return encryptCBCAESNI(aesKey, aesKey+16, data, size);
+#endif
+
+    AES_ctx ctx;
+    AES_init_ctx_iv(&ctx, aesKey, aesKey+16);
+    AES_CBC_encrypt_buffer(&ctx, data, size);
+}
+
+static void decryptCBC(const uint8_t* aesKey, uint8_t* data, size_t size)
+{
+#if SAVEDGAME_USE_AESNI
+    static const bool useAESNI = hasAESNI();
+    if (useAESNI) return decryptCBCAESNI(aesKey, aesKey+16, data, size);
+#endif
+
+    AES_ctx ctx;
+    AES_init_ctx_iv(&ctx, aesKey, aesKey+16);
+    AES_CBC_decrypt_buffer(&ctx, data, size);
+}
 #endif
 
 bool readEncryptedSaveFile(sf::InputStream& stream, SavedGame& savedGame, SavedGame::Key key)
@@ -217,16 +331,13 @@ bool readEncryptedSaveFile(sf::InputStream& stream, SavedGame& savedGame, SavedG
     
     std::vector<uint8_t> scrambledMem;
     if (!readFromStream(stream, scrambledMem)) return false;
+    if (scrambledMem.empty() || scrambledMem.size() % 16 != 0) return false;
     
     uint8_t aesKey[32];
     generateAESKey(key.aesGeneratorKey, aesKey);
 
     for (size_t i = 0; i < EncryptRuns; i++)
-    {
-        AES_ctx ctx;
-        AES_init_ctx_iv(&ctx, aesKey, aesKey+16);
-        AES_CBC_decrypt_buffer(&ctx, scrambledMem.data(), scrambledMem.size());
-    }
+        decryptCBC(aesKey, scrambledMem.data(), scrambledMem.size());
     
     uint8_t padSize = scrambledMem.back();
     scrambledMem.resize(scrambledMem.size() - padSize);
@@ -260,19 +371,15 @@ bool readEncryptedSaveFile(sf::InputStream& stream, SavedGame& savedGame, SavedG
     return readFromStream(mstream, savedGame);
 }
 
-bool writeEncryptedSaveFile(OutputStream& stream, const SavedGame& savedGame, SavedGame::Key& key)
+bool encodeSaveFile(const std::vector<uint8_t>& mem, std::vector<uint8_t>& file, SavedGame::Key& key)
 {
     key = SavedGame::Key();
     
 #if CRYPT_OFF
-    return writeToStream(stream, savedGame);
+    file = mem;
+    return true;
 #endif
     
-    MemoryOutputStream mstream;
-    if (!writeToStream(mstream, savedGame)) return false;
-    
-    const auto& mem = mstream.getContents();
-    
     key.bitScramblingKey = getCryptoRandomKey();
     key.aesGeneratorKey = getCryptoRandomKey();
     
@@ -295,11 +402,19 @@ bool writeEncryptedSaveFile(OutputStream& stream, const SavedGame& savedGame, Sa
     generateAESKey(key.aesGeneratorKey, aesKey);
     
     for (size_t i = 0; i < EncryptRuns; i++)
-    {
-        AES_ctx ctx;
-        AES_init_ctx_iv(&ctx, aesKey, aesKey+16);
-        AES_CBC_encrypt_buffer(&ctx, scrambledMem.data(), scrambledMem.size());
-    }
+        encryptCBC(aesKey, scrambledMem.data(), scrambledMem.size());
+    
+    MemoryOutputStream fileStream;
+    if (!writeToStream(fileStream, scrambledMem)) return false;
+    file = std::move(fileStream.getContents());
+    return true;
+}
+
+bool writeEncryptedSaveFile(OutputStream& stream, const SavedGame& savedGame, SavedGame::Key& key)
+{
+    MemoryOutputStream mstream;
+    if (!writeToStream(mstream, savedGame)) return false;
     
-    return writeToStream(stream, scrambledMem);
+    std::vector<uint8_t> file;
+    return encodeSaveFile(mstream.getContents(), file, key) && stream.write(file.data(), file.size());
 }
@@ -116,5 +116,12 @@ struct SavedGame
     }
 };
 
+bool readFromStream(sf::InputStream& stream, SavedGame& savedGame);
+bool writeToStream(OutputStream& stream, const SavedGame& savedGame);
+
 bool readEncryptedSaveFile(sf::InputStream& stream, SavedGame& savedGame, SavedGame::Key key);
 bool writeEncryptedSaveFile(OutputStream& stream, const SavedGame& savedGame, SavedGame::Key& key);
+
+// Scrambles and encrypts a SavedGame already written to memory into the contents of a save
+// file, generating a new key; takes long enough that SaveService runs it off the main thread
+bool encodeSaveFile(const std::vector<uint8_t>& mem, std::vector<uint8_t>& file, SavedGame::Key& key);
@@ -23,8 +23,8 @@
 
 #include "ScriptedActions.hpp"
 
-bool ScriptedButtonAction::isTriggered() const { return false; }
-bool ScriptedButtonAction::isPressed() const { return false; }
-bool ScriptedButtonAction::isReleased() const { return false; }
+bool ScriptedButtonAction::isTriggered() const { return pressed && !wasPressed; }
+bool ScriptedButtonAction::isPressed() const { return pressed; }
+bool ScriptedButtonAction::isReleased() const { return !pressed && wasPressed; }
 
-sf::Vector2f ScriptedDualAxisAction::getValue() const { return sf::Vector2f(0, 0); }
+sf::Vector2f ScriptedDualAxisAction::getValue() const { return value; }
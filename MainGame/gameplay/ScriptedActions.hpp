@@ -25,9 +25,16 @@
 
 #include "VirtualActions.hpp"
 
+// Actions driven by code instead of input; they stay idle unless someone updates them every frame
 class ScriptedButtonAction : public VirtualButtonAction
 {
+    bool pressed, wasPressed;
+
 public:
+    ScriptedButtonAction() : pressed(false), wasPressed(false) {}
+
+    void update(bool newPressed) { wasPressed = pressed; pressed = newPressed; }
+
     virtual bool isTriggered() const override;
     virtual bool isPressed() const override;
     virtual bool isReleased() const override;
@@ -35,6 +42,10 @@ public:
 
 class ScriptedDualAxisAction : public VirtualDualAxisAction
 {
+    sf::Vector2f value;
+
 public:
+    void update(sf::Vector2f newValue) { value = newValue; }
+
     virtual sf::Vector2f getValue() const override;
 };
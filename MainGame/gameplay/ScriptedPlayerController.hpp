@@ -28,13 +28,23 @@
 
 class ScriptedPlayerController : public PlayerController
 {
-    ScriptedButtonAction dummy;
-    ScriptedDualAxisAction dummyMovement;
+    ScriptedButtonAction jumpAction, dashAction, bombAction, pauseAction;
+    ScriptedDualAxisAction movementAction;
     
 public:
-    virtual const VirtualButtonAction& jump() const { return dummy; };
-    virtual const VirtualButtonAction& dash() const { return dummy; };
-    virtual const VirtualButtonAction& bomb() const { return dummy; };
-    virtual const VirtualButtonAction& pause() const { return dummy; };
-    virtual const VirtualDualAxisAction& movement() const { return dummyMovement; };
+    virtual const VirtualButtonAction& jump() const { return jumpAction; };
+    virtual const VirtualButtonAction& dash() const { return dashAction; };
+    virtual const VirtualButtonAction& bomb() const { return bombAction; };
+    virtual const VirtualButtonAction& pause() const { return pauseAction; };
+    virtual const VirtualDualAxisAction& movement() const { return movementAction; };
+
+    // Feeds the state of every action for the next frame
+    void update(sf::Vector2f movement, bool jump, bool dash, bool bomb, bool pause = false)
+    {
+        movementAction.update(movement);
+        jumpAction.update(jump);
+        dashAction.update(dash);
+        bombAction.update(bomb);
+        pauseAction.update(pause);
+    }
 };
@@ -0,0 +1,160 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+// Piles up a few hundred circles of two collision types in a box, so that every step runs
+// thousands of pre-solve callbacks, and times it with the handler registered through
+// cp::Space against the dispatch it replaced, which went through std::function and looked the
+// shape up in a hash map for a shared_ptr on every contact
+//
+// usage: ContactBenchmark [bodies] [steps]
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <unordered_map>
+
+#include <cppmunk/Space.h>
+#include <cppmunk/Body.h>
+#include <cppmunk/Shape.h>
+#include <cppmunk/CircleShape.h>
+#include <cppmunk/SegmentShape.h>
+
+constexpr cpCollisionType TypeA = 1, TypeB = 2;
+
+struct ContactCounter
+{
+    size_t contacts = 0;
+    cpFloat depth = 0;
+
+    bool onContact(cp::Shape& shape, cp::Arbiter arbiter)
+    {
+        contacts++;
+        depth += arbiter.getDepth(0) + shape.getElasticity();
+        return true;
+    }
+};
+
+// The old handler: the callbacks behind std::function, the wrapper looked up by hashing
+struct LegacyHandler
+{
+    std::function<int(cp::Arbiter, cp::Space&)> preSolve;
+    std::unordered_map<cpShape*, std::shared_ptr<cp::Shape>> shapes;
+    cp::Space* space;
+};
+
+static void fillSpace(cp::Space& space, size_t bodies, ContactCounter& counter, std::vector<std::shared_ptr<cp::Shape>>& shapes)
+{
+    space.setGravity(cpVect{0, 1024});
+    space.setIterations(10);
+
+    auto box = space.getStaticBody();
+    for (auto ends : { std::make_pair(cpVect{0, 0}, cpVect{0, 640}), std::make_pair(cpVect{0, 640}, cpVect{640, 640}),
+                       std::make_pair(cpVect{640, 640}, cpVect{640, 0}) })
+    {
+        auto wall = std::make_shared<cp::SegmentShape>(box, ends.first, ends.second, 4);
+        space.add(wall);
+        shapes.push_back(wall);
+    }
+
+    for (size_t i = 0; i < bodies; i++)
+    {
+        auto body = std::make_shared<cp::Body>(1, cpMomentForCircle(1, 0, 8, cpvzero));
+        body->setPosition(cpVect{16 + (i % 30) * 20.0 + (i / 30 % 2) * 10, 620 - (i / 30) * 18.0});
+        body->setUserData(&counter);
+        space.add(body);
+
+        auto shape = std::make_shared<cp::CircleShape>(body, 8, cpvzero);
+        shape->setFriction(0.7);
+        shape->setCollisionType(i % 2 ? TypeA : TypeB);
+        space.add(shape);
+        shapes.push_back(shape);
+    }
+}
+
+static double microsecondsPerStep(cp::Space& space, size_t steps)
+{
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < steps; i++) space.step(1.0 / 60);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - begin).count() / steps;
+}
+
+int main(int argc, char **argv)
+{
+    size_t bodies = argc > 1 ? std::stoul(argv[1]) : 600;
+    size_t steps = argc > 2 ? std::stoul(argv[2]) : 600;
+
+    ContactCounter legacyCounter, templateCounter;
+    double legacyTime, templateTime;
+
+    {
+        cp::Space space;
+        std::vector<std::shared_ptr<cp::Shape>> shapes;
+        fillSpace(space, bodies, legacyCounter, shapes);
+
+        LegacyHandler legacy;
+        legacy.space = &space;
+        for (const auto& shape : shapes) legacy.shapes.emplace(*shape, shape);
+        legacy.preSolve = [&](cp::Arbiter arbiter, cp::Space& space)
+        {
+            auto counter = static_cast<ContactCounter*>(cp::Body::of(arbiter.getBodyA())->getUserData());
+            std::shared_ptr<cp::Shape> shape = legacy.shapes.find(arbiter.getShapeB())->second;
+            return counter->onContact(*shape, arbiter);
+        };
+
+        auto handler = cpSpaceAddCollisionHandler(space, TypeA, TypeB);
+        handler->preSolveFunc = [](cpArbiter* arb, cpSpace*, void* data) -> cpBool
+        {
+            auto& legacy = *static_cast<LegacyHandler*>(data);
+            return legacy.preSolve(arb, *legacy.space);
+        };
+        handler->userData = &legacy;
+
+        legacyTime = microsecondsPerStep(space, steps);
+    }
+
+    {
+        cp::Space space;
+        std::vector<std::shared_ptr<cp::Shape>> shapes;
+        fillSpace(space, bodies, templateCounter, shapes);
+
+        space.addCollisionHandler(TypeA, TypeB,
+            [](cp::Arbiter, cp::Space&) { return true; },
+            [](cp::Arbiter arbiter, cp::Space&)
+            {
+                auto counter = static_cast<ContactCounter*>(cp::Body::of(arbiter.getBodyA())->getUserData());
+                return counter->onContact(*cp::Shape::of(arbiter.getShapeB()), arbiter);
+            }, [](cp::Arbiter, cp::Space&) {}, [](cp::Arbiter, cp::Space&) {});
+
+        templateTime = microsecondsPerStep(space, steps);
+    }
+
+    std::cout << bodies << " bodies, " << legacyCounter.contacts / steps << " pre-solve callbacks per step, us per step: "
+        << legacyTime << " -> " << templateTime << " (" << legacyTime / templateTime << "x)" << std::endl;
+    if (legacyCounter.contacts != templateCounter.contacts || legacyCounter.depth != templateCounter.depth)
+        std::cout << "MISMATCH: " << legacyCounter.contacts << " against " << templateCounter.contacts << " contacts" << std::endl;
+
+    return 0;
+}
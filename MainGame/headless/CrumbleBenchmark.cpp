@@ -0,0 +1,176 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+// Builds a tile room into a space and crumbles a whole row of it at once, comparing the old
+// path, which added the shapes one at a time and reindexed the room body after every removed
+// tile, with the batched add and remove; each is timed with the static shapes in a bounding
+// box tree and in a spatial hash, along with steps of a few bodies resting on the room
+//
+// usage: CrumbleBenchmark [iterations] [columns] [rows]
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+
+#include <cppmunk/Space.h>
+#include <cppmunk/Body.h>
+#include <cppmunk/SegmentShape.h>
+#include <cppmunk/PolyShape.h>
+
+#include "defaults.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static double microsecondsSince(Clock::time_point begin)
+{
+    return std::chrono::duration<double, std::micro>(Clock::now() - begin).count();
+}
+
+struct TileRoom
+{
+    std::vector<std::shared_ptr<cp::Shape>> shapes, crumblingRow;
+};
+
+// Walls and floor, platforms merged into segments like RoomShapeGenerator does, and a row of
+// single crumbling tiles across the middle of the room
+static TileRoom buildRoom(std::shared_ptr<cp::Body> body, size_t columns, size_t rows)
+{
+    TileRoom room;
+    const cpFloat tile = DefaultTileSize, width = columns * tile, height = rows * tile;
+    auto segment = [&](cpVect a, cpVect b) { room.shapes.push_back(std::make_shared<cp::SegmentShape>(body, a, b, 0)); };
+
+    segment(cpVect{0, 0}, cpVect{0, height});
+    segment(cpVect{width, 0}, cpVect{width, height});
+    segment(cpVect{0, height}, cpVect{width, height});
+
+    std::mt19937 generator(7);
+    for (size_t y = 3; y < rows - 1; y += 3)
+    {
+        if (y == rows / 2) continue;
+        for (size_t x = 0; x < columns;)
+        {
+            size_t length = 1 + generator() % 8;
+            if (generator() % 2) segment(cpVect{x * tile, y * tile}, cpVect{std::min(x + length, columns) * tile, y * tile});
+            x += length + 1 + generator() % 4;
+        }
+    }
+
+    for (size_t x = 0; x < columns; x++)
+    {
+        cpFloat l = x * tile, t = rows / 2 * tile;
+        auto shape = std::make_shared<cp::PolyShape>(body, std::vector<cpVect>
+            { cpVect{l, t}, cpVect{l + tile, t}, cpVect{l + tile, t + tile}, cpVect{l, t + tile} });
+        room.shapes.push_back(shape);
+        room.crumblingRow.push_back(shape);
+    }
+
+    return room;
+}
+
+struct Timings { double load = 0, crumble = 0, step = 0; };
+
+static Timings run(size_t iterations, size_t columns, size_t rows, cp::Space::StaticIndex index, bool batched)
+{
+    Timings timings;
+
+    for (size_t i = 0; i < iterations; i++)
+    {
+        cp::Space space;
+        space.setGravity(cpVect{0.0f, 1024.0f});
+        if (index == cp::Space::StaticIndex::SpatialHash)
+            space.useStaticIndex(index, 2 * DefaultTileSize, 1024);
+
+        auto roomBody = std::make_shared<cp::Body>(cp::Body::Static);
+        space.add(roomBody);
+        auto room = buildRoom(roomBody, columns, rows);
+
+        auto begin = Clock::now();
+        if (batched) space.add(room.shapes);
+        else for (auto& shape : room.shapes) space.add(shape);
+        timings.load += microsecondsSince(begin);
+
+        // boxes falling onto the crumbling row, which is what wakes them up when it goes away
+        std::vector<std::shared_ptr<cp::Body>> bodies;
+        std::vector<std::shared_ptr<cp::Shape>> bodyShapes;
+        for (size_t x = 1; x < columns; x += 4)
+        {
+            auto body = std::make_shared<cp::Body>(1, cpMomentForBox(1, 24, 24));
+            body->setPosition(cpVect{x * (cpFloat)DefaultTileSize, (rows / 2 - 1) * (cpFloat)DefaultTileSize});
+            space.add(body);
+            auto shape = std::make_shared<cp::PolyShape>(body, std::vector<cpVect>
+                { cpVect{-12, -12}, cpVect{12, -12}, cpVect{12, 12}, cpVect{-12, 12} });
+            space.add(shape);
+            bodies.push_back(body);
+            bodyShapes.push_back(shape);
+        }
+
+        begin = Clock::now();
+        for (size_t k = 0; k < 30; k++) space.step(1.0 / 60);
+        timings.step += microsecondsSince(begin) / 30;
+
+        begin = Clock::now();
+        if (batched) space.remove(room.crumblingRow);
+        else for (auto& shape : room.crumblingRow)
+        {
+            space.remove(shape);
+            space.reindexShapesForBody(roomBody);
+        }
+        timings.crumble += microsecondsSince(begin);
+
+        for (auto& shape : bodyShapes) space.remove(shape);
+        for (auto& body : bodies) space.remove(body);
+        space.remove(std::vector<std::shared_ptr<cp::Shape>>(room.shapes.begin(), room.shapes.end() - columns));
+        space.remove(roomBody);
+    }
+
+    timings.load /= iterations;
+    timings.crumble /= iterations;
+    timings.step /= iterations;
+    return timings;
+}
+
+int main(int argc, char **argv)
+{
+    size_t iterations = argc > 1 ? std::stoul(argv[1]) : 100;
+    size_t columns = argc > 2 ? std::stoul(argv[2]) : 80;
+    size_t rows = argc > 3 ? std::stoul(argv[3]) : 48;
+
+    std::cout << columns << "x" << rows << " tile room, a row of " << columns << " crumbling tiles, us per room:" << std::endl;
+
+    for (auto index : { cp::Space::StaticIndex::BoundingBoxTree, cp::Space::StaticIndex::SpatialHash })
+    {
+        auto legacy = run(iterations, columns, rows, index, false);
+        auto batched = run(iterations, columns, rows, index, true);
+
+        std::cout << std::setw(18) << (index == cp::Space::StaticIndex::SpatialHash ? "spatial hash: " : "bounding box tree: ")
+            << "load " << legacy.load << " -> " << batched.load
+            << ", crumble " << legacy.crumble << " -> " << batched.crumble
+            << " (" << legacy.crumble / batched.crumble << "x)"
+            << ", step " << legacy.step << " -> " << batched.step << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,235 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+// Runs the game simulation without a window, a sound card or real input, as fast as possible,
+// and reports how much it costs; the player is driven by a looping input script
+//
+// usage: HeadlessRunner <level.lvl> [room] [frames] [input script]
+//
+// Each line of an input script is "<frames> <move x> <move y> [jump] [dash] [bomb]";
+// rendering never happens, but loading textures still needs an OpenGL context, so on
+// Linux machines without a display run it under a virtual X server (e.g. xvfb-run).
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <clocale>
+#include <chronoUtils.hpp>
+
+#include "input/InputManager.hpp"
+#include "resources/ResourceManager.hpp"
+#include "resources/FilesystemResourceLocator.hpp"
+#include "resources/PackResourceLocator.hpp"
+#include "scene/SceneManager.hpp"
+#include "scene/GameScene.hpp"
+#include "gameplay/ScriptedPlayerController.hpp"
+#include "settings/Settings.hpp"
+#include "language/LocalizationManager.hpp"
+#include "audio/AudioManager.hpp"
+#include "gameplay/SaveService.hpp"
+#include "Services.hpp"
+#include "profiler/Profiler.hpp"
+
+static std::atomic<size_t> allocationCount(0), allocationBytes(0);
+
+void* operator new(size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocationBytes.fetch_add(size, std::memory_order_relaxed);
+
+    if (void* ptr = std::malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+struct InputStep
+{
+    size_t frames;
+    sf::Vector2f movement;
+    bool jump, dash, bomb;
+};
+
+// run right, hop, dash and drop a bomb now and then
+static const std::vector<InputStep> DefaultInputScript =
+{
+    { 60, {  1, 0 }, false, false, false },
+    { 20, {  1, 0 }, true,  false, false },
+    { 10, {  1, 0 }, false, true,  false },
+    { 30, { -1, 0 }, false, false, false },
+    { 15, { -1, 0 }, true,  false, false },
+    {  5, {  0, 1 }, false, false, true  },
+    { 20, {  0, 0 }, false, false, false },
+};
+
+static bool loadInputScript(const std::string& fileName, std::vector<InputStep>& script)
+{
+    std::ifstream file(fileName);
+    if (!file) return false;
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream stream(line);
+        InputStep step{};
+        int jump = 0, dash = 0, bomb = 0;
+        if (!(stream >> step.frames >> step.movement.x >> step.movement.y)) return false;
+        stream >> jump >> dash >> bomb;
+
+        step.jump = jump;
+        step.dash = dash;
+        step.bomb = bomb;
+        script.push_back(step);
+    }
+
+    return !script.empty();
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cout << "Usage: " << argv[0] << " <level.lvl> [room] [frames] [input script]" << std::endl;
+        return 1;
+    }
+
+    std::setlocale(LC_ALL, "");
+
+    std::string levelName = argv[1];
+    size_t roomId = argc > 2 ? std::stoul(argv[2]) : (size_t)-1;
+    size_t numFrames = argc > 3 ? std::stoul(argv[3]) : 3600;
+
+    std::vector<InputStep> inputScript;
+    if (argc > 4)
+    {
+        if (!loadInputScript(argv[4], inputScript))
+        {
+            std::cout << "Could not read the input script " << argv[4] << std::endl;
+            return 1;
+        }
+    }
+    else inputScript = DefaultInputScript;
+
+    bool success;
+    auto settings = loadSettingsFile(&success);
+    if (!success) settings.languageFile = languageDescriptorForLocale("");
+
+    InputManager inputManager;
+
+    ResourceManager resourceManager;
+    try
+    {
+        resourceManager.setResourceLocator(new PackResourceLocator());
+    }
+    catch (const PackFileError&)
+    {
+        resourceManager.setResourceLocator(new FilesystemResourceLocator());
+    }
+
+    LocalizationManager localizationManager(true);
+    localizationManager.loadLanguageDescriptor(settings.languageFile);
+
+    AudioManager audioManager(AudioBackend::Null);
+
+    SaveService saveService;
+
+    Services services { audioManager, inputManager, localizationManager, resourceManager, saveService, settings };
+
+    SceneManager sceneManager;
+    PROFILE_THREAD("Main");
+    auto scene = new GameScene(services, SavedGame());
+    sceneManager.pushScene(scene);
+    scene->loadLevel(levelName);
+    if (roomId != (size_t)-1) scene->requestRoomLoad(roomId);
+
+    ScriptedPlayerController controller;
+    scene->setPlayerController(controller);
+
+    std::vector<double> frameTimes;
+    frameTimes.reserve(numFrames);
+
+    size_t stepIndex = 0, stepFrame = 0;
+    auto gameTime = FrameTime() + UpdatePeriod;
+
+    auto initialAllocations = allocationCount.load();
+    auto initialBytes = allocationBytes.load();
+    auto beginTime = std::chrono::steady_clock::now();
+
+    for (size_t frame = 0; frame < numFrames; frame++)
+    {
+        const auto& step = inputScript[stepIndex];
+        controller.update(step.movement, step.jump, step.dash, step.bomb);
+        if (++stepFrame >= step.frames)
+        {
+            stepFrame = 0;
+            stepIndex = (stepIndex + 1) % inputScript.size();
+        }
+
+        PROFILE_FRAME();
+        auto frameBegin = std::chrono::steady_clock::now();
+        sceneManager.update(gameTime);
+        audioManager.update();
+        auto frameEnd = std::chrono::steady_clock::now();
+
+        frameTimes.push_back(std::chrono::duration<double, std::micro>(frameEnd - frameBegin).count());
+        gameTime += UpdatePeriod;
+
+        if (!sceneManager.hasScenes()) break;
+    }
+
+    auto totalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - beginTime).count();
+    auto allocations = allocationCount.load() - initialAllocations;
+    auto bytes = allocationBytes.load() - initialBytes;
+
+    if (frameTimes.empty())
+    {
+        std::cout << "No frames were simulated" << std::endl;
+        return 1;
+    }
+
+    std::sort(frameTimes.begin(), frameTimes.end());
+    auto percentile = [&](double p) { return frameTimes[std::min<size_t>(frameTimes.size()-1, p * frameTimes.size())]; };
+
+    std::cout << "Simulated " << frameTimes.size() << " frames of " << levelName << " in " << totalSeconds << " s" << std::endl;
+    std::cout << "Updates per second: " << frameTimes.size() / totalSeconds << std::endl;
+    std::cout << "Frame time (us): p50 " << percentile(0.5) << ", p90 " << percentile(0.9) << ", p99 "
+        << percentile(0.99) << ", max " << frameTimes.back() << std::endl;
+    std::cout << "Allocations: " << allocations << " (" << (double)allocations / frameTimes.size() << " per frame), "
+        << bytes << " bytes" << std::endl;
+
+#if PROFILER_ENABLED
+    if (profiler::writeChromeTrace("headless-profile.json"))
+        std::cout << "Profile written to headless-profile.json" << std::endl;
+#endif
+
+    return 0;
+}
@@ -0,0 +1,256 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+// Mixes a set of voices through AudioManager's block mixer and through the per-sample mixer
+// it replaced, compares their output and reports how many voices are mixed per millisecond
+//
+// usage: MixerBenchmark [voices] [callbacks] [frames per callback] [rounds]
+//
+// The block mixer sums the voices in float and converts once, while the old one converted
+// every voice's contribution to int32 on its own, so the two can't match bit for bit: with
+// steady voices the accepted deviation is 1e-6 of full scale. The old mixer also ramped fades
+// by adding the step to the volume on every sample, which drifts by about 1e-5 over a fade of
+// a second, so with fading voices the accepted deviation is 5e-5 of full scale, still below a
+// 16-bit step. The benchmark fails if any sample is further apart than that. The voices are
+// quiet enough that the old mixer never wraps around, and long enough not to end or loop,
+// since the old mixer handled both only at the end of each callback.
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <random>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "audio/AudioManager.hpp"
+#include "HeadlessCommon.hpp"
+
+// Keep in sync with AudioManager.cpp
+constexpr double CanonicalSampleRate = 44100;
+constexpr uint32_t Scale = (int32_t)1 << 30;
+
+constexpr double SteadyTolerance = 1e-6, FadeTolerance = 5e-5;
+
+struct VoiceSetup
+{
+    std::shared_ptr<Sound> sound;
+    float volume, logPitch, balance;
+    bool fades;
+    float fadeVolume;
+    FrameDuration fadeDuration;
+};
+
+static std::vector<VoiceSetup> generateVoices(size_t count, double seconds, bool fades)
+{
+    static const size_t SampleRates[] = { 22050, 44100, 48000 };
+
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> unit;
+
+    std::vector<VoiceSetup> voices(count);
+    for (size_t v = 0; v < count; v++)
+    {
+        auto sound = std::make_shared<Sound>();
+        sound->stereo = v % 2 == 1;
+        sound->sampleRate = SampleRates[v % 3];
+        sound->loopPoint = std::numeric_limits<size_t>::max();
+
+        // long enough for the fastest pitch to still be playing at the end
+        size_t frames = size_t(seconds * sound->sampleRate * 2) + 1;
+        float frequency = 110 + unit(generator) * 880;
+        sound->data.resize(sound->stereo ? 2*frames : frames);
+        for (size_t i = 0; i < sound->data.size(); i++)
+            sound->data[i] = 0.8f * sinf(2 * M_PI * frequency * i / sound->sampleRate) + 0.2f * (2 * unit(generator) - 1);
+
+        auto& voice = voices[v];
+        voice.sound = sound;
+        voice.volume = 0.01f + unit(generator) * 0.02f;
+        voice.logPitch = unit(generator) - 0.5f;
+        voice.balance = 2 * unit(generator) - 1;
+        voice.fades = fades && v % 4 == 0;
+        voice.fadeVolume = unit(generator) * 0.01f;
+        voice.fadeDuration = FrameDuration(std::max(1L, std::lround(seconds * 60 * (0.25 + unit(generator) * 0.5))));
+    }
+
+    return voices;
+}
+
+// The instance state and callback loop as they were before the block mixer
+struct LegacyVoice
+{
+    const Sound* sound;
+    size_t curSample, curSampleFractional, sampleIncr, fadeCount;
+    float volume, fadeOfs, balance;
+};
+
+static std::vector<LegacyVoice> setupLegacyVoices(const std::vector<VoiceSetup>& voices)
+{
+    std::vector<LegacyVoice> legacyVoices;
+    for (const auto& voice : voices)
+    {
+        LegacyVoice legacy{};
+        legacy.sound = voice.sound.get();
+        legacy.volume = voice.volume;
+        legacy.balance = voice.balance/2;
+        legacy.sampleIncr = 65536ULL * exp2f(voice.logPitch) * voice.sound->sampleRate / CanonicalSampleRate;
+
+        if (voice.fades)
+        {
+            legacy.fadeCount = toSeconds<size_t>(CanonicalSampleRate * voice.fadeDuration);
+            legacy.fadeOfs = (voice.fadeVolume - voice.volume) / legacy.fadeCount;
+        }
+
+        legacyVoices.push_back(legacy);
+    }
+
+    return legacyVoices;
+}
+
+static void legacyMix(std::vector<LegacyVoice>& voices, int32_t* out, size_t numFrames)
+{
+    std::fill_n(out, 2*numFrames, 0);
+
+    for (auto& instance : voices)
+    {
+        if (!instance.sound) continue;
+
+        for (size_t i = 0; i < numFrames; i++)
+        {
+            if (instance.sound->stereo)
+            {
+                out[2*i] += Scale * instance.sound->data[2*instance.curSample] * instance.volume * (0.5 - instance.balance);
+                out[2*i+1] += Scale * instance.sound->data[2*instance.curSample+1] * instance.volume * (0.5 + instance.balance);
+            }
+            else
+            {
+                out[2*i] += Scale * instance.sound->data[instance.curSample] * instance.volume * (0.5 - instance.balance);
+                out[2*i+1] += Scale * instance.sound->data[instance.curSample] * instance.volume * (0.5 + instance.balance);
+            }
+
+            instance.curSampleFractional += instance.sampleIncr;
+            instance.curSample += instance.curSampleFractional >> 16;
+            instance.curSampleFractional &= 65535ULL;
+            if (instance.curSample >= instance.sound->data.size()) break;
+
+            if (instance.fadeCount > 0)
+            {
+                instance.volume += instance.fadeOfs;
+                instance.fadeCount--;
+
+                if (instance.fadeCount == 0 && instance.volume <= 0)
+                {
+                    instance.sound = nullptr;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+static std::unique_ptr<AudioManager> setupMixer(const std::vector<VoiceSetup>& voices)
+{
+    std::unique_ptr<AudioManager> mixer{new AudioManager(AudioBackend::Null)};
+
+    for (const auto& voice : voices)
+    {
+        auto ref = mixer->playSound(voice.sound, voice.volume, voice.logPitch, voice.balance);
+        if (voice.fades) mixer->fadeSound(ref, voice.fadeDuration, voice.fadeVolume);
+    }
+
+    // the callback applies only a few commands at a time, so let it drain them without mixing
+    for (size_t i = 0; i < voices.size(); i++) mixer->mixFrames(nullptr, 0);
+    return mixer;
+}
+
+struct Comparison
+{
+    double maxDeviation = 0, mixTime = 0, legacyMixTime = 0;
+};
+
+static Comparison compareMixers(const std::vector<VoiceSetup>& voices, size_t callbacks, size_t framesPerCallback,
+    size_t rounds)
+{
+    std::vector<int32_t> output(2 * framesPerCallback), legacyOutput(2 * framesPerCallback);
+    Comparison comparison;
+
+    for (size_t round = 0; round < rounds; round++)
+    {
+        auto mixer = setupMixer(voices);
+        auto legacyVoices = setupLegacyVoices(voices);
+
+        for (size_t callback = 0; callback < callbacks; callback++)
+        {
+            comparison.mixTime += microsecondsPerRun(1, [&] { mixer->mixFrames(output.data(), framesPerCallback); });
+            comparison.legacyMixTime += microsecondsPerRun(1, [&]
+            {
+                legacyMix(legacyVoices, legacyOutput.data(), framesPerCallback);
+            });
+
+            for (size_t i = 0; i < output.size(); i++)
+                comparison.maxDeviation = std::max(comparison.maxDeviation,
+                    std::abs((double)output[i] - legacyOutput[i]) / 2147483648.0);
+        }
+    }
+
+    return comparison;
+}
+
+int main(int argc, char **argv)
+{
+    size_t voiceCount = argc > 1 ? std::stoul(argv[1]) : 64;
+    size_t callbacks = argc > 2 ? std::stoul(argv[2]) : 300;
+    size_t framesPerCallback = argc > 3 ? std::stoul(argv[3]) : size_t(CanonicalSampleRate / 300);
+    size_t rounds = argc > 4 ? std::stoul(argv[4]) : 10;
+
+    voiceCount = std::min(voiceCount, MaxSounds);
+    auto seconds = callbacks * framesPerCallback / CanonicalSampleRate;
+
+    auto steady = compareMixers(generateVoices(voiceCount, seconds, false), callbacks, framesPerCallback, rounds);
+    auto fading = compareMixers(generateVoices(voiceCount, seconds, true), callbacks, framesPerCallback, rounds);
+
+    auto callbackCount = double(2 * rounds * callbacks);
+    auto mixTime = steady.mixTime + fading.mixTime, legacyMixTime = steady.legacyMixTime + fading.legacyMixTime;
+    auto callbackPeriod = 1000000 * framesPerCallback / CanonicalSampleRate;
+
+    std::cout << voiceCount << " voices, " << callbackCount << " callbacks of " << framesPerCallback << " frames ("
+        << callbackPeriod << " us of audio each)" << std::endl;
+    std::cout << "Block mixer:  " << mixTime / callbackCount << " us per callback, "
+        << voiceCount * callbackCount / (mixTime / 1000) << " voices/ms" << std::endl;
+    std::cout << "Legacy mixer: " << legacyMixTime / callbackCount << " us per callback, "
+        << voiceCount * callbackCount / (legacyMixTime / 1000) << " voices/ms ("
+        << legacyMixTime / mixTime << "x)" << std::endl;
+    std::cout << "Maximum deviation, steady voices: " << steady.maxDeviation << " of full scale, tolerance "
+        << SteadyTolerance << std::endl;
+    std::cout << "Maximum deviation, fading voices: " << fading.maxDeviation << " of full scale, tolerance "
+        << FadeTolerance << std::endl;
+
+    if (steady.maxDeviation > SteadyTolerance || fading.maxDeviation > FadeTolerance)
+    {
+        std::cout << "FAILED: the block mixer deviates from the legacy mixer" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,164 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+// Streams a music track for a long stretch of audio time, the way the decoder and audio threads
+// share a MusicStream but on a single thread and as fast as possible, and checks that the
+// resident memory stays flat while the track loops over and over; it also reports how much
+// faster than real time the decoder runs
+//
+// usage: MusicStreamBenchmark <music.ogg> [seconds]
+//
+// Only anonymous memory is counted, since the pages of a track mapped from the pack become
+// resident as they are read; the stream fails the check if it grows by more than 1 MiB after
+// the first ten seconds. Resident memory is read from /proc, so the check only runs on Linux.
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+#include "audio/Music.hpp"
+#include "audio/MusicStream.hpp"
+#include "resources/ResourceManager.hpp"
+#include "resources/FilesystemResourceLocator.hpp"
+#include "resources/PackResourceLocator.hpp"
+
+// Keep in sync with AudioManager.cpp
+constexpr double CanonicalSampleRate = 44100;
+constexpr size_t BufferSize = CanonicalSampleRate / 300;
+constexpr size_t FramesPerDecode = CanonicalSampleRate / 50;
+
+constexpr size_t WarmupSeconds = 10;
+constexpr size_t AllowedGrowth = 1024 * 1024;
+
+// Anonymous resident memory in bytes, or 0 where it can't be measured
+static size_t residentAnonymousBytes()
+{
+#if defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+    {
+        if (line.compare(0, 8, "RssAnon:") == 0)
+            return std::stoul(line.substr(8)) * 1024;
+    }
+#endif
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cout << "Usage: " << argv[0] << " <music.ogg> [seconds]" << std::endl;
+        return 1;
+    }
+
+    std::string musicName = argv[1];
+    size_t seconds = argc > 2 ? std::stoul(argv[2]) : 600;
+
+    ResourceManager resourceManager;
+    try
+    {
+        resourceManager.setResourceLocator(new PackResourceLocator());
+    }
+    catch (const PackFileError&)
+    {
+        resourceManager.setResourceLocator(new FilesystemResourceLocator());
+    }
+
+    std::shared_ptr<Music> music;
+    try
+    {
+        music = resourceManager.load<Music>(musicName);
+    }
+    catch (const std::exception& exception)
+    {
+        std::cout << exception.what() << std::endl;
+        return 1;
+    }
+
+    MusicStream stream(music, CanonicalSampleRate);
+    std::vector<float> left(BufferSize), right(BufferSize);
+
+    size_t totalFrames = seconds * (size_t)CanonicalSampleRate, framesRead = 0, underruns = 0;
+    size_t framesSinceDecode = FramesPerDecode, nextSample = 0;
+    size_t baseline = 0, peak = 0;
+
+    auto begin = std::chrono::steady_clock::now();
+    while (framesRead < totalFrames && !stream.isFinished())
+    {
+        // the decoder thread wakes up every 20 ms, the audio callback every BufferSize frames
+        if (framesSinceDecode >= FramesPerDecode)
+        {
+            stream.decode();
+            framesSinceDecode = 0;
+        }
+
+        auto count = stream.read(left.data(), right.data(), BufferSize);
+        if (count < BufferSize) underruns++;
+
+        framesRead += BufferSize;
+        framesSinceDecode += BufferSize;
+
+        if (framesRead >= nextSample)
+        {
+            auto resident = residentAnonymousBytes();
+            if (framesRead <= WarmupSeconds * CanonicalSampleRate) baseline = resident;
+            peak = std::max(peak, resident);
+            nextSample += (size_t)CanonicalSampleRate;
+        }
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    auto streamedSeconds = framesRead / CanonicalSampleRate;
+    std::cout << "Streamed " << streamedSeconds << " s of " << musicName << " (" << music->dataSize
+        << " bytes compressed) in " << elapsed << " s, " << streamedSeconds / elapsed << "x real time" << std::endl;
+    std::cout << "Callbacks that underran: " << underruns << std::endl;
+    std::cout << "Decoded as a whole, it would take " << 2 * sizeof(float) * framesRead << " bytes" << std::endl;
+
+    if (stream.isFinished() && framesRead < totalFrames)
+    {
+        std::cout << "FAILED: the stream ended before the requested time" << std::endl;
+        return 1;
+    }
+
+    if (peak == 0)
+    {
+        std::cout << "Resident memory can't be measured on this platform" << std::endl;
+        return 0;
+    }
+
+    std::cout << "Anonymous resident memory: " << baseline << " bytes after " << WarmupSeconds << " s, peak "
+        << peak << " bytes" << std::endl;
+
+    if (peak > baseline + AllowedGrowth)
+    {
+        std::cout << "FAILED: resident memory grew while streaming" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,171 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+// Compares the resource pack against loose files: every resource the game ships is opened and
+// read through PackResourceLocator and FilesystemResourceLocator, and the ones that don't need
+// an OpenGL context are also fully loaded through ResourceLoader, the way the loading threads
+// do when a level starts; the first pass is reported apart, since it pays for the page faults
+// of the mapping and the directory lookups of the loose files
+//
+// usage: PackLoadBenchmark [iterations] [pack file]
+//
+// the loose files are the ones in the Resources directory next to the executable, as in the game
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#include "execDir.hpp"
+#include "resources/ResourceLoader.hpp"
+#include "resources/FilesystemResourceLocator.hpp"
+#include "resources/PackResourceLocator.hpp"
+#include "HeadlessCommon.hpp"
+
+// textures are uploaded as they load, so they are only read here
+static const std::vector<std::string> ReadOnlyTypes = { "png" };
+static const std::vector<std::string> LoadedTypes = { "map", "ts", "lvl", "pe", "ttf", "sdf", "wav", "ogg" };
+
+static bool contains(const std::vector<std::string>& list, const std::string& value)
+{
+    return std::find(list.begin(), list.end(), value) != list.end();
+}
+
+static size_t readResource(ResourceLocator& locator, const std::string& name, std::vector<char>& buffer)
+{
+    auto stream = locator.getResource(name);
+    buffer.resize(stream->getSize());
+    return stream->read(buffer.data(), buffer.size());
+}
+
+static bool loadResource(ResourceLocator& locator, const std::string& name, const std::string& type)
+{
+    return (bool)ResourceLoader::loadFromStream(locator.getResource(name), type, &locator);
+}
+
+struct Timings
+{
+    double firstRead = 0, read = 0, firstLoad = 0, load = 0;
+};
+
+static Timings measure(ResourceLocator& locator, const std::vector<std::string>& names, size_t iterations)
+{
+    std::vector<char> buffer;
+    auto readAll = [&]
+    {
+        for (const auto& name : names) readResource(locator, name, buffer);
+    };
+
+    auto loadAll = [&]
+    {
+        for (const auto& name : names)
+        {
+            auto type = name.substr(name.find_last_of('.') + 1);
+            if (contains(LoadedTypes, type)) loadResource(locator, name, type);
+        }
+    };
+
+    Timings timings;
+    timings.firstRead = microsecondsPerRun(1, readAll);
+    timings.read = microsecondsPerRun(iterations, readAll);
+    timings.firstLoad = microsecondsPerRun(1, loadAll);
+    timings.load = microsecondsPerRun(iterations, loadAll);
+    return timings;
+}
+
+int main(int argc, char **argv)
+{
+    size_t iterations = argc > 1 ? std::stoul(argv[1]) : 20;
+    std::string packFile = argc > 2 ? argv[2] : getExecutableDirectory() + "/Resources.pak";
+    std::string resourceDirectory = getExecutableDirectory() + "/Resources";
+
+    std::unique_ptr<ResourceLocator> packLocator;
+    try
+    {
+        packLocator.reset(new PackResourceLocator(packFile));
+    }
+    catch (const PackFileError& error)
+    {
+        std::cout << error.what() << std::endl;
+        return 1;
+    }
+
+    std::unique_ptr<ResourceLocator> filesystemLocator{new FilesystemResourceLocator()};
+
+    // only the resources both locators can serve, so they do the same work
+    auto allNames = getAllFilesInDir(resourceDirectory);
+    std::sort(allNames.begin(), allNames.end());
+
+    std::vector<std::string> names;
+    size_t totalSize = 0, loadedCount = 0;
+    std::vector<char> buffer;
+    for (const auto& name : allNames)
+    {
+        auto pos = name.find_last_of('.');
+        if (pos == std::string::npos) continue;
+
+        auto type = name.substr(pos + 1);
+        if (!contains(ReadOnlyTypes, type) && !contains(LoadedTypes, type)) continue;
+
+        try
+        {
+            auto size = readResource(*filesystemLocator, name, buffer);
+            if (readResource(*packLocator, name, buffer) != size) throw std::runtime_error("size mismatch");
+            totalSize += size;
+        }
+        catch (const std::exception& exception)
+        {
+            std::cout << std::setw(24) << name << ": skipped, " << exception.what() << std::endl;
+            continue;
+        }
+
+        names.push_back(name);
+        if (contains(LoadedTypes, type)) loadedCount++;
+    }
+
+    if (names.empty())
+    {
+        std::cout << "No resources found in " << resourceDirectory << std::endl;
+        return 1;
+    }
+
+    auto packTimings = measure(*packLocator, names, iterations);
+    auto filesystemTimings = measure(*filesystemLocator, names, iterations);
+
+    auto report = [](const char* what, double filesystem, double pack)
+    {
+        std::cout << std::setw(12) << what << ": filesystem " << filesystem << " us, pack " << pack
+            << " us (" << filesystem / pack << "x)" << std::endl;
+    };
+
+    std::cout << "Read " << names.size() << " resources (" << totalSize << " bytes), loaded "
+        << loadedCount << " of them" << std::endl;
+    report("first read", filesystemTimings.firstRead, packTimings.firstRead);
+    report("read", filesystemTimings.read, packTimings.read);
+    report("first load", filesystemTimings.firstLoad, packTimings.firstLoad);
+    report("load", filesystemTimings.load, packTimings.load);
+
+    return 0;
+}
@@ -0,0 +1,296 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+// Runs the particle kernels over 10k, 100k and 1M particles (or the given counts) for a
+// number of frames, refilling what expires the way a dense emitter does, and reports how many
+// particles per millisecond are updated and expanded into quads; the same frames are run
+// through the array-of-structs batch it replaced, with its Vec4 color math, per-particle
+// duration_cast and swap-and-pop expiry
+//
+// usage: ParticleBenchmark [frames] [particle counts...]
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <chronoUtils.hpp>
+
+#include "particles/ParticleData.hpp"
+#include "HeadlessCommon.hpp"
+
+struct SpawnInfo
+{
+    sf::Vector2f position, velocity, acceleration;
+    sf::Glsl::Vec4 beginColor, endColor;
+    float beginSize, endSize, lifetime;
+};
+
+// precomputed, so the random number generation isn't timed
+static std::vector<SpawnInfo> generateSpawns(size_t count)
+{
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> unit;
+
+    std::vector<SpawnInfo> spawns(count);
+    for (auto& spawn : spawns)
+    {
+        spawn.position = sf::Vector2f(unit(generator) * 768, unit(generator) * 576);
+        spawn.velocity = sf::Vector2f(unit(generator) * 200 - 100, unit(generator) * 200 - 100);
+        spawn.acceleration = sf::Vector2f(0, 100);
+        spawn.beginColor = sf::Glsl::Vec4(unit(generator), unit(generator), unit(generator), 1);
+        spawn.endColor = sf::Glsl::Vec4(unit(generator), unit(generator), unit(generator), 0);
+        spawn.beginSize = 2 + unit(generator) * 6;
+        spawn.endSize = unit(generator) * 2;
+        spawn.lifetime = 0.25f + unit(generator) * 1.75f;
+    }
+
+    return spawns;
+}
+
+static void addParticle(ParticleData& particles, const SpawnInfo& spawn, float time)
+{
+    auto i = particles.append();
+
+    particles.x[i] = spawn.position.x;
+    particles.y[i] = spawn.position.y;
+    particles.vx[i] = spawn.velocity.x;
+    particles.vy[i] = spawn.velocity.y;
+    particles.ax[i] = spawn.acceleration.x;
+    particles.ay[i] = spawn.acceleration.y;
+
+    particles.beginTime[i] = time;
+    particles.endTime[i] = time + spawn.lifetime;
+    particles.invLifetime[i] = 1.0f / spawn.lifetime;
+
+    const float beginColor[] = { spawn.beginColor.x, spawn.beginColor.y, spawn.beginColor.z, spawn.beginColor.w };
+    const float endColor[] = { spawn.endColor.x, spawn.endColor.y, spawn.endColor.z, spawn.endColor.w };
+    for (size_t c = 0; c < 4; c++)
+    {
+        particles.beginColor[c][i] = beginColor[c];
+        particles.deltaColor[c][i] = endColor[c] - beginColor[c];
+    }
+
+    particles.beginSize[i] = spawn.beginSize;
+    particles.deltaSize[i] = spawn.endSize - spawn.beginSize;
+    particles.curSize[i] = spawn.beginSize;
+    particles.curColor[i] = sf::Color(beginColor[0] * 255.f, beginColor[1] * 255.f,
+                                      beginColor[2] * 255.f, beginColor[3] * 255.f);
+    particles.owner[i] = 0;
+}
+
+// The batch as it was before the particles were laid out as structure-of-arrays
+struct LegacyBatch
+{
+    using TimePoint = std::chrono::steady_clock::time_point;
+    using Duration = TimePoint::duration;
+
+    struct PositionInfo { sf::Vector2f position, velocity, acceleration; };
+    struct DisplayInfo { sf::Glsl::Vec4 beginColor, endColor, curColor; float beginSize, endSize, curSize; };
+    struct TimeInfo { TimePoint beginTime, endTime; Duration lifetime; };
+
+    std::vector<PositionInfo> positionAttributes;
+    std::vector<DisplayInfo> displayAttributes;
+    std::vector<TimeInfo> lifeAttributes;
+    std::vector<sf::Vertex> vertices;
+
+    static sf::Glsl::Vec4 add(sf::Glsl::Vec4 v1, sf::Glsl::Vec4 v2)
+    {
+        return sf::Glsl::Vec4(v1.x + v2.x, v1.y + v2.y, v1.z + v2.z, v1.w + v2.w);
+    }
+
+    static sf::Glsl::Vec4 sub(sf::Glsl::Vec4 v1, sf::Glsl::Vec4 v2)
+    {
+        return sf::Glsl::Vec4(v1.x - v2.x, v1.y - v2.y, v1.z - v2.z, v1.w - v2.w);
+    }
+
+    static sf::Glsl::Vec4 mul(float s, sf::Glsl::Vec4 v)
+    {
+        return sf::Glsl::Vec4(s * v.x, s * v.y, s * v.z, s * v.w);
+    }
+
+    static TimePoint convertTime(float seconds)
+    {
+        return TimePoint(std::chrono::duration_cast<Duration>(std::chrono::duration<float>(seconds)));
+    }
+
+    void addParticle(const SpawnInfo& spawn, float time)
+    {
+        auto lifetime = std::chrono::duration_cast<Duration>(std::chrono::duration<float>(spawn.lifetime));
+        positionAttributes.push_back({ spawn.position, spawn.velocity, spawn.acceleration });
+        displayAttributes.push_back({ spawn.beginColor, spawn.endColor, spawn.beginColor,
+            spawn.beginSize, spawn.endSize, spawn.beginSize });
+        lifeAttributes.push_back({ convertTime(time), convertTime(time) + lifetime, lifetime });
+        vertices.resize(6*positionAttributes.size());
+    }
+
+    void removeParticle(size_t index)
+    {
+        using std::swap;
+
+        auto last = positionAttributes.size()-1;
+        swap(positionAttributes[index], positionAttributes[last]);
+        swap(displayAttributes[index], displayAttributes[last]);
+        swap(lifeAttributes[index], lifeAttributes[last]);
+
+        positionAttributes.pop_back();
+        displayAttributes.pop_back();
+        lifeAttributes.pop_back();
+        vertices.resize(6*positionAttributes.size());
+    }
+
+    void update(float time, float dt)
+    {
+        for (auto& data : positionAttributes)
+        {
+            data.position += data.velocity * dt;
+            data.velocity += data.acceleration * dt;
+        }
+
+        for (size_t i = 0; i < displayAttributes.size(); i++)
+        {
+            auto& display = displayAttributes[i];
+            auto& life = lifeAttributes[i];
+
+            auto factor = toSeconds<float>(convertTime(time) - life.beginTime) / toSeconds<float>(life.lifetime);
+            if (factor >= 1.0) factor = 1.0;
+            display.curColor = add(display.beginColor, mul(factor, sub(display.endColor, display.beginColor)));
+            display.curSize = display.beginSize + factor * (display.endSize - display.beginSize);
+        }
+
+        for (size_t i = 0; i < lifeAttributes.size(); i++)
+            if (convertTime(time) > lifeAttributes[i].endTime) removeParticle(i);
+    }
+
+    void expand()
+    {
+        for (size_t i = 0; i < positionAttributes.size(); i++)
+        {
+            for (size_t k = 0; k < 6; k++)
+            {
+                vertices[6*i+k].position = positionAttributes[i].position;
+                vertices[6*i+k].color = sf::Color(displayAttributes[i].curColor.x * 255.f,
+                                                  displayAttributes[i].curColor.y * 255.f,
+                                                  displayAttributes[i].curColor.z * 255.f,
+                                                  displayAttributes[i].curColor.w * 255.f);
+            }
+
+            auto curSize = displayAttributes[i].curSize;
+
+            vertices[6*i+0].position += sf::Vector2f(-curSize/2, -curSize/2);
+            vertices[6*i+1].position += sf::Vector2f(+curSize/2, -curSize/2);
+            vertices[6*i+2].position += sf::Vector2f(+curSize/2, +curSize/2);
+            vertices[6*i+3].position += sf::Vector2f(-curSize/2, +curSize/2);
+            vertices[6*i+4].position += sf::Vector2f(-curSize/2, -curSize/2);
+            vertices[6*i+5].position += sf::Vector2f(+curSize/2, +curSize/2);
+
+            vertices[6*i+0].texCoords = sf::Vector2f(0, curSize);
+            vertices[6*i+1].texCoords = sf::Vector2f(1, curSize);
+            vertices[6*i+2].texCoords = sf::Vector2f(3, curSize);
+            vertices[6*i+3].texCoords = sf::Vector2f(2, curSize);
+            vertices[6*i+4].texCoords = sf::Vector2f(0, curSize);
+            vertices[6*i+5].texCoords = sf::Vector2f(3, curSize);
+        }
+    }
+};
+
+struct FrameTimings
+{
+    double update = 0, expand = 0;
+    double total() const { return update + expand; }
+};
+
+static void report(const char* name, size_t count, FrameTimings timings)
+{
+    std::cout << "  " << name << ": update " << timings.update << " us, expand " << timings.expand
+        << " us per frame, " << count / (timings.total() / 1000) << " particles/ms" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    size_t frames = argc > 1 ? std::stoul(argv[1]) : 60;
+
+    std::vector<size_t> counts;
+    for (int i = 2; i < argc; i++) counts.push_back(std::stoul(argv[i]));
+    if (counts.empty()) counts = { 10000, 100000, 1000000 };
+
+    constexpr float dt = 1.0f / 60;
+
+    std::cout << "SSE2 kernels: " << (PARTICLES_USE_SSE2 ? "yes" : "no") << std::endl;
+    for (auto count : counts)
+    {
+        auto spawns = generateSpawns(count);
+        size_t nextSpawn = 0;
+        auto spawn = [&]() -> const SpawnInfo& { nextSpawn = (nextSpawn + 1) % spawns.size(); return spawns[nextSpawn]; };
+
+        ParticleData particles;
+        std::vector<sf::Vertex> vertices;
+        FrameTimings timings;
+        float time = 0;
+
+        for (size_t i = 0; i < count; i++) addParticle(particles, spawn(), time);
+        for (size_t frame = 0; frame < frames; frame++)
+        {
+            time += dt;
+            timings.update += microsecondsPerRun(1, [&]
+            {
+                integrateParticles(particles, dt);
+                interpolateParticles(particles, time);
+                removeExpiredParticles(particles, time);
+                while (particles.size() < count) addParticle(particles, spawn(), time);
+            }) / frames;
+
+            timings.expand += microsecondsPerRun(1, [&]
+            {
+                vertices.resize(6*particles.size());
+                expandParticleQuads(particles, vertices.data());
+            }) / frames;
+        }
+
+        LegacyBatch legacy;
+        FrameTimings legacyTimings;
+        nextSpawn = 0;
+        time = 0;
+
+        for (size_t i = 0; i < count; i++) legacy.addParticle(spawn(), time);
+        for (size_t frame = 0; frame < frames; frame++)
+        {
+            time += dt;
+            legacyTimings.update += microsecondsPerRun(1, [&]
+            {
+                legacy.update(time, dt);
+                while (legacy.positionAttributes.size() < count) legacy.addParticle(spawn(), time);
+            }) / frames;
+
+            legacyTimings.expand += microsecondsPerRun(1, [&] { legacy.expand(); }) / frames;
+        }
+
+        std::cout << count << " particles, " << frames << " frames:" << std::endl;
+        report("structure-of-arrays", count, timings);
+        report("array-of-structs   ", count, legacyTimings);
+        std::cout << "  speedup: " << legacyTimings.total() / timings.total() << "x" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,142 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+// Times PluralForm::pick against the stack interpreter it replaced, over every plural form
+// of the en-us and pt-br descriptors, for small numbers and for large ones, and checks that
+// both agree on every number
+//
+// usage: PluralRuleBenchmark [numbers]
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "language/LanguageDescriptor.hpp"
+#include "language/LocalizationManager.hpp"
+#include "HeadlessCommon.hpp"
+
+// The interpreter as it was before plural forms were compiled, with its shared stack
+static intmax_t runExpressionOnSharedStack(const ExpressionCommands& cmds, size_t x)
+{
+    if (cmds.opcodes.empty()) return 0;
+    
+    static std::vector<intmax_t> stack;
+    stack.clear();
+    
+    for (auto opcode : cmds.opcodes)
+    {
+        if (opcode >= 15) stack.push_back(opcode - 15);
+        else if (opcode == 14) stack.push_back(x);
+        else
+        {
+            if (stack.size() <= 1) return 0;
+            
+            intmax_t a = stack[stack.size()-2];
+            intmax_t b = stack[stack.size()-1];
+            stack.pop_back();
+            
+            switch (opcode)
+            {
+                case 0: stack.back() = a + b; break;
+                case 1: stack.back() = a - b; break;
+                case 2: stack.back() = a * b; break;
+                case 3: if (b != 0) stack.back() = a / b;
+                    else return 0; break;
+                case 4: if (b != 0) stack.back() = a % b;
+                    else return 0; break;
+                case 5: stack.back() = a == b; break;
+                case 6: stack.back() = a != b; break;
+                case 7: stack.back() = a < b; break;
+                case 8: stack.back() = a > b; break;
+                case 9: stack.back() = a <= b; break;
+                case 10: stack.back() = a >= b; break;
+                case 11: stack.back() = a && b; break;
+                case 12: stack.back() = a || b; break;
+                case 13: stack.back() = (a != 0) != (b != 0); break;
+            }
+        }
+    }
+    
+    return stack[0];
+}
+
+static size_t interpretedPick(const PluralForm& pluralForm, size_t x)
+{
+    size_t i;
+    for (i = 0; i < pluralForm.pluralUnits.size(); i++)
+        if (runExpressionOnSharedStack(pluralForm.pluralUnits[i], x)) break;
+    return i;
+}
+
+static void benchmark(const std::string& name, size_t numbers)
+{
+    LanguageDescriptor descriptor;
+    sf::FileInputStream file;
+    if (!file.open(getPathOfLanguageDescriptor(name)) || !readFromStream(file, descriptor))
+    {
+        std::cout << "Could not read the language descriptor " << name << std::endl;
+        return;
+    }
+    
+    for (size_t k = 0; k < descriptor.pluralForms.size(); k++)
+    {
+        const auto& pluralForm = descriptor.pluralForms[k];
+        
+        // small numbers are the usual counts, large ones spread over the whole range
+        auto number = [](size_t i, bool large) { return large ? i * 2654435761u : i % 1000; };
+        
+        size_t mismatches = 0;
+        for (size_t i = 0; i < numbers; i++)
+            for (bool large : { false, true })
+                if (pluralForm.pick(number(i, large)) != interpretedPick(pluralForm, number(i, large)))
+                    mismatches++;
+        
+        std::cout << name << " plural form " << k << " (" << pluralForm.pluralUnits.size() << " units, ";
+        if (pluralForm.pickPeriod != 0)
+            std::cout << "table of " << pluralForm.pickTable.size() << " repeating every " << pluralForm.pickPeriod;
+        else std::cout << "interpreted";
+        std::cout << "), ns per pick:";
+        
+        for (bool large : { false, true })
+        {
+            volatile size_t sink = 0;
+            size_t i = 0, j = 0;
+            double interpreted = microsecondsPerRun(numbers, [&] { sink = sink + interpretedPick(pluralForm, number(i++, large)); });
+            double compiled = microsecondsPerRun(numbers, [&] { sink = sink + pluralForm.pick(number(j++, large)); });
+            
+            std::cout << (large ? " large " : " small ") << interpreted * 1000 << " -> " << compiled * 1000;
+        }
+        
+        std::cout << ", " << mismatches << " mismatches" << std::endl;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    size_t numbers = argc > 1 ? std::stoul(argv[1]) : 1000000;
+
+    benchmark("en-us.lang", numbers);
+    benchmark("pt-br.lang", numbers);
+    
+    return 0;
+}
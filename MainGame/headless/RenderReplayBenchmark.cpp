@@ -0,0 +1,205 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+// Captures one frame of a level, the way the game pushes it into the renderer, and replays it
+// through the sorted, batching render queue and through the depth-ordered multimap it replaced,
+// which issued one draw call per push; both replays are rendered to an offscreen target and
+// compared pixel by pixel, so a change in the draw order shows up as a mismatch
+//
+// usage: RenderReplayBenchmark <level.lvl> [room] [warmup frames] [replays]
+//
+// this renders for real, so it needs an OpenGL context like the headless runner
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <clocale>
+#include <chronoUtils.hpp>
+
+#include "defaults.hpp"
+#include "input/InputManager.hpp"
+#include "resources/ResourceManager.hpp"
+#include "resources/FilesystemResourceLocator.hpp"
+#include "resources/PackResourceLocator.hpp"
+#include "rendering/Renderer.hpp"
+#include "scene/SceneManager.hpp"
+#include "scene/GameScene.hpp"
+#include "gameplay/ScriptedPlayerController.hpp"
+#include "settings/Settings.hpp"
+#include "language/LocalizationManager.hpp"
+#include "audio/AudioManager.hpp"
+#include "gameplay/SaveService.hpp"
+#include "Services.hpp"
+#include "HeadlessCommon.hpp"
+
+// The captured frame: the commands keep pointing at the scene's drawables, which stay alive
+struct CapturedFrame
+{
+    std::vector<RenderCommand> commands;
+    std::vector<sf::Vertex> vertices;
+};
+
+static void replayBatched(const CapturedFrame& frame, Renderer& renderer, sf::RenderTarget& target)
+{
+    for (const auto& command : frame.commands)
+    {
+        if (command.drawable) renderer.pushDrawable(*command.drawable, command.states, command.depth);
+        else renderer.pushVertices(&frame.vertices[command.vertexBegin], command.vertexCount,
+            command.primitiveType, command.states, command.depth);
+    }
+
+    renderer.render(target);
+    renderer.clearState();
+}
+
+// The queue as it was before: every push went into a multimap keyed by depth and was drawn on its own
+static size_t replayLegacy(const CapturedFrame& frame, sf::RenderTarget& target)
+{
+    std::multimap<long, std::reference_wrapper<const RenderCommand>> drawableList;
+    for (const auto& command : frame.commands)
+        drawableList.emplace(command.depth, std::cref(command));
+
+    for (const auto& pair : drawableList)
+    {
+        const RenderCommand& command = pair.second;
+        if (command.drawable) target.draw(*command.drawable, command.states);
+        else target.draw(&frame.vertices[command.vertexBegin], command.vertexCount,
+            command.primitiveType, command.states);
+    }
+
+    return drawableList.size();
+}
+
+static size_t countDifferentPixels(const sf::Image& image1, const sf::Image& image2)
+{
+    auto size = image1.getSize();
+    size_t count = 0;
+    for (unsigned int y = 0; y < size.y; y++)
+        for (unsigned int x = 0; x < size.x; x++)
+            if (image1.getPixel(x, y) != image2.getPixel(x, y)) count++;
+    return count;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cout << "Usage: " << argv[0] << " <level.lvl> [room] [warmup frames] [replays]" << std::endl;
+        return 1;
+    }
+
+    std::setlocale(LC_ALL, "");
+
+    std::string levelName = argv[1];
+    size_t roomId = argc > 2 ? std::stoul(argv[2]) : (size_t)-1;
+    size_t warmupFrames = argc > 3 ? std::stoul(argv[3]) : 120;
+    size_t replays = argc > 4 ? std::stoul(argv[4]) : 1000;
+
+    bool success;
+    auto settings = loadSettingsFile(&success);
+    if (!success) settings.languageFile = languageDescriptorForLocale("");
+
+    InputManager inputManager;
+
+    ResourceManager resourceManager;
+    try
+    {
+        resourceManager.setResourceLocator(new PackResourceLocator());
+    }
+    catch (const PackFileError&)
+    {
+        resourceManager.setResourceLocator(new FilesystemResourceLocator());
+    }
+
+    LocalizationManager localizationManager(true);
+    localizationManager.loadLanguageDescriptor(settings.languageFile);
+
+    AudioManager audioManager(AudioBackend::Null);
+
+    SaveService saveService;
+
+    Services services { audioManager, inputManager, localizationManager, resourceManager, saveService, settings };
+
+    SceneManager sceneManager;
+    auto scene = new GameScene(services, SavedGame());
+    sceneManager.pushScene(scene);
+    scene->loadLevel(levelName);
+    if (roomId != (size_t)-1) scene->requestRoomLoad(roomId);
+
+    // let the room settle and the player run into it, so the frame has some particles and enemies
+    ScriptedPlayerController controller;
+    scene->setPlayerController(controller);
+    controller.update({ 1, 0 }, false, false, false);
+
+    auto gameTime = FrameTime() + UpdatePeriod;
+    for (size_t frame = 0; frame < warmupFrames && sceneManager.hasScenes(); frame++)
+    {
+        sceneManager.update(gameTime);
+        gameTime += UpdatePeriod;
+    }
+
+    if (!sceneManager.hasScenes())
+    {
+        std::cout << "The level closed before the frame could be captured" << std::endl;
+        return 1;
+    }
+
+    Renderer renderer;
+    sceneManager.render(renderer);
+
+    CapturedFrame frame { renderer.getCommands(), renderer.getVertices() };
+    renderer.clearState();
+
+    sf::RenderTexture target;
+    if (!target.create(ScreenWidth, ScreenHeight))
+    {
+        std::cout << "Could not create the offscreen target" << std::endl;
+        return 1;
+    }
+
+    target.clear();
+    replayLegacy(frame, target);
+    target.display();
+    auto legacyImage = target.getTexture().copyToImage();
+
+    target.clear();
+    replayBatched(frame, renderer, target);
+    target.display();
+    auto batchedImage = target.getTexture().copyToImage();
+    auto stats = renderer.getLastFrameStats();
+
+    // the driver queues the draw calls, so every replay waits for them to be submitted
+    auto legacyTime = microsecondsPerRun(replays, [&] { replayLegacy(frame, target); target.display(); });
+    auto batchedTime = microsecondsPerRun(replays, [&] { replayBatched(frame, renderer, target); target.display(); });
+
+    std::cout << "Captured " << frame.commands.size() << " commands (" << frame.vertices.size()
+        << " vertices) from " << levelName << " after " << warmupFrames << " frames" << std::endl;
+    std::cout << "Legacy:  " << frame.commands.size() << " draw calls, " << legacyTime << " us per frame" << std::endl;
+    std::cout << "Batched: " << stats.drawCallCount << " draw calls (" << stats.batchCount << " batches of "
+        << stats.batchedCommandCount << " commands), " << batchedTime << " us per frame" << std::endl;
+    std::cout << "Pixels that differ: " << countDifferentPixels(legacyImage, batchedImage) << std::endl;
+
+    return 0;
+}
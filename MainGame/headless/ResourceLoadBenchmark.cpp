@@ -0,0 +1,118 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+// Compares loading the rooms, tilesets, levels and particle emitters exported in the flat
+// layout against the same files in the stream format, which the LegacyResources target
+// exports; both are loaded from memory through ResourceLoader, the way the pack serves
+// them, so only the parsing is timed
+//
+// usage: ResourceLoadBenchmark [iterations] [flat directory] [legacy directory]
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#include <FlatResource.hpp>
+
+#include "execDir.hpp"
+#include "resources/ResourceLoader.hpp"
+#include "resources/MappedInputStream.hpp"
+#include "HeadlessCommon.hpp"
+
+struct FileContents
+{
+    std::shared_ptr<const void> data;
+    size_t size = 0;
+};
+
+// Aligned like the entries of the pack, so flat resources can be used in place
+static FileContents readFile(const std::string& name)
+{
+    struct alignas(util::FlatAlignment) Block { char bytes[util::FlatAlignment]; };
+
+    std::ifstream in(name, std::ios::in | std::ios::binary | std::ios::ate);
+    if (!in) return FileContents{};
+
+    size_t size = in.tellg();
+    std::shared_ptr<Block> blocks(new Block[(size + util::FlatAlignment - 1) / util::FlatAlignment],
+        std::default_delete<Block[]>());
+
+    in.seekg(0);
+    if (!in.read((char*)blocks.get(), size)) return FileContents{};
+    return FileContents{ std::move(blocks), size };
+}
+
+static bool loadFile(const FileContents& file, const std::string& type)
+{
+    std::unique_ptr<sf::InputStream> stream{new MappedInputStream(file.data, file.data.get(), file.size)};
+    return (bool)ResourceLoader::loadFromStream(std::move(stream), type);
+}
+
+int main(int argc, char **argv)
+{
+    size_t iterations = argc > 1 ? std::stoul(argv[1]) : 1000;
+    std::string flatDirectory = argc > 2 ? argv[2] : getExecutableDirectory() + "/Resources";
+    std::string legacyDirectory = argc > 3 ? argv[3] : flatDirectory + "/legacy";
+
+    auto names = getAllFilesInDir(legacyDirectory);
+    std::sort(names.begin(), names.end());
+
+    std::map<std::string,std::pair<double,double>> totals;
+    for (const auto& name : names)
+    {
+        auto type = name.substr(name.find_last_of('.') + 1);
+        if (type != "map" && type != "ts" && type != "lvl" && type != "pe") continue;
+
+        auto legacy = readFile(legacyDirectory + '/' + name);
+        auto flat = readFile(flatDirectory + '/' + name);
+        if (!legacy.data || !flat.data) continue;
+
+        std::cout << std::setw(24) << name << ": ";
+        if (!loadFile(legacy, type) || !loadFile(flat, type))
+        {
+            std::cout << "failed to load, export the resources again" << std::endl;
+            continue;
+        }
+
+        double legacyTime = microsecondsPerRun(iterations, [&] { loadFile(legacy, type); });
+        double flatTime = microsecondsPerRun(iterations, [&] { loadFile(flat, type); });
+
+        totals[type].first += legacyTime;
+        totals[type].second += flatTime;
+
+        std::cout << "stream " << legacyTime << " us, flat " << flatTime << " us ("
+            << legacyTime / flatTime << "x)" << std::endl;
+    }
+
+    for (const auto& pair : totals)
+    {
+        std::cout << "all ." << pair.first << ": stream " << pair.second.first << " us, flat "
+            << pair.second.second << " us (" << pair.second.first / pair.second.second << "x)" << std::endl;
+    }
+
+    return 0;
+}
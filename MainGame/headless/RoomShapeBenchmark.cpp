@@ -0,0 +1,139 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+// Compares the two ways Room::loadRoom builds the collision shapes of a room: generating them
+// from the main layer and the tileset, and instantiating the ones tmxToMap precomputed into
+// the .map file; every room of every level is timed both ways and the shapes are checked
+// to cover the same bounding boxes
+//
+// usage: RoomShapeBenchmark [iterations]
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cmath>
+
+#include <cppmunk/Body.h>
+#include <cppmunk/Shape.h>
+
+#include "resources/ResourceManager.hpp"
+#include "resources/FilesystemResourceLocator.hpp"
+#include "resources/PackResourceLocator.hpp"
+#include "data/LevelData.hpp"
+#include "data/RoomData.hpp"
+#include "data/TileSet.hpp"
+#include "objects/Room.hpp"
+#include "HeadlessCommon.hpp"
+
+std::vector<std::shared_ptr<cp::Shape>>
+    generateShapesForTilemap(const RoomData& data, const TileSet& tileSet, std::shared_ptr<cp::Body> body,
+    ShapeGeneratorDataOpaque& shaderGeneratorData, std::unordered_map<void*,CrumblingData>& crumblingTiles);
+std::vector<std::shared_ptr<cp::Shape>>
+    instantiateShapesForTilemap(const RoomData& data, std::shared_ptr<cp::Body> body,
+    ShapeGeneratorDataOpaque& shapeGeneratorData, std::unordered_map<void*,CrumblingData>& crumblingTiles);
+
+static bool sameShapes(const std::vector<std::shared_ptr<cp::Shape>>& shapes1,
+    const std::vector<std::shared_ptr<cp::Shape>>& shapes2)
+{
+    if (shapes1.size() != shapes2.size()) return false;
+
+    for (size_t i = 0; i < shapes1.size(); i++)
+    {
+        auto bb1 = cpShapeCacheBB(*shapes1[i]), bb2 = cpShapeCacheBB(*shapes2[i]);
+        if (fabs(bb1.l - bb2.l) > 1e-3 || fabs(bb1.b - bb2.b) > 1e-3 ||
+            fabs(bb1.r - bb2.r) > 1e-3 || fabs(bb1.t - bb2.t) > 1e-3) return false;
+        if (*(TileSet::Attribute*)shapes1[i]->getUserData() !=
+            *(TileSet::Attribute*)shapes2[i]->getUserData()) return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    size_t iterations = argc > 1 ? std::stoul(argv[1]) : 100;
+
+    ResourceManager resourceManager;
+    try
+    {
+        resourceManager.setResourceLocator(new PackResourceLocator());
+    }
+    catch (const PackFileError&)
+    {
+        resourceManager.setResourceLocator(new FilesystemResourceLocator());
+    }
+
+    auto body = std::make_shared<cp::Body>(cp::Body::Static);
+    double totalGenerated = 0, totalPrecomputed = 0;
+
+    for (size_t levelNumber = 1;; levelNumber++)
+    {
+        auto level = resourceManager.load<LevelData>("level" + std::to_string(levelNumber) + ".lvl");
+        if (!level) break;
+
+        for (const auto& roomName : level->roomResourceNames)
+        {
+            auto room = resourceManager.load<RoomData>(roomName + ".map");
+            auto tileSet = room ? resourceManager.load<TileSet>(std::string(room->tilesetName) + ".ts") : nullptr;
+            if (!room || !tileSet) continue;
+
+            std::cout << std::setw(12) << roomName << ": ";
+            if (!room->hasPrecomputedShapes)
+            {
+                std::cout << "no precomputed shapes, export the room again" << std::endl;
+                continue;
+            }
+
+            ShapeGeneratorDataOpaque data1(nullptr, [](void*){}), data2(nullptr, [](void*){});
+            std::unordered_map<void*,CrumblingData> crumbling1, crumbling2;
+            std::vector<std::shared_ptr<cp::Shape>> shapes1, shapes2;
+
+            double generated = microsecondsPerRun(iterations, [&]
+            {
+                crumbling1.clear();
+                shapes1 = generateShapesForTilemap(*room, *tileSet, body, data1, crumbling1);
+            });
+
+            double precomputed = microsecondsPerRun(iterations, [&]
+            {
+                crumbling2.clear();
+                shapes2 = instantiateShapesForTilemap(*room, body, data2, crumbling2);
+            });
+
+            totalGenerated += generated;
+            totalPrecomputed += precomputed;
+
+            std::cout << shapes2.size() << " shapes, generated " << generated << " us, precomputed "
+                << precomputed << " us (" << generated / precomputed << "x)";
+            if (!sameShapes(shapes1, shapes2) || crumbling1.size() != crumbling2.size())
+                std::cout << " MISMATCH";
+            std::cout << std::endl;
+        }
+    }
+
+    std::cout << "all rooms: generated " << totalGenerated << " us, precomputed " << totalPrecomputed
+        << " us (" << totalGenerated / totalPrecomputed << "x)" << std::endl;
+
+    return 0;
+}
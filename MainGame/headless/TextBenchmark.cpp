@@ -0,0 +1,168 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+// Measures how long TextDrawable takes to lay text out: every string of the en-us and pt-br
+// language descriptors in the shipped distance field font and in a plain Latin font, plus
+// Japanese and Arabic samples in the CJK and Arabic fonts; each one is laid out cold (empty
+// shaping cache), warm, and then only recolored and re-anchored, which is what menus and
+// message boxes do most of the time
+//
+// usage: TextBenchmark [iterations]
+//
+// glyphs are rendered into textures, so this needs an OpenGL context like the headless runner;
+// the .sdf font is an exported resource, so run it next to the pack or the batch export output
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <clocale>
+
+#include "resources/ResourceManager.hpp"
+#include "resources/FilesystemResourceLocator.hpp"
+#include "resources/PackResourceLocator.hpp"
+#include "resources/FontHandler.hpp"
+#include "drawables/TextDrawable.hpp"
+#include "language/LanguageDescriptor.hpp"
+#include "language/LocalizationManager.hpp"
+#include "HeadlessCommon.hpp"
+
+static const std::vector<std::string> JapaneseSamples =
+{
+    u8"ファイルを選択してください。",
+    u8"壁の近くでジャンプボタンを押すと、壁を蹴って高く跳ぶことができます。",
+    u8"ゲームを続けますか？",
+};
+
+static const std::vector<std::string> ArabicSamples =
+{
+    u8"اختر ملفًا للمتابعة.",
+    u8"اضغط زر القفز بالقرب من الجدار لترتد عنه وتقفز إلى الأعلى.",
+    u8"هل تريد متابعة اللعبة؟",
+};
+
+static std::vector<std::string> loadDescriptorStrings(const std::string& name)
+{
+    std::vector<std::string> strings;
+
+    LanguageDescriptor descriptor;
+    sf::FileInputStream file;
+    if (!file.open(getPathOfLanguageDescriptor(name)) || !readFromStream(file, descriptor))
+    {
+        std::cout << "Could not read the language descriptor " << name << std::endl;
+        return strings;
+    }
+
+    for (const auto& string : descriptor.strings)
+        strings.emplace_back(descriptor.getString(string));
+    return strings;
+}
+
+static void benchmark(const char* name, std::shared_ptr<FontHandler> fontHandler,
+    const std::vector<std::string>& strings, bool rtl, size_t iterations)
+{
+    if (!fontHandler || strings.empty())
+    {
+        std::cout << name << ": font or strings not available" << std::endl;
+        return;
+    }
+
+    std::vector<TextDrawable> texts(strings.size(), TextDrawable(fontHandler));
+    for (auto& text : texts)
+    {
+        text.setFontSize(24);
+        text.setWordWrappingWidth(480);
+        text.setRTL(rtl);
+    }
+
+    auto layoutAll = [&]
+    {
+        for (size_t i = 0; i < texts.size(); i++)
+        {
+            texts[i].setString(strings[i]);
+            texts[i].buildGeometry();
+        }
+    };
+
+    // every run lays out all the strings, so the times are divided back into a per-string figure
+    fontHandler->getHBWrapper().clearCache();
+    double cold = microsecondsPerRun(1, layoutAll) / texts.size();
+    double warm = microsecondsPerRun(iterations, layoutAll) / texts.size();
+
+    size_t k = 0;
+    double recolor = microsecondsPerRun(iterations, [&]
+    {
+        for (auto& text : texts)
+        {
+            text.setDefaultColor(sf::Color(255, 255, 255, k % 256));
+            text.buildGeometry();
+        }
+        k++;
+    }) / texts.size();
+
+    k = 0;
+    double reanchor = microsecondsPerRun(iterations, [&]
+    {
+        for (auto& text : texts)
+        {
+            text.setHorizontalAnchor(k % 2 ? TextDrawable::HorAnchor::Center : TextDrawable::HorAnchor::Left);
+            text.buildGeometry();
+        }
+        k++;
+    }) / texts.size();
+
+    std::cout << name << " (" << texts.size() << " strings), us per string: cold " << cold
+        << ", warm " << warm << ", recolor " << recolor << ", reanchor " << reanchor << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    std::setlocale(LC_ALL, "");
+    size_t iterations = argc > 1 ? std::stoul(argv[1]) : 100;
+
+    ResourceManager resourceManager;
+    try
+    {
+        resourceManager.setResourceLocator(new PackResourceLocator());
+    }
+    catch (const PackFileError&)
+    {
+        resourceManager.setResourceLocator(new FilesystemResourceLocator());
+    }
+
+    // the font en-us and pt-br use in the game, baked from the descriptors of both
+    auto shippedFont = resourceManager.load<FontHandler>("mplus-1m-medium.sdf");
+    auto latinFont = resourceManager.load<FontHandler>("Roboto-Medium.ttf");
+    auto japaneseFont = resourceManager.load<FontHandler>("mplus-1p-medium.ttf");
+    auto arabicFont = resourceManager.load<FontHandler>("LateefRegOT.ttf");
+
+    auto englishStrings = loadDescriptorStrings("en-us.lang");
+    auto portugueseStrings = loadDescriptorStrings("pt-br.lang");
+
+    benchmark("en-us, mplus-1m-medium.sdf", shippedFont, englishStrings, false, iterations);
+    benchmark("pt-br, mplus-1m-medium.sdf", shippedFont, portugueseStrings, false, iterations);
+    benchmark("en-us, Roboto-Medium.ttf", latinFont, englishStrings, false, iterations);
+    benchmark("pt-br, Roboto-Medium.ttf", latinFont, portugueseStrings, false, iterations);
+    benchmark("Japanese", japaneseFont, JapaneseSamples, false, iterations);
+    benchmark("Arabic", arabicFont, ArabicSamples, true, iterations);
+
+    return 0;
+}
@@ -0,0 +1,192 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+// Scrolls the camera across a room, the way GameScene moves it, and times every tilemap draw:
+// the first pass builds each chunk as it comes into view, the later ones only draw the cached
+// geometry; then it crumbles random tiles one at a time through setTile, against copying the
+// whole grid back with setTileData, which is how Room removed tiles before
+//
+// usage: TilemapBenchmark <room.map> [passes] [crumbles]
+//
+// the tileset texture and the drawing need an OpenGL context, like the headless runner
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include "defaults.hpp"
+#include "data/RoomData.hpp"
+#include "data/TileSet.hpp"
+#include "drawables/Tilemap.hpp"
+#include "resources/ResourceManager.hpp"
+#include "resources/FilesystemResourceLocator.hpp"
+#include "resources/PackResourceLocator.hpp"
+#include "HeadlessCommon.hpp"
+
+struct ScrollTimings
+{
+    double average, max;
+};
+
+// Left to right over the top of the room, then back over the bottom, four pixels per frame
+static ScrollTimings scroll(const Tilemap& tilemap, sf::RenderTarget& target, sf::Vector2f roomSize)
+{
+    sf::Vector2f playfieldOffset((float)(ScreenWidth-PlayfieldWidth)/2, (float)(ScreenHeight-PlayfieldHeight)/2);
+    float maxX = std::max(roomSize.x - (float)PlayfieldWidth, 0.0f);
+    float maxY = std::max(roomSize.y - (float)PlayfieldHeight, 0.0f);
+
+    std::vector<sf::Vector2f> cameraPositions;
+    for (float x = 0; x <= maxX; x += 4) cameraPositions.emplace_back(x, 0);
+    for (float y = 0; y <= maxY; y += 4) cameraPositions.emplace_back(maxX, y);
+    for (float x = maxX; x >= 0; x -= 4) cameraPositions.emplace_back(x, maxY);
+
+    ScrollTimings timings{};
+    for (auto position : cameraPositions)
+    {
+        sf::RenderStates states;
+        states.transform.translate(playfieldOffset - position);
+
+        auto time = microsecondsPerRun(1, [&] { target.draw(tilemap, states); });
+        timings.average += time;
+        timings.max = std::max(timings.max, time);
+    }
+
+    timings.average /= cameraPositions.size();
+    return timings;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cout << "Usage: " << argv[0] << " <room.map> [passes] [crumbles]" << std::endl;
+        return 1;
+    }
+
+    std::string roomName = argv[1];
+    size_t passes = argc > 2 ? std::stoul(argv[2]) : 20;
+    size_t crumbles = argc > 3 ? std::stoul(argv[3]) : 10000;
+
+    ResourceManager resourceManager;
+    try
+    {
+        resourceManager.setResourceLocator(new PackResourceLocator());
+    }
+    catch (const PackFileError&)
+    {
+        resourceManager.setResourceLocator(new FilesystemResourceLocator());
+    }
+
+    std::shared_ptr<RoomData> room;
+    std::shared_ptr<TileSet> tileSet;
+    std::shared_ptr<sf::Texture> texture;
+    try
+    {
+        room = resourceManager.load<RoomData>(roomName);
+        tileSet = resourceManager.load<TileSet>(std::string(room->tilesetName) + ".ts");
+        texture = resourceManager.load<sf::Texture>(std::string(tileSet->textureName));
+    }
+    catch (const std::exception& exception)
+    {
+        std::cout << exception.what() << std::endl;
+        return 1;
+    }
+
+    sf::RenderTexture target;
+    if (!target.create(ScreenWidth, ScreenHeight))
+    {
+        std::cout << "Could not create the offscreen target" << std::endl;
+        return 1;
+    }
+
+    sf::FloatRect drawingFrame{(float)(ScreenWidth-PlayfieldWidth)/2, (float)(ScreenHeight-PlayfieldHeight)/2,
+        (float)PlayfieldWidth, (float)PlayfieldHeight};
+    sf::Vector2f roomSize((float)DefaultTileSize * room->mainLayer.width(), (float)DefaultTileSize * room->mainLayer.height());
+
+    Tilemap tilemap(drawingFrame);
+    tilemap.setTexture(texture);
+    tilemap.setTileData(room->mainLayer);
+
+    auto firstPass = scroll(tilemap, target, roomSize);
+
+    ScrollTimings cachedPass{};
+    for (size_t i = 0; i < passes; i++)
+    {
+        auto timings = scroll(tilemap, target, roomSize);
+        cachedPass.average += timings.average / passes;
+        cachedPass.max = std::max(cachedPass.max, timings.max);
+    }
+
+    std::cout << "Room " << roomName << ": " << room->mainLayer.width() << 'x' << room->mainLayer.height()
+        << " tiles, " << ((room->mainLayer.width() + Tilemap::ChunkSize - 1) / Tilemap::ChunkSize) *
+        ((room->mainLayer.height() + Tilemap::ChunkSize - 1) / Tilemap::ChunkSize) << " chunks" << std::endl;
+    std::cout << "Scroll, building chunks: " << firstPass.average << " us per frame, max " << firstPass.max << " us" << std::endl;
+    std::cout << "Scroll, cached chunks:   " << cachedPass.average << " us per frame, max " << cachedPass.max << " us" << std::endl;
+
+    // the camera stays on the top left corner, so some of the crumbled tiles are on screen
+    std::vector<std::pair<size_t,size_t>> solidTiles;
+    for (size_t y = 0; y < room->mainLayer.height(); y++)
+        for (size_t x = 0; x < room->mainLayer.width(); x++)
+            if (room->mainLayer(x, y) != (uint8_t)-1) solidTiles.emplace_back(x, y);
+
+    if (solidTiles.empty())
+    {
+        std::cout << "The room has no tiles to crumble" << std::endl;
+        return 0;
+    }
+
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<size_t> distribution(0, solidTiles.size() - 1);
+
+    sf::RenderStates states;
+    states.transform.translate(drawingFrame.left, drawingFrame.top);
+
+    auto crumbleTime = microsecondsPerRun(crumbles, [&]
+    {
+        auto tile = solidTiles[distribution(generator)];
+        auto value = tilemap.getTileData()(tile.first, tile.second);
+        tilemap.setTile(tile.first, tile.second, -1);
+        target.draw(tilemap, states);
+        tilemap.setTile(tile.first, tile.second, value);
+    });
+
+    generator.seed(42);
+    util::grid<uint8_t> tileData(room->mainLayer.width(), room->mainLayer.height(), room->mainLayer.data());
+    auto legacyCrumbleTime = microsecondsPerRun(crumbles, [&]
+    {
+        auto tile = solidTiles[distribution(generator)];
+        auto value = tileData(tile.first, tile.second);
+        tileData(tile.first, tile.second) = -1;
+        tilemap.setTileData(tileData);
+        target.draw(tilemap, states);
+        tileData(tile.first, tile.second) = value;
+    });
+
+    std::cout << "Crumble with setTile:     " << crumbleTime << " us per tile, drawing included" << std::endl;
+    std::cout << "Crumble with setTileData: " << legacyCrumbleTime << " us per tile, drawing included ("
+        << legacyCrumbleTime / crumbleTime << "x)" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,150 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+// Steps a batch of water surfaces the way the solver thread does, against the per-body update
+// it replaced, which allocated the velocities and packed texels with fmodf on every step, and
+// reports how far apart their heights and texels end up
+//
+// usage: WaterBenchmark [bodies] [columns] [steps]
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cstring>
+
+#include "drawables/WaterBody.hpp"
+#include "HeadlessCommon.hpp"
+
+// The surface state as it was before the solver was batched
+struct LegacySurface
+{
+    size_t width;
+    std::vector<float> previousFrame2, previousFrame, curFrame, newVelocity;
+    std::vector<sf::Uint8> texBuffer;
+
+    LegacySurface(size_t width) : width(width), previousFrame2(width), previousFrame(width),
+        curFrame(width), newVelocity(width), texBuffer(4 * width) {}
+
+    void step()
+    {
+        std::vector<float> velocity;
+        velocity.resize(newVelocity.size());
+        velocity.swap(newVelocity);
+
+        previousFrame2.swap(previousFrame);
+        previousFrame.swap(curFrame);
+
+        for (size_t i = 0; i < width; i++)
+        {
+            float fxt = previousFrame[i];
+            float fxnt = i > 0 ? previousFrame[i - 1] : 0;
+            float fxpt = i < width - 1 ? previousFrame[i + 1] : 0;
+            float fxtn = previousFrame2[i];
+            float vel = velocity[i];
+
+            float output = 0.99f*(2 * fxt - fxtn) + 0.92f * 0.92f *(fxnt + fxpt - 2.0*fxt) - vel;
+            curFrame[i] = output;
+
+            if (output > 255) output = 255;
+            else if (output < -255) output = -255;
+
+            texBuffer[4 * i] = floorf(fmodf(fabsf(output) * 256, 256));
+            texBuffer[4 * i + 1] = floorf(fabsf(output));
+            texBuffer[4 * i + 2] = 255 * (output >= 0);
+            texBuffer[4 * i + 3] = 255;
+        }
+    }
+};
+
+struct BatchedSurface
+{
+    size_t width, newestFrame;
+    std::vector<float> frames[2], velocities;
+    std::vector<sf::Uint8> texBuffer;
+
+    BatchedSurface(size_t width) : width(width), newestFrame(0), frames{ std::vector<float>(width), std::vector<float>(width) },
+        velocities(width), texBuffer(4 * width) {}
+
+    void step()
+    {
+        stepDynamicWaves(frames[newestFrame].data(), frames[newestFrame ^ 1].data(), velocities.data(), texBuffer.data(), width);
+        std::fill(velocities.begin(), velocities.end(), 0.0f);
+        newestFrame ^= 1;
+    }
+};
+
+int main(int argc, char **argv)
+{
+    size_t bodies = argc > 1 ? std::stoul(argv[1]) : 64;
+    size_t columns = argc > 2 ? std::stoul(argv[2]) : 2048;
+    size_t steps = argc > 3 ? std::stoul(argv[3]) : 1000;
+
+    std::vector<LegacySurface> legacy(bodies, LegacySurface(columns));
+    std::vector<BatchedSurface> batched(bodies, BatchedSurface(columns));
+
+    // a few splashes every step, like bodies hit by the player and the enemies, the same
+    // sequence for both runs
+    std::mt19937 generator;
+    std::uniform_int_distribution<size_t> column(0, columns - 1);
+    std::uniform_real_distribution<float> velocity(-8, 8);
+    bool legacyRun;
+    auto splash = [&]
+    {
+        for (size_t k = 0; k < bodies; k++)
+            for (size_t j = 0; j < 4; j++)
+            {
+                size_t i = column(generator);
+                if (legacyRun) legacy[k].newVelocity[i] = velocity(generator);
+                else batched[k].velocities[i] = velocity(generator);
+            }
+    };
+
+    generator.seed(42);
+    legacyRun = true;
+    double legacyTime = microsecondsPerRun(steps, [&] { splash(); for (auto& surface : legacy) surface.step(); });
+
+    generator.seed(42);
+    legacyRun = false;
+    double batchedTime = microsecondsPerRun(steps, [&] { splash(); for (auto& surface : batched) surface.step(); });
+
+    // the old update kept part of the stencil in double precision, so heights drift by rounding
+    float maxDifference = 0;
+    size_t texelMismatches = 0;
+    for (size_t k = 0; k < bodies; k++)
+        for (size_t i = 0; i < columns; i++)
+        {
+            float difference = fabsf(legacy[k].curFrame[i] - batched[k].frames[batched[k].newestFrame][i]);
+            maxDifference = std::max(maxDifference, difference);
+            if (memcmp(&legacy[k].texBuffer[4 * i], &batched[k].texBuffer[4 * i], 4) != 0)
+                texelMismatches++;
+        }
+
+    std::cout << bodies << " bodies of " << columns << " columns, us per step of all bodies: "
+        << legacyTime << " -> " << batchedTime << " (" << legacyTime / batchedTime << "x)" << std::endl;
+    std::cout << "max height difference " << maxDifference << ", " << texelMismatches
+        << " of " << bodies * columns << " texels differ" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,153 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+// Times loadWaveFile over every .wav in the resource directory, both through a file
+// stream and from memory the way the pack serves them, and over synthetic one-minute
+// 44.1kHz stereo files in every sample encoding the loader understands
+//
+// usage: WaveLoadBenchmark [iterations] [resource directory]
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#include "execDir.hpp"
+#include "audio/readWav.hpp"
+#include "audio/Sound.hpp"
+#include "resources/MappedInputStream.hpp"
+#include "HeadlessCommon.hpp"
+
+static std::shared_ptr<Sound> loadFromMemory(const std::shared_ptr<const std::vector<char>>& file)
+{
+    std::unique_ptr<sf::InputStream> stream{new MappedInputStream(file, file->data(), file->size())};
+    auto sound = loadWaveFile(stream);
+    return sound ? sound.as<Sound>() : nullptr;
+}
+
+static std::shared_ptr<Sound> loadFromFile(const std::string& name)
+{
+    std::unique_ptr<sf::FileInputStream> file{new sf::FileInputStream()};
+    if (!file->open(name)) return nullptr;
+
+    std::unique_ptr<sf::InputStream> stream{file.release()};
+    auto sound = loadWaveFile(stream);
+    return sound ? sound.as<Sound>() : nullptr;
+}
+
+template <typename T>
+static void append(std::vector<char>& data, T value, size_t size = sizeof(T))
+{
+    data.insert(data.end(), (const char*)&value, (const char*)&value + size);
+}
+
+// A sine sweep with a LIST chunk in front of the format, like the files most editors write
+static std::shared_ptr<const std::vector<char>> makeSyntheticFile(uint16_t format, uint16_t bitsPerSample)
+{
+    constexpr uint32_t SampleRate = 44100, Channels = 2, Frames = SampleRate * 60;
+    uint16_t blockAlign = Channels * bitsPerSample / 8;
+
+    std::vector<char> data;
+    data.insert(data.end(), { 'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E' });
+    data.insert(data.end(), { 'L', 'I', 'S', 'T', 4, 0, 0, 0, 'I', 'N', 'F', 'O' });
+    data.insert(data.end(), { 'f', 'm', 't', ' ', 16, 0, 0, 0 });
+    append(data, format);
+    append(data, (uint16_t)Channels);
+    append(data, SampleRate);
+    append(data, SampleRate * blockAlign);
+    append(data, blockAlign);
+    append(data, bitsPerSample);
+    data.insert(data.end(), { 'd', 'a', 't', 'a' });
+    append(data, Frames * blockAlign);
+
+    for (uint32_t i = 0; i < Frames * Channels; i++)
+    {
+        double value = 0.5 * sin(i * (0.001 + i * 1e-9));
+        if (format == 3) append(data, (float)value);
+        else if (bitsPerSample == 8) append(data, (uint8_t)(value * 127 + 128));
+        else append(data, (int32_t)(value * (1 << (bitsPerSample - 1))), bitsPerSample / 8);
+    }
+
+    uint32_t riffSize = data.size() - 8;
+    memcpy(data.data() + 4, &riffSize, sizeof(uint32_t));
+    return std::make_shared<const std::vector<char>>(std::move(data));
+}
+
+int main(int argc, char **argv)
+{
+    size_t iterations = argc > 1 ? std::stoul(argv[1]) : 100;
+    std::string directory = argc > 2 ? argv[2] : getExecutableDirectory() + "/Resources";
+
+    auto names = getAllFilesInDir(directory);
+    std::sort(names.begin(), names.end());
+
+    double totalFile = 0, totalMemory = 0;
+    for (const auto& name : names)
+    {
+        if (name.size() < 4 || name.compare(name.size() - 4, 4, ".wav") != 0) continue;
+
+        std::string path = directory + '/' + name;
+        std::ifstream in(path, std::ios::in | std::ios::binary);
+        auto contents = std::make_shared<const std::vector<char>>(std::istreambuf_iterator<char>(in),
+            std::istreambuf_iterator<char>());
+
+        std::cout << std::setw(24) << name << ": ";
+        auto sound = loadFromMemory(contents);
+        if (!sound)
+        {
+            std::cout << "failed to load" << std::endl;
+            continue;
+        }
+
+        double fileTime = microsecondsPerRun(iterations, [&] { loadFromFile(path); });
+        double memoryTime = microsecondsPerRun(iterations, [&] { loadFromMemory(contents); });
+        totalFile += fileTime;
+        totalMemory += memoryTime;
+
+        std::cout << sound->size() << (sound->stereo ? " stereo" : " mono") << " frames, file " << fileTime
+            << " us, memory " << memoryTime << " us" << std::endl;
+    }
+
+    std::cout << "all resources: file " << totalFile << " us, memory " << totalMemory << " us" << std::endl;
+
+    const std::pair<uint16_t,uint16_t> encodings[] = { { 1, 8 }, { 1, 16 }, { 1, 24 }, { 1, 32 }, { 3, 32 } };
+    for (auto encoding : encodings)
+    {
+        auto contents = makeSyntheticFile(encoding.first, encoding.second);
+        if (!loadFromMemory(contents))
+        {
+            std::cout << "synthetic file failed to load" << std::endl;
+            continue;
+        }
+
+        std::cout << "one minute, " << (encoding.first == 3 ? "float " : "PCM ") << encoding.second << "-bit stereo: "
+            << microsecondsPerRun(std::max<size_t>(iterations / 10, 1), [&] { loadFromMemory(contents); })
+            << " us" << std::endl;
+    }
+
+    return 0;
+}
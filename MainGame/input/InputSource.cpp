@@ -94,7 +94,7 @@ std::string InputSource::getInputName(LocalizationManager& lm)
 {
     switch (type)
     {
-        case Type::None: return lm.getString("input-source-none");
+        case Type::None: return std::string(lm.getString("input-source-none"));
         case Type::Keyboard: return scanCodeToKeyName(attribute, lm);
         case Type::JoystickButton:
             return lm.getFormattedString("joystick-button-id", {}, {{"n",attribute}}, {});
@@ -79,25 +79,25 @@ std::string scanCodeToKeyName(sf::Uint32 code, LocalizationManager& lm)
     
     switch (code)
     {
-        case kVK_Return: return lm.getString("key-name-macos-return");
-        case kVK_Tab: return lm.getString("key-name-tab");
-        case kVK_Space: return lm.getString("key-name-space");
-        case kVK_Delete: return lm.getString("key-name-macos-delete");
-        case kVK_Escape: return lm.getString("key-name-escape");
-        case kVK_Command: return lm.getString("key-name-macos-command");
-        case kVK_Shift: return lm.getString("key-name-macos-shift");
-        case kVK_CapsLock: return lm.getString("key-name-caps-lock");
-        case kVK_Option: return lm.getString("key-name-macos-option");
-        case kVK_Control: return lm.getString("key-name-macos-control");
-        case kVK_RightCommand: return lm.getString("key-name-macos-right-command");
-        case kVK_RightShift: return lm.getString("key-name-macos-right-shift");
-        case kVK_RightOption: return lm.getString("key-name-macos-right-option");
-        case kVK_RightControl: return lm.getString("key-name-macos-right-control");
-        case kVK_Function: return lm.getString("key-name-macos-function");
+        case kVK_Return: return std::string(lm.getString("key-name-macos-return"));
+        case kVK_Tab: return std::string(lm.getString("key-name-tab"));
+        case kVK_Space: return std::string(lm.getString("key-name-space"));
+        case kVK_Delete: return std::string(lm.getString("key-name-macos-delete"));
+        case kVK_Escape: return std::string(lm.getString("key-name-escape"));
+        case kVK_Command: return std::string(lm.getString("key-name-macos-command"));
+        case kVK_Shift: return std::string(lm.getString("key-name-macos-shift"));
+        case kVK_CapsLock: return std::string(lm.getString("key-name-caps-lock"));
+        case kVK_Option: return std::string(lm.getString("key-name-macos-option"));
+        case kVK_Control: return std::string(lm.getString("key-name-macos-control"));
+        case kVK_RightCommand: return std::string(lm.getString("key-name-macos-right-command"));
+        case kVK_RightShift: return std::string(lm.getString("key-name-macos-right-shift"));
+        case kVK_RightOption: return std::string(lm.getString("key-name-macos-right-option"));
+        case kVK_RightControl: return std::string(lm.getString("key-name-macos-right-control"));
+        case kVK_Function: return std::string(lm.getString("key-name-macos-function"));
         case kVK_F17: return lm.getFormattedString("keyboard-key-name-fkey", {}, {{"n", 17}}, {});
-        case kVK_VolumeUp: return lm.getString("key-name-macos-volup");
-        case kVK_VolumeDown: return lm.getString("key-name-macos-voldown");
-        case kVK_Mute: return lm.getString("key-name-macos-mute");
+        case kVK_VolumeUp: return std::string(lm.getString("key-name-macos-volup"));
+        case kVK_VolumeDown: return std::string(lm.getString("key-name-macos-voldown"));
+        case kVK_Mute: return std::string(lm.getString("key-name-macos-mute"));
         case kVK_F18: return lm.getFormattedString("keyboard-key-name-fkey", {}, {{"n", 18}}, {});
         case kVK_F19: return lm.getFormattedString("keyboard-key-name-fkey", {}, {{"n", 19}}, {});
         case kVK_F20: return lm.getFormattedString("keyboard-key-name-fkey", {}, {{"n", 20}}, {});
@@ -114,19 +114,19 @@ std::string scanCodeToKeyName(sf::Uint32 code, LocalizationManager& lm)
         case kVK_F10: return lm.getFormattedString("keyboard-key-name-fkey", {}, {{"n", 10}}, {});
         case kVK_F12: return lm.getFormattedString("keyboard-key-name-fkey", {}, {{"n", 12}}, {});
         case kVK_F15: return lm.getFormattedString("keyboard-key-name-fkey", {}, {{"n", 15}}, {});
-        case kVK_Help: return lm.getString("key-name-help");
-        case kVK_Home: return lm.getString("key-name-home");
-        case kVK_PageUp: return lm.getString("key-name-page-up");
-        case kVK_ForwardDelete: return lm.getString("key-name-macos-fwd-delete");
+        case kVK_Help: return std::string(lm.getString("key-name-help"));
+        case kVK_Home: return std::string(lm.getString("key-name-home"));
+        case kVK_PageUp: return std::string(lm.getString("key-name-page-up"));
+        case kVK_ForwardDelete: return std::string(lm.getString("key-name-macos-fwd-delete"));
         case kVK_F4: return lm.getFormattedString("keyboard-key-name-fkey", {}, {{"n", 4}}, {});
-        case kVK_End: return lm.getString("key-name-end");
+        case kVK_End: return std::string(lm.getString("key-name-end"));
         case kVK_F2: return lm.getFormattedString("keyboard-key-name-fkey", {}, {{"n", 2}}, {});
-        case kVK_PageDown: return lm.getString("key-name-page-down");
+        case kVK_PageDown: return std::string(lm.getString("key-name-page-down"));
         case kVK_F1: return lm.getFormattedString("keyboard-key-name-fkey", {}, {{"n", 1}}, {});
-        case kVK_LeftArrow: return lm.getString("key-name-left");
-        case kVK_RightArrow: return lm.getString("key-name-right");
-        case kVK_DownArrow: return lm.getString("key-name-down");
-        case kVK_UpArrow: return lm.getString("key-name-up");
+        case kVK_LeftArrow: return std::string(lm.getString("key-name-left"));
+        case kVK_RightArrow: return std::string(lm.getString("key-name-right"));
+        case kVK_DownArrow: return std::string(lm.getString("key-name-down"));
+        case kVK_UpArrow: return std::string(lm.getString("key-name-up"));
         case kVK_ANSI_Keypad0: return lm.getFormattedString("keyboard-key-name-numkey", {}, {{"n", 0}}, {});
         case kVK_ANSI_Keypad1: return lm.getFormattedString("keyboard-key-name-numkey", {}, {{"n", 1}}, {});
         case kVK_ANSI_Keypad2: return lm.getFormattedString("keyboard-key-name-numkey", {}, {{"n", 2}}, {});
@@ -137,14 +137,14 @@ std::string scanCodeToKeyName(sf::Uint32 code, LocalizationManager& lm)
         case kVK_ANSI_Keypad7: return lm.getFormattedString("keyboard-key-name-numkey", {}, {{"n", 7}}, {});
         case kVK_ANSI_Keypad8: return lm.getFormattedString("keyboard-key-name-numkey", {}, {{"n", 8}}, {});
         case kVK_ANSI_Keypad9: return lm.getFormattedString("keyboard-key-name-numkey", {}, {{"n", 9}}, {});
-        case kVK_ANSI_KeypadDecimal: return lm.getString("key-name-num-decimal");
-        case kVK_ANSI_KeypadMultiply: return lm.getString("key-name-num-multply");
-        case kVK_ANSI_KeypadPlus: return lm.getString("key-name-num-add");
-        case kVK_ANSI_KeypadClear: return lm.getString("key-name-num-clear");
-        case kVK_ANSI_KeypadDivide: return lm.getString("key-name-num-divide");
-        case kVK_ANSI_KeypadEnter: return lm.getString("key-name-num-return");
-        case kVK_ANSI_KeypadMinus: return lm.getString("key-name-num-subtract");
-        case kVK_ANSI_KeypadEquals: return lm.getString("key-name-num-equal");
+        case kVK_ANSI_KeypadDecimal: return std::string(lm.getString("key-name-num-decimal"));
+        case kVK_ANSI_KeypadMultiply: return std::string(lm.getString("key-name-num-multply"));
+        case kVK_ANSI_KeypadPlus: return std::string(lm.getString("key-name-num-add"));
+        case kVK_ANSI_KeypadClear: return std::string(lm.getString("key-name-num-clear"));
+        case kVK_ANSI_KeypadDivide: return std::string(lm.getString("key-name-num-divide"));
+        case kVK_ANSI_KeypadEnter: return std::string(lm.getString("key-name-num-return"));
+        case kVK_ANSI_KeypadMinus: return std::string(lm.getString("key-name-num-subtract"));
+        case kVK_ANSI_KeypadEquals: return std::string(lm.getString("key-name-num-equal"));
     }
     
     return scanCodeToLocalizedKeyName(code, lm);
@@ -193,7 +193,7 @@ std::string scanCodeToKeyName(sf::Uint32 code, LocalizationManager& lm)
         sf::Uint32 charCode = 0;
 
         // ASCII character;
-        if (key == 32) return lm.getString("key-name-space");
+        if (key == 32) return std::string(lm.getString("key-name-space"));
         else if (key > 32 && key <= 126) charCode = islower(key) ? toupper(key) : key;
         else if (key >= 0xA0 && key <= 0xDF) charCode = key;
         else if (key == 0xF7) charCode = 0xF7;
@@ -240,7 +240,7 @@ std::string scanCodeToKeyName(sf::Uint32 code, LocalizationManager& lm)
                 if (pair.first != pair.second) id = pair.first->id;
             }
 
-            if (id != "") return lm.getString(id);
+            if (!id.empty()) return std::string(lm.getString(id));
         }
 
         if (charCode > 0)
@@ -23,4 +23,39 @@
 
 #pragma once
 
-using LangID = std::string;
+#include <string>
+#include <string_view>
+#include <functional>
+#include <PerfectHash.hpp>
+
+// Strings are looked up by the 64-bit hash of their key, which is computed at
+// compile time for literals; the key itself never reaches the game
+class LangID final
+{
+    uint64_t hash;
+
+    constexpr explicit LangID(uint64_t hash, int) : hash(hash) {}
+
+public:
+    constexpr LangID() : hash(0) {}
+    constexpr LangID(const char* str) : LangID(std::string_view(str)) {}
+    constexpr LangID(std::string_view str) : hash(util::fnv1a64(str.data(), str.size())) {}
+    LangID(const std::string& str) : LangID(std::string_view(str)) {}
+
+    static constexpr LangID fromHash(uint64_t hash) { return LangID(hash, 0); }
+
+    constexpr uint64_t getHash() const { return hash; }
+    constexpr bool empty() const { return hash == 0; }
+
+    constexpr bool operator==(LangID other) const { return hash == other.hash; }
+    constexpr bool operator!=(LangID other) const { return hash != other.hash; }
+};
+
+namespace std
+{
+    template <>
+    struct hash<LangID>
+    {
+        size_t operator()(LangID id) const noexcept { return (size_t)id.getHash(); }
+    };
+}
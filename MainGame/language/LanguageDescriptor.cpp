@@ -29,10 +29,9 @@
 
 bool readFromStream(sf::InputStream& stream, LangString& string)
 {
-    if (!readFromStream(stream, string.string)) return false;
-    
     size_t size;
-    if (!readFromStream(stream, varLength(size))) return false;
+    if (!readFromStream(stream, varLength(string.offset), varLength(string.length), varLength(size)))
+        return false;
     
     std::vector<std::pair<size_t,size_t>> pairs(size);
     for (auto& pair : pairs)
@@ -49,7 +48,7 @@ bool readFromStream(sf::InputStream& stream, Formatter& formatter)
     
     formatter.specifiers.resize(size);
     
-    return std::all_of(formatter.specifiers.begin(), formatter.specifiers.end(),
+    bool read = std::all_of(formatter.specifiers.begin(), formatter.specifiers.end(),
     [&] (auto& specifier)
     {
         if (!readFromStream(stream, varLength(specifier.byteLocation), specifier.type))
@@ -69,11 +68,70 @@ bool readFromStream(sf::InputStream& stream, Formatter& formatter)
             (specifier.type != Formatter::Specifier::Type::Pvterm ||
                 readFromStream(stream, specifier.specifier2));
     });
+    
+    return read && formatter.compile();
+}
+
+static bool readTableEntries(sf::InputStream& stream, LangIDTable& table, size_t& size)
+{
+    if (!readFromStream(stream, table.displacements, varLength(size))) return false;
+    if (size > 0 && table.displacements.empty()) return false;
+    
+    table.keys.resize(size);
+    return true;
+}
+
+bool readStringTable(sf::InputStream& stream, LanguageDescriptor& descriptor)
+{
+    size_t size;
+    if (!(readFromStream(stream, descriptor.stringData) &&
+        readTableEntries(stream, descriptor.stringIDs, size))) return false;
+    
+    descriptor.strings.assign(size, LangString());
+    for (size_t i = 0; i < size; i++)
+    {
+        auto& string = descriptor.strings[i];
+        if (!readFromStream(stream, descriptor.stringIDs.keys[i], string)) return false;
+        if (string.offset > descriptor.stringData.size() ||
+            string.length > descriptor.stringData.size() - string.offset) return false;
+    }
+    
+    return true;
+}
+
+bool readFormatterTable(sf::InputStream& stream, LanguageDescriptor& descriptor)
+{
+    size_t size;
+    if (!readTableEntries(stream, descriptor.formatterIDs, size)) return false;
+    
+    descriptor.formatters.assign(size, Formatter());
+    for (size_t i = 0; i < size; i++)
+        if (!readFromStream(stream, descriptor.formatterIDs.keys[i], descriptor.formatters[i])) return false;
+    
+    return true;
+}
+
+static bool readVarLengthVector(sf::InputStream& stream, std::vector<size_t>& vec)
+{
+    size_t size;
+    if (!readFromStream(stream, varLength(size))) return false;
+    
+    vec.resize(size);
+    for (auto& v : vec) if (!readFromStream(stream, varLength(v))) return false;
+    return true;
 }
 
 bool readFromStream(sf::InputStream& stream, PluralForm& pluralForm)
 {
-    return readFromStream(stream, pluralForm.pluralUnits);
+    if (!(readFromStream(stream, pluralForm.pluralUnits) && readFromStream(stream, varLength(pluralForm.pickPeriod)) &&
+        readVarLengthVector(stream, pluralForm.pickTable))) return false;
+    
+    if (pluralForm.pickPeriod > pluralForm.pickTable.size()) return false;
+    for (auto i : pluralForm.pickTable)
+        if (i > pluralForm.pluralUnits.size()) return false;
+    
+    if (pluralForm.pickPeriod == 0) pluralForm.buildPickCache();
+    return true;
 }
 
 bool readPterms(sf::InputStream& stream, std::vector<Pterm>& pterms, const std::vector<PluralForm>& pluralForms)
@@ -95,16 +153,6 @@ bool readPterms(sf::InputStream& stream, std::vector<Pterm>& pterms, const std::
     return true;
 }
 
-static bool readVarLengthVector(sf::InputStream& stream, std::vector<size_t>& vec)
-{
-    size_t size;
-    if (!readFromStream(stream, varLength(size))) return false;
-    
-    vec.resize(size);
-    for (auto& v : vec) if (!readFromStream(stream, varLength(v))) return false;
-    return true;
-}
-
 bool readFromStream(sf::InputStream& stream, Vterm& vterm)
 {
     size_t size;
@@ -144,18 +192,79 @@ bool readFromStream(sf::InputStream& stream, LanguageDescriptor& descriptor)
 {
     return checkMagic(stream, "LANG") &&
         readFromStream(stream, descriptor.name, descriptor.posixLocale, descriptor.windowsLocale,
-            descriptor.fontName, descriptor.fontSizeFactorRTL, descriptor.strings,
-            descriptor.formatters, descriptor.pluralForms) &&
+            descriptor.fontName, descriptor.fontSizeFactorRTL) &&
+            readStringTable(stream, descriptor) && readFormatterTable(stream, descriptor) &&
+            readFromStream(stream, descriptor.pluralForms) &&
             readPterms(stream, descriptor.pterms, descriptor.pluralForms) &&
             readFromStream(stream, descriptor.vterms, descriptor.pvterms);
 }
 
+size_t LangIDTable::find(LangID id) const
+{
+    if (keys.empty()) return npos;
+    
+    auto hash = id.getHash();
+    auto displacement = displacements[util::perfectHashBucket(hash, displacements.size())];
+    auto slot = util::perfectHashSlot(hash, displacement, keys.size());
+    return keys[slot] == id ? slot : npos;
+}
+
+const LangString* LanguageDescriptor::findString(LangID id) const
+{
+    auto slot = stringIDs.find(id);
+    return slot == LangIDTable::npos ? nullptr : &strings[slot];
+}
+
+const Formatter* LanguageDescriptor::findFormatter(LangID id) const
+{
+    auto slot = formatterIDs.find(id);
+    return slot == LangIDTable::npos ? nullptr : &formatters[slot];
+}
+
+bool Formatter::compile()
+{
+    segments.clear();
+    segments.reserve(specifiers.size() + 1);
+    
+    size_t offset = 0;
+    for (const auto& specifier : specifiers)
+    {
+        if (specifier.byteLocation < offset || specifier.byteLocation > modelString.size())
+            return false;
+        
+        segments.push_back({ offset, specifier.byteLocation - offset });
+        offset = specifier.byteLocation;
+    }
+    
+    segments.push_back({ offset, modelString.size() - offset });
+    return true;
+}
+
+void PluralForm::buildPickCache()
+{
+    pickTable.clear();
+    pickTable.reserve(CachedPicks);
+    pickPeriod = 0;
+    
+    for (size_t x = 0; x < CachedPicks; x++)
+    {
+        size_t i;
+        for (i = 0; i < pluralUnits.size(); i++)
+            if (runExpression(pluralUnits.at(i), x)) break;
+        pickTable.push_back(i);
+    }
+}
+
 size_t PluralForm::pick(size_t x) const
 {
+    if (x < pickTable.size()) return pickTable[x];
+    if (pickPeriod != 0)
+        return pickTable[pickTable.size() - pickPeriod + (x - pickTable.size()) % pickPeriod];
+    
     size_t i;
     for (i = 0; i < pluralUnits.size(); i++)
     {
-        if (runExpression(pluralUnits.at(i), x))
+        if (runExpression(pluralUnits[i], x))
             break;
     }
     
@@ -24,6 +24,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_set>
 #include <unordered_map>
@@ -35,7 +36,7 @@
 
 struct LangString final
 {
-    std::string string;
+    size_t offset, length;
     std::unordered_map<size_t,size_t> vcategoryAssociations;
     
     std::vector<size_t> typesForVariantCategories(const std::vector<size_t>& categories) const;
@@ -51,14 +52,33 @@ struct Formatter final
         size_t term;
     };
     
+    // The model string split around the specifiers: segment i is the text
+    // written before specifier i, and the last one is the trailing text
+    struct Segment
+    {
+        size_t offset, length;
+    };
+    
     std::string modelString;
     std::vector<Specifier> specifiers;
+    std::vector<Segment> segments;
+    
+    bool compile();
 };
 
+// pickTable holds the unit each x below its size picks, precomputed by export-language;
+// when pickPeriod is not zero, larger x repeat its last pickPeriod entries, otherwise the
+// rules are interpreted past the first CachedPicks numbers
 struct PluralForm final
 {
+    static constexpr size_t CachedPicks = 128;
+    
     std::vector<ExpressionCommands> pluralUnits;
+    std::vector<size_t> pickTable;
+    size_t pickPeriod;
+    
     size_t pick(size_t x) const;
+    void buildPickCache();
 };
 
 struct Pterm final
@@ -93,25 +113,48 @@ struct Pvterm final
     std::vector<Variant> variants;
 };
 
+// Minimal perfect hash over the ids of a table, built by export-language;
+// the stored keys reject ids that are not in the table
+struct LangIDTable final
+{
+    static constexpr size_t npos = (size_t)-1;
+    
+    std::vector<uint32_t> displacements;
+    std::vector<LangID> keys;
+    
+    size_t find(LangID id) const;
+};
+
 struct LanguageDescriptor final
 {
     std::string name, posixLocale, windowsLocale, fontName;
     float fontSizeFactorRTL;
     
-    std::unordered_map<LangID,LangString> strings;
-    std::unordered_map<LangID,Formatter> formatters;
+    std::string stringData;
+    LangIDTable stringIDs, formatterIDs;
+    std::vector<LangString> strings;
+    std::vector<Formatter> formatters;
     
     std::vector<PluralForm> pluralForms;
     std::vector<Pterm> pterms;
     std::vector<Vterm> vterms;
     std::vector<Pvterm> pvterms;
     
+    const LangString* findString(LangID id) const;
+    const Formatter* findFormatter(LangID id) const;
+    std::string_view getString(const LangString& string) const
+    {
+        return std::string_view(stringData.data() + string.offset, string.length);
+    }
+    
     float getFontSizeFactor() const { return fabsf(fontSizeFactorRTL); }
     bool isRTL() const { return fontSizeFactorRTL < 0; }
 };
 
 bool readFromStream(sf::InputStream& stream, LangString& string);
 bool readFromStream(sf::InputStream& stream, Formatter& formatter);
+bool readStringTable(sf::InputStream& stream, LanguageDescriptor& descriptor);
+bool readFormatterTable(sf::InputStream& stream, LanguageDescriptor& descriptor);
 bool readFromStream(sf::InputStream& stream, PluralForm& pluralForm);
 bool readPterms(sf::InputStream& stream, std::vector<Pterm>& pterms, const std::vector<PluralForm>& pluralForms);
 bool readFromStream(sf::InputStream& stream, Vterm& vterm);
@@ -23,28 +23,39 @@
 
 #include "LocalizationManager.hpp"
 #include <SFML/System.hpp>
+#include <algorithm>
+#include <charconv>
+#include <type_traits>
+#include <cstdio>
 
 constexpr auto DefaultLanguageDescriptor = "en-us.lang";
-constexpr auto DefaultFontName = "mplus-1m-medium.ttf";
+constexpr auto DefaultFontName = "mplus-1m-medium.sdf";
+
+std::string formatLangID(const LangID& id)
+{
+    char buffer[24];
+    snprintf(buffer, sizeof(buffer), "#%016llx", (unsigned long long)id.getHash());
+    return buffer;
+}
 
 auto buildErrorForString(const LangID& id)
 {
-    return "!!! STRING " + id + " NOT FOUND IN DESCRIPTOR !!!";
+    return "!!! STRING " + formatLangID(id) + " NOT FOUND IN DESCRIPTOR !!!";
 }
 
 auto buildErrorForFormatter(const LangID& id)
 {
-    return "!!! FORMATTER " + id + " NOT FOUND IN DESCRIPTOR !!!";
+    return "!!! FORMATTER " + formatLangID(id) + " NOT FOUND IN DESCRIPTOR !!!";
 }
 
 auto buildErrorForStringSpecifier(const LangID& id)
 {
-    return "!!! STRING SPECIFIER " + id + " NOT PASSED AS PARAMETER !!!";
+    return "!!! STRING SPECIFIER " + formatLangID(id) + " NOT PASSED AS PARAMETER !!!";
 }
 
 auto buildErrorForNumberSpecifier(const LangID& id)
 {
-    return "!!! NUMBER SPECIFIER " + id + " NOT PASSED AS PARAMETER !!!";
+    return "!!! NUMBER SPECIFIER " + formatLangID(id) + " NOT PASSED AS PARAMETER !!!";
 }
 
 auto buildErrorForNumberPterm(size_t x)
@@ -54,7 +65,7 @@ auto buildErrorForNumberPterm(size_t x)
 
 auto buildErrorForStringVariant(const LangID& id)
 {
-    return "!!! STRING " + id + " DON'T HAVE ALL NECESSARY VARIANTS !!!";
+    return "!!! STRING " + formatLangID(id) + " DON'T HAVE ALL NECESSARY VARIANTS !!!";
 }
 
 std::string getPathOfLanguageDescriptor(std::string name)
@@ -98,15 +109,14 @@ std::string getLanguageDescriptorName(std::string lang)
         !readFromStream(file, languageDescriptor))
         return "";
 
-    auto it = languageDescriptor.strings.find("metadata-english-name");
-    if (it == languageDescriptor.strings.end())
-        return "Unknown Language";
+    auto english = languageDescriptor.findString("metadata-english-name");
+    if (!english) return "Unknown Language";
 
-    auto it2 = languageDescriptor.strings.find("metadata-native-name");
-    if (it2 == languageDescriptor.strings.end())
-        return it->second.string;
+    std::string englishName(languageDescriptor.getString(*english));
+    auto native = languageDescriptor.findString("metadata-native-name");
+    if (!native) return englishName;
 
-    return it2->second.string + " / " + it->second.string;
+    return std::string(languageDescriptor.getString(*native)) + " / " + englishName;
 }
 
 void LocalizationManager::loadLanguageDescriptor(std::string name)
@@ -121,19 +131,95 @@ void LocalizationManager::loadLanguageDescriptor(std::string name)
             !readFromStream(file, languageDescriptor))
             error = true;
     }
+    
+    formatMemoIndex.clear();
+    formatMemo.clear();
 
     for (auto& callback : languageChangeCallbacks) callback();
 }
 
-std::string LocalizationManager::getString(const LangID& id) const
+std::string_view LocalizationManager::getString(const LangID& id) const
 {
-    if (error) return "";
+    if (error) return {};
+    
+    if (auto string = languageDescriptor.findString(id))
+        return languageDescriptor.getString(*string);
     
-    auto it = languageDescriptor.strings.find(id);
-    if (it != languageDescriptor.strings.end())
-        return it->second.string;
+    if (!descriptorDebug) return {};
+    return debugStrings.try_emplace(id, buildErrorForString(id)).first->second;
+}
+
+template <typename Map>
+static auto findArgument(const Map& map, const LangID& id) -> const typename Map::mapped_type*
+{
+    auto it = map.find(id);
+    return it == map.end() ? nullptr : &it->second;
+}
+
+template <typename T>
+static void appendKeyBytes(std::string& key, const T& value)
+{
+    key.append((const char*)&value, sizeof(T));
+}
+
+// resolve(specifier, value) looks up one argument, where value is the std::optional<std::string_view>,
+// const LangID* or const size_t* slot to fill; it is left untouched if the argument was not passed
+template <typename Resolve>
+void LocalizationManager::resolveArguments(const LangID& id, const Formatter& formatter, Resolve resolve) const
+{
+    formatArguments.assign(formatter.specifiers.size(), FormatArgument());
+    formatKey.clear();
+    appendKeyBytes(formatKey, id.getHash());
     
-    return descriptorDebug ? buildErrorForString(id) : "";
+    for (size_t i = 0; i < formatter.specifiers.size(); i++)
+    {
+        const auto& specifier = formatter.specifiers[i];
+        auto& argument = formatArguments[i];
+        
+        switch (specifier.type)
+        {
+            case Formatter::Specifier::Type::String:
+                resolve(specifier.specifier1, argument.raw);
+                if (!argument.raw) resolve(specifier.specifier1, argument.string);
+                break;
+                
+            case Formatter::Specifier::Type::Number:
+            case Formatter::Specifier::Type::Pterm:
+                resolve(specifier.specifier1, argument.number);
+                break;
+                
+            case Formatter::Specifier::Type::Vterm:
+                resolve(specifier.specifier1, argument.string);
+                break;
+                
+            case Formatter::Specifier::Type::Pvterm:
+                resolve(specifier.specifier1, argument.number);
+                resolve(specifier.specifier2, argument.string);
+                break;
+        }
+        
+        // Every field is tagged and sized, so different arguments never share a key
+        if (argument.raw)
+        {
+            formatKey += 'r';
+            appendKeyBytes(formatKey, argument.raw->size());
+            formatKey += *argument.raw;
+        }
+        
+        if (argument.string)
+        {
+            formatKey += 's';
+            appendKeyBytes(formatKey, argument.string->getHash());
+        }
+        
+        if (argument.number)
+        {
+            formatKey += 'n';
+            appendKeyBytes(formatKey, *argument.number);
+        }
+        
+        formatKey += '|';
+    }
 }
 
 std::string LocalizationManager::getFormattedString(const LangID& id, const StringSpecifierMap &stringSpecifiers,
@@ -141,11 +227,77 @@ std::string LocalizationManager::getFormattedString(const LangID& id, const Stri
 {
     if (error) return "";
     
-    auto it = languageDescriptor.formatters.find(id);
-    if (it != languageDescriptor.formatters.end())
-        return buildFormat(id, stringSpecifiers, numberSpecifiers, rawSpecifiers);
+    auto formatter = languageDescriptor.findFormatter(id);
+    if (!formatter) return descriptorDebug ? buildErrorForFormatter(id) : "";
     
-    return descriptorDebug ? buildErrorForFormatter(id) : "";
+    resolveArguments(id, *formatter, [&](const LangID& specifier, auto& value)
+    {
+        using Value = std::decay_t<decltype(value)>;
+        if constexpr (std::is_same_v<Value, std::optional<std::string_view>>)
+        {
+            if (auto raw = findArgument(rawSpecifiers, specifier)) value = *raw;
+        }
+        else if constexpr (std::is_same_v<Value, const LangID*>) value = findArgument(stringSpecifiers, specifier);
+        else value = findArgument(numberSpecifiers, specifier);
+    });
+    
+    return std::string(formatResolved(*formatter));
+}
+
+std::string_view LocalizationManager::getFormattedString(const LangID& id,
+    std::initializer_list<SpecifierArgument> arguments) const
+{
+    if (error) return {};
+    
+    auto formatter = languageDescriptor.findFormatter(id);
+    if (!formatter)
+    {
+        if (!descriptorDebug) return {};
+        return formatBuffer = buildErrorForFormatter(id);
+    }
+    
+    resolveArguments(id, *formatter, [&](const LangID& specifier, auto& value)
+    {
+        using Value = std::decay_t<decltype(value)>;
+        for (const auto& argument : arguments)
+        {
+            if (argument.specifier != specifier) continue;
+            
+            if constexpr (std::is_same_v<Value, std::optional<std::string_view>>)
+            {
+                if (argument.type == SpecifierArgument::Type::Raw) value = argument.raw;
+            }
+            else if constexpr (std::is_same_v<Value, const LangID*>)
+            {
+                if (argument.type == SpecifierArgument::Type::String) value = &argument.string;
+            }
+            else if (argument.type == SpecifierArgument::Type::Number) value = &argument.number;
+        }
+    });
+    
+    return formatResolved(*formatter);
+}
+
+std::string_view LocalizationManager::formatResolved(const Formatter& formatter) const
+{
+    auto it = formatMemoIndex.find(formatKey);
+    if (it != formatMemoIndex.end())
+    {
+        formatMemo.splice(formatMemo.begin(), formatMemo, it->second);
+        return it->second->second;
+    }
+    
+    buildFormat(formatter);
+    
+    if (formatMemo.size() >= FormatMemoCapacity)
+    {
+        formatMemoIndex.erase(formatMemo.back().first);
+        formatMemo.pop_back();
+    }
+    
+    formatMemo.emplace_front(formatKey, formatBuffer);
+    formatMemoIndex.emplace(formatMemo.front().first, formatMemo.begin());
+    return formatMemo.front().second;
 }
 
 float LocalizationManager::getFontSizeFactor() const
@@ -160,159 +312,147 @@ bool LocalizationManager::isRTL() const
     return languageDescriptor.isRTL();
 }
 
-std::string LocalizationManager::buildFormat(const LangID& id, const StringSpecifierMap &stringSpecifiers,
-    const NumberSpecifierMap& numberSpecifiers, const RawSpecifierMap& rawSpecifiers) const
+void LocalizationManager::buildFormat(const Formatter& formatter) const
 {
-    const auto& formatter = languageDescriptor.formatters.at(id);
+    formatBuffer.clear();
     
-    size_t addedBytes = 0;
-    std::string builtString = formatter.modelString;
+    for (size_t i = 0; i < formatter.specifiers.size(); i++)
+    {
+        const auto& segment = formatter.segments[i];
+        formatBuffer.append(formatter.modelString, segment.offset, segment.length);
+        appendReplacement(formatter.specifiers[i], formatArguments[i]);
+    }
     
-    for (const auto& specifier : formatter.specifiers)
+    const auto& tail = formatter.segments.back();
+    formatBuffer.append(formatter.modelString, tail.offset, tail.length);
+}
+
+void LocalizationManager::appendReplacement(const Formatter::Specifier& specifier, const FormatArgument& argument) const
+{
+    switch (specifier.type)
     {
-        std::string replacement;
+        case Formatter::Specifier::Type::String:
+        {
+            if (argument.raw) formatBuffer += *argument.raw;
+            else if (argument.string) formatBuffer += getString(*argument.string);
+            else if (descriptorDebug) formatBuffer += buildErrorForStringSpecifier(specifier.specifier1);
+        } break;
         
-        switch (specifier.type)
+        case Formatter::Specifier::Type::Number:
         {
-            case Formatter::Specifier::Type::String:
+            if (!argument.number)
             {
-                auto it = stringSpecifiers.find(specifier.specifier1);
-                auto it2 = rawSpecifiers.find(specifier.specifier1);
-                if (it == stringSpecifiers.end() && it2 == rawSpecifiers.end())
-                {
-                    replacement = descriptorDebug ? buildErrorForStringSpecifier(specifier.specifier1) : "";
-                    break;
-                }
-
-                if (it2 == rawSpecifiers.end())
-                    replacement = getString(it->second);
-                else replacement = it2->second;
-            } break;
+                if (descriptorDebug) formatBuffer += buildErrorForStringSpecifier(specifier.specifier1);
+                break;
+            }
             
-            case Formatter::Specifier::Type::Number:
+            char digits[24];
+            auto result = std::to_chars(digits, digits + sizeof(digits), *argument.number);
+            formatBuffer.append(digits, result.ptr);
+        } break;
+        
+        case Formatter::Specifier::Type::Pterm:
+        {
+            if (!argument.number)
             {
-                auto it = numberSpecifiers.find(specifier.specifier1);
-                if (it == numberSpecifiers.end())
-                {
-                    replacement = descriptorDebug ? buildErrorForStringSpecifier(specifier.specifier1) : "";
-                    break;
-                }
-                
-                replacement = std::to_string(it->second);
-            } break;
+                if (descriptorDebug) formatBuffer += buildErrorForStringSpecifier(specifier.specifier1);
+                break;
+            }
             
-            case Formatter::Specifier::Type::Pterm:
+            size_t x = *argument.number;
+            const auto& pterm = languageDescriptor.pterms.at(specifier.term);
+            const auto& pluralForm = languageDescriptor.pluralForms.at(pterm.category);
+
+            size_t i = pluralForm.pick(x);
+            if (i == pluralForm.pluralUnits.size())
             {
-                auto it = numberSpecifiers.find(specifier.specifier1);
-                if (it == numberSpecifiers.end())
-                {
-                    replacement = descriptorDebug ? buildErrorForStringSpecifier(specifier.specifier1) : "";
-                    break;
-                }
-                
-                size_t x = it->second;
-                const auto& pterm = languageDescriptor.pterms.at(specifier.term);
-                const auto& pluralForm = languageDescriptor.pluralForms.at(pterm.category);
-
-                size_t i = pluralForm.pick(x);
-                if (i == pluralForm.pluralUnits.size())
-                {
-                    replacement = descriptorDebug ? buildErrorForNumberPterm(x) : "";
-                    break;
-                }
-                
-                replacement = pterm.variants.at(i);
-            } break;
+                if (descriptorDebug) formatBuffer += buildErrorForNumberPterm(x);
+                break;
+            }
             
-            case Formatter::Specifier::Type::Vterm:
+            formatBuffer += pterm.variants.at(i);
+        } break;
+        
+        case Formatter::Specifier::Type::Vterm:
+        {
+            if (!argument.string)
             {
-                auto it = stringSpecifiers.find(specifier.specifier1);
-                if (it == stringSpecifiers.end())
-                {
-                    replacement = descriptorDebug ? buildErrorForStringSpecifier(specifier.specifier1) : "";
-                    break;
-                }
-                
-                auto id = it->second;
-
-                auto it2 = languageDescriptor.strings.find(id);
-                if (it2 == languageDescriptor.strings.end())
-                {
-                    replacement = descriptorDebug ? buildErrorForString(id) : "";
-                    break;
-                }
-                
-                const auto& vterm = languageDescriptor.vterms.at(specifier.term);
-                auto types = it2->second.typesForVariantCategories(vterm.categories);
-                
-                if (types.empty())
-                {
-                    replacement = descriptorDebug ? buildErrorForStringVariant(id) : "";
-                    break;
-                }
-                
-                auto it3 = std::find_if(vterm.variants.begin(), vterm.variants.end(),
-                [&] (const auto& variant) { return variant.types == types; });
-                
-                replacement = it3->string;
-            } break;
+                if (descriptorDebug) formatBuffer += buildErrorForStringSpecifier(specifier.specifier1);
+                break;
+            }
             
-            case Formatter::Specifier::Type::Pvterm:
+            auto id = *argument.string;
+
+            auto string = languageDescriptor.findString(id);
+            if (!string)
             {
-                auto it = numberSpecifiers.find(specifier.specifier1);
-                if (it == numberSpecifiers.end())
-                {
-                    replacement = descriptorDebug ? buildErrorForStringSpecifier(specifier.specifier1) : "";
-                    break;
-                }
-                
-                size_t x = it->second;
-                
-                auto it2 = stringSpecifiers.find(specifier.specifier2);
-                if (it2 == stringSpecifiers.end())
-                {
-                    replacement = descriptorDebug ? buildErrorForStringSpecifier(specifier.specifier2) : "";
-                    break;
-                }
-                
-                auto id = it2->second;
-
-                auto it3 = languageDescriptor.strings.find(id);
-                if (it3 == languageDescriptor.strings.end())
-                {
-                    replacement = descriptorDebug ? buildErrorForString(id) : "";
-                    break;
-                }
-                
-                const auto& pvterm = languageDescriptor.pvterms.at(specifier.term);
-                const auto& pluralForm = languageDescriptor.pluralForms.at(pvterm.pcategory);
-
-                size_t i = pluralForm.pick(x);
-                if (i == pluralForm.pluralUnits.size())
-                {
-                    replacement = descriptorDebug ? buildErrorForNumberPterm(x) : "";
-                    break;
-                }
-                
-                auto types = it3->second.typesForVariantCategories(pvterm.vcategories);
-                if (types.empty())
-                {
-                    replacement = descriptorDebug ? buildErrorForStringVariant(id) : "";
-                    break;
-                }
-                
-                auto it4 = std::find_if(pvterm.variants.begin(), pvterm.variants.end(),
-                [&] (const auto& variant) { return variant.ptype == i && variant.vtypes == types; });
-                
-                replacement = it4->string;
-            } break;
-        }
+                if (descriptorDebug) formatBuffer += buildErrorForString(id);
+                break;
+            }
+            
+            const auto& vterm = languageDescriptor.vterms.at(specifier.term);
+            auto types = string->typesForVariantCategories(vterm.categories);
+            
+            if (types.empty())
+            {
+                if (descriptorDebug) formatBuffer += buildErrorForStringVariant(id);
+                break;
+            }
+            
+            auto it = std::find_if(vterm.variants.begin(), vterm.variants.end(),
+            [&] (const auto& variant) { return variant.types == types; });
+            
+            formatBuffer += it->string;
+        } break;
         
-        builtString.insert(addedBytes + specifier.byteLocation, replacement);
-        addedBytes += replacement.size();
+        case Formatter::Specifier::Type::Pvterm:
+        {
+            if (!argument.number)
+            {
+                if (descriptorDebug) formatBuffer += buildErrorForStringSpecifier(specifier.specifier1);
+                break;
+            }
+            
+            size_t x = *argument.number;
+            
+            if (!argument.string)
+            {
+                if (descriptorDebug) formatBuffer += buildErrorForStringSpecifier(specifier.specifier2);
+                break;
+            }
+            
+            auto id = *argument.string;
+
+            auto string = languageDescriptor.findString(id);
+            if (!string)
+            {
+                if (descriptorDebug) formatBuffer += buildErrorForString(id);
+                break;
+            }
+            
+            const auto& pvterm = languageDescriptor.pvterms.at(specifier.term);
+            const auto& pluralForm = languageDescriptor.pluralForms.at(pvterm.pcategory);
+
+            size_t i = pluralForm.pick(x);
+            if (i == pluralForm.pluralUnits.size())
+            {
+                if (descriptorDebug) formatBuffer += buildErrorForNumberPterm(x);
+                break;
+            }
+            
+            auto types = string->typesForVariantCategories(pvterm.vcategories);
+            if (types.empty())
+            {
+                if (descriptorDebug) formatBuffer += buildErrorForStringVariant(id);
+                break;
+            }
+            
+            auto it = std::find_if(pvterm.variants.begin(), pvterm.variants.end(),
+            [&] (const auto& variant) { return variant.ptype == i && variant.vtypes == types; });
+            
+            formatBuffer += it->string;
+        } break;
     }
-    
-    return builtString;
 }
 
 std::string LocalizationManager::getFontName() const
@@ -25,8 +25,12 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
 #include <set>
 #include <list>
+#include <optional>
+#include <initializer_list>
+#include <cstdint>
 #include <unordered_map>
 #include <functional>
 #include <ContainerEntry.hpp>
@@ -39,6 +43,19 @@ using StringSpecifierMap = std::unordered_map<LangID,LangID>;
 using RawSpecifierMap = std::unordered_map<LangID,std::string>;
 using NumberSpecifierMap = std::unordered_map<LangID,size_t>;
 
+// A single specifier argument, for formatting without building the specifier maps
+struct SpecifierArgument
+{
+    enum class Type : uint8_t { String, Number, Raw } type;
+    LangID specifier, string;
+    size_t number;
+    std::string_view raw;
+
+    static SpecifierArgument fromString(LangID specifier, LangID id) { return { Type::String, specifier, id, 0, {} }; }
+    static SpecifierArgument fromNumber(LangID specifier, size_t x) { return { Type::Number, specifier, {}, x, {} }; }
+    static SpecifierArgument fromRaw(LangID specifier, std::string_view str) { return { Type::Raw, specifier, {}, 0, str }; }
+};
+
 class LocalizationManager final
 {
 public:
@@ -50,6 +67,25 @@ private:
     bool descriptorDebug, error;
     LanguageDescriptor languageDescriptor;
     CallbackList languageChangeCallbacks;
+    mutable std::unordered_map<LangID,std::string> debugStrings;
+    
+    // What each specifier of the formatter being built resolved to
+    struct FormatArgument
+    {
+        std::optional<std::string_view> raw;
+        const LangID* string = nullptr;
+        const size_t* number = nullptr;
+    };
+    
+    // Formatted strings are memoized by formatter id and arguments, most
+    // recently used first, and dropped whenever the language changes
+    using FormatMemo = std::list<std::pair<std::string,std::string>>;
+    static constexpr size_t FormatMemoCapacity = 256;
+    
+    mutable std::vector<FormatArgument> formatArguments;
+    mutable std::string formatKey, formatBuffer;
+    mutable FormatMemo formatMemo;
+    mutable std::unordered_map<std::string_view,FormatMemo::iterator> formatMemoIndex;
     
 public:
     LocalizationManager(bool debug = false) : descriptorDebug(debug), error(true) {}
@@ -57,9 +93,12 @@ public:
     
     void loadLanguageDescriptor(std::string name);
     
-    std::string getString(const LangID& id) const;
+    std::string_view getString(const LangID& id) const;
     std::string getFormattedString(const LangID& id, const StringSpecifierMap &stringSpecifiers,
         const NumberSpecifierMap& numberSpecifiers, const RawSpecifierMap& rawSpecifiers) const;
+
+    // The returned view points into the memo, so it is only valid until the next formatting or language change
+    std::string_view getFormattedString(const LangID& id, std::initializer_list<SpecifierArgument> arguments) const;
         
     std::string getFontName() const;
         
@@ -69,8 +108,11 @@ public:
     CallbackEntry registerLanguageChangeCallback(Callback callback);
     
 private:
-    std::string buildFormat(const LangID& id, const StringSpecifierMap &stringSpecifiers,
-        const NumberSpecifierMap& numberSpecifiers, const RawSpecifierMap& rawSpecifiers) const;
+    template <typename Resolve>
+    void resolveArguments(const LangID& id, const Formatter& formatter, Resolve resolve) const;
+    std::string_view formatResolved(const Formatter& formatter) const;
+    void buildFormat(const Formatter& formatter) const;
+    void appendReplacement(const Formatter::Specifier& specifier, const FormatArgument& argument) const;
 };
 
 std::set<std::string> getAllLanguageDescriptors();
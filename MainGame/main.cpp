@@ -35,6 +35,7 @@
 #include "scene/Scene.hpp"
 #include "resources/ResourceManager.hpp"
 #include "resources/FilesystemResourceLocator.hpp"
+#include "resources/PackResourceLocator.hpp"
 #include "drawables/Tilemap.hpp"
 #include "scene/SceneManager.hpp"
 #include "scene/GameScene.hpp"
@@ -46,13 +47,18 @@
 #include "language/LanguageDescriptor.hpp"
 #include "language/KeyboardKeyName.hpp"
 #include "audio/AudioManager.hpp"
+#include "gameplay/SaveService.hpp"
 #include "Services.hpp"
+#include "profiler/Profiler.hpp"
+#include "profiler/ProfilerOverlay.hpp"
+#include <execDir.hpp>
 
 #include "scene/TitleScene.hpp"
 
 #include <chronoUtils.hpp>
 
 #define DEBUG_STEADY 0
+#define DEBUG_RENDER_STATS 0
 
 using namespace std::literals::chrono_literals;
 
@@ -76,14 +82,23 @@ int main(int argc, char **argv)
     InputManager inputManager;
 
     ResourceManager resourceManager;
-    resourceManager.setResourceLocator(new FilesystemResourceLocator());
+    try
+    {
+        resourceManager.setResourceLocator(new PackResourceLocator());
+    }
+    catch (const PackFileError&)
+    {
+        resourceManager.setResourceLocator(new FilesystemResourceLocator());
+    }
     
     LocalizationManager localizationManager(true);
     localizationManager.loadLanguageDescriptor(settings.languageFile);
 
     AudioManager audioManager;
 
-    Services services { audioManager, inputManager, localizationManager, resourceManager, settings };
+    SaveService saveService;
+
+    Services services { audioManager, inputManager, localizationManager, resourceManager, saveService, settings };
 
     auto scene = new TitleScene(services);
     
@@ -92,12 +107,33 @@ int main(int argc, char **argv)
     SceneManager sceneManager;
     sceneManager.pushScene(scene);
 
+#if PROFILER_ENABLED
+    PROFILE_THREAD("Main");
+    ProfilerOverlay profilerOverlay(resourceManager);
+#endif
+
     while (windowHandler.getWindow().isOpen())
     {
+        PROFILE_FRAME();
         sf::Event event;
 
         while (windowHandler.getWindow().pollEvent(event))
         {
+#if PROFILER_ENABLED
+            // F3 toggles the overlay, F4 dumps the recorded events next to the executable
+            if (event.type == sf::Event::EventType::KeyPressed && event.key.code == sf::Keyboard::F3)
+            {
+                profilerOverlay.toggle();
+                continue;
+            }
+            if (event.type == sf::Event::EventType::KeyPressed && event.key.code == sf::Keyboard::F4)
+            {
+                auto filename = getExecutableDirectory() + "/profile.json";
+                if (profiler::writeChromeTrace(filename)) std::cout << "Profile written to " << filename << std::endl;
+                else std::cout << "WARNING! Could not write the profile to " << filename << std::endl;
+                continue;
+            }
+#endif
             if (inputManager.handleEvent(event)) continue;
             switch (event.type)
             {
@@ -140,13 +176,27 @@ int main(int argc, char **argv)
 
         windowHandler.prepareForDraw();
         sceneManager.render(windowHandler.getRenderer());
+#if PROFILER_ENABLED
+        profilerOverlay.update();
+        profilerOverlay.render(windowHandler.getRenderer());
+#endif
         windowHandler.display();
 
+#if DEBUG_RENDER_STATS
+        const auto& stats = windowHandler.getRenderer().getLastFrameStats();
+        std::cout << "Render: " << stats.commandCount << " commands, " << stats.drawCallCount << " draw calls, "
+            << stats.batchCount << " batches (" << stats.batchedCommandCount << " commands batched)" << std::endl;
+#endif
+
         audioManager.update();
     }
 
     clearMapTextures();
 
+    // the keys of saves still being written only reach the settings through their callbacks
+    saveService.waitForPendingSaves();
+    saveService.update();
+
     if (!storeSettingsFile(settings))
         std::cout << "WARNING! Settings file not stored properly!" << std::endl;
 
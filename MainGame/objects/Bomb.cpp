@@ -27,7 +27,7 @@
 #include "scene/GameScene.hpp"
 #include "rendering/Renderer.hpp"
 #include "resources/ResourceManager.hpp"
-#include "particles/ParticleBatch.hpp"
+#include "particles/ParticleSystem.hpp"
 
 #include "objects/Player.hpp"
 
@@ -46,7 +46,7 @@ Bomb::Bomb(GameScene& scene, cpVect pos, FrameTime initialTime)
 
 Bomb::~Bomb()
 {
-    auto player = gameScene.getObjectByName<Player>("player");
+    auto player = gameScene.getPlayer();
     if (player) player->numBombs++;
 }
 
@@ -63,9 +63,8 @@ void Bomb::update(FrameTime curTime)
 
 void Bomb::detonate()
 {
-    auto batch = std::make_unique<ParticleBatch>(gameScene, "player-particles.pe", "bomb");
-    batch->setPosition(getDisplayPosition());
-    gameScene.addObject(std::move(batch));
+    auto batch = gameScene.getParticleSystem().spawn("player-particles.pe", "bomb");
+    batch.setPosition(getDisplayPosition());
 
     gameScene.playSound("bomb-detonate.wav");
 
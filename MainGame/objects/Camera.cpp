@@ -37,7 +37,7 @@ void Camera::update(FrameTime curTime)
 {
     this->curTime = curTime;
     
-    auto player = gameScene.getObjectByName<Player>("player");
+    auto player = gameScene.getPlayer();
     if (player)
     {
         position = player->getDisplayPosition();
@@ -37,8 +37,8 @@ void Collectible::setupCollisionHandlers(Space* space)
         space->addCollisionHandler(Player::CollisionType, CollisionType,
             [](Arbiter arbiter, Space&)
             {
-                auto player = static_cast<Player*>(cpBodyGetUserData(arbiter.getBodyA()));
-                auto collectible = static_cast<Collectible*>(cpBodyGetUserData(arbiter.getBodyB()));
+                auto player = static_cast<Player*>(Body::of(arbiter.getBodyA())->getUserData());
+                auto collectible = static_cast<Collectible*>(Body::of(arbiter.getBodyB())->getUserData());
                 collectible->onCollect(*player);
                 return false;
             }, [](Arbiter, Space&) { return false; }, [](Arbiter, Space&) {}, [](Arbiter, Space&) {});
@@ -27,6 +27,7 @@
 
 #include <cppmunk/Arbiter.h>
 #include <cppmunk/Space.h>
+#include <cppmunk/Shape.h>
 
 using namespace cp;
 
@@ -37,16 +38,16 @@ void Enemy::setupCollisionHandlers(Space* space)
     {
         auto attackHandler = [](Arbiter arbiter, Space& space)
         {
-            auto player = static_cast<Player*>(cpBodyGetUserData(arbiter.getBodyA()));
-            auto enemy = static_cast<Enemy*>(cpBodyGetUserData(arbiter.getBodyB()));
-            return enemy->onCollisionAttack(*player, space.findShape(arbiter.getShapeB()));
+            auto player = static_cast<Player*>(Body::of(arbiter.getBodyA())->getUserData());
+            auto enemy = static_cast<Enemy*>(Body::of(arbiter.getBodyB())->getUserData());
+            return enemy->onCollisionAttack(*player, *Shape::of(arbiter.getShapeB()));
         };
         
         auto hitHandler = [](Arbiter arbiter, Space& space)
         {
-            auto player = static_cast<Player*>(cpBodyGetUserData(arbiter.getBodyA()));
-            auto enemy = static_cast<Enemy*>(cpBodyGetUserData(arbiter.getBodyB()));
-            return enemy->onCollisionHit(*player, space.findShape(arbiter.getShapeB()));
+            auto player = static_cast<Player*>(Body::of(arbiter.getBodyA())->getUserData());
+            auto enemy = static_cast<Enemy*>(Body::of(arbiter.getBodyB())->getUserData());
+            return enemy->onCollisionHit(*player, *Shape::of(arbiter.getShapeB()));
         };
         
         auto groundStandHandler = [] (Arbiter arbiter, Space&)
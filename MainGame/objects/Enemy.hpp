@@ -47,8 +47,8 @@ public:
 
     void setupPhysics();
 
-    virtual bool onCollisionAttack(Player& player, std::shared_ptr<cp::Shape> shape) = 0;
-    virtual bool onCollisionHit(Player& player, std::shared_ptr<cp::Shape> shape) = 0;
+    virtual bool onCollisionAttack(Player& player, cp::Shape& shape) = 0;
+    virtual bool onCollisionHit(Player& player, cp::Shape& shape) = 0;
 
     auto getPosition() const { return collisionBody->getPosition(); }
     auto getDisplayPosition() const
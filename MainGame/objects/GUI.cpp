@@ -103,7 +103,7 @@ GUI::GUI(GameScene& scene) : gameScene(scene),
 void GUI::configureText()
 {
     auto& lm = gameScene.getLocalizationManager();
-    auto config = parseConfigString(lm.getString("ingame-gui-level-config"));
+    auto config = parseConfigString(std::string(lm.getString("ingame-gui-level-config")));
     
     levelLabel.setString(lm.getString("ingame-gui-level-label"));
     levelLabel.setFontSize(config.labelSize);
@@ -115,7 +115,7 @@ void GUI::configureText()
     configTextDrawable(levelLabel, lm);
     levelLabel.buildGeometry();
 
-    levelID.setString(lm.getFormattedString("ingame-gui-level-number", {}, { { "n", levelNumber } }, {}));
+    levelID.setString(lm.getFormattedString("ingame-gui-level-number", { SpecifierArgument::fromNumber("n", levelNumber) }));
     levelID.setFontSize(config.idSize);
     levelID.setDefaultColor(sf::Color::White);
     //levelLabel.setWordAlignment(TextDrawable::Alignment::Center);
@@ -131,7 +131,7 @@ void GUI::configureText()
         configTextDrawable(levelLabel, lm);
         levelLabel.buildGeometry();
 
-        levelID.setString(lm.getFormattedString("ingame-gui-level-number", {}, { { "n", levelNumber } }, {}));
+        levelID.setString(lm.getFormattedString("ingame-gui-level-number", { SpecifierArgument::fromNumber("n", levelNumber) }));
         configTextDrawable(levelID, lm);
         levelID.buildGeometry();
     });
@@ -146,7 +146,7 @@ void GUI::setLevelNumber(size_t number)
     guiMap.presentRoom(gameScene.getCurrentRoomID());
     
     auto& lm = gameScene.getLocalizationManager();
-    levelID.setString(lm.getFormattedString("ingame-gui-level-number", {}, { { "n", levelNumber } }, {}));
+    levelID.setString(lm.getFormattedString("ingame-gui-level-number", { SpecifierArgument::fromNumber("n", levelNumber) }));
     levelID.buildGeometry();
 }
 
@@ -166,7 +166,7 @@ void GUI::update(FrameTime curTime)
 {
     if (lastTime == decltype(lastTime)()) lastTime = curTime;
     
-    auto player = gameScene.getObjectByName<Player>("player");
+    auto player = gameScene.getPlayer();
     
     if (player)
     {
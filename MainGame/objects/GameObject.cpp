@@ -0,0 +1,68 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+
+#include "GameObject.hpp"
+#include "ObjectRegistry.hpp"
+
+#include <unordered_map>
+
+// the keys view into the owned strings, which never move
+static auto& getObjectNames()
+{
+    static std::unordered_map<std::string_view, std::unique_ptr<std::string>> objectNames;
+    return objectNames;
+}
+
+const std::string* internObjectName(std::string_view name)
+{
+    auto& objectNames = getObjectNames();
+
+    auto it = objectNames.find(name);
+    if (it != objectNames.end()) return it->second.get();
+
+    auto str = std::make_unique<std::string>(name);
+    auto ptr = str.get();
+    objectNames.emplace(*ptr, std::move(str));
+    return ptr;
+}
+
+const std::string* findObjectName(std::string_view name)
+{
+    auto& objectNames = getObjectNames();
+
+    auto it = objectNames.find(name);
+    return it != objectNames.end() ? it->second.get() : nullptr;
+}
+
+void GameObject::setName(std::string_view name)
+{
+    auto interned = internObjectName(name);
+    if (registry) registry->rename(*this, interned);
+    else this->name = interned;
+}
+
+GameObject::~GameObject()
+{
+    if (registry) registry->remove(*this);
+}
@@ -31,24 +31,37 @@
 #include <chronoUtils.hpp>
 #include <chronoUtils.hpp>
 #include <functional>
+#include <string>
+#include <string_view>
 #include <SFML/System.hpp>
 
 class GameScene;
 class Renderer;
+class ObjectRegistry;
+
+// Object names are interned, so the scene can index objects by the name's address;
+// findObjectName returns null for names no object was ever given
+const std::string* internObjectName(std::string_view name);
+const std::string* findObjectName(std::string_view name);
 
 class GameObject : util::non_copyable
 {
 protected:
     GameScene& gameScene;
-    std::string name;
 
+private:
+    const std::string* name;
+    ObjectRegistry* registry;
+    uint32_t registrySlot;
+
+protected:
     bool shouldRemove:1;
     bool isPersistent:1;
     bool transitionState:1;
 
 public:
-    GameObject(GameScene& scene) : gameScene(scene), shouldRemove(false), isPersistent(false), transitionState(false),
-        name() {}
+    GameObject(GameScene& scene) : gameScene(scene), name(internObjectName({})), registry(nullptr), registrySlot(0),
+        shouldRemove(false), isPersistent(false), transitionState(false) {}
     inline void remove() { shouldRemove = true; }
 
     virtual void update(FrameTime curTime) = 0;
@@ -56,12 +69,13 @@ public:
 
     virtual bool notifyScreenTransition(cpVect displacement) { return false; }
 
-    std::string getName() const { return name; }
-    void setName(std::string name) { this->name = name; }
+    const std::string& getName() const { return *name; }
+    void setName(std::string_view name);
 
-    virtual ~GameObject() {}
+    virtual ~GameObject();
 
     friend class GameScene;
+    friend class ObjectRegistry;
 
     static constexpr cpCollisionType Interactable = 'itbl';
     using InteractionHandler = std::function<void(uint32_t,void*)>;
@@ -63,11 +63,11 @@ std::unique_ptr<GameObject> createObjectFromDescriptor(GameScene& gameScene, con
 {
     if (SchwartzCounter == 0) return std::unique_ptr<GameObject>{};
 
-    auto it = factoryParams.find(descriptor.klass);
+    auto it = factoryParams.find(std::string(descriptor.klass));
 
     if (it == factoryParams.end())
         return std::unique_ptr<GameObject>{};
 
-    auto obj = it->second.factory(gameScene, descriptor.name, descriptor.parameters);
+    auto obj = it->second.factory(gameScene, std::string(descriptor.name), descriptor.parameters);
     return obj;
 }
@@ -34,7 +34,7 @@ InteractableObject::InteractableObject(GameScene& scene)
 
 void InteractableObject::update(FrameTime curTime)
 {
-    auto player = gameScene.getObjectByName<Player>("player");
+    auto player = gameScene.getPlayer();
 
     bool popup = false;
     if (active && player)
@@ -120,7 +120,7 @@ void MessageBox::display(Script& script, std::string text)
 
 void MessageBox::displayString(Script &script, const LangID &id)
 {
-    display(script, localizationManager.getString(id));
+    display(script, std::string(localizationManager.getString(id)));
 }
 
 void MessageBox::displayFormattedString(Script &script, const LangID &id, const StringSpecifierMap &stringSpecifiers,
@@ -0,0 +1,121 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+
+#include "ObjectRegistry.hpp"
+
+#include <algorithm>
+
+// Most objects are unnamed and never looked up by name; indexing them would put them all
+// in one bucket, and every removal would have to search it
+void ObjectRegistry::indexName(GameObject& object)
+{
+    if (object.name->empty()) return;
+    nameIndex[object.name].push_back(&object);
+}
+
+void ObjectRegistry::unindexName(GameObject& object)
+{
+    if (object.name->empty()) return;
+
+    auto it = nameIndex.find(object.name);
+    if (it == nameIndex.end()) return;
+
+    // keep the vector around even when it empties, so objects respawning with the same name don't allocate
+    auto& objects = it->second;
+    objects.erase(std::find(objects.begin(), objects.end(), &object));
+}
+
+void ObjectRegistry::add(GameObject& object)
+{
+    if (object.registry) object.registry->remove(object);
+
+    uint32_t index;
+    if (!freeSlots.empty())
+    {
+        index = freeSlots.back();
+        freeSlots.pop_back();
+        slots[index].object = &object;
+    }
+    else
+    {
+        index = slots.size();
+        slots.push_back(Slot{ &object, 1 });
+    }
+
+    object.registry = this;
+    object.registrySlot = index;
+    indexName(object);
+}
+
+void ObjectRegistry::remove(GameObject& object)
+{
+    if (object.registry != this) return;
+
+    unindexName(object);
+
+    auto& slot = slots[object.registrySlot];
+    slot.object = nullptr;
+    slot.generation++;
+    freeSlots.push_back(object.registrySlot);
+
+    object.registry = nullptr;
+}
+
+void ObjectRegistry::rename(GameObject& object, const std::string* name)
+{
+    if (object.registry != this)
+    {
+        object.name = name;
+        return;
+    }
+
+    unindexName(object);
+    object.name = name;
+    indexName(object);
+}
+
+void ObjectRegistry::clear()
+{
+    for (auto& slot : slots)
+    {
+        if (slot.object)
+        {
+            slot.object->registry = nullptr;
+            slot.object = nullptr;
+            slot.generation++;
+        }
+    }
+
+    freeSlots.clear();
+    for (uint32_t i = slots.size(); i > 0; i--) freeSlots.push_back(i-1);
+    for (auto& entry : nameIndex) entry.second.clear();
+}
+
+const std::vector<GameObject*>& ObjectRegistry::findAllByName(const std::string* name) const
+{
+    static const std::vector<GameObject*> NoObjects;
+
+    auto it = nameIndex.find(name);
+    return it == nameIndex.end() ? NoObjects : it->second;
+}
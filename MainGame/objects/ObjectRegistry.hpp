@@ -0,0 +1,111 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+
+#pragma once
+
+#include <non_copyable_movable.hpp>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "GameObject.hpp"
+
+class ObjectRegistry;
+
+// Generational reference to a GameObject living in the scene; unlike a raw pointer
+// it can be cached across frames, as it resolves to null once the object dies
+template <typename T>
+class ObjectHandle final
+{
+    const ObjectRegistry* registry;
+    uint32_t index, generation;
+
+public:
+    ObjectHandle() : registry(nullptr), index(0), generation(0) {}
+    ObjectHandle(const ObjectRegistry& registry, uint32_t index, uint32_t generation)
+        : registry(&registry), index(index), generation(generation) {}
+
+    T* get() const;
+    T* operator->() const { return get(); }
+    explicit operator bool() const { return get() != nullptr; }
+};
+
+// Slot table and name index of the objects currently in a scene; objects unregister themselves
+// when they are destroyed, so neither lookups nor handles can observe a dangling object
+class ObjectRegistry final : util::non_copyable
+{
+    struct Slot
+    {
+        GameObject* object;
+        uint32_t generation;
+    };
+
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    std::unordered_map<const std::string*, std::vector<GameObject*>> nameIndex;
+
+    void indexName(GameObject& object);
+    void unindexName(GameObject& object);
+
+public:
+    ObjectRegistry() {}
+    ~ObjectRegistry() { clear(); }
+
+    void add(GameObject& object);
+    void remove(GameObject& object);
+    void rename(GameObject& object, const std::string* name);
+    void clear();
+
+    GameObject* get(uint32_t index, uint32_t generation) const
+    {
+        return index < slots.size() && slots[index].generation == generation ? slots[index].object : nullptr;
+    }
+
+    // in registration order, which is the order of the scene's object list; unnamed objects are never found
+    const std::vector<GameObject*>& findAllByName(const std::string* name) const;
+    GameObject* findByName(const std::string* name) const
+    {
+        const auto& objects = findAllByName(name);
+        return objects.empty() ? nullptr : objects.front();
+    }
+
+    template <typename T>
+    ObjectHandle<T> getHandle(T& object) const
+    {
+        if (object.registry != this) return ObjectHandle<T>();
+        return ObjectHandle<T>(*this, object.registrySlot, slots[object.registrySlot].generation);
+    }
+};
+
+template <typename T>
+T* ObjectHandle<T>::get() const
+{
+    static_assert(std::is_base_of<GameObject, T>::value, "Handles can only refer to GameObjects!");
+
+    // the type was checked when the handle was created, and the generation guarantees it is the same object
+    return registry ? static_cast<T*>(registry->get(index, generation)) : nullptr;
+}
@@ -32,7 +32,7 @@
 #include <assert.hpp>
 #include <vector_math.hpp>
 #include "objects/Bomb.hpp"
-#include "particles/ParticleBatch.hpp"
+#include "particles/ParticleSystem.hpp"
 #include "objects/Room.hpp"
 #include "data/TileSet.hpp"
 #include "particles/TextureExplosion.hpp"
@@ -89,8 +89,8 @@ constexpr size_t SpikeDamage = 50;
 Player::Player(GameScene& scene)
     : abilityLevel(0), angle(0), lastFade(0), GameObject(scene), health(BaseHealth), maxHealth(BaseHealth),
     numBombs(MaxBombs), dashDirection(DashDir::None), dashConsumed(false), doubleJumpConsumed(false), waterArea(0),
-    chargingForHardball(false), hardballEnabled(false), grappleEnabled(false), grapplePoints(0), dashBatch(nullptr),
-    doubleArmor(false), moveRegen(false), hardballBatch(nullptr), curEntry(0), previousWallState(CollisionState::None),
+    chargingForHardball(false), hardballEnabled(false), grappleEnabled(false), grapplePoints(0),
+    doubleArmor(false), moveRegen(false), curEntry(0), previousWallState(CollisionState::None),
     microHealth(0), sprite(scene.getResourceManager().load<sf::Texture>("player.png")), graphicalDisplacement(),
     grappleSprite(scene.getResourceManager().load<sf::Texture>("player-grapple.png"))
 {
@@ -107,7 +107,7 @@ Player::Player(GameScene& scene)
 
 bool Player::configure(const Player::ConfigStruct& config)
 {
-    bool cfg = gameScene.getObjectByName("player") == nullptr;
+    bool cfg = gameScene.getPlayer() == nullptr;
     
     if (cfg)
     {
@@ -155,7 +155,7 @@ void Player::setupPhysics()
             {
                 auto vel = cpBodyGetVelocity(cpShapeGetBody(player));
 
-                switch (*(TileSet::Attribute*)cpShapeGetUserData(shp))
+                switch (*(TileSet::Attribute*)cp::Shape::of(shp)->getUserData())
                 {
                     case TileSet::Attribute::LeftSolid:
                     case TileSet::Attribute::LeftNoWalljump: return vel.x >= 0;
@@ -310,7 +310,7 @@ Player::CollisionState Player::enumerateAndActOnArbiters()
 
             if (cpShapeGetCollisionType(shp) == Room::CollisionType)
             {
-                auto attr = *(TileSet::Attribute*)cpShapeGetUserData(shp);
+                auto attr = *(TileSet::Attribute*)cp::Shape::of(shp)->getUserData();
                 if (TileSet::isNoWalljump(attr)) walljump = false;
                 else if (attr == TileSet::Attribute::Spike) state = CollisionState::Spike;
             }
@@ -326,7 +326,7 @@ Player::CollisionState Player::enumerateAndActOnArbiters()
             graphicalDisplacement += sgn * depthSum * set.normal;
             
             if (isDashing() && cpShapeGetCollisionType(shp) == Interactable)
-                (*(GameObject::InteractionHandler*)cpShapeGetUserData(shp))(DashInteractionType, (void*)this);
+                (*(GameObject::InteractionHandler*)cp::Shape::of(shp)->getUserData())(DashInteractionType, (void*)this);
             
             abortDash();
         }
@@ -446,13 +446,9 @@ void Player::observeDashAction()
         dash();
         
         if (!dashBatch)
-        {
-            auto batch = std::make_unique<ParticleBatch>(gameScene, "player-particles.pe", getDashEmitterName(), true);
-            dashBatch = batch.get();
-            gameScene.addObject(std::move(batch));
-        }
+            dashBatch = gameScene.getParticleSystem().spawn("player-particles.pe", getDashEmitterName(), true);
         
-        dashBatch->setPosition(getDisplayPosition());
+        dashBatch.setPosition(getDisplayPosition());
     }
     else disableDashBatch();
 }
@@ -504,10 +500,8 @@ void Player::observeHardballTrigger()
     {
         if (!hardballBatch)
         {
-            auto batch = std::make_unique<ParticleBatch>(gameScene, "player-particles.pe", "hardball-spark");
-            hardballBatch = batch.get();
-            hardballBatch->setPosition(getDisplayPosition());
-            gameScene.addObject(std::move(batch));
+            hardballBatch = gameScene.getParticleSystem().spawn("player-particles.pe", "hardball-spark");
+            hardballBatch.setPosition(getDisplayPosition());
             gameScene.playSound("player-hardball.wav");
         }
         
@@ -525,8 +519,8 @@ void Player::observeHardballTrigger()
             
             if (hardballBatch)
             {
-                hardballBatch->abort();
-                hardballBatch = nullptr;
+                hardballBatch.abort();
+                hardballBatch = {};
             }
         }
     }
@@ -534,8 +528,8 @@ void Player::observeHardballTrigger()
     {
         if (hardballBatch)
         {
-            hardballBatch->abort();
-            hardballBatch = nullptr;
+            hardballBatch.abort();
+            hardballBatch = {};
         }
     }
 }
@@ -563,9 +557,8 @@ bool Player::notifyScreenTransition(cpVect displacement)
 
 void Player::jump()
 {
-    auto batch = std::make_unique<ParticleBatch>(gameScene, "player-particles.pe", "jump");
-    batch->setPosition(getDisplayPosition());
-    gameScene.addObject(std::move(batch));
+    auto batch = gameScene.getParticleSystem().spawn("player-particles.pe", "jump");
+    batch.setPosition(getDisplayPosition());
     
     auto body = playerShape->getBody();
     auto dest = abilityLevel >= 6 ? PeakJumpSpeedEnhanced : PeakJumpSpeed;
@@ -594,9 +587,8 @@ void Player::wallJump(Player::CollisionState state)
     body->applyImpulseAtLocalPoint(dv * body->getMass(), cpvzero);
 
     auto name = state == CollisionState::WallLeft ? "wall-jump-left" : "wall-jump-right";
-    auto batch = std::make_unique<ParticleBatch>(gameScene, "player-particles.pe", name);
-    batch->setPosition(getDisplayPosition());
-    gameScene.addObject(std::move(batch));
+    auto batch = gameScene.getParticleSystem().spawn("player-particles.pe", name);
+    batch.setPosition(getDisplayPosition());
 }
 
 std::string Player::getDashEmitterName() const
@@ -639,8 +631,8 @@ void Player::disableDashBatch()
 {
     if (dashBatch)
     {
-        dashBatch->abort();
-        dashBatch = nullptr;
+        dashBatch.abort();
+        dashBatch = {};
     }
 }
 
@@ -26,6 +26,7 @@
 #include "objects/GameObject.hpp"
 #include "drawables/Sprite.hpp"
 #include "gameplay/Script.hpp"
+#include "particles/ParticleBatch.hpp"
 
 #include <SFML/Graphics.hpp>
 #include <cppmunk/Shape.h>
@@ -40,7 +41,6 @@ class PlayerController;
 class ResourceManager;
 class GameScene;
 class Renderer;
-class ParticleBatch;
 class Bomb;
 class GUI;
 namespace collectibles
@@ -61,8 +61,7 @@ class Player final : public GameObject
     
     Sprite sprite, grappleSprite;
     std::shared_ptr<cp::Shape> playerShape;
-    ParticleBatch* dashBatch;
-    ParticleBatch* hardballBatch;
+    ParticleBatch dashBatch, hardballBatch;
 
     CollisionState previousWallState;
 
@@ -28,7 +28,7 @@
 #include "defaults.hpp"
 #include <chronoUtils.hpp>
 
-#include "particles/ParticleBatch.hpp"
+#include "particles/ParticleSystem.hpp"
 #include "scene/GameScene.hpp"
 
 constexpr auto FadeDuration = 30_frames;
@@ -55,9 +55,8 @@ void PlayerDeath::update(FrameTime curTime)
     {
         if (!spawnedParticle)
         {
-            auto batch = std::make_unique<ParticleBatch>(gameScene, "player-particles.pe", "player-death", (size_t)32);
-            batch->setPosition(position);
-            gameScene.addObject(std::move(batch));
+            auto batch = gameScene.getParticleSystem().spawn("player-particles.pe", "player-death", (size_t)32);
+            batch.setPosition(position);
             
             spawnedParticle = true;
         }
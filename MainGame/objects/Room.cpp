@@ -28,6 +28,7 @@
 #include "objects/GameObject.hpp"
 #include "gameplay/MapGenerator.hpp"
 #include "particles/TextureExplosion.hpp"
+#include "profiler/Profiler.hpp"
 
 #include <assert.hpp>
 
@@ -41,6 +42,9 @@
 std::vector<std::shared_ptr<cp::Shape>>
     generateShapesForTilemap(const RoomData& data, const TileSet& tileSet, std::shared_ptr<cp::Body> body,
     ShapeGeneratorDataOpaque& shaderGeneratorData, std::unordered_map<void*,CrumblingData>& crumblingTiles);
+std::vector<std::shared_ptr<cp::Shape>>
+    instantiateShapesForTilemap(const RoomData& data, std::shared_ptr<cp::Body> body,
+    ShapeGeneratorDataOpaque& shapeGeneratorData, std::unordered_map<void*,CrumblingData>& crumblingTiles);
 
 Room::Room(GameScene& scene) : gameScene(scene), shapeGeneratorData(nullptr, [](void*){}),
     transitionData(nullptr, [](void*){})
@@ -74,22 +78,24 @@ void Room::loadRoom(const RoomData& data, bool transition, cpVect displacement)
         gameScene.getGameSpace().reindexShapesForBody(transitionBody);
     }
     
-    tileSet = gameScene.getResourceManager().load<TileSet>(data.tilesetName + ".ts");
+    tileSet = gameScene.getResourceManager().load<TileSet>(std::string(data.tilesetName) + ".ts");
     
-    mainLayerTilemap.setTexture(gameScene.getResourceManager().load<sf::Texture>(tileSet->textureName));
+    mainLayerTilemap.setTexture(gameScene.getResourceManager().load<sf::Texture>(std::string(tileSet->textureName)));
     mainLayerTilemap.setTileData(data.mainLayer);
 
     clearShapes();
     roomBody = std::make_unique<cp::Body>(cp::Body::Static);
 	gameScene.getGameSpace().add(roomBody);
 
-    roomShapes = generateShapesForTilemap(data, *tileSet, roomBody, shapeGeneratorData, crumblingTiles);
+    if (data.hasPrecomputedShapes)
+        roomShapes = instantiateShapesForTilemap(data, roomBody, shapeGeneratorData, crumblingTiles);
+    else roomShapes = generateShapesForTilemap(data, *tileSet, roomBody, shapeGeneratorData, crumblingTiles);
     for (auto& shape : roomShapes)
     {
         shape->setElasticity(0.6);
         shape->setCollisionType(CollisionType);
-        gameScene.getGameSpace().add(shape);
     }
+    gameScene.getGameSpace().add(roomShapes);
 }
 
 void setCrumbleOffset(std::unique_ptr<TextureExplosion>& explosion, FrameDuration crumbleTime)
@@ -104,6 +110,7 @@ void setCrumbleOffset(std::unique_ptr<TextureExplosion>& explosion, FrameDuratio
 
 void Room::update(FrameTime curTime)
 {
+    PROFILE_ZONE("Room::update");
     auto checkCrumbling = [&,curTime,this](bool transition)
     {
         auto& roomBody = transition ? transitionBody : this->roomBody;
@@ -111,6 +118,7 @@ void Room::update(FrameTime curTime)
         auto& crumblingTiles = transition ? transitionCrumblingTiles : this->crumblingTiles;
 
         if (!roomBody) return;
+        std::vector<std::shared_ptr<cp::Shape>> crumbledShapes;
 
         roomBody->eachArbiter([&,curTime,this] (cp::Arbiter arbiter)
         {
@@ -122,7 +130,7 @@ void Room::update(FrameTime curTime)
                     arbiter.getShapeB() : arbiter.getShapeA();
                 if (cpShapeGetCollisionType(otherShp) == CollisionType) return;
 
-                void* attribute = cpShapeGetUserData(shp);
+                void* attribute = cp::Shape::of(shp)->getUserData();
                 if (*(TileSet::Attribute*)attribute == TileSet::Attribute::Crumbling)
                     if (isNull(crumblingTiles[attribute].initTime))
                         crumblingTiles[attribute].initTime = curTime;
@@ -136,10 +144,8 @@ void Room::update(FrameTime curTime)
 
             if (!data.crumbling && curTime - data.initTime > data.waitTime)
             {
-                auto grid = tilemap.getTileData();
-                auto texRect = tilemap.getTextureRectForTile(grid(data.x, data.y));
-                grid(data.x, data.y) = -1;
-                tilemap.setTileData(grid);
+                auto texRect = tilemap.getTextureRectForTile(tilemap.getTileData()(data.x, data.y));
+                tilemap.setTile(data.x, data.y, -1);
                 data.crumbling = true;
 
                 auto grav = gameScene.getGameSpace().getGravity();
@@ -155,12 +161,15 @@ void Room::update(FrameTime curTime)
             
             if (curTime - data.initTime > data.waitTime + data.crumbleTime)
             {
-                gameScene.getGameSpace().remove(data.shape);
-                gameScene.getGameSpace().reindexShapesForBody(roomBody);
+                crumbledShapes.push_back(data.shape);
                 it = crumblingTiles.erase(it);
             }
             else ++it;
         }
+
+        // tiles that crumble together, like a whole row, leave the static index in one go,
+        // and removing a static shape doesn't need the rest of the room to be reindexed
+        gameScene.getGameSpace().remove(crumbledShapes);
     };
 
     checkCrumbling(false);
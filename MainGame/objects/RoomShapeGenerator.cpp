@@ -27,6 +27,7 @@
 #include <memory>
 #include <utility>
 #include <chronoUtils.hpp>
+#include <RoomSegments.hpp>
 
 #include <cppmunk/Space.h>
 #include <cppmunk/Body.h>
@@ -41,184 +42,48 @@
 using ssize_t = intmax_t;
 #endif
 
-enum NodeType { TerrainBoundary, TerrainAnkle, TerrainCorner, LevelEdge };
-    
-struct Segment // Generic segments
+// Lets util::generateRoomSegments read the tiles through the game's TileSet
+struct SegmentationTiles
 {
-    NodeType end1, end2;
-    bool isOtherEnd;
-    bool isSemiTerrain;
-    size_t terrain, j, i1, i2;
-};
+    using TileType = TileSet::TileType;
+    using Attribute = TileSet::Attribute;
 
-template <bool Vertical>
-inline void generateSegments(std::vector<Segment>& segments, const TileSet& tileSet, const util::grid<uint8_t>& layer)
-{
-// Replacement rule to help in the annoying things
-#define TT TileSet::TileType
-#define At TileSet::Attribute
-    
-    auto terrainCanMakeNewSegment = [](TileSet::TileType type)
-    {
-        return isContained(type, TT::TerrainUpperLeft, TT::TerrainUpperRight, TT::TerrainLowerLeft,
-            TT::TerrainLowerRight, Vertical ? TT::TerrainLeft : TT::TerrainUp,
-            Vertical ? TT::TerrainRight : TT::TerrainDown);
-    };
-    
-    auto isCornerTerrain = [](TileSet::TileType type)
-    {
-        return isContained(type, TT::TerrainUpperLeft, Vertical ? TT::TerrainUpperRight : TT::TerrainLowerLeft);
-    };
+    const TileSet& tileSet;
 
-    auto isTerrainOtherEnd = [](TileSet::TileType type)
-    {
-        return isContained(type, TT::TerrainLowerRight, Vertical ? TT::TerrainUpperRight : TT::TerrainLowerLeft,
-            Vertical ? TT::TerrainRight : TT::TerrainDown);
-    };
-    
-    auto isTerrainSegmentCorner = [](TileSet::TileType type)
-    {
-        return isContained(type, TT::TerrainLowerRight, Vertical ? TT::TerrainLowerLeft : TT::TerrainUpperRight);
-    };
-    
-    auto getViableContinuation = [](bool semiterrain, bool otherEnd)
-    {
-        if (semiterrain) return TT::SemiTerrain2;
-        else if (otherEnd) return Vertical ? TT::TerrainRight : TT::TerrainDown;
-        else return Vertical ? TT::TerrainLeft : TT::TerrainUp;
-    };
-    
-    auto jSize = Vertical ? layer.width() : layer.height();
-    auto iSize = Vertical ? layer.height() : layer.width();
+    const TileSet::TileIdentity& identity(uint8_t tile) const { return tileSet.tileIdentities[tile]; }
+    Attribute attribute(uint8_t tile) const { return tileSet.getTileAttribute(tile); }
 
-    Segment curSegment;
-    bool newSegment = false;
-    for (size_t j = 0; j < jSize; j++)
+    static bool isTerrain(TileType type) { return TileSet::isTerrain(type); }
+    static bool isSemiTerrain(TileType type) { return TileSet::isSemiTerrain(type); }
+    static bool isIdHorizontalSemiTerrain(size_t id) { return TileSet::isIdHorizontalSemiTerrain(id); }
+    static bool isIdVerticalSemiTerrain(size_t id) { return TileSet::isIdVerticalSemiTerrain(id); }
+    static bool refersToSame(const TileSet::TileIdentity& t1, const TileSet::TileIdentity& t2)
     {
-        const TileSet::TileIdentity* lastIdentity = nullptr;
-        for (size_t i = 0; i < iSize; i++)
-        {
-            auto curTile = Vertical ? layer(j, i) : layer(i, j);
-            const auto &identity = tileSet.tileIdentities[curTile];
-
-            bool isViableSemiTerrain = TileSet::isSemiTerrain(identity.type) &&
-                (Vertical ? TileSet::isIdHorizontalSemiTerrain(identity.id) :
-                            TileSet::isIdVerticalSemiTerrain(identity.id));
-            TileSet::Attribute terrainAttr = tileSet.getTileAttribute(curTile);
-            
-            if (TileSet::isTerrain(identity.type) || isViableSemiTerrain)
-            {
-                if (newSegment && !TileSet::refersToSame(*lastIdentity, identity))
-                {
-                    curSegment.i2 = i-1;
-                    curSegment.end2 = TerrainBoundary;
-                    segments.push_back(curSegment);
-                    newSegment = false;
-                }
-
-            repeatNewSegmentPhase: // People will spank me, but...
-                if (!newSegment && (isViableSemiTerrain || terrainCanMakeNewSegment(identity.type)))
-                {
-                    bool isTerrainCorner = isViableSemiTerrain ? identity.type == TT::SemiTerrain1 :
-                        isCornerTerrain(identity.type);
-                    bool isOtherEnd = isViableSemiTerrain ?
-                        (Vertical ? isContained(terrainAttr, At::RightSolid, At::RightNoWalljump) :
-                        terrainAttr == At::DownSolid) : isTerrainOtherEnd(identity.type);
-
-                    newSegment = true;
-                    curSegment.j = j;
-                    curSegment.i1 = i;
-                    curSegment.end1 = isTerrainCorner ? TerrainCorner : i == 0 ? LevelEdge :
-                        TileSet::refersToSame(*lastIdentity, identity) ? TerrainAnkle : TerrainBoundary;
-                    curSegment.isOtherEnd = isOtherEnd;
-
-                    curSegment.isSemiTerrain = isViableSemiTerrain;
-                    curSegment.terrain = identity.id;
-
-                    if (isTerrainCorner) goto skipSegmentTermination;
-                }
-                
-                if (newSegment && identity.type != getViableContinuation(isViableSemiTerrain, curSegment.isOtherEnd))
-                {
-                    bool isTerrainCorner = isViableSemiTerrain ? identity.type == TT::SemiTerrain3 :
-                        isTerrainSegmentCorner(identity.type);
-                    
-                    curSegment.i2 = isTerrainCorner ? i : i-1;
-                    curSegment.end2 = isTerrainCorner ? TerrainCorner : TerrainAnkle;
-                    segments.push_back(curSegment);
-                    newSegment = false;
-
-                    bool isNewTerrainCorner = isViableSemiTerrain ? identity.type == TT::SemiTerrain1 :
-                        isCornerTerrain(identity.type);
-                    // In order to avoid code duplication
-                    if (isNewTerrainCorner) goto repeatNewSegmentPhase;
-                }
-#undef At
-#undef TT
-            }
-            else if (newSegment)
-            {
-                curSegment.i2 = i-1;
-                curSegment.end2 = TerrainBoundary;
-                segments.push_back(curSegment);
-                newSegment = false;
-            }
-
-        skipSegmentTermination:
-            lastIdentity = &identity;
-        }
-
-        if (newSegment)
-        {
-            curSegment.i2 = iSize-1;
-            curSegment.end2 = LevelEdge;
-            segments.push_back(curSegment);
-            newSegment = false;
-        }
+        return TileSet::refersToSame(t1, t2);
     }
-}
+};
 
 template <bool Vertical>
 void convertShapes(std::vector<std::shared_ptr<cp::Shape>> &shapes, std::shared_ptr<cp::Body> body,
-    const TileSet& tileSet, const std::vector<Segment>& segments, TileSet::Attribute* attributes)
+    const TileSet& tileSet, const std::vector<util::RoomSegment>& segments, TileSet::Attribute* attributes)
 {
     auto pi = Vertical ? &cpVect::y : &cpVect::x;
     auto pj = Vertical ? &cpVect::x : &cpVect::y;
 
     size_t i = 0;
-    for (const Segment& segment : segments)
+    for (const util::RoomSegment& segment : segments)
     {
         auto physicalParams = segment.isSemiTerrain ? TileSet::PhysicalParameters() :
             tileSet.terrains[segment.terrain].physicalParameters;
 
-        auto perpnOffset = Vertical ? physicalParams.upperOffset : physicalParams.leftOffset,
-             perppOffset = Vertical ? physicalParams.lowerOffset : physicalParams.rightOffset,
-             parnOffset  = Vertical ? physicalParams.leftOffset  : physicalParams.upperOffset,
-             parpOffset  = Vertical ? physicalParams.rightOffset : physicalParams.lowerOffset,
-             cornerRadius = physicalParams.cornerRadius;
+        auto cornerRadius = physicalParams.cornerRadius;
+        auto coords = util::getRoomSegmentCoordinates<Vertical>(segment, DefaultTileSize, physicalParams.upperOffset,
+            physicalParams.lowerOffset, physicalParams.leftOffset, physicalParams.rightOffset, cornerRadius);
 
         cpVect endPoint1, endPoint2;
-        endPoint1.*pj = endPoint2.*pj = DefaultTileSize * segment.j +
-            (segment.isOtherEnd ? DefaultTileSize + perpnOffset - cornerRadius
-                                : -perppOffset + cornerRadius);
-
-        endPoint1.*pi = DefaultTileSize * segment.i1;
-        switch (segment.end1)
-        {
-            case LevelEdge: endPoint1.*pi -= DefaultTileSize; break;
-            case TerrainAnkle: endPoint1.*pi += parpOffset - cornerRadius; break;
-            case TerrainCorner: endPoint1.*pi -= parnOffset - cornerRadius; break;
-            default: break;
-        } 
-        
-        endPoint2.*pi = DefaultTileSize * (segment.i2+1);
-        switch (segment.end2)
-        {
-            case LevelEdge: endPoint2.*pi += DefaultTileSize; break;
-            case TerrainAnkle: endPoint2.*pi -= parnOffset - cornerRadius; break;
-            case TerrainCorner: endPoint2.*pi += parpOffset - cornerRadius; break;
-            default: break;
-        }
+        endPoint1.*pj = endPoint2.*pj = coords.j;
+        endPoint1.*pi = coords.i1;
+        endPoint2.*pi = coords.i2;
 
         attributes[i] = segment.isSemiTerrain ? TileSet::getSemiTerrainAttribute(segment.terrain) :
             tileSet.terrains[segment.terrain].terrainAttribute;
@@ -254,7 +119,7 @@ void convertShapes(std::vector<std::shared_ptr<cp::Shape>> &shapes, std::shared_
 }
 
 inline size_t collectSingleObjects(std::vector<std::pair<size_t,size_t>>& singleObjectLocations,
-    const TileSet& tileSet, const util::grid<uint8_t>& layer)
+    const TileSet& tileSet, util::grid_view<uint8_t> layer)
 {
     size_t numShapes = 0;
     
@@ -274,7 +139,7 @@ inline size_t collectSingleObjects(std::vector<std::pair<size_t,size_t>>& single
 }
 
 inline void convertSingleObjects(std::vector<std::shared_ptr<cp::Shape>> &shapes, std::shared_ptr<cp::Body> body,
-    const TileSet& tileSet, const util::grid<uint8_t>& layer,
+    const TileSet& tileSet, util::grid_view<uint8_t> layer,
     const std::vector<std::pair<size_t,size_t>>& singleObjectLocations, TileSet::Attribute* attributes,
     std::unordered_map<void*,CrumblingData>& crumblingTiles)
 {
@@ -343,9 +208,10 @@ std::vector<std::shared_ptr<cp::Shape>>
 {
     const auto& layer = data.mainLayer;
 
-    std::vector<Segment> horizontalSegments, verticalSegments;
-    generateSegments<false>(horizontalSegments, tileSet, layer);
-    generateSegments<true>(verticalSegments, tileSet, layer);
+    SegmentationTiles tiles{tileSet};
+    std::vector<util::RoomSegment> horizontalSegments, verticalSegments;
+    util::generateRoomSegments<false>(horizontalSegments, tiles, layer, layer.width(), layer.height());
+    util::generateRoomSegments<true>(verticalSegments, tiles, layer, layer.width(), layer.height());
 
     std::vector<std::pair<size_t,size_t>> singleObjectLocations;
     auto totalShapes = collectSingleObjects(singleObjectLocations, tileSet, layer); 
@@ -364,3 +230,53 @@ std::vector<std::shared_ptr<cp::Shape>>
 
     return shapes;
 }
+
+std::vector<std::shared_ptr<cp::Shape>>
+    instantiateShapesForTilemap(const RoomData& data, std::shared_ptr<cp::Body> body,
+    ShapeGeneratorDataOpaque& shapeGeneratorData, std::unordered_map<void*,CrumblingData>& crumblingTiles)
+{
+    TileSet::Attribute* attrs = new TileSet::Attribute[data.shapes.size()];
+    shapeGeneratorData = ShapeGeneratorDataOpaque(static_cast<void*>(attrs),
+        [](void* ptr) { delete[] static_cast<TileSet::Attribute*>(ptr); });
+
+    std::vector<std::shared_ptr<cp::Shape>> shapes;
+    shapes.reserve(data.shapes.size());
+
+    std::vector<cpVect> points;
+    for (size_t i = 0; i < data.shapes.size(); i++)
+    {
+        const auto& shp = data.shapes[i];
+
+        points.clear();
+        for (size_t k = 0; k < shp.numPoints; k++)
+        {
+            auto pt = data.shapePoints[shp.pointOffset + k];
+            points.push_back(cpVect{ (cpFloat)pt.x, (cpFloat)pt.y });
+        }
+
+        std::shared_ptr<cp::Shape> shape;
+        switch (shp.type)
+        {
+            case RoomShape::Type::Segment:
+                shape = std::make_shared<cp::SegmentShape>(body, points[0], points[1], shp.radius); break;
+            case RoomShape::Type::Circle:
+                shape = std::make_shared<cp::CircleShape>(body, shp.radius, points[0]); break;
+            case RoomShape::Type::Polygon:
+                shape = std::make_shared<cp::PolyShape>(body, points, shp.radius); break;
+        }
+
+        attrs[i] = (TileSet::Attribute)shp.attribute;
+        shape->setUserData(attrs+i);
+        shapes.push_back(shape);
+
+        if (attrs[i] == TileSet::Attribute::Crumbling)
+        {
+            auto waitTime = FrameDuration((size_t)(shp.waitTime * 60));
+            auto crumbleTime = FrameDuration((size_t)(shp.crumbleTime * 60));
+            crumblingTiles.emplace(attrs+i, CrumblingData{ shp.x, shp.y, shape, waitTime, crumbleTime,
+                shp.crumblePieceSize, FrameTime(), false });
+        }
+    }
+
+    return shapes;
+}
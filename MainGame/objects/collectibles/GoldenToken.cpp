@@ -41,9 +41,7 @@ GoldenToken::GoldenToken(GameScene& scene) : Collectible(scene),
 {
     setupPhysics();
     
-    auto batch = std::make_unique<ParticleBatch>(gameScene, "golden-token-particles.pe", "golden-token");
-    tokenBatch = batch.get();
-    gameScene.addObject(std::move(batch));
+    tokenBatch = gameScene.getParticleSystem().spawn("golden-token-particles.pe", "golden-token");
 }
 
 bool GoldenToken::configure(const GoldenToken::ConfigStruct& config)
@@ -78,7 +76,7 @@ GoldenToken::~GoldenToken()
     gameScene.getGameSpace().remove(collisionShape);
     gameScene.getGameSpace().remove(collisionBody);
     
-    tokenBatch->abort();
+    tokenBatch.abort();
 }
 
 void GoldenToken::onCollect(Player& player)
@@ -99,7 +97,7 @@ void GoldenToken::update(FrameTime curTime)
     pos.y = baseY - Amplitude * factor;
     collisionBody->setPosition(pos);
     
-    tokenBatch->setPosition(sf::Vector2f(pos.x, pos.y));
+    tokenBatch.setPosition(sf::Vector2f(pos.x, pos.y));
 }
 
 bool GoldenToken::notifyScreenTransition(cpVect displacement)
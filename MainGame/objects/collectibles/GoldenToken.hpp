@@ -36,7 +36,7 @@ namespace collectibles
         std::shared_ptr<cp::Shape> collisionShape;
         FrameTime initialTime;
         cpFloat baseY;
-        ParticleBatch* tokenBatch;
+        ParticleBatch tokenBatch;
         uint16_t tokenId;
 
     public:
@@ -171,7 +171,7 @@ void Powerup::render(Renderer& renderer)
 {
     renderer.pushTransform();
     renderer.currentTransform.translate(getDisplayPosition());
-    renderer.pushDrawable(vertices, sf::RenderStates(texture.get()), 25);
+    renderer.pushVertices(vertices, sf::RenderStates(texture.get()), 25);
     renderer.popTransform();
 }
 
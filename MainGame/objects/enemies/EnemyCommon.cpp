@@ -44,13 +44,13 @@ EnemyCommon::~EnemyCommon()
 }
 
 
-bool EnemyCommon::onCollisionHit(Player& player, std::shared_ptr<cp::Shape> shape)
+bool EnemyCommon::onCollisionHit(Player& player, cp::Shape& shape)
 {
     damage(touchDamage);
     return true;
 }
 
-bool EnemyCommon::onCollisionAttack(Player& player, std::shared_ptr<cp::Shape> shape)
+bool EnemyCommon::onCollisionAttack(Player& player, cp::Shape& shape)
 {
     player.damage(playerDamage(player, shape));
     return true;
@@ -60,10 +60,10 @@ namespace enemies
     public:
         virtual ~EnemyCommon();
         
-        virtual bool onCollisionAttack(Player& player, std::shared_ptr<cp::Shape> shape) override;
-        virtual bool onCollisionHit(Player& player, std::shared_ptr<cp::Shape> shape) override;
+        virtual bool onCollisionAttack(Player& player, cp::Shape& shape) override;
+        virtual bool onCollisionHit(Player& player, cp::Shape& shape) override;
         
-        virtual size_t playerDamage(Player& player, const std::shared_ptr<cp::Shape> shape) const = 0;
+        virtual size_t playerDamage(Player& player, const cp::Shape& shape) const = 0;
         virtual void damage(size_t amount);
         virtual void die();
         
@@ -89,13 +89,13 @@ Floater::~Floater()
     gameScene.getGameSpace().remove(collisionBody);
 }
 
-bool Floater::onCollisionAttack(Player& player, std::shared_ptr<cp::Shape> shape)
+bool Floater::onCollisionAttack(Player& player, cp::Shape& shape)
 {
     player.damage(25);
     return true;
 }
 
-bool Floater::onCollisionHit(Player& player, std::shared_ptr<cp::Shape> shape)
+bool Floater::onCollisionHit(Player& player, cp::Shape& shape)
 {
     remove();
     return true;
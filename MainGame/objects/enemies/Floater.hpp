@@ -52,8 +52,8 @@ namespace enemies
 
         void setupPhysics();
 
-        virtual bool onCollisionAttack(Player& player, std::shared_ptr<cp::Shape> shape) override;
-        virtual bool onCollisionHit(Player& player, std::shared_ptr<cp::Shape> shape) override;
+        virtual bool onCollisionAttack(Player& player, cp::Shape& shape) override;
+        virtual bool onCollisionHit(Player& player, cp::Shape& shape) override;
 
         virtual void update(FrameTime curTime) override;
         virtual void render(Renderer& renderer) override;
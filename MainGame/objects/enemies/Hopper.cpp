@@ -130,7 +130,7 @@ Hopper::~Hopper()
         gameScene.getGameSpace().remove(body);
 }
 
-size_t Hopper::playerDamage(Player& player, const std::shared_ptr<cp::Shape> shape) const
+size_t Hopper::playerDamage(Player& player, const cp::Shape& shape) const
 {
     return 24;
 }
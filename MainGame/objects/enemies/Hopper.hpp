@@ -56,7 +56,7 @@ namespace enemies
         Hopper(GameScene& gameScene);
         virtual ~Hopper();
         
-        virtual size_t playerDamage(Player& player, const std::shared_ptr<cp::Shape> shape) const override;
+        virtual size_t playerDamage(Player& player, const cp::Shape& shape) const override;
         virtual void die() override;
         
         virtual void update(FrameTime curTime) override;
@@ -96,13 +96,13 @@ Rotator::~Rotator()
 }
 
 
-bool Rotator::onCollisionAttack(Player& player, std::shared_ptr<cp::Shape> shape)
+bool Rotator::onCollisionAttack(Player& player, cp::Shape& shape)
 {
     player.damage(10);
     return true;
 }
 
-bool Rotator::onCollisionHit(Player& player, std::shared_ptr<cp::Shape> shape)
+bool Rotator::onCollisionHit(Player& player, cp::Shape& shape)
 {
     remove();
     return true;
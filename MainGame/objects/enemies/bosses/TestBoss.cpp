@@ -145,7 +145,7 @@ void TestBoss::die()
     gameScene.getSavedGame().setCurLevel(2);
 }
 
-size_t TestBoss::playerDamage(Player& player, const std::shared_ptr<cp::Shape> shape) const
+size_t TestBoss::playerDamage(Player& player, const cp::Shape& shape) const
 {
     return 18;
 }
@@ -194,7 +194,7 @@ TestBossProjectile::~TestBossProjectile()
     gameScene.getGameSpace().remove(collisionBody);
 }
 
-bool TestBossProjectile::onCollisionAttack(Player& player, std::shared_ptr<cp::Shape> shape)
+bool TestBossProjectile::onCollisionAttack(Player& player, cp::Shape& shape)
 {
     player.damage(10);
     remove();
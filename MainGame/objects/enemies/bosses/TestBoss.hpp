@@ -47,7 +47,7 @@ namespace enemies
             TestBoss(GameScene& scene);
             virtual ~TestBoss();
             
-            virtual size_t playerDamage(Player& player, const std::shared_ptr<cp::Shape> shape) const override;
+            virtual size_t playerDamage(Player& player, const cp::Shape& shape) const override;
             virtual void die() override;
             
             virtual void update(FrameTime curTime) override;
@@ -79,8 +79,8 @@ namespace enemies
             TestBossProjectile(GameScene& scene, cpVect pos, cpVect vel);
             virtual ~TestBossProjectile();
             
-            virtual bool onCollisionAttack(Player& player, std::shared_ptr<cp::Shape> shape) override;
-            virtual bool onCollisionHit(Player& player, std::shared_ptr<cp::Shape> shape) override { return true; }
+            virtual bool onCollisionAttack(Player& player, cp::Shape& shape) override;
+            virtual bool onCollisionHit(Player& player, cp::Shape& shape) override { return true; }
             
             virtual void update(FrameTime curTime) override;
             virtual void render(Renderer& renderer) override;
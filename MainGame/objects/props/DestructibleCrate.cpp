@@ -168,7 +168,7 @@ bool DestructibleCrate::notifyScreenTransition(cpVect displacement)
 
 bool DashCrate::isDestructionViable() const
 {
-    auto player = gameScene.getObjectByName<Player>("player");
+    auto player = gameScene.getPlayer();
     return player && player->canBreakDash();
 }
 
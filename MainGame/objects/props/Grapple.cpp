@@ -55,7 +55,7 @@ Grapple::~Grapple()
 {
     if (isExcited)
     {
-        auto player = gameScene.getObjectByName<Player>("player");
+        auto player = gameScene.getPlayer();
         if (player) player->setGrappling(false);
     }
 }
@@ -74,7 +74,7 @@ void Grapple::update(FrameTime curTime)
     if (initialTime == decltype(initialTime)())
         initialTime = curTime;
 
-    auto player = gameScene.getObjectByName<Player>("player");
+    auto player = gameScene.getPlayer();
     if (player)
     {
         bool newIsExcited = player->canGrapple() &&
@@ -133,7 +133,7 @@ void Grapple::render(Renderer& renderer)
     
     if (fade != 0.0)
     {
-        auto player = gameScene.getObjectByName<Player>("player");
+        auto player = gameScene.getPlayer();
         if (player)
         {
             auto vec = player->getDisplayPosition() - getDisplayPosition();
@@ -144,7 +144,7 @@ PushableCrate::~PushableCrate()
 
 void PushableCrate::update(FrameTime curTime)
 {
-    auto player = gameScene.getObjectByName<Player>("player");
+    auto player = gameScene.getPlayer();
     
     if (player)
     {
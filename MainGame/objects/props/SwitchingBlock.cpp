@@ -46,7 +46,7 @@ FrameDuration SwitchingBlock::getFadeDuration()
 SwitchingBlock::SwitchingBlock(GameScene &scene) : GameObject(scene),
     blockSprite(scene.getResourceManager().load<sf::Texture>("switching-block.png")),
     fadeSprite(scene.getResourceManager().load<sf::Texture>("switching-block-fade.png")),
-    visible(false), blockClusterName(), blockTime(0), parentBlockCluster(nullptr),
+    visible(false), blockClusterName(), blockTime(0), parentBlockCluster(),
     fadeTime(), curTime()
 {
 
@@ -93,21 +93,18 @@ SwitchingBlock::~SwitchingBlock()
         }
     }
 
-    if (parentBlockCluster != nullptr)
-    {
-        parentBlockCluster = gameScene.getObjectByName<SwitchingBlockCluster>(blockClusterName);
-        if (parentBlockCluster != nullptr) parentBlockCluster->unregisterSwitchBlock(blockTime, this);
-    }
+    if (auto cluster = parentBlockCluster.get())
+        cluster->unregisterSwitchBlock(blockTime, this);
 }
 
 void SwitchingBlock::update(FrameTime curTime)
 {
     this->curTime = curTime;
 
-    if (parentBlockCluster == nullptr)
+    if (!parentBlockCluster)
     {
-        parentBlockCluster = gameScene.getObjectByName<SwitchingBlockCluster>(blockClusterName);
-        if (parentBlockCluster == nullptr) remove();
+        parentBlockCluster = gameScene.getObjectHandleByName<SwitchingBlockCluster>(blockClusterName);
+        if (!parentBlockCluster) remove();
         else parentBlockCluster->registerSwitchBlock(blockTime, this);
     }
 
@@ -48,7 +48,7 @@ namespace props
         bool visible;
         std::string blockClusterName;
         size_t blockTime;
-        SwitchingBlockCluster* parentBlockCluster;
+        ObjectHandle<SwitchingBlockCluster> parentBlockCluster;
 
         FrameTime fadeTime, curTime;
 
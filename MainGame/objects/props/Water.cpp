@@ -100,7 +100,7 @@ Water::Water(GameScene& scene) : GameObject(scene), oldArea(0), shape(sf::Vector
 
 Water::~Water()
 {
-     auto player = gameScene.getObjectByName<Player>("player");
+     auto player = gameScene.getPlayer();
      if (player) player->addToWaterArea(-oldArea);
 }
 
@@ -132,7 +132,7 @@ void Water::setRect(sf::IntRect rect)
 
 void Water::update(FrameTime curTime)
 {
-	auto player = gameScene.getObjectByName<Player>("player");
+	auto player = gameScene.getPlayer();
 
     if (player)
     {
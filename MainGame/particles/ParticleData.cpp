@@ -0,0 +1,263 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "ParticleData.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if PARTICLES_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+template <typename Func>
+static void forEachLane(ParticleData& data, Func func)
+{
+    for (auto lane : { &data.x, &data.y, &data.vx, &data.vy, &data.ax, &data.ay,
+        &data.beginTime, &data.endTime, &data.invLifetime, &data.beginSize, &data.deltaSize, &data.curSize })
+        func(*lane);
+
+    for (size_t c = 0; c < 4; c++)
+    {
+        func(data.beginColor[c]);
+        func(data.deltaColor[c]);
+    }
+
+    func(data.curColor);
+    func(data.owner);
+}
+
+void ParticleData::resize(size_t size)
+{
+    forEachLane(*this, [=](auto& lane) { lane.resize(size); });
+}
+
+void ParticleData::reserve(size_t capacity)
+{
+    forEachLane(*this, [=](auto& lane) { lane.reserve(capacity); });
+}
+
+size_t ParticleData::append()
+{
+    auto index = size();
+    if (index == capacity()) reserve(std::max<size_t>(2*index, 64));
+    forEachLane(*this, [](auto& lane) { lane.emplace_back(); });
+    return index;
+}
+
+void integrateParticles(ParticleData& data, float dt)
+{
+    size_t size = data.size(), i = 0;
+    float *x = data.x.data(), *y = data.y.data(), *vx = data.vx.data(), *vy = data.vy.data();
+    const float *ax = data.ax.data(), *ay = data.ay.data();
+
+#if PARTICLES_USE_SSE2
+    auto vdt = _mm_set1_ps(dt);
+    for (; i+4 <= size; i += 4)
+    {
+        auto cvx = _mm_loadu_ps(vx+i), cvy = _mm_loadu_ps(vy+i);
+        _mm_storeu_ps(x+i, _mm_add_ps(_mm_loadu_ps(x+i), _mm_mul_ps(cvx, vdt)));
+        _mm_storeu_ps(y+i, _mm_add_ps(_mm_loadu_ps(y+i), _mm_mul_ps(cvy, vdt)));
+        _mm_storeu_ps(vx+i, _mm_add_ps(cvx, _mm_mul_ps(_mm_loadu_ps(ax+i), vdt)));
+        _mm_storeu_ps(vy+i, _mm_add_ps(cvy, _mm_mul_ps(_mm_loadu_ps(ay+i), vdt)));
+    }
+#endif
+
+    for (; i < size; i++)
+    {
+        x[i] += vx[i] * dt;
+        y[i] += vy[i] * dt;
+        vx[i] += ax[i] * dt;
+        vy[i] += ay[i] * dt;
+    }
+}
+
+void translateParticles(ParticleData& data, sf::Vector2f displacement)
+{
+    for (auto& x : data.x) x += displacement.x;
+    for (auto& y : data.y) y += displacement.y;
+}
+
+static inline uint8_t toColorByte(float val)
+{
+    return (uint8_t)std::min(std::max(val * 255.0f, 0.0f), 255.0f);
+}
+
+void interpolateParticles(ParticleData& data, float curTime)
+{
+    size_t size = data.size(), i = 0;
+    const float *beginTime = data.beginTime.data(), *invLifetime = data.invLifetime.data();
+    const float *beginSize = data.beginSize.data(), *deltaSize = data.deltaSize.data();
+    const float *beginColor[4], *deltaColor[4];
+    float* curSize = data.curSize.data();
+    sf::Color* curColor = data.curColor.data();
+
+    for (size_t c = 0; c < 4; c++)
+    {
+        beginColor[c] = data.beginColor[c].data();
+        deltaColor[c] = data.deltaColor[c].data();
+    }
+
+#if PARTICLES_USE_SSE2
+    auto vtime = _mm_set1_ps(curTime);
+    auto zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), max = _mm_set1_ps(255.0f);
+
+    for (; i+4 <= size; i += 4)
+    {
+        auto factor = _mm_mul_ps(_mm_sub_ps(vtime, _mm_loadu_ps(beginTime+i)), _mm_loadu_ps(invLifetime+i));
+        factor = _mm_min_ps(factor, one);
+
+        _mm_storeu_ps(curSize+i, _mm_add_ps(_mm_loadu_ps(beginSize+i), _mm_mul_ps(factor, _mm_loadu_ps(deltaSize+i))));
+
+        // sf::Color is laid out as r, g, b, a, so on little-endian targets each one is a packed 32-bit lane
+        __m128i packed = _mm_setzero_si128();
+        for (int c = 0; c < 4; c++)
+        {
+            auto color = _mm_add_ps(_mm_loadu_ps(beginColor[c]+i), _mm_mul_ps(factor, _mm_loadu_ps(deltaColor[c]+i)));
+            color = _mm_min_ps(_mm_max_ps(_mm_mul_ps(color, max), zero), max);
+            packed = _mm_or_si128(packed, _mm_slli_epi32(_mm_cvttps_epi32(color), 8*c));
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(curColor+i), packed);
+    }
+#endif
+
+    for (; i < size; i++)
+    {
+        float factor = std::min((curTime - beginTime[i]) * invLifetime[i], 1.0f);
+
+        curSize[i] = beginSize[i] + factor * deltaSize[i];
+        curColor[i] = sf::Color(toColorByte(beginColor[0][i] + factor * deltaColor[0][i]),
+                                toColorByte(beginColor[1][i] + factor * deltaColor[1][i]),
+                                toColorByte(beginColor[2][i] + factor * deltaColor[2][i]),
+                                toColorByte(beginColor[3][i] + factor * deltaColor[3][i]));
+    }
+}
+
+void removeExpiredParticles(ParticleData& data, float curTime)
+{
+    size_t size = data.size(), i = 0;
+    const float* endTime = data.endTime.data();
+
+#if PARTICLES_USE_SSE2
+    auto vtime = _mm_set1_ps(curTime);
+#endif
+
+    // expired particles are replaced by the last live one, like the batch did before, so a frame
+    // costs the live prefix scan plus one copy per lane for each particle that expired
+    for (;;)
+    {
+#if PARTICLES_USE_SSE2
+        // skip quickly over live runs, which are most of the batch on a typical frame
+        while (i+4 <= size && _mm_movemask_ps(_mm_cmpgt_ps(vtime, _mm_loadu_ps(endTime+i))) == 0)
+            i += 4;
+#endif
+        while (i < size && !(curTime > endTime[i])) i++;
+        if (i >= size) break;
+
+        while (size > i+1 && curTime > endTime[size-1]) size--;
+        size--;
+
+        if (i != size) forEachLane(data, [&](auto& lane) { lane[i] = lane[size]; });
+        i++;
+    }
+
+    if (size != data.size()) data.resize(size);
+}
+
+#if PARTICLES_USE_SSE2
+// Each row of p holds (x0, y0, x1, y1) for one particle, and the two low lanes of cs hold its
+// color bits and size; the six vertices are 30 dwords, written as seven and a half vector stores
+static inline void storeParticleQuad(float* out, __m128 p, __m128 cs)
+{
+    static_assert(sizeof(sf::Vertex) == 5*sizeof(float), "sf::Vertex must be tightly packed");
+
+    auto k0 = _mm_movelh_ps(cs, _mm_setzero_ps());          // c s 0 0
+    auto k1 = _mm_movelh_ps(cs, _mm_setr_ps(1, 3, 0, 0));   // c s 1 3
+    auto k2 = _mm_movelh_ps(cs, _mm_setr_ps(2, 0, 0, 0));   // c s 2 0
+
+    auto sx1 = _mm_shuffle_ps(k0, p, _MM_SHUFFLE(2, 2, 1, 1));  // s s x1 x1
+    auto y0c = _mm_shuffle_ps(p, k0, _MM_SHUFFLE(0, 0, 1, 1));  // y0 y0 c c
+    auto y1c = _mm_shuffle_ps(p, k0, _MM_SHUFFLE(0, 0, 3, 3));  // y1 y1 c c
+    auto r0 = _mm_shuffle_ps(p, k0, _MM_SHUFFLE(2, 0, 1, 0));   // x0 y0 c 0
+
+    _mm_storeu_ps(out, r0);
+    _mm_storeu_ps(out+4, _mm_shuffle_ps(sx1, y0c, _MM_SHUFFLE(2, 0, 2, 0)));   // s x1 y0 c
+    _mm_storeu_ps(out+8, _mm_shuffle_ps(_mm_shuffle_ps(k1, k1, _MM_SHUFFLE(1, 1, 2, 2)), p,
+        _MM_SHUFFLE(3, 2, 2, 0)));                                               // 1 s x1 y1
+    _mm_storeu_ps(out+12, _mm_shuffle_ps(k1, _mm_shuffle_ps(k1, p, _MM_SHUFFLE(0, 0, 1, 1)),
+        _MM_SHUFFLE(2, 0, 3, 0)));                                               // c 3 s x0
+    _mm_storeu_ps(out+16, _mm_shuffle_ps(y1c, _mm_shuffle_ps(k2, k2, _MM_SHUFFLE(1, 1, 2, 2)),
+        _MM_SHUFFLE(2, 0, 2, 0)));                                               // y1 c 2 s
+    _mm_storeu_ps(out+20, r0);
+    _mm_storeu_ps(out+24, _mm_shuffle_ps(sx1, y1c, _MM_SHUFFLE(2, 0, 2, 0)));  // s x1 y1 c
+    _mm_storel_pi(reinterpret_cast<__m64*>(out+28), _mm_shuffle_ps(k1, k1, _MM_SHUFFLE(1, 3, 1, 3)));  // 3 s
+}
+#endif
+
+void expandParticleQuads(const ParticleData& data, sf::Vertex* vertices)
+{
+    static const sf::Vector2f Offsets[] = { {-0.5f, -0.5f}, {+0.5f, -0.5f}, {+0.5f, +0.5f},
+                                            {-0.5f, +0.5f}, {-0.5f, -0.5f}, {+0.5f, +0.5f} };
+    static const float TexIds[] = { 0, 1, 3, 2, 0, 3 };
+
+    size_t count = data.size(), i = 0;
+
+#if PARTICLES_USE_SSE2
+    const float *x = data.x.data(), *y = data.y.data(), *curSize = data.curSize.data();
+    const sf::Color* curColor = data.curColor.data();
+    auto minusHalf = _mm_set1_ps(-0.5f), plusHalf = _mm_set1_ps(+0.5f);
+
+    for (; i+4 <= count; i += 4)
+    {
+        auto vx = _mm_loadu_ps(x+i), vy = _mm_loadu_ps(y+i), vsize = _mm_loadu_ps(curSize+i);
+        auto vcolor = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(curColor+i)));
+
+        // same operations as the scalar loop, so both produce the same vertices
+        auto x0 = _mm_add_ps(vx, _mm_mul_ps(minusHalf, vsize)), x1 = _mm_add_ps(vx, _mm_mul_ps(plusHalf, vsize));
+        auto y0 = _mm_add_ps(vy, _mm_mul_ps(minusHalf, vsize)), y1 = _mm_add_ps(vy, _mm_mul_ps(plusHalf, vsize));
+        _MM_TRANSPOSE4_PS(x0, y0, x1, y1);
+
+        auto cs01 = _mm_unpacklo_ps(vcolor, vsize), cs23 = _mm_unpackhi_ps(vcolor, vsize);
+        auto out = reinterpret_cast<float*>(vertices + 6*i);
+        storeParticleQuad(out, x0, cs01);
+        storeParticleQuad(out+30, y0, _mm_movehl_ps(cs01, cs01));
+        storeParticleQuad(out+60, x1, cs23);
+        storeParticleQuad(out+90, y1, _mm_movehl_ps(cs23, cs23));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        auto size = data.curSize[i];
+        auto color = data.curColor[i];
+
+        for (size_t k = 0; k < 6; k++)
+        {
+            auto& vertex = vertices[6*i+k];
+            vertex.position = sf::Vector2f(data.x[i] + Offsets[k].x * size, data.y[i] + Offsets[k].y * size);
+            vertex.color = color;
+            vertex.texCoords = sf::Vector2f(TexIds[k], size);
+        }
+    }
+}
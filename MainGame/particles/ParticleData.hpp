@@ -0,0 +1,67 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PARTICLES_USE_SSE2 1
+#else
+#define PARTICLES_USE_SSE2 0
+#endif
+
+// Structure-of-arrays storage for particles: every attribute lives in its own lane,
+// so the per-frame kernels below can process several particles per instruction
+struct ParticleData final
+{
+    std::vector<float> x, y, vx, vy, ax, ay;
+    std::vector<float> beginTime, endTime, invLifetime;
+    std::vector<float> beginColor[4], deltaColor[4];
+    std::vector<float> beginSize, deltaSize, curSize;
+    std::vector<sf::Color> curColor;
+    std::vector<uint32_t> owner;
+
+    size_t size() const { return x.size(); }
+    bool empty() const { return x.empty(); }
+
+    size_t capacity() const { return x.capacity(); }
+
+    void resize(size_t size);
+    void reserve(size_t capacity);
+    void clear() { resize(0); }
+
+    // Grows every lane by one and returns the index of the new particle; the lanes double
+    // their capacity together when full, so a burst of emissions reallocates them only a few times
+    size_t append();
+};
+
+void integrateParticles(ParticleData& data, float dt);
+void translateParticles(ParticleData& data, sf::Vector2f displacement);
+void interpolateParticles(ParticleData& data, float curTime);
+void removeExpiredParticles(ParticleData& data, float curTime);
+
+// Writes six vertices (two triangles) for each particle
+void expandParticleQuads(const ParticleData& data, sf::Vertex* vertices);
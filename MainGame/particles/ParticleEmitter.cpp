@@ -22,15 +22,22 @@
 
 
 #include "ParticleEmitter.hpp"
+#include "resources/FlatResourceData.hpp"
 
 #include <chronoUtils.hpp>
 #include <vector_math.hpp>
+#include <FlatLayouts.hpp>
 
 #include <utility>
 #include <limits>
 
 using namespace std::literals::chrono_literals;
 
+static ParticleSystem::Duration toDuration(float seconds)
+{
+    return std::chrono::duration_cast<ParticleSystem::Duration>(FloatSeconds(seconds));
+}
+
 bool readFromStream(sf::InputStream& stream, ParticleEmitter& in)
 {
     float lifetimeSeconds, emissionPeriodSeconds;
@@ -47,22 +54,78 @@ bool readFromStream(sf::InputStream& stream, ParticleEmitter& in)
                         in.colorBeginFirst, in.colorBeginSecond,
                         in.colorEndFirst, in.colorEndSecond, hsv)) return false;
 
-    if (lifetimeSeconds == std::numeric_limits<float>::infinity()) in.totalLifetime = ParticleBatch::Duration::max();
-    else in.totalLifetime = std::chrono::duration_cast<ParticleBatch::Duration>(FloatSeconds(lifetimeSeconds));
+    if (lifetimeSeconds == std::numeric_limits<float>::infinity()) in.totalLifetime = ParticleSystem::Duration::max();
+    else in.totalLifetime = toDuration(lifetimeSeconds);
     
-    in.emissionPeriod = std::chrono::duration_cast<ParticleBatch::Duration>(FloatSeconds(emissionPeriodSeconds));
-    in.lifetimeFirst = std::chrono::duration_cast<ParticleBatch::Duration>(FloatSeconds(firstSeconds));
-    in.lifetimeSecond = std::chrono::duration_cast<ParticleBatch::Duration>(FloatSeconds(secondSeconds));
+    in.emissionPeriod = toDuration(emissionPeriodSeconds);
+    in.lifetimeFirst = toDuration(firstSeconds);
+    in.lifetimeSecond = toDuration(secondSeconds);
     in.generateHSV = hsv;
 
     return true;
 }
 
+bool readFromFlat(const util::flat_particle_emitter& record, ParticleEmitter& in)
+{
+    auto color = [](const uint8_t (&c)[4]) { return sf::Color(c[0], c[1], c[2], c[3]); };
+
+    in.particleStyle = (ParticleSystem::Style)record.particleStyle;
+    if (record.totalLifetime == std::numeric_limits<float>::infinity()) in.totalLifetime = ParticleSystem::Duration::max();
+    else in.totalLifetime = toDuration(record.totalLifetime);
+    in.emissionPeriod = toDuration(record.emissionPeriod);
+
+    in.emissionCenter = sf::Vector2f(record.emissionCenter[0], record.emissionCenter[1]);
+    in.emissionHalfSize = sf::Vector2f(record.emissionHalfSize[0], record.emissionHalfSize[1]);
+    in.acceleration = sf::Vector2f(record.acceleration[0], record.acceleration[1]);
+    in.emissionInnerLimit = record.emissionInnerLimit;
+
+    in.directionFirst = record.direction[0];
+    in.directionSecond = record.direction[1];
+    in.directionCenterWeight = record.direction[2];
+    in.speedFirst = record.speed[0];
+    in.speedSecond = record.speed[1];
+    in.speedWeight = record.speed[2];
+    in.sizeBeginFirst = record.sizeBegin[0];
+    in.sizeBeginSecond = record.sizeBegin[1];
+    in.sizeBeginWeight = record.sizeBegin[2];
+    in.sizeEndFirst = record.sizeEnd[0];
+    in.sizeEndSecond = record.sizeEnd[1];
+    in.sizeEndWeight = record.sizeEnd[2];
+
+    in.lifetimeFirst = toDuration(record.lifetime[0]);
+    in.lifetimeSecond = toDuration(record.lifetime[1]);
+    in.colorBeginFirst = color(record.colorBegin[0]);
+    in.colorBeginSecond = color(record.colorBegin[1]);
+    in.colorEndFirst = color(record.colorEnd[0]);
+    in.colorEndSecond = color(record.colorEnd[1]);
+    in.generateHSV = record.generateHSV;
+
+    return true;
+}
+
+bool readFromFlat(const FlatResourceData& data, ParticleEmitterSet& set)
+{
+    const auto& reader = data.getReader();
+    util::flat_view<util::flat_string> names;
+    util::flat_view<util::flat_particle_emitter> emitters;
+    if (!reader.get(util::FlatEmitterNames, names) || !reader.get(util::FlatEmitters, emitters) ||
+        names.size() != emitters.size()) return false;
+
+    set.reserve(names.size());
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        std::string name;
+        if (!reader.get(names[i], name) || !readFromFlat(emitters[i], set[name])) return false;
+    }
+
+    return true;
+}
+
 util::generic_shared_ptr loadParticleEmitterList(std::unique_ptr<sf::InputStream>& stream)
 {
     std::shared_ptr<ParticleEmitterSet> content{new ParticleEmitterSet};
 
-    if (checkMagic(*stream, "PEMIT") && readFromStream(*stream, *content))
+    if (readFlatOrStream(*stream, "PEMIT", *content))
         return util::generic_shared_ptr{content};
 
     return util::generic_shared_ptr{};
@@ -108,7 +171,8 @@ sf::Color HSVtoRGB(float h, float s, float v, char a)
     }
 }
 
-sf::Color randomColor(std::function<float()> &generator, sf::Color c1, sf::Color c2, bool hsv)
+template <typename Generator>
+sf::Color randomColor(Generator& generator, sf::Color c1, sf::Color c2, bool hsv)
 {
     if (!hsv)
     {
@@ -137,16 +201,17 @@ float signedPowf(float x, float y)
     return x < 0 ? -up : up;
 }
 
-void ParticleEmitter::generateNewParticles(ParticleBatch& batch,
-    ParticleBatch::Duration cur, ParticleBatch::Duration last) const
+void ParticleEmitter::generateNewParticles(ParticleSystem& system, uint32_t index,
+    ParticleSystem::Duration cur, ParticleSystem::Duration last) const
 {
-	auto& generator = batch.generator;
+    auto generator = [&] { return system.random(); };
 
     size_t numParticles = cur/emissionPeriod - last/emissionPeriod;
+    if (numParticles > 0) system.reserveParticles(index, numParticles);
 
     for (size_t i = 0; i < numParticles; i++)
     {
-        ParticleBatch::PositionInfo posInfo;
+        ParticleSystem::PositionInfo posInfo;
 
         float insq = emissionInnerLimit * emissionInnerLimit;
         float radius = sqrtf(insq + generator()*(1 - insq));
@@ -164,13 +229,13 @@ void ParticleEmitter::generateNewParticles(ParticleBatch& batch,
 
         posInfo.acceleration = acceleration;
 
-        ParticleBatch::DisplayInfo displayInfo;
+        ParticleSystem::DisplayInfo displayInfo;
         displayInfo.beginColor = randomColor(generator, colorBeginFirst, colorBeginSecond, generateHSV);
         displayInfo.endColor = randomColor(generator, colorEndFirst, colorEndSecond, generateHSV);
         displayInfo.beginSize = sizeBeginFirst + powf(generator(), sizeBeginWeight) * (sizeBeginSecond - sizeBeginFirst);
         displayInfo.endSize = sizeEndFirst + powf(generator(), sizeEndWeight) * (sizeEndSecond - sizeEndFirst);
 
         auto lifetime = lifetimeFirst + generator() * (lifetimeSecond - lifetimeFirst);
-        batch.addParticle(posInfo, displayInfo, lifetime);
+        system.addParticle(index, posInfo, displayInfo, lifetime);
     }
 }
@@ -28,13 +28,16 @@
 
 #include <generic_ptrs.hpp>
 #include <streamReaders.hpp>
-#include "particles/ParticleBatch.hpp"
+#include "particles/ParticleSystem.hpp"
+
+namespace util { struct flat_particle_emitter; }
+class FlatResourceData;
 
 class ParticleEmitter final
 {
-    ParticleBatch::Style particleStyle;
-    ParticleBatch::Duration totalLifetime;
-    ParticleBatch::Duration emissionPeriod;
+    ParticleSystem::Style particleStyle;
+    ParticleSystem::Duration totalLifetime;
+    ParticleSystem::Duration emissionPeriod;
 
     sf::Vector2f emissionCenter;
     sf::Vector2f emissionHalfSize;
@@ -46,7 +49,7 @@ class ParticleEmitter final
     float sizeBeginFirst, sizeBeginSecond, sizeBeginWeight;
     float sizeEndFirst, sizeEndSecond, sizeEndWeight;
     
-    ParticleBatch::Duration lifetimeFirst, lifetimeSecond;
+    ParticleSystem::Duration lifetimeFirst, lifetimeSecond;
 
     sf::Color colorBeginFirst, colorBeginSecond;
     sf::Color colorEndFirst, colorEndSecond;
@@ -55,13 +58,16 @@ class ParticleEmitter final
 public:
 	ParticleEmitter() {}
 
-    void generateNewParticles(ParticleBatch& batch, ParticleBatch::Duration cur, ParticleBatch::Duration last) const;
+    void generateNewParticles(ParticleSystem& system, uint32_t index,
+        ParticleSystem::Duration cur, ParticleSystem::Duration last) const;
     auto getTotalLifetime() const { return totalLifetime; }
     auto getParticleStyle() const { return particleStyle; }
 
     friend bool readFromStream(sf::InputStream& stream, ParticleEmitter& in);
+    friend bool readFromFlat(const util::flat_particle_emitter& record, ParticleEmitter& in);
 };
 
-using ParticleEmitterSet = std::unordered_map<std::string,ParticleEmitter>;
+bool readFromFlat(const FlatResourceData& data, ParticleEmitterSet& set);
+
 
 util::generic_shared_ptr loadParticleEmitterList(std::unique_ptr<sf::InputStream>& stream);
@@ -0,0 +1,363 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "ParticleSystem.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include "particles/ParticleEmitter.hpp"
+#include "rendering/Renderer.hpp"
+#include "resources/ResourceManager.hpp"
+#include <assert.hpp>
+
+using namespace std::literals::chrono_literals;
+
+constexpr auto ParticleVertexShader = R"vertex(
+varying float PointSize;
+varying vec2 TexCoord;
+
+void main()
+{
+    gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;
+    PointSize = gl_MultiTexCoord0.y;
+    
+    float texId = gl_MultiTexCoord0.x;
+    TexCoord = vec2(mod(texId,2.0), floor(texId/2.0));
+    
+    gl_FrontColor = gl_Color;
+}
+)vertex";
+
+constexpr auto ParticleSmoothFragmentShader = R"fragment(
+varying vec2 TexCoord;
+
+void main()
+{
+    gl_FragColor = gl_Color;
+    gl_FragColor.a *= 1.0 - 2.0 * distance(TexCoord, vec2(0.5, 0.5));
+}
+)fragment";
+
+constexpr auto ParticleDiskFragmentShader = R"fragment(
+varying float PointSize;
+varying vec2 TexCoord;
+
+void main()
+{
+    gl_FragColor = gl_Color;
+    gl_FragColor.a *= clamp((1.0 - 2.0 * distance(TexCoord, vec2(0.5, 0.5))) * PointSize, 0.0, 1.0);
+}
+)fragment";
+
+const char* ParticleFragmentShaders[] = { ParticleSmoothFragmentShader, ParticleDiskFragmentShader };
+
+// Particle times are stored as floats relative to the epoch, which is moved forward
+// periodically so they don't lose precision over a long play session
+constexpr auto EpochRebasePeriod = 1024s;
+
+sf::Shader& ParticleSystem::getParticleShader(ParticleSystem::Style style)
+{
+    static sf::Shader shaders[(size_t)Style::MaxSize];
+    static bool shadersLoaded[(size_t)Style::MaxSize];
+
+    if (!shadersLoaded[(size_t)style])
+    {
+        ASSERT(shaders[(size_t)style].loadFromMemory(ParticleVertexShader, ParticleFragmentShaders[(size_t)style]));
+        shadersLoaded[(size_t)style] = true;
+    }
+
+    return shaders[(size_t)style];
+}
+
+inline static auto convertDuration(FrameDuration duration)
+{
+    return std::chrono::duration_cast<ParticleSystem::Duration>(duration);
+}
+
+ParticleSystem::ParticleSystem(ResourceManager& resourceManager) : resourceManager(resourceManager)
+{
+    std::random_device init;
+    randomEngine.seed(init());
+}
+
+ParticleSystem::~ParticleSystem()
+{
+}
+
+const ParticleEmitter* ParticleSystem::findEmitter(std::string_view setName, std::string_view emitterName)
+{
+    for (const auto& cached : emitterCache)
+        if (cached.setName == setName && cached.emitterName == emitterName)
+            return cached.emitter;
+
+    // first time this emitter is seen: load its set and keep it alive for the whole scene
+    auto emitterSet = resourceManager.load<ParticleEmitterSet>(std::string(setName));
+    auto emitter = &emitterSet->at(std::string(emitterName));
+
+    if (std::find(emitterSets.begin(), emitterSets.end(), emitterSet) == emitterSets.end())
+        emitterSets.push_back(emitterSet);
+
+    emitterCache.push_back(CachedEmitter{std::string(setName), std::string(emitterName), emitter});
+    return emitter;
+}
+
+uint32_t ParticleSystem::findBucket(ParticleSystem::Style style, size_t depth)
+{
+    for (uint32_t i = 0; i < buckets.size(); i++)
+        if (buckets[i].style == style && buckets[i].depth == depth)
+            return i;
+
+    buckets.push_back(Bucket{style, depth, ParticleData()});
+    return buckets.size()-1;
+}
+
+ParticleBatch ParticleSystem::spawn(std::string_view emitterSetName, std::string_view emitterName,
+    bool persistent, size_t depth)
+{
+    auto emitter = findEmitter(emitterSetName, emitterName);
+
+    uint32_t index;
+    if (!freeSlots.empty())
+    {
+        index = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else
+    {
+        index = slots.size();
+        slots.emplace_back();
+        slots.back().generation = 0;
+    }
+
+    auto& slot = slots[index];
+    slot.emitter = emitter;
+    slot.position = sf::Vector2f();
+    slot.initialTime = slot.lastTime = FrameTime();
+    slot.bucket = findBucket(emitter->getParticleStyle(), depth);
+    slot.liveParticles = 0;
+    slot.active = true;
+    slot.started = false;
+    slot.aborted = false;
+    slot.persistent = persistent;
+    slot.transitionState = false;
+
+    return ParticleBatch(*this, index, slot.generation);
+}
+
+void ParticleSystem::releaseSlot(uint32_t index)
+{
+    // bumping the generation invalidates every handle still pointing to this slot
+    slots[index].active = false;
+    slots[index].generation++;
+    freeSlots.push_back(index);
+}
+
+void ParticleSystem::removeOrphanParticles()
+{
+    constexpr auto Dead = -std::numeric_limits<float>::infinity();
+
+    for (auto& bucket : buckets)
+    {
+        auto& particles = bucket.particles;
+        bool anyDead = false;
+
+        for (size_t i = 0; i < particles.size(); i++)
+            if (!slots[particles.owner[i]].active)
+            {
+                particles.endTime[i] = Dead;
+                anyDead = true;
+            }
+
+        if (anyDead) removeExpiredParticles(particles, std::numeric_limits<float>::lowest());
+    }
+}
+
+void ParticleSystem::reserveParticles(uint32_t index, size_t count)
+{
+    auto& particles = buckets[slots[index].bucket].particles;
+    if (particles.size() + count > particles.capacity())
+        particles.reserve(std::max(particles.size() + count, 2*particles.capacity()));
+}
+
+void ParticleSystem::addParticle(uint32_t index, ParticleSystem::PositionInfo pos,
+                                 ParticleSystem::DisplayInfo display,
+                                 ParticleSystem::Duration lifetime)
+{
+    const auto& slot = slots[index];
+    auto& particles = buckets[slot.bucket].particles;
+
+    auto beginTime = toSeconds<float>(slot.lastTime - epoch);
+    auto i = particles.append();
+
+    particles.x[i] = pos.position.x + slot.position.x;
+    particles.y[i] = pos.position.y + slot.position.y;
+    particles.vx[i] = pos.velocity.x;
+    particles.vy[i] = pos.velocity.y;
+    particles.ax[i] = pos.acceleration.x;
+    particles.ay[i] = pos.acceleration.y;
+
+    particles.beginTime[i] = beginTime;
+    particles.endTime[i] = beginTime + toSeconds<float>(lifetime);
+    particles.invLifetime[i] = 1.0f / toSeconds<float>(lifetime);
+
+    const float beginColor[] = { display.beginColor.x, display.beginColor.y, display.beginColor.z, display.beginColor.w };
+    const float endColor[] = { display.endColor.x, display.endColor.y, display.endColor.z, display.endColor.w };
+    for (size_t c = 0; c < 4; c++)
+    {
+        particles.beginColor[c][i] = beginColor[c];
+        particles.deltaColor[c][i] = endColor[c] - beginColor[c];
+    }
+
+    particles.beginSize[i] = display.beginSize;
+    particles.deltaSize[i] = display.endSize - display.beginSize;
+    particles.curSize[i] = display.beginSize;
+    particles.curColor[i] = sf::Color(beginColor[0] * 255.f, beginColor[1] * 255.f,
+                                      beginColor[2] * 255.f, beginColor[3] * 255.f);
+    particles.owner[i] = index;
+}
+
+void ParticleSystem::rebaseTime(FrameTime curTime)
+{
+    if (curTime - epoch < EpochRebasePeriod) return;
+
+    auto shift = toSeconds<float>(curTime - epoch);
+    for (auto& bucket : buckets)
+    {
+        for (auto& time : bucket.particles.beginTime) time -= shift;
+        for (auto& time : bucket.particles.endTime) time -= shift;
+    }
+
+    epoch = curTime;
+}
+
+void ParticleSystem::update(FrameTime curTime)
+{
+    if (epoch == decltype(epoch)()) epoch = curTime;
+    if (lastUpdate == decltype(lastUpdate)()) lastUpdate = curTime;
+    rebaseTime(curTime);
+
+    auto dt = toSeconds<float>(curTime - lastUpdate);
+    auto time = toSeconds<float>(curTime - epoch);
+
+    for (auto& bucket : buckets)
+    {
+        integrateParticles(bucket.particles, dt);
+        interpolateParticles(bucket.particles, time);
+        removeExpiredParticles(bucket.particles, time);
+    }
+
+    for (uint32_t i = 0; i < slots.size(); i++)
+    {
+        auto& slot = slots[i];
+        if (!slot.active) continue;
+
+        if (!slot.started)
+        {
+            slot.initialTime = slot.lastTime = curTime;
+            slot.started = true;
+        }
+
+        if (!slot.aborted && curTime - slot.initialTime <= slot.emitter->getTotalLifetime())
+            slot.emitter->generateNewParticles(*this, i, convertDuration(curTime - slot.initialTime),
+                convertDuration(slot.lastTime - slot.initialTime));
+
+        slot.lastTime = curTime;
+        slot.liveParticles = 0;
+    }
+
+    for (const auto& bucket : buckets)
+        for (auto owner : bucket.particles.owner)
+            slots[owner].liveParticles++;
+
+    // emitters that can't emit anymore die together with their last particle
+    for (uint32_t i = 0; i < slots.size(); i++)
+    {
+        const auto& slot = slots[i];
+        if (slot.active && slot.liveParticles == 0 &&
+            (slot.aborted || curTime - slot.initialTime > slot.emitter->getTotalLifetime()))
+            releaseSlot(i);
+    }
+
+    lastUpdate = curTime;
+}
+
+void ParticleSystem::render(Renderer& renderer)
+{
+    for (const auto& bucket : buckets)
+    {
+        if (bucket.particles.empty()) continue;
+
+        vertices.resize(6*bucket.particles.size());
+        expandParticleQuads(bucket.particles, vertices.data());
+
+        sf::RenderStates states;
+        states.blendMode = sf::BlendAlpha;
+        states.shader = &getParticleShader(bucket.style);
+        renderer.pushVertices(vertices.data(), vertices.size(), sf::Triangles, states, bucket.depth);
+    }
+}
+
+void ParticleSystem::notifyScreenTransition(cpVect displacement)
+{
+    sf::Vector2f disp(displacement.x, displacement.y);
+
+    for (auto& bucket : buckets)
+        translateParticles(bucket.particles, disp);
+
+    for (auto& slot : slots)
+    {
+        if (!slot.active) continue;
+
+        slot.position += disp;
+        if (!slot.persistent) slot.transitionState = true;
+    }
+}
+
+void ParticleSystem::removeTransitionEmitters()
+{
+    bool anyRemoved = false;
+
+    for (uint32_t i = 0; i < slots.size(); i++)
+        if (slots[i].active && slots[i].transitionState)
+        {
+            releaseSlot(i);
+            anyRemoved = true;
+        }
+
+    if (anyRemoved) removeOrphanParticles();
+}
+
+void ParticleSystem::clear(bool removePersistent)
+{
+    bool anyRemoved = false;
+
+    for (uint32_t i = 0; i < slots.size(); i++)
+        if (slots[i].active && (removePersistent || !slots[i].persistent))
+        {
+            releaseSlot(i);
+            anyRemoved = true;
+        }
+
+    if (anyRemoved) removeOrphanParticles();
+}
@@ -0,0 +1,154 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <chronoUtils.hpp>
+#include <chipmunk/chipmunk.h>
+#include <non_copyable_movable.hpp>
+
+#include "particles/ParticleBatch.hpp"
+#include "particles/ParticleData.hpp"
+
+class Renderer;
+class ResourceManager;
+
+class ParticleEmitter;
+using ParticleEmitterSet = std::unordered_map<std::string,ParticleEmitter>;
+
+// Scene-wide owner of every live particle: emitters are pooled slots addressed by
+// ParticleBatch handles, and particles are stored in one bucket per (style, depth)
+// pair, so each bucket is drawn with a single call
+class ParticleSystem final : util::non_copyable
+{
+public:
+    enum class Style : uint8_t { Smooth, Disk, MaxSize };
+
+    using TimePoint = std::chrono::steady_clock::time_point;
+    using Duration = TimePoint::duration;
+
+    struct PositionInfo
+    {
+        sf::Vector2f position, velocity, acceleration;
+    };
+
+    struct DisplayInfo
+    {
+        sf::Glsl::Vec4 beginColor, endColor;
+        float beginSize, endSize;
+    };
+
+private:
+    static sf::Shader& getParticleShader(Style style);
+
+    struct EmitterSlot
+    {
+        const ParticleEmitter* emitter;
+        sf::Vector2f position;
+        FrameTime initialTime, lastTime;
+        uint32_t generation, bucket;
+        size_t liveParticles;
+        bool active, started, aborted, persistent, transitionState;
+    };
+
+    struct Bucket
+    {
+        Style style;
+        size_t depth;
+        ParticleData particles;
+    };
+
+    struct CachedEmitter
+    {
+        std::string setName, emitterName;
+        const ParticleEmitter* emitter;
+    };
+
+    ResourceManager& resourceManager;
+    std::mt19937 randomEngine;
+    std::uniform_real_distribution<float> distribution;
+
+    std::vector<EmitterSlot> slots;
+    std::vector<uint32_t> freeSlots;
+    std::vector<Bucket> buckets;
+
+    std::vector<std::shared_ptr<ParticleEmitterSet>> emitterSets;
+    std::vector<CachedEmitter> emitterCache;
+
+    std::vector<sf::Vertex> vertices;
+    FrameTime epoch, lastUpdate;
+
+    const ParticleEmitter* findEmitter(std::string_view setName, std::string_view emitterName);
+    uint32_t findBucket(Style style, size_t depth);
+
+    void releaseSlot(uint32_t index);
+    void removeOrphanParticles();
+    void rebaseTime(FrameTime curTime);
+
+public:
+    explicit ParticleSystem(ResourceManager& resourceManager);
+    ~ParticleSystem();
+
+    ParticleBatch spawn(std::string_view emitterSetName, std::string_view emitterName,
+        bool persistent = false, size_t depth = 12);
+    ParticleBatch spawn(std::string_view emitterSetName, std::string_view emitterName, size_t depth,
+        bool persistent = false) { return spawn(emitterSetName, emitterName, persistent, depth); }
+
+    // Makes room for a burst of particles of the emitter at once, before adding them one by one
+    void reserveParticles(uint32_t index, size_t count);
+    void addParticle(uint32_t index, PositionInfo pos, DisplayInfo display, Duration lifetime);
+
+    template <class Rep, class Period>
+    inline void addParticle(uint32_t index, PositionInfo pos, DisplayInfo display,
+        const std::chrono::duration<Rep,Period>& lt)
+    {
+        addParticle(index, pos, display, std::chrono::duration_cast<Duration>(lt));
+    }
+
+    float random() { return distribution(randomEngine); }
+
+    bool isAlive(uint32_t index, uint32_t generation) const
+    {
+        return index < slots.size() && slots[index].active && slots[index].generation == generation;
+    }
+
+    void setAborted(uint32_t index, bool aborted) { slots[index].aborted = aborted; }
+    sf::Vector2f getPosition(uint32_t index) const { return slots[index].position; }
+    void setPosition(uint32_t index, sf::Vector2f pos) { slots[index].position = pos; }
+
+    void update(FrameTime curTime);
+    void render(Renderer& renderer);
+
+    // Mirror the GameObject lifecycle: particles follow the scene through screen transitions,
+    // and emitters that are not persistent die either on a room load or when the transition ends
+    void notifyScreenTransition(cpVect displacement);
+    void removeTransitionEmitters();
+    void clear(bool removePersistent);
+};
@@ -224,5 +224,5 @@ void TextureExplosion::render(Renderer& renderer)
     sf::RenderStates states;
     states.blendMode = sf::BlendAlpha;
     states.texture = texture.get();
-    renderer.pushDrawable(vertices, states, drawingDepth);
+    renderer.pushVertices(vertices, states, drawingDepth);
 }
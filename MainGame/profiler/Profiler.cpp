@@ -0,0 +1,403 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+
+#include "Profiler.hpp"
+
+#if PROFILER_ENABLED
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+#if defined(__GNUC__) || defined(__clang__)
+#include <cxxabi.h>
+#endif
+
+namespace profiler
+{
+    constexpr size_t EventCapacity = 1 << 17;
+    constexpr double AverageWeight = 0.05;
+    constexpr double PeakDecay = 0.98;
+    constexpr size_t StaleFrames = 600;
+
+    using Clock = std::chrono::steady_clock;
+
+    enum class Phase : uint8_t { Begin, End, Frame };
+
+    struct Event
+    {
+        const char* name;
+        const char* detail;
+        int64_t timestamp;
+        Phase phase;
+    };
+
+    struct ZoneKey
+    {
+        const char* name;
+        const char* detail;
+
+        bool operator==(const ZoneKey& other) const { return name == other.name && detail == other.detail; }
+    };
+
+    struct ZoneKeyHash
+    {
+        size_t operator()(const ZoneKey& key) const
+        {
+            return std::hash<const void*>()(key.name) * 31 + std::hash<const void*>()(key.detail);
+        }
+    };
+
+    struct ZoneAccumulator
+    {
+        size_t depth = 0, order = 0;
+        int64_t frameNanoseconds = 0;
+        size_t frameCalls = 0;
+
+        bool initialized = false;
+        double average = 0, peak = 0, averageCalls = 0;
+        size_t lastSeenFrame = 0;
+    };
+
+    struct ThreadBuffer
+    {
+        std::string name;
+        const char* lastNameSet = nullptr;
+        size_t id;
+
+        // single producer (the owning thread); the exporter reads it through writeIndex
+        std::unique_ptr<Event[]> events;
+        std::atomic<uint64_t> writeIndex;
+
+        // touched only by the owning thread, on markFrame() and getZoneStats()
+        uint64_t frameBeginIndex = 0;
+        size_t frameCount = 0;
+        int64_t lastFrameTimestamp = 0;
+        double averageFrame = 0;
+        std::vector<uint64_t> scanStack;
+        std::unordered_map<ZoneKey, ZoneAccumulator, ZoneKeyHash> zones;
+
+        ThreadBuffer(size_t id) : name("Thread " + std::to_string(id)), id(id),
+            events(new Event[EventCapacity]), writeIndex(0) {}
+    };
+
+    struct Registry
+    {
+        const Clock::time_point epoch = Clock::now();
+
+        // buffers outlive their threads, so the trace still shows finished ones
+        std::mutex mutex;
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+
+        std::mutex internMutex;
+        std::unordered_set<std::string> internedNames;
+    };
+
+    static Registry& getRegistry()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    static ThreadBuffer& getThreadBuffer()
+    {
+        thread_local std::shared_ptr<ThreadBuffer> buffer = []
+        {
+            auto& registry = getRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.buffers.push_back(std::make_shared<ThreadBuffer>(registry.buffers.size() + 1));
+            return registry.buffers.back();
+        }();
+
+        return *buffer;
+    }
+
+    static int64_t now() noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - getRegistry().epoch).count();
+    }
+
+    static void record(ThreadBuffer& buffer, const char* name, const char* detail, Phase phase) noexcept
+    {
+        auto index = buffer.writeIndex.load(std::memory_order_relaxed);
+        buffer.events[index & (EventCapacity - 1)] = { name, detail, now(), phase };
+        buffer.writeIndex.store(index + 1, std::memory_order_release);
+    }
+
+    static std::string demangle(const char* name)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        int status;
+        std::unique_ptr<char, decltype(&std::free)> result(abi::__cxa_demangle(name, nullptr, nullptr, &status),
+            &std::free);
+        if (status == 0) return result.get();
+#endif
+        // MSVC's type_info::name() is already human-readable, and interned details are plain strings
+        return name;
+    }
+
+    void beginZone(const char* name, const char* detail) noexcept
+    {
+        record(getThreadBuffer(), name, detail, Phase::Begin);
+    }
+
+    void endZone() noexcept
+    {
+        record(getThreadBuffer(), nullptr, nullptr, Phase::End);
+    }
+
+    static void updateZoneStats(ThreadBuffer& buffer, int64_t frameTimestamp)
+    {
+        auto end = buffer.writeIndex.load(std::memory_order_relaxed);
+        auto begin = std::max(buffer.frameBeginIndex, end > EventCapacity ? end - EventCapacity : 0);
+        buffer.frameBeginIndex = end;
+        buffer.frameCount++;
+
+        if (buffer.lastFrameTimestamp != 0)
+        {
+            double frameMilliseconds = (frameTimestamp - buffer.lastFrameTimestamp) / 1000000.0;
+            buffer.averageFrame += AverageWeight * (frameMilliseconds - buffer.averageFrame);
+        }
+        buffer.lastFrameTimestamp = frameTimestamp;
+
+        buffer.scanStack.clear();
+        for (auto i = begin; i < end; i++)
+        {
+            const auto& event = buffer.events[i & (EventCapacity - 1)];
+            if (event.phase == Phase::Begin) buffer.scanStack.push_back(i);
+            else if (event.phase == Phase::End && !buffer.scanStack.empty())
+            {
+                const auto& beginEvent = buffer.events[buffer.scanStack.back() & (EventCapacity - 1)];
+                auto& zone = buffer.zones[{ beginEvent.name, beginEvent.detail }];
+
+                // the position in the frame keeps the overlay ordered like the zone tree
+                zone.depth = buffer.scanStack.size() - 1;
+                zone.order = buffer.scanStack.back() - begin;
+                zone.frameNanoseconds += event.timestamp - beginEvent.timestamp;
+                zone.frameCalls++;
+                buffer.scanStack.pop_back();
+            }
+        }
+
+        for (auto it = buffer.zones.begin(); it != buffer.zones.end();)
+        {
+            auto& zone = it->second;
+            double frameMilliseconds = zone.frameNanoseconds / 1000000.0;
+
+            if (!zone.initialized)
+            {
+                zone.average = frameMilliseconds;
+                zone.averageCalls = zone.frameCalls;
+                zone.initialized = true;
+            }
+            else
+            {
+                zone.average += AverageWeight * (frameMilliseconds - zone.average);
+                zone.averageCalls += AverageWeight * (zone.frameCalls - zone.averageCalls);
+            }
+            zone.peak = std::max(frameMilliseconds, zone.peak * PeakDecay);
+
+            if (zone.frameCalls > 0) zone.lastSeenFrame = buffer.frameCount;
+            zone.frameNanoseconds = 0;
+            zone.frameCalls = 0;
+
+            if (buffer.frameCount - zone.lastSeenFrame > StaleFrames) it = buffer.zones.erase(it);
+            else ++it;
+        }
+    }
+
+    void markFrame() noexcept
+    {
+        auto& buffer = getThreadBuffer();
+        record(buffer, "Frame", nullptr, Phase::Frame);
+        updateZoneStats(buffer, buffer.events[(buffer.writeIndex - 1) & (EventCapacity - 1)].timestamp);
+    }
+
+    void setThreadName(const char* name)
+    {
+        // cheap enough to call from callbacks that run on foreign threads, like the audio one
+        auto& buffer = getThreadBuffer();
+        if (buffer.lastNameSet == name) return;
+        buffer.lastNameSet = name;
+
+        std::lock_guard<std::mutex> lock(getRegistry().mutex);
+        buffer.name = name;
+    }
+
+    const char* internName(const std::string& name)
+    {
+        auto& registry = getRegistry();
+        std::lock_guard<std::mutex> lock(registry.internMutex);
+        return registry.internedNames.insert(name).first->c_str();
+    }
+
+    std::vector<ZoneStats> getZoneStats()
+    {
+        auto& buffer = getThreadBuffer();
+
+        std::vector<std::pair<size_t, ZoneStats>> orderedStats;
+        orderedStats.reserve(buffer.zones.size());
+        for (const auto& entry : buffer.zones)
+        {
+            std::string name = entry.first.name;
+            if (entry.first.detail) name += " [" + demangle(entry.first.detail) + "]";
+
+            const auto& zone = entry.second;
+            orderedStats.push_back({ zone.order,
+                { std::move(name), zone.depth, zone.average, zone.peak, zone.averageCalls } });
+        }
+
+        std::sort(orderedStats.begin(), orderedStats.end(),
+            [](const auto& s1, const auto& s2) { return s1.first < s2.first; });
+
+        std::vector<ZoneStats> stats;
+        stats.reserve(orderedStats.size());
+        for (auto& entry : orderedStats) stats.push_back(std::move(entry.second));
+        return stats;
+    }
+
+    double getAverageFrameMilliseconds()
+    {
+        return getThreadBuffer().averageFrame;
+    }
+
+    static void writeJsonString(std::ostream& out, const std::string& str)
+    {
+        out << '"';
+        for (char c : str)
+        {
+            if (c == '"' || c == '\\') out << '\\' << c;
+            else if ((unsigned char)c < 0x20)
+                out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c << std::dec;
+            else out << c;
+        }
+        out << '"';
+    }
+
+    bool writeChromeTrace(const std::string& filename)
+    {
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        std::vector<std::string> threadNames;
+        {
+            auto& registry = getRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            buffers = registry.buffers;
+            for (const auto& buffer : buffers) threadNames.push_back(buffer->name);
+        }
+
+        std::ofstream out(filename);
+        if (!out) return false;
+
+        out << std::fixed << std::setprecision(3);
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+        bool first = true;
+        auto beginEvent = [&](const char* phase, size_t tid, const std::string& name)
+        {
+            if (!first) out << ",\n";
+            first = false;
+            out << "{\"pid\":1,\"tid\":" << tid << ",\"ph\":\"" << phase << "\",\"name\":";
+            writeJsonString(out, name);
+        };
+
+        std::unordered_map<const char*, std::string> demangledDetails;
+        auto writeDetail = [&](const char* detail)
+        {
+            if (!detail) return;
+            auto it = demangledDetails.find(detail);
+            if (it == demangledDetails.end()) it = demangledDetails.emplace(detail, demangle(detail)).first;
+            out << ",\"args\":{\"detail\":";
+            writeJsonString(out, it->second);
+            out << '}';
+        };
+
+        std::vector<Event> snapshot;
+        std::vector<size_t> stack;
+        for (size_t k = 0; k < buffers.size(); k++)
+        {
+            auto& buffer = *buffers[k];
+            beginEvent("M", buffer.id, "thread_name");
+            out << ",\"args\":{\"name\":";
+            writeJsonString(out, threadNames[k]);
+            out << "}}";
+
+            // the owning thread keeps writing while we copy, so anything it may have
+            // overwritten in the meantime is dropped instead of stopping it
+            auto end = buffer.writeIndex.load(std::memory_order_acquire);
+            auto begin = end > EventCapacity ? end - EventCapacity : 0;
+            snapshot.clear();
+            for (auto i = begin; i < end; i++) snapshot.push_back(buffer.events[i & (EventCapacity - 1)]);
+
+            auto written = buffer.writeIndex.load(std::memory_order_acquire);
+            auto validBegin = written > EventCapacity ? written - EventCapacity : 0;
+            size_t firstValid = validBegin > begin ? validBegin - begin : 0;
+
+            stack.clear();
+            for (size_t i = firstValid; i < snapshot.size(); i++)
+            {
+                const auto& event = snapshot[i];
+                if (event.phase == Phase::Begin) stack.push_back(i);
+                else if (event.phase == Phase::End)
+                {
+                    if (stack.empty()) continue;
+                    const auto& zone = snapshot[stack.back()];
+                    stack.pop_back();
+
+                    beginEvent("X", buffer.id, zone.name);
+                    out << ",\"ts\":" << zone.timestamp / 1000.0
+                        << ",\"dur\":" << (event.timestamp - zone.timestamp) / 1000.0;
+                    writeDetail(zone.detail);
+                    out << '}';
+                }
+                else
+                {
+                    beginEvent("i", buffer.id, event.name);
+                    out << ",\"ts\":" << event.timestamp / 1000.0 << ",\"s\":\"t\"}";
+                }
+            }
+
+            // zones still open at the time of the snapshot extend to the end of the trace
+            for (auto i : stack)
+            {
+                beginEvent("B", buffer.id, snapshot[i].name);
+                out << ",\"ts\":" << snapshot[i].timestamp / 1000.0;
+                writeDetail(snapshot[i].detail);
+                out << '}';
+            }
+        }
+
+        out << "]}\n";
+        return (bool)out;
+    }
+}
+
+#endif
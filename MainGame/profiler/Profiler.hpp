@@ -0,0 +1,96 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+
+#pragma once
+
+// The profiler is compiled out unless the build defines PROFILER_ENABLED=1 (the ENABLE_PROFILER
+// CMake option does that); every PROFILE_* macro then expands to nothing, arguments included
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 0
+#endif
+
+#if PROFILER_ENABLED
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <typeinfo>
+
+namespace profiler
+{
+    // name and detail must outlive the profiler: string literals, type_info names or internName() results
+    void beginZone(const char* name, const char* detail = nullptr) noexcept;
+    void endZone() noexcept;
+    void markFrame() noexcept;
+
+    void setThreadName(const char* name);
+    const char* internName(const std::string& name);
+
+    struct ZoneStats
+    {
+        std::string name;
+        size_t depth;
+        double averageMilliseconds, peakMilliseconds, averageCalls;
+    };
+
+    // moving averages of the zones recorded by the calling thread, updated on each markFrame()
+    std::vector<ZoneStats> getZoneStats();
+    double getAverageFrameMilliseconds();
+
+    // Chrome trace-event JSON, loadable by chrome://tracing and Perfetto
+    bool writeChromeTrace(const std::string& filename);
+
+    class ScopedZone final
+    {
+    public:
+        explicit ScopedZone(const char* name, const char* detail = nullptr) noexcept { beginZone(name, detail); }
+        ~ScopedZone() { endZone(); }
+
+        ScopedZone(const ScopedZone&) = delete;
+        ScopedZone& operator=(const ScopedZone&) = delete;
+    };
+}
+
+#define PROFILER_CONCAT_IMPL(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_IMPL(a, b)
+
+#define PROFILE_ZONE(name) ::profiler::ScopedZone PROFILER_CONCAT(profilerZone, __COUNTER__)(name)
+#define PROFILE_ZONE_DETAIL(name, detail) \
+    ::profiler::ScopedZone PROFILER_CONCAT(profilerZone, __COUNTER__)(name, detail)
+#define PROFILE_OBJECT_ZONE(zoneName, object) \
+    ::profiler::ScopedZone PROFILER_CONCAT(profilerZone, __COUNTER__)(zoneName, typeid(object).name())
+#define PROFILE_INTERN(str) ::profiler::internName(str)
+#define PROFILE_THREAD(name) ::profiler::setThreadName(name)
+#define PROFILE_FRAME() ::profiler::markFrame()
+
+#else
+
+#define PROFILE_ZONE(name)
+#define PROFILE_ZONE_DETAIL(name, detail)
+#define PROFILE_OBJECT_ZONE(zoneName, object)
+#define PROFILE_INTERN(str)
+#define PROFILE_THREAD(name)
+#define PROFILE_FRAME()
+
+#endif
@@ -0,0 +1,85 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+
+#include "ProfilerOverlay.hpp"
+
+#if PROFILER_ENABLED
+
+#include "resources/ResourceManager.hpp"
+#include "rendering/Renderer.hpp"
+
+#include <cstdio>
+
+constexpr size_t RefreshPeriod = 15;
+constexpr size_t MaxLines = 40;
+constexpr long OverlayDepth = 2000000000;
+
+ProfilerOverlay::ProfilerOverlay(ResourceManager& resourceManager)
+    : text(resourceManager.load<FontHandler>("RobotoMono-Regular.ttf")), visible(false), framesUntilRefresh(0)
+{
+    text.setFontSize(12);
+    text.setDefaultColor(sf::Color::White);
+    text.setDefaultOutlineColor(sf::Color::Black);
+    text.setOutlineThickness(1);
+    text.setHorizontalAnchor(TextDrawable::HorAnchor::Left);
+    text.setVerticalAnchor(TextDrawable::VertAnchor::Top);
+}
+
+void ProfilerOverlay::update()
+{
+    if (!visible || framesUntilRefresh-- > 0) return;
+    framesUntilRefresh = RefreshPeriod;
+
+    char line[256];
+    std::snprintf(line, sizeof(line), "frame %6.2f ms      avg ms   peak ms  calls\n",
+        profiler::getAverageFrameMilliseconds());
+    std::string str = line;
+
+    size_t lines = 0;
+    for (const auto& zone : profiler::getZoneStats())
+    {
+        if (lines++ == MaxLines) break;
+
+        auto name = std::string(2 * zone.depth, ' ') + zone.name;
+        if (name.size() > 48) name.replace(45, std::string::npos, "...");
+        std::snprintf(line, sizeof(line), "%-48s %8.3f %8.3f %6.1f\n", name.c_str(),
+            zone.averageMilliseconds, zone.peakMilliseconds, zone.averageCalls);
+        str += line;
+    }
+
+    text.setString(std::move(str));
+    text.buildGeometry();
+}
+
+void ProfilerOverlay::render(Renderer& renderer)
+{
+    if (!visible) return;
+
+    renderer.pushTransform();
+    renderer.currentTransform.translate(4, 4);
+    renderer.pushDrawable(text, {}, OverlayDepth);
+    renderer.popTransform();
+}
+
+#endif
@@ -22,8 +22,11 @@
 
 
 #include "Renderer.hpp"
+#include "profiler/Profiler.hpp"
 
 #include <iostream>
+#include <algorithm>
+#include <limits>
 
 Renderer::Renderer(Renderer&& other) noexcept : Renderer()
 {
@@ -40,8 +43,15 @@ void swap(Renderer& r1, Renderer& r2)
 {
     using std::swap;
     
-    swap(r1.drawableList, r2.drawableList);
+    swap(r1.commandList, r2.commandList);
+    swap(r1.vertexArena, r2.vertexArena);
+    swap(r1.batchBuffer, r2.batchBuffer);
+    swap(r1.sortKeys, r2.sortKeys);
+    swap(r1.sortKeysScratch, r2.sortKeysScratch);
+    swap(r1.sortIndices, r2.sortIndices);
+    swap(r1.sortIndicesScratch, r2.sortIndicesScratch);
     swap(r1.transformStack, r2.transformStack);
+    swap(r1.lastStats, r2.lastStats);
     swap(r1.currentTransform, r2.currentTransform);
 }
 
@@ -56,18 +66,174 @@ inline static std::ostream& operator<<(std::ostream& out, const sf::Transform& t
 void Renderer::pushDrawable(const sf::Drawable &drawable, sf::RenderStates states, long depth)
 {
     states.transform.combine(currentTransform);
-    drawableList.emplace(depth, std::make_pair(std::cref(drawable), states));
+    commandList.push_back({ &drawable, states, sf::Triangles, 0, 0, depth });
+}
+
+void Renderer::pushVertices(const sf::Vertex* vertices, size_t vertexCount, sf::PrimitiveType type,
+    sf::RenderStates states, long depth)
+{
+    states.transform.combine(currentTransform);
+
+    auto begin = vertexArena.size();
+    auto push = [&](const sf::Vertex& vertex)
+    {
+        vertexArena.push_back(vertex);
+        vertexArena.back().position = states.transform.transformPoint(vertex.position);
+    };
+
+    // Strips, fans and quads can't be concatenated, so they are unrolled into their base primitives
+    switch (type)
+    {
+        case sf::Points:
+        case sf::Lines:
+        case sf::Triangles:
+            for (size_t i = 0; i < vertexCount; i++) push(vertices[i]);
+            break;
+        case sf::LineStrip:
+            for (size_t i = 0; i+1 < vertexCount; i++)
+            {
+                push(vertices[i]);
+                push(vertices[i+1]);
+            }
+            type = sf::Lines;
+            break;
+        case sf::TriangleStrip:
+            for (size_t i = 0; i+2 < vertexCount; i++)
+            {
+                push(vertices[i]);
+                push(vertices[i+1]);
+                push(vertices[i+2]);
+            }
+            type = sf::Triangles;
+            break;
+        case sf::TriangleFan:
+            for (size_t i = 1; i+1 < vertexCount; i++)
+            {
+                push(vertices[0]);
+                push(vertices[i]);
+                push(vertices[i+1]);
+            }
+            type = sf::Triangles;
+            break;
+        case sf::Quads:
+            for (size_t i = 0; i+3 < vertexCount; i += 4)
+            {
+                push(vertices[i]);
+                push(vertices[i+1]);
+                push(vertices[i+2]);
+                push(vertices[i]);
+                push(vertices[i+2]);
+                push(vertices[i+3]);
+            }
+            type = sf::Triangles;
+            break;
+    }
+
+    if (vertexArena.size() == begin) return;
+
+    states.transform = sf::Transform::Identity;
+    commandList.push_back({ nullptr, states, type, begin, vertexArena.size() - begin, depth });
+}
+
+static bool areStatesCompatible(const sf::RenderStates& s1, const sf::RenderStates& s2)
+{
+    return s1.shader == s2.shader && s1.texture == s2.texture && s1.blendMode == s2.blendMode;
+}
+
+static bool canMerge(const RenderCommand& c1, const RenderCommand& c2)
+{
+    return !c1.drawable && !c2.drawable && c1.primitiveType == c2.primitiveType
+        && areStatesCompatible(c1.states, c2.states);
+}
+
+void Renderer::sortCommands()
+{
+    auto size = commandList.size();
+
+    sortKeys.resize(size);
+    sortKeysScratch.resize(size);
+    sortIndices.resize(size);
+    sortIndicesScratch.resize(size);
+
+    for (size_t i = 0; i < size; i++)
+    {
+        auto depth = std::clamp<long>(commandList[i].depth, std::numeric_limits<int32_t>::min(),
+            std::numeric_limits<int32_t>::max());
+
+        sortKeys[i] = (uint32_t)((int64_t)depth - std::numeric_limits<int32_t>::min());
+        sortIndices[i] = i;
+    }
+
+    // LSD radix sort on the depth; being stable, it preserves the push order inside a depth,
+    // so only commands that were pushed one after the other can end up merged
+    for (size_t shift = 0; shift < 32; shift += 8)
+    {
+        size_t counts[257] = {};
+        for (auto key : sortKeys) counts[((key >> shift) & 0xFF) + 1]++;
+
+        // all keys share this digit, the pass wouldn't change anything
+        if (std::find(counts+1, counts+257, size) != counts+257) continue;
+
+        for (size_t i = 1; i < 257; i++) counts[i] += counts[i-1];
+        for (size_t i = 0; i < size; i++)
+        {
+            auto pos = counts[(sortKeys[i] >> shift) & 0xFF]++;
+            sortKeysScratch[pos] = sortKeys[i];
+            sortIndicesScratch[pos] = sortIndices[i];
+        }
+
+        std::swap(sortKeys, sortKeysScratch);
+        std::swap(sortIndices, sortIndicesScratch);
+    }
 }
 
 void Renderer::render(sf::RenderTarget& target)
 {
-    for (const auto& pair : drawableList)
-        target.draw(pair.second.first, pair.second.second);
+    PROFILE_ZONE("Renderer::render");
+    sortCommands();
+    lastStats = { commandList.size(), 0, 0, 0 };
+
+    for (size_t i = 0; i < sortIndices.size();)
+    {
+        const auto& command = commandList[sortIndices[i]];
+
+        if (command.drawable)
+        {
+            target.draw(*command.drawable, command.states);
+            lastStats.drawCallCount++;
+            i++;
+            continue;
+        }
+
+        size_t j = i+1;
+        while (j < sortIndices.size() && canMerge(command, commandList[sortIndices[j]])) j++;
+
+        if (j == i+1) target.draw(&vertexArena[command.vertexBegin], command.vertexCount,
+            command.primitiveType, command.states);
+        else
+        {
+            batchBuffer.clear();
+            for (size_t k = i; k < j; k++)
+            {
+                const auto& cur = commandList[sortIndices[k]];
+                batchBuffer.insert(batchBuffer.end(), vertexArena.begin() + cur.vertexBegin,
+                    vertexArena.begin() + cur.vertexBegin + cur.vertexCount);
+            }
+
+            target.draw(batchBuffer.data(), batchBuffer.size(), command.primitiveType, command.states);
+            lastStats.batchCount++;
+            lastStats.batchedCommandCount += j-i;
+        }
+
+        lastStats.drawCallCount++;
+        i = j;
+    }
 }
 
 void Renderer::clearState()
 {
-    drawableList.clear();
+    commandList.clear();
+    vertexArena.clear();
 
     while (!transformStack.empty())
         transformStack.pop();
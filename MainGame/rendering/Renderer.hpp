@@ -25,30 +25,67 @@
 
 #include <SFML/Graphics.hpp>
 #include <memory>
-#include <map>
+#include <vector>
 #include <stack>
+#include <cstdint>
 #include <non_copyable_movable.hpp>
 
-using RenderData = std::pair<std::reference_wrapper<const sf::Drawable>,sf::RenderStates>;
+struct RenderCommand
+{
+    const sf::Drawable* drawable;
+    sf::RenderStates states;
+    sf::PrimitiveType primitiveType;
+    size_t vertexBegin, vertexCount;
+    long depth;
+};
+
+struct RenderStats
+{
+    size_t commandCount, drawCallCount, batchCount, batchedCommandCount;
+};
 
 class Renderer final : util::non_copyable
 {
-    std::multimap<long,RenderData> drawableList;
+    // All of these are per-frame arenas: they are cleared, but never shrunk, by clearState
+    std::vector<RenderCommand> commandList;
+    std::vector<sf::Vertex> vertexArena, batchBuffer;
+    std::vector<uint32_t> sortKeys, sortKeysScratch;
+    std::vector<uint32_t> sortIndices, sortIndicesScratch;
     std::stack<sf::Transform> transformStack;
 
+    RenderStats lastStats;
+
+    void sortCommands();
+
 public:
-    Renderer() noexcept : currentTransform(sf::Transform::Identity) {}
+    Renderer() noexcept : lastStats{}, currentTransform(sf::Transform::Identity) {}
     Renderer(Renderer&& other) noexcept;
     Renderer& operator=(Renderer other);
 
     void pushDrawable(const sf::Drawable &drawable, sf::RenderStates states, long depth = 0);
 
+    // The vertices are copied and pre-transformed, so consecutive pushes on the same depth with
+    // compatible states are merged into a single draw call; the shader must not rely on per-draw uniforms
+    void pushVertices(const sf::Vertex* vertices, size_t vertexCount, sf::PrimitiveType type,
+        sf::RenderStates states, long depth = 0);
+    void pushVertices(const sf::VertexArray& vertices, sf::RenderStates states, long depth = 0)
+    {
+        if (vertices.getVertexCount() > 0)
+            pushVertices(&vertices[0], vertices.getVertexCount(), vertices.getPrimitiveType(), states, depth);
+    }
+
     void pushTransform();
     void popTransform();
 
     void render(sf::RenderTarget& target);
     void clearState();
 
+    const RenderStats& getLastFrameStats() const { return lastStats; }
+
+    // What was pushed since the last clearState, in push order; vertex commands index into getVertices
+    const std::vector<RenderCommand>& getCommands() const { return commandList; }
+    const std::vector<sf::Vertex>& getVertices() const { return vertexArena; }
+
     sf::Transform currentTransform;
     
     friend void swap(Renderer& r1, Renderer& r2);
@@ -23,6 +23,7 @@
 
 #include "WindowHandler.hpp"
 #include "defaults.hpp"
+#include "profiler/Profiler.hpp"
 #include <stdexcept>
 #include <SFML/OpenGL.hpp>
 
@@ -134,6 +135,7 @@ void WindowHandler::prepareForDraw()
 
 void WindowHandler::display()
 {
+    PROFILE_ZONE("WindowHandler::display");
     if (getFullscreen())
     {
         fullscreenTexture->clear();
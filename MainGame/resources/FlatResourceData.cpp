@@ -0,0 +1,71 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "FlatResourceData.hpp"
+#include "MappedInputStream.hpp"
+
+#include <algorithm>
+
+namespace
+{
+    struct alignas(util::FlatAlignment) flat_block
+    {
+        char bytes[util::FlatAlignment];
+    };
+}
+
+bool FlatResourceData::isFlat(sf::InputStream& stream)
+{
+    auto position = stream.tell();
+    if (position < 0) return false;
+
+    char magic[4];
+    bool result = stream.read(magic, sizeof(magic)) == sizeof(magic) && std::equal(magic, magic+4, "FLAT");
+    return stream.seek(position) == position && result;
+}
+
+bool FlatResourceData::load(sf::InputStream& stream, const char* type)
+{
+    if (auto mapped = dynamic_cast<MappedInputStream*>(&stream))
+    {
+        if (reader.open(mapped->getData(), mapped->getDataSize(), type))
+        {
+            owner = mapped->getOwner();
+            return true;
+        }
+
+        // only a misaligned mapping is worth another try through a copy
+        if ((uintptr_t)mapped->getData() % util::FlatAlignment == 0) return false;
+    }
+
+    auto size = stream.getSize();
+    if (size <= 0 || stream.seek(0) != 0) return false;
+
+    std::shared_ptr<flat_block> memory(new flat_block[(size + util::FlatAlignment - 1) / util::FlatAlignment],
+        std::default_delete<flat_block[]>());
+    if (stream.read(memory.get(), size) != size) return false;
+
+    if (!reader.open(memory.get(), size, type)) return false;
+    owner = std::move(memory);
+    return true;
+}
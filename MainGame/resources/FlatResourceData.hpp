@@ -0,0 +1,63 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+
+#pragma once
+
+#include <SFML/System.hpp>
+#include <FlatResource.hpp>
+#include <streamReaders.hpp>
+#include <memory>
+
+// The bytes of a resource exported in the flat layout: the pack mapping itself when the
+// stream comes from it, or a single aligned copy otherwise. Views taken from the reader
+// are valid as long as this object is.
+class FlatResourceData final
+{
+    std::shared_ptr<const void> owner;
+    util::flat_reader reader;
+
+public:
+    FlatResourceData() {}
+
+    // Peeks at the magic and leaves the stream where it was, so legacy readers can take over
+    static bool isFlat(sf::InputStream& stream);
+
+    bool load(sf::InputStream& stream, const char* type);
+
+    const util::flat_reader& getReader() const { return reader; }
+    const auto& getOwner() const { return owner; }
+};
+
+// Resources are detected by their magic, so rooms, tilesets, levels and particle
+// emitters exported before the flat layout keep loading through the stream readers;
+// readFromFlat may keep views into the data, as long as it also keeps its owner
+template <typename T>
+bool readFlatOrStream(sf::InputStream& stream, const char* magic, T& content)
+{
+    if (!FlatResourceData::isFlat(stream))
+        return checkMagic(stream, magic) && readFromStream(stream, content);
+
+    FlatResourceData data;
+    return data.load(stream, magic) && readFromFlat(data, content);
+}
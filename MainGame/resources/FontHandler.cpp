@@ -22,29 +22,98 @@
 
 
 #include "FontHandler.hpp"
+#include "MappedInputStream.hpp"
+#include <streamReaders.hpp>
 
 using namespace util;
 
-FontHandler::FontHandler(std::unique_ptr<const char[]> &&data, size_t size) : fontData(std::move(data)),
+FontHandler::FontHandler(std::shared_ptr<const char> data, size_t size) : fontData(std::move(data)),
     harfBuzzWrapper(fontData.get(), size)
 {
     if (!font.loadFromMemory(fontData.get(), size))
         throw -1;
 }
 
+FontHandler::FontHandler(std::shared_ptr<const char> data, size_t size, std::shared_ptr<const SdfFont> sdfFont)
+    : fontData(std::move(data)), sdfFont(std::move(sdfFont)), harfBuzzWrapper(fontData.get(), size) {}
+
+float FontHandler::getAscent(unsigned int size) const
+{
+    return sdfFont ? sdfFont->getAscent(size) : font.getAscent(size);
+}
+
+float FontHandler::getDescent(unsigned int size) const
+{
+    return sdfFont ? sdfFont->getDescent(size) : font.getDescent(size);
+}
+
+float FontHandler::getLineSpacing(unsigned int size) const
+{
+    return sdfFont ? sdfFont->getLineSpacing(size) : font.getLineSpacing(size);
+}
+
+float FontHandler::getCharacterAdvance(uint32_t codePoint, unsigned int size) const
+{
+    return sdfFont ? sdfFont->getCharacterAdvance(codePoint, size) : font.getGlyph(codePoint, size, false).advance;
+}
+
+// Takes the whole font file; mapped fonts are used in place, the data keeps the mapping alive
+static bool readFontData(std::unique_ptr<sf::InputStream>& stream, std::shared_ptr<const char>& data, size_t& size)
+{
+    if (auto mapped = dynamic_cast<MappedInputStream*>(stream.get()))
+    {
+        data = std::shared_ptr<const char>(mapped->getOwner(), mapped->getData());
+        size = mapped->getDataSize();
+        return true;
+    }
+
+    auto streamSize = stream->getSize();
+    if (streamSize == -1) return false;
+    if (stream->seek(0) != 0) return false;
+    
+    std::unique_ptr<char[]> memory(new char[streamSize]);
+    if (stream->read(memory.get(), streamSize) != streamSize)
+        return false;
+        
+    data = std::shared_ptr<const char>(memory.release(), std::default_delete<char[]>());
+    size = streamSize;
+    return true;
+}
+
 util::generic_shared_ptr loadFontHandler(std::unique_ptr<sf::InputStream>& stream)
 {
     try
     {
-        auto size = stream->getSize();
-        if (size == -1) return generic_shared_ptr{};
-        if (stream->seek(0) != 0) return generic_shared_ptr{};
-        
-        std::unique_ptr<char[]> memory(new char[size]);
-        if (stream->read(memory.get(), size) != size)
+        std::shared_ptr<const char> data;
+        size_t size;
+        if (!readFontData(stream, data, size)) return generic_shared_ptr{};
+
+        return generic_shared_ptr{std::make_shared<FontHandler>(std::move(data), size)};
+    }
+    catch (...)
+    {
+        return generic_shared_ptr{};
+    }
+}
+
+util::generic_shared_ptr loadSdfFontHandler(std::unique_ptr<sf::InputStream>& stream, ResourceLocator& locator)
+{
+    try
+    {
+        auto sdfFont = std::make_shared<SdfFont>();
+        if (!checkMagic(*stream, SdfFont::ReadMagic) || !readFromStream(*stream, *sdfFont))
             return generic_shared_ptr{};
-            
-        return generic_shared_ptr{std::make_shared<FontHandler>(std::move(memory), size)};
+
+        // the atlas is followed by the name of the shipped font HarfBuzz shapes with
+        std::string fontName;
+        if (!readFromStream(*stream, fontName)) return generic_shared_ptr{};
+
+        auto fontStream = locator.getResource(fontName);
+        std::shared_ptr<const char> data;
+        size_t size;
+        if (!readFontData(fontStream, data, size)) return generic_shared_ptr{};
+
+        return generic_shared_ptr{std::make_shared<FontHandler>(std::move(data), size, std::move(sdfFont))};
     }
     catch (...)
     {
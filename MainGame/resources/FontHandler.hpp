@@ -27,15 +27,20 @@
 #include <generic_ptrs.hpp>
 #include <memory>
 #include "unicode/HarfBuzzWrapper.hpp"
+#include "SdfFont.hpp"
+#include "ResourceLocator.hpp"
 
 class FontHandler final
 {
-    std::unique_ptr<const char[]> fontData;
+    std::shared_ptr<const char> fontData;
     sf::Font font;
+    std::shared_ptr<const SdfFont> sdfFont;
     HarfBuzzWrapper harfBuzzWrapper;
     
 public:
-    FontHandler(std::unique_ptr<const char[]> &&data, size_t size);
+    FontHandler(std::shared_ptr<const char> data, size_t size);
+    // Distance field fonts only keep the font data for shaping
+    FontHandler(std::shared_ptr<const char> data, size_t size, std::shared_ptr<const SdfFont> sdfFont);
     ~FontHandler() {}
     
     FontHandler(const FontHandler&) = delete;
@@ -43,6 +48,13 @@ public:
     
     auto& getFont() { return font; }
     auto& getHBWrapper() { return harfBuzzWrapper; }
+    const auto& getSdfFont() const { return sdfFont; }
+
+    float getAscent(unsigned int size) const;
+    float getDescent(unsigned int size) const;
+    float getLineSpacing(unsigned int size) const;
+    float getCharacterAdvance(uint32_t codePoint, unsigned int size) const;
 };
 
 util::generic_shared_ptr loadFontHandler(std::unique_ptr<sf::InputStream>&);
+util::generic_shared_ptr loadSdfFontHandler(std::unique_ptr<sf::InputStream>&, ResourceLocator&);
@@ -0,0 +1,50 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#pragma once
+
+#include <SFML/System.hpp>
+#include <memory>
+
+// An input stream over a block of memory that outlives any copy of its owner, so loaders
+// that can consume memory directly may keep a reference to the bytes instead of copying them
+class MappedInputStream final : public sf::InputStream
+{
+    std::shared_ptr<const void> owner;
+    const char* data;
+    sf::Int64 size, offset;
+
+public:
+    MappedInputStream(std::shared_ptr<const void> owner, const void* data, size_t size)
+        : owner(std::move(owner)), data(static_cast<const char*>(data)), size(size), offset(0) {}
+    virtual ~MappedInputStream() {}
+
+    virtual sf::Int64 read(void* dest, sf::Int64 count) override;
+    virtual sf::Int64 seek(sf::Int64 position) override;
+    virtual sf::Int64 tell() override { return offset; }
+    virtual sf::Int64 getSize() override { return size; }
+
+    const auto& getOwner() const { return owner; }
+    const char* getData() const { return data; }
+    size_t getDataSize() const { return size; }
+};
@@ -0,0 +1,164 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "PackResourceLocator.hpp"
+#include "FilesystemResourceLocator.hpp"
+#include "MappedInputStream.hpp"
+#include "execDir.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+#if _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+class PackResourceLocator::Mapping final
+{
+#if _WIN32
+    HANDLE file, fileMapping;
+#endif
+    const char* base;
+    size_t size;
+
+public:
+    Mapping(const std::string& filename);
+    ~Mapping();
+
+    Mapping(const Mapping&) = delete;
+    Mapping& operator=(const Mapping&) = delete;
+
+    const char* getBase() const { return base; }
+    size_t getSize() const { return size; }
+};
+
+#if _WIN32
+PackResourceLocator::Mapping::Mapping(const std::string& filename) : fileMapping(nullptr), base(nullptr), size(0)
+{
+    file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) throw PackFileError(filename, "could not open the file");
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize))
+    {
+        CloseHandle(file);
+        throw PackFileError(filename, "could not query the file size");
+    }
+    size = fileSize.QuadPart;
+
+    fileMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (fileMapping) base = static_cast<const char*>(MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0));
+
+    if (!base)
+    {
+        if (fileMapping) CloseHandle(fileMapping);
+        CloseHandle(file);
+        throw PackFileError(filename, "could not map the file");
+    }
+}
+
+PackResourceLocator::Mapping::~Mapping()
+{
+    UnmapViewOfFile(base);
+    CloseHandle(fileMapping);
+    CloseHandle(file);
+}
+#else
+PackResourceLocator::Mapping::Mapping(const std::string& filename) : base(nullptr), size(0)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) throw PackFileError(filename, "could not open the file");
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        throw PackFileError(filename, "could not query the file size");
+    }
+    size = st.st_size;
+
+    auto ptr = size > 0 ? mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+
+    if (ptr == MAP_FAILED) throw PackFileError(filename, "could not map the file");
+    base = static_cast<const char*>(ptr);
+}
+
+PackResourceLocator::Mapping::~Mapping()
+{
+    munmap(const_cast<char*>(base), size);
+}
+#endif
+
+PackResourceLocator::PackResourceLocator() : PackResourceLocator(getExecutableDirectory() + "/Resources.pak") {}
+
+PackResourceLocator::PackResourceLocator(const std::string& filename)
+    : mapping(std::make_shared<Mapping>(filename))
+{
+    auto base = mapping->getBase();
+    auto size = mapping->getSize();
+
+    if (size < sizeof(Header)) throw PackFileError(filename, "file too short");
+
+    Header header;
+    std::memcpy(&header, base, sizeof(Header));
+    if (std::memcmp(header.magic, "RPAK", 4) != 0) throw PackFileError(filename, "invalid magic");
+    if (header.version != Version) throw PackFileError(filename, "unsupported version");
+
+    size_t indexEnd = sizeof(Header) + (size_t)header.entryCount * sizeof(Entry) + header.nameBlobSize;
+    if (indexEnd > size) throw PackFileError(filename, "truncated index");
+
+    entries = reinterpret_cast<const Entry*>(base + sizeof(Header));
+    names = base + sizeof(Header) + header.entryCount * sizeof(Entry);
+    entryCount = header.entryCount;
+
+    for (size_t i = 0; i < entryCount; i++)
+    {
+        const auto& entry = entries[i];
+        if (entry.offset > size || entry.size > size - entry.offset ||
+            (uint64_t)entry.nameOffset + entry.nameLength > header.nameBlobSize)
+            throw PackFileError(filename, "corrupted index entry");
+    }
+}
+
+std::unique_ptr<sf::InputStream> PackResourceLocator::getResource(std::string name)
+{
+    auto entryName = [this](const Entry& entry)
+    {
+        return std::string_view(names + entry.nameOffset, entry.nameLength);
+    };
+
+    auto it = std::lower_bound(entries, entries + entryCount, std::string_view(name),
+        [&](const Entry& entry, std::string_view name) { return entryName(entry) < name; });
+    if (it == entries + entryCount || entryName(*it) != name) throw FileNotFound(name);
+
+    return std::make_unique<MappedInputStream>(mapping, mapping->getBase() + it->offset, it->size);
+}
@@ -0,0 +1,72 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#pragma once
+
+#include "ResourceLocator.hpp"
+#include <string>
+#include <cstdint>
+#include <stdexcept>
+
+class PackResourceLocator : public ResourceLocator
+{
+public:
+    // Keep in sync with ExportTools/pack-resources.cpp
+#pragma pack(push, 1)
+    struct Header
+    {
+        char magic[4];
+        uint32_t version, entryCount, nameBlobSize;
+    };
+
+    struct Entry
+    {
+        uint64_t offset, size;
+        uint32_t nameOffset, nameLength;
+    };
+#pragma pack(pop)
+
+    static constexpr uint32_t Version = 1;
+
+private:
+    class Mapping;
+
+    std::shared_ptr<const Mapping> mapping;
+    const Entry* entries;
+    const char* names;
+    size_t entryCount;
+
+public:
+    PackResourceLocator();
+    explicit PackResourceLocator(const std::string& filename);
+    virtual ~PackResourceLocator() {}
+
+    virtual std::unique_ptr<sf::InputStream> getResource(std::string name) override;
+};
+
+class PackFileError : public std::runtime_error
+{
+public:
+    inline PackFileError(std::string name, std::string reason)
+    : std::runtime_error("Error opening resource pack " + name + ": " + reason + "!") {}
+};
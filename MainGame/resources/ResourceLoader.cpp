@@ -33,19 +33,22 @@
 #include "data/TileSet.hpp"
 #include "particles/ParticleEmitter.hpp"
 #include "audio/readWav.hpp"
+#include "audio/readVorbis.hpp"
 
 #include "FontHandler.hpp"
+#include "FlatResourceData.hpp"
 
 using namespace util;
 using namespace ResourceLoader;
 
 using loadFunc = generic_shared_ptr (*)(std::unique_ptr<sf::InputStream>&);
+using locatorLoadFunc = generic_shared_ptr (*)(std::unique_ptr<sf::InputStream>&, ResourceLocator&);
 
 template <typename T>
 generic_shared_ptr loadGenericResource(std::unique_ptr<sf::InputStream>& stream)
 {
     std::shared_ptr<T> content{new T()};
-	if (checkMagic(*stream, T::ReadMagic) && readFromStream(*stream, *content))
+	if (readFlatOrStream(*stream, T::ReadMagic, *content))
 		return generic_shared_ptr{content};
 
     return generic_shared_ptr{};
@@ -70,12 +73,23 @@ const std::unordered_map<std::string,loadFunc> loadFuncs =
     { "png", loadSFMLResource<sf::Texture> },
     { "ttf", loadFontHandler },
     { "wav", loadWaveFile },
+    { "ogg", loadVorbisFile },
 };
 
-generic_shared_ptr ResourceLoader::loadFromStream(std::unique_ptr<sf::InputStream> stream, std::string type)
+const std::unordered_map<std::string,locatorLoadFunc> locatorLoadFuncs =
+{
+    { "sdf", loadSdfFontHandler },
+};
+
+generic_shared_ptr ResourceLoader::loadFromStream(std::unique_ptr<sf::InputStream> stream, std::string type,
+    ResourceLocator* locator)
 {
     auto it = loadFuncs.find(type);
 	if (it != loadFuncs.end())
 		return it->second(stream);
+
+    auto lit = locatorLoadFuncs.find(type);
+    if (lit != locatorLoadFuncs.end() && locator)
+        return lit->second(stream, *locator);
     return generic_shared_ptr{};
 }
@@ -27,10 +27,13 @@
 #include <SFML/System.hpp>
 
 #include <generic_ptrs.hpp>
+#include "ResourceLocator.hpp"
 
 namespace ResourceLoader
 {
-    util::generic_shared_ptr loadFromStream(std::unique_ptr<sf::InputStream> stream, std::string type);
+    // locator opens the other resources a type refers to, like the font an .sdf shapes with
+    util::generic_shared_ptr loadFromStream(std::unique_ptr<sf::InputStream> stream, std::string type,
+        ResourceLocator* locator = nullptr);
 }
 
 class ResourceLoadingError : public std::runtime_error
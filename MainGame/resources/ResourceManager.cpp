@@ -23,68 +23,152 @@
 
 #include "ResourceManager.hpp"
 #include "ResourceLoader.hpp"
+#include "profiler/Profiler.hpp"
+
+#include <algorithm>
+#include <iostream>
 
 using namespace util;
 
+bool ResourceFuture::isReady() const
+{
+    return future.valid() && future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
 
-ResourceManager::ResourceManager() : loadCommandQueue(12), loadingThread(&ResourceManager::loadLoop, this)
+generic_shared_ptr ResourceFuture::get() const
 {
-    
+    auto ptr = future.get();
+    if (!ptr) throw ResourceLoadingError(id);
+    return ptr;
+}
+
+ResourceManager::ResourceManager(size_t workerCount) : stopping(false), cacheHits(0), cacheMisses(0)
+{
+    if (workerCount == 0)
+        workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+    for (size_t i = 0; i < workerCount; i++)
+        loadingThreads.emplace_back(&ResourceManager::loadLoop, this);
 }
 
 ResourceManager::~ResourceManager()
 {
-    loadCommandQueue.enqueue("");
-    loadingThread.join();
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        stopping = true;
+    }
+
+    loadRequested.notify_all();
+    for (auto& thread : loadingThreads) thread.join();
 }
 
 void ResourceManager::loadLoop()
 {
-    std::string id("---");
+    PROFILE_THREAD("Resource loader");
+    std::unique_lock<std::mutex> lock(cacheMutex);
 
     for (;;)
     {
-        loadCommandQueue.wait_dequeue(id);
-        if (id.empty()) break;
+        loadRequested.wait(lock, [this] { return stopping || !blockingQueue.empty() || !prefetchQueue.empty(); });
+        if (stopping) break;
 
-        std::unique_lock<std::mutex> lock(cacheMutex);
-        if (cache.find(id) != cache.end())
-        {
-            newResourceLoaded.notify_one();
-            continue;
-        }
+        auto& queue = blockingQueue.empty() ? prefetchQueue : blockingQueue;
+        auto id = std::move(queue.front());
+        queue.pop_front();
+
+        // a promoted prefetch leaves a stale entry in the other queue
+        auto it = pendingLoads.find(id);
+        if (it == pendingLoads.end() || it->second.started) continue;
+        it->second.started = true;
 
         lock.unlock();
-        auto type = id.substr(id.find_last_of('.') + 1);
-        auto ptr = ResourceLoader::loadFromStream(locator->getResource(id), type);
+        generic_shared_ptr ptr;
+        try
+        {
+            PROFILE_ZONE_DETAIL("ResourceManager::load", PROFILE_INTERN(id));
+            auto type = id.substr(id.find_last_of('.') + 1);
+            ptr = ResourceLoader::loadFromStream(locator->getResource(id), type, locator.get());
+            if (!ptr) std::cout << "WARNING! Could not load the resource " << id << std::endl;
+        }
+        catch (const std::exception& exception)
+        {
+            std::cout << "WARNING! Could not load the resource " << id << ": " << exception.what() << std::endl;
+        }
         lock.lock();
 
-        cache.emplace(id, ptr);
-        newResourceLoaded.notify_one();
+        // failures aren't cached, so the next request for the resource tries loading it again
+        if (ptr) cache.emplace(id, ptr);
+
+        it = pendingLoads.find(id);
+        it->second.promise.set_value(ptr);
+        pendingLoads.erase(it);
     }
 }
 
-void ResourceManager::requestLoadAsync(std::string id)
+std::shared_future<generic_shared_ptr> ResourceManager::enqueueLoad(const std::string& id, LoadPriority priority)
 {
-    loadCommandQueue.enqueue(std::move(id));
+    auto it = pendingLoads.find(id);
+    if (it != pendingLoads.end())
+    {
+        auto& pending = it->second;
+        if (!pending.started && pending.priority < priority)
+        {
+            pending.priority = priority;
+            blockingQueue.push_back(id);
+            loadRequested.notify_one();
+        }
+
+        return pending.future;
+    }
+
+    auto& pending = pendingLoads[id];
+    pending.future = pending.promise.get_future().share();
+    pending.priority = priority;
+    pending.started = false;
+
+    (priority == LoadPriority::Blocking ? blockingQueue : prefetchQueue).push_back(id);
+    loadRequested.notify_one();
+
+    return pending.future;
+}
+
+ResourceFuture ResourceManager::requestLoadAsync(std::string id, LoadPriority priority)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+
+    auto it = cache.find(id);
+    if (it != cache.end())
+    {
+        std::promise<generic_shared_ptr> promise;
+        promise.set_value(it->second);
+        return ResourceFuture(std::move(id), promise.get_future().share());
+    }
+
+    auto future = enqueueLoad(id, priority);
+    return ResourceFuture(std::move(id), std::move(future));
 }
 
 generic_shared_ptr ResourceManager::load(std::string id)
 {
     if (id.empty()) return generic_shared_ptr{};
 
-    std::unique_lock<std::mutex> lock(cacheMutex);
-    
-    auto it = cache.find(id);
-    if (it == cache.end())
+    std::shared_future<generic_shared_ptr> future;
     {
-        requestLoadAsync(id);
-        while ((it = cache.find(id)) == cache.end())
-            newResourceLoaded.wait(lock);
+        std::lock_guard<std::mutex> lock(cacheMutex);
+
+        auto it = cache.find(id);
+        if (it != cache.end())
+        {
+            if (!it->second) throw ResourceLoadingError(id);
+            cacheHits++;
+            return it->second;
+        }
+
+        cacheMisses++;
+        future = enqueueLoad(id, LoadPriority::Blocking);
     }
 
-    if (!it->second) throw ResourceLoadingError(id);
-    return it->second;
+    return ResourceFuture(std::move(id), std::move(future)).get();
 }
 
 void ResourceManager::collectUnusedResources()
@@ -27,29 +27,69 @@
 #include <string>
 #include <memory>
 #include <thread>
-#include <shared_mutex>
+#include <deque>
+#include <vector>
+#include <future>
+#include <mutex>
+#include <atomic>
 #include <condition_variable>
 #include <generic_ptrs.hpp>
 #include <non_copyable_movable.hpp>
 #include "ResourceLocator.hpp"
-#include "readerwriterqueue/readerwriterqueue.h"
+
+enum class LoadPriority : uint8_t { Prefetch, Blocking };
+
+class ResourceFuture final
+{
+    std::string id;
+    std::shared_future<util::generic_shared_ptr> future;
+
+public:
+    ResourceFuture() {}
+    ResourceFuture(std::string id, std::shared_future<util::generic_shared_ptr> future)
+        : id(std::move(id)), future(std::move(future)) {}
+
+    bool valid() const { return future.valid(); }
+    bool isReady() const;
+
+    util::generic_shared_ptr get() const;
+
+    template <typename T>
+    std::shared_ptr<T> get() const { return get().as<T>(); }
+};
 
 class ResourceManager : util::non_copyable_movable
 {
-    moodycamel::BlockingReaderWriterQueue<std::string,32> loadCommandQueue;
+    struct PendingLoad
+    {
+        std::promise<util::generic_shared_ptr> promise;
+        std::shared_future<util::generic_shared_ptr> future;
+        LoadPriority priority;
+        bool started;
+    };
+
     std::mutex cacheMutex;
-    std::condition_variable newResourceLoaded;
-    std::thread loadingThread;
+    std::condition_variable loadRequested;
+    std::deque<std::string> blockingQueue, prefetchQueue;
+    std::unordered_map<std::string,PendingLoad> pendingLoads;
+    std::vector<std::thread> loadingThreads;
+    bool stopping;
+
+    std::atomic<size_t> cacheHits, cacheMisses;
 
     std::unordered_map<std::string,util::generic_shared_ptr> cache;
     std::unique_ptr<ResourceLocator> locator;
 
+    // must be called with cacheMutex held
+    std::shared_future<util::generic_shared_ptr> enqueueLoad(const std::string& id, LoadPriority priority);
+
 public:
-    ResourceManager();
+    // workerCount == 0 picks one worker per spare hardware thread
+    explicit ResourceManager(size_t workerCount = 0);
     ~ResourceManager();
 
     void loadLoop();
-    void requestLoadAsync(std::string id);
+    ResourceFuture requestLoadAsync(std::string id, LoadPriority priority = LoadPriority::Prefetch);
     util::generic_shared_ptr load(std::string id);
 
     template <typename T>
@@ -57,6 +97,11 @@ public:
 
     void collectUnusedResources();
 
+    // a miss is a load() call that had to wait for a worker to decode the resource
+    size_t getCacheHitCount() const { return cacheHits; }
+    size_t getCacheMissCount() const { return cacheMisses; }
+    void resetCacheCounters() { cacheHits = cacheMisses = 0; }
+
     ResourceLocator* getResourceLocator() { return locator.get(); }
     void setResourceLocator(ResourceLocator* loc) { locator.reset(loc); }
 };
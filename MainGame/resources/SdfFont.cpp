@@ -0,0 +1,119 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+
+#include "SdfFont.hpp"
+
+#include <streamReaders.hpp>
+#include <algorithm>
+#include <vector>
+
+const SdfFont::Glyph& SdfFont::getBakedGlyph(uint32_t index) const
+{
+    auto it = glyphs.find(index);
+    if (it == glyphs.end()) it = glyphs.find(0);
+    return it->second;
+}
+
+sf::Glyph SdfFont::getGlyph(uint32_t index, unsigned int size) const
+{
+    const auto& baked = getBakedGlyph(index);
+    float scale = size / bakeSize;
+
+    sf::Glyph glyph;
+    glyph.advance = baked.advance * scale;
+    glyph.bounds = sf::FloatRect(baked.bounds.left * scale, baked.bounds.top * scale,
+        baked.bounds.width * scale, baked.bounds.height * scale);
+    glyph.textureRect = baked.textureRect;
+    return glyph;
+}
+
+float SdfFont::getCharacterAdvance(uint32_t codePoint, unsigned int size) const
+{
+    auto it = characterMap.find(codePoint);
+    return getBakedGlyph(it == characterMap.end() ? 0 : it->second).advance * size / bakeSize;
+}
+
+float SdfFont::getEdgeThreshold(unsigned int size, float thickness) const
+{
+    // thickness is in screen pixels, the field encodes spread baked pixels on each side of the edge
+    float bakedThickness = thickness * bakeSize / size;
+    return std::max(0.0f, 0.5f - bakedThickness / (2 * spread));
+}
+
+bool readFromStream(sf::InputStream& stream, SdfFont& font)
+{
+    if (!readFromStream(stream, font.bakeSize, font.spread, font.ascent, font.descent, font.lineSpacing))
+        return false;
+    if (font.bakeSize <= 0 || font.spread <= 0) return false;
+
+    size_t width, height;
+    if (!readFromStream(stream, varLength(width), varLength(height))) return false;
+
+    std::vector<uint8_t> distances(width * height);
+    if (stream.read(distances.data(), distances.size()) != (sf::Int64)distances.size()) return false;
+
+    // The distance goes to the alpha channel, so the vertex color tints the glyphs
+    std::vector<sf::Uint8> pixels(4 * distances.size(), 255);
+    for (size_t i = 0; i < distances.size(); i++)
+        pixels[4*i+3] = distances[i];
+
+    if (!font.atlas.create(width, height)) return false;
+    font.atlas.update(pixels.data());
+    font.atlas.setSmooth(true);
+
+    size_t numGlyphs;
+    if (!readFromStream(stream, varLength(numGlyphs))) return false;
+
+    font.glyphs.clear();
+    font.glyphs.reserve(numGlyphs);
+    for (size_t i = 0; i < numGlyphs; i++)
+    {
+        size_t index, w, h, x, y;
+        SdfFont::Glyph glyph;
+        if (!readFromStream(stream, varLength(index), glyph.advance, glyph.bounds.left, glyph.bounds.top)) return false;
+        if (!readFromStream(stream, varLength(w), varLength(h), varLength(x), varLength(y))) return false;
+        if (x + w > width || y + h > height) return false;
+
+        glyph.bounds.width = w;
+        glyph.bounds.height = h;
+        glyph.textureRect = sf::IntRect(x, y, w, h);
+        font.glyphs.emplace(index, glyph);
+    }
+
+    if (font.glyphs.find(0) == font.glyphs.end()) return false;
+
+    size_t numCharacters;
+    if (!readFromStream(stream, varLength(numCharacters))) return false;
+
+    font.characterMap.clear();
+    font.characterMap.reserve(numCharacters);
+    for (size_t i = 0; i < numCharacters; i++)
+    {
+        size_t codePoint, index;
+        if (!readFromStream(stream, varLength(codePoint), varLength(index))) return false;
+        font.characterMap.emplace(codePoint, index);
+    }
+
+    return true;
+}
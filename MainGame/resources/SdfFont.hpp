@@ -0,0 +1,76 @@
+//
+// Copyright (c) 2016-2018 João Baptista de Paula e Silva.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <unordered_map>
+
+// A font baked offline into a signed distance field atlas; the edge of every
+// glyph sits on 0.5, so a single texture renders the glyphs at any size
+class SdfFont final
+{
+public:
+    static constexpr auto ReadMagic = "SDFF";
+
+    struct Glyph
+    {
+        float advance;
+        sf::FloatRect bounds;
+        sf::IntRect textureRect;
+    };
+
+private:
+    float bakeSize, spread;
+    float ascent, descent, lineSpacing;
+    sf::Texture atlas;
+
+    std::unordered_map<uint32_t,Glyph> glyphs;
+    std::unordered_map<uint32_t,uint32_t> characterMap;
+
+    const Glyph& getBakedGlyph(uint32_t index) const;
+
+public:
+    SdfFont() {}
+
+    SdfFont(const SdfFont&) = delete;
+    SdfFont& operator=(const SdfFont&) = delete;
+
+    sf::Glyph getGlyph(uint32_t index, unsigned int size) const;
+    float getCharacterAdvance(uint32_t codePoint, unsigned int size) const;
+
+    float getAscent(unsigned int size) const { return ascent * size / bakeSize; }
+    float getDescent(unsigned int size) const { return descent * size / bakeSize; }
+    float getLineSpacing(unsigned int size) const { return lineSpacing * size / bakeSize; }
+
+    // The distance value at which an outline of the given thickness begins
+    float getEdgeThreshold(unsigned int size, float thickness) const;
+
+    const auto& getTexture() const { return atlas; }
+
+    friend bool readFromStream(sf::InputStream& stream, SdfFont& font);
+};
+
+bool readFromStream(sf::InputStream& stream, SdfFont& font);
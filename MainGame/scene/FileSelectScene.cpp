@@ -34,7 +34,7 @@
 #include "rendering/Renderer.hpp"
 #include "defaults.hpp"
 #include "gameplay/SavedGame.hpp"
-#include "streams/FileOutputStream.hpp"
+#include "gameplay/SaveService.hpp"
 #include "execDir.hpp"
 
 #include "audio/AudioManager.hpp"
@@ -58,14 +58,6 @@ bool loadSaveFromFile(SavedGame& sg, std::string file, SavedGame::Key key)
     return readEncryptedSaveFile(stream, sg, key);
 }
 
-bool saveSaveToFile(const SavedGame& sg, std::string file, SavedGame::Key& key)
-{
-    FileOutputStream stream;
-    auto fullName = getExecutableDirectory() + '/' + file;
-    if (!stream.open(fullName)) return false;
-    return writeEncryptedSaveFile(stream, sg, key);
-}
-
 std::string getNextFileSlot()
 {
     auto files = getAllFilesInDir(getExecutableDirectory());
@@ -80,7 +72,7 @@ FileSelectScene::FileSelectScene(Services& services, const SavedGame& savedGame,
     : sceneFrame(services.resourceManager.load<sf::Texture>("mid-level-scene-frame.png"), sf::Vector2f(0, 0)),
     pointer(services), buttonGroup(services, TravelingMode::Vertical), cancelButton(services.inputManager, 8),
     headerBackground(services.resourceManager.load<sf::Texture>("ui-file-button-frame.png")),
-    headerLabel(loadDefaultFont(services))
+    headerLabel(loadDefaultFont(services)), services(services), saving(false)
 {
     sceneFrame.setBlendColor(sf::Color(128, 128, 128, 255));
 
@@ -99,14 +91,18 @@ FileSelectScene::FileSelectScene(Services& services, const SavedGame& savedGame,
 
         if (action == FileAction::Save)
         {
-            fileButtons[k]->setPressAction([&, savedGame, k, file = pair.name, this]
+            fileButtons[k]->setPressAction([&, savedGame, k, file = pair.name, globalBounds, this]
             {
-                if (this != getSceneManager().currentScene()) return;
+                if (this != getSceneManager().currentScene() || saving) return;
 
                 services.audioManager.playSound(services.resourceManager.load<Sound>("ui-file-select.wav"));
-                SavedGame::Key key;
-                if (saveSaveToFile(savedGame, file, key))
+                saving = true;
+                services.saveService.requestSave(savedGame, file, [&, savedGame, k, globalBounds, this]
+                    (bool success, SavedGame::Key key)
                 {
+                    saving = false;
+                    if (!success) return;
+                    
                     services.settings.savedKeys[k].key = key;
                     substituteButton = std::move(fileButtons[k]);
                     fileButtons[k] = std::make_unique<UIFileSelectButton>(savedGame, services, k);
@@ -114,7 +110,7 @@ FileSelectScene::FileSelectScene(Services& services, const SavedGame& savedGame,
                     fileButtons[k]->setDepth(60);
                     fileButtons[k]->setGlobalBounds(globalBounds);
                     getSceneManager().popSceneTransition(1s);
-                }
+                });
             });
         }
         else
@@ -160,16 +156,20 @@ FileSelectScene::FileSelectScene(Services& services, const SavedGame& savedGame,
         dummyButton->setDepth(60);
         dummyButton->setGlobalBounds(globalBounds);
         
-        dummyButton->setPressAction([&, savedGame, k, this]
+        dummyButton->setPressAction([&, savedGame, k, globalBounds, this]
         {
-            if (this != getSceneManager().currentScene()) return;
+            if (this != getSceneManager().currentScene() || saving) return;
 
             services.audioManager.playSound(services.resourceManager.load<Sound>("ui-file-select.wav"));
             auto file = getNextFileSlot();
             
-            SavedGame::Key key;
-            if (saveSaveToFile(savedGame, file, key))
+            saving = true;
+            services.saveService.requestSave(savedGame, file, [&, savedGame, k, file, globalBounds, this]
+                (bool success, SavedGame::Key key)
             {
+                saving = false;
+                if (!success) return;
+                
                 services.settings.savedKeys.emplace_back(file, key);
                 substituteButton = std::move(dummyButton);
                 dummyButton = std::make_unique<UIFileSelectButton>(savedGame, services, k);
@@ -177,7 +177,7 @@ FileSelectScene::FileSelectScene(Services& services, const SavedGame& savedGame,
                 dummyButton->setDepth(60);
                 dummyButton->setGlobalBounds(globalBounds);
                 getSceneManager().popSceneTransition(1s);
-            }
+            });
         });
         
         dummyButton->setOverAction([=,&services]
@@ -237,7 +237,7 @@ FileSelectScene::FileSelectScene(Services& services, const SavedGame& savedGame,
         
         cancelButton.setPressAction([&,this]
         {
-            if (this != getSceneManager().currentScene()) return;
+            if (this != getSceneManager().currentScene() || saving) return;
 
             playConfirm(services);
             getSceneManager().popSceneTransition(1s);
@@ -285,6 +285,7 @@ size_t FileSelectScene::getScrollSize() const
 
 void FileSelectScene::update(FrameTime curTime)
 {
+    services.saveService.update();
     if (!scrollBar) return;
     
     size_t k = 0;
@@ -56,6 +56,9 @@ private:
     UIButtonGroup buttonGroup;
     SegmentedSprite headerBackground;
     TextDrawable headerLabel;
+    
+    Services& services;
+    bool saving;
 
 public:
     FileSelectScene(Services& services, const SavedGame& savedGame, FileAction action);
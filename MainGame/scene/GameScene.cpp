@@ -41,6 +41,9 @@
 
 #include "audio/AudioManager.hpp"
 #include "audio/Sound.hpp"
+#include "audio/Music.hpp"
+#include "resources/ResourceLoader.hpp"
+#include "profiler/Profiler.hpp"
 
 #include <functional>
 #include <iterator>
@@ -53,13 +56,18 @@
 #include <execDir.hpp>
 #endif
 
+constexpr auto MusicCrossfadeDuration = 60_frames;
+
+constexpr cpFloat StaticIndexCellSize = 2 * DefaultTileSize;
+constexpr int StaticIndexCells = 1024;
+
 template <typename T>
 T clamp(T cur, T min, T max)
 {
     return cur < min ? min : cur > max ? max : cur;
 }
 
-StringSpecifierMap buildKeySpecifierMap(const Settings& settings, LocalizationManager& lm)
+RawSpecifierMap buildKeySpecifierMap(const Settings& settings, LocalizationManager& lm)
 {
     const auto& key = settings.inputSettings.keyboardSettings;
 
@@ -80,7 +88,7 @@ StringSpecifierMap buildKeySpecifierMap(const Settings& settings, LocalizationMa
         };
 }
 
-StringSpecifierMap buildJoystickSpecifierMap(const Settings& settings, LocalizationManager& lm)
+RawSpecifierMap buildJoystickSpecifierMap(const Settings& settings, LocalizationManager& lm)
 {
     const auto& jtk = settings.inputSettings.joystickSettings;
 
@@ -94,15 +102,16 @@ StringSpecifierMap buildJoystickSpecifierMap(const Settings& settings, Localizat
             {"dashbtn", buildString(jtk.dashInput)},
             {"jumpbtn", buildString(jtk.jumpInput)},
             {"bombbtn", buildString(jtk.bombInput)},
-            {"leftbtn", lm.getString("input-joystick-left")},
-            {"rightbtn", lm.getString("input-joystick-right")},
-            {"upbtn", lm.getString("input-joystick-up")},
-            {"downbtn", lm.getString("input-joystick-down")},
+            {"leftbtn", std::string(lm.getString("input-joystick-left"))},
+            {"rightbtn", std::string(lm.getString("input-joystick-right"))},
+            {"upbtn", std::string(lm.getString("input-joystick-up"))},
+            {"downbtn", std::string(lm.getString("input-joystick-down"))},
         };
 }
 
 GameScene::GameScene(Services& services, SavedGame sg)
-    : room(*this), services(services), sceneRequested(NextScene::None), savedGame(sg),
+    : room(*this), roomPrefetcher(services.resourceManager), particleSystem(services.resourceManager),
+    services(services), sceneRequested(NextScene::None), savedGame(sg),
     inputPlayerController(services.inputManager, services.settings.inputSettings),
     messageBox(services), objectsLoaded(false), curRoomID(-1), requestedID(-1), gui(*this),
     camera(*this), levelTransition(*this), pausing(false), pauseLag(0), currentPlayerController(nullptr)
@@ -111,6 +120,8 @@ GameScene::GameScene(Services& services, SavedGame sg)
 #endif
 {
     gameSpace.setGravity(cpVect{0.0f, 1024.0f});
+    // room geometry is all tile-aligned, which a spatial hash indexes better than a tree
+    gameSpace.useStaticIndex(cp::Space::StaticIndex::SpatialHash, StaticIndexCellSize, StaticIndexCells);
     keysMap = buildKeySpecifierMap(services.settings, services.localizationManager);
     joystickMap = buildJoystickSpecifierMap(services.settings, services.localizationManager);
 }
@@ -138,8 +149,29 @@ void GameScene::loadLevel(std::string levelName)
     }
 #endif
     
+    playLevelMusic();
     reloadLevel();
 }
+
+void GameScene::playLevelMusic()
+{
+    auto& audioManager = services.audioManager;
+    if (levelData->songResourceName.empty())
+    {
+        audioManager.stopMusic(MusicCrossfadeDuration);
+        return;
+    }
+
+    try
+    {
+        audioManager.playMusic(services.resourceManager.load<Music>(levelData->songResourceName), MusicCrossfadeDuration);
+    }
+    catch (const ResourceLoadingError&)
+    {
+        // a missing soundtrack shouldn't prevent the level from being played
+        audioManager.stopMusic(MusicCrossfadeDuration);
+    }
+}
  
 void GameScene::reloadLevel()
 {
@@ -169,6 +201,7 @@ void GameScene::loadRoom(size_t id, bool transition, cpVect displacement, bool d
         if (deletePersistent) gameObjects.clear();
         else gameObjects.erase(std::remove_if(gameObjects.begin(), gameObjects.end(),
             [](const auto& obj) { return !obj->isPersistent; }), gameObjects.end());
+        particleSystem.clear(deletePersistent);
     }
     else
     {
@@ -188,11 +221,14 @@ void GameScene::loadRoom(size_t id, bool transition, cpVect displacement, bool d
         
         gameObjects.erase(std::remove_if(gameObjects.begin(), gameObjects.end(),
             [](const auto& obj) { return !obj; }), gameObjects.end());
-            
+
+        particleSystem.removeTransitionEmitters();
+        particleSystem.notifyScreenTransition(displacement);
     }
     
     currentRoomData = services.resourceManager.load<RoomData>(roomName);
     room.loadRoom(*currentRoomData, transition, displacement);
+    roomPrefetcher.setCurrentRoom(levelData, currentRoomData);
     visibleMaps.at(id) = true;
     objectsLoaded = false;
     
@@ -206,7 +242,9 @@ void GameScene::loadRoomObjects()
     for (const auto& descriptor : currentRoomData->gameObjectDescriptors)
     {
         auto obj = createObjectFromDescriptor(*this, descriptor);
-        if (obj) gameObjects.push_back(std::move(obj));
+        if (!obj) continue;
+        objectRegistry.add(*obj);
+        gameObjects.push_back(std::move(obj));
     }
 
     objectsLoaded = true;
@@ -218,29 +256,27 @@ void GameScene::addObject(std::unique_ptr<GameObject> obj)
     objectsToAdd.push_back(std::move(obj));
 }
 
-GameObject* GameScene::getObjectByName(std::string str)
+GameObject* GameScene::getObjectByName(std::string_view name) const
 {
-    for (const auto& obj : gameObjects)
-        if (obj && obj->getName() == str)
-            return obj.get();
-
-    return nullptr;
+    return objectRegistry.findByName(findObjectName(name));
 }
 
-std::vector<GameObject*> GameScene::getObjectsByName(std::string str)
+const std::vector<GameObject*>& GameScene::getObjectsByName(std::string_view name) const
 {
-    std::vector<GameObject*> objs;
-
-    for (const auto& obj : gameObjects)
-        if (obj && obj->getName() == str)
-            objs.push_back(obj.get());
+    return objectRegistry.findAllByName(findObjectName(name));
+}
 
-    return objs;
+void GameScene::removeObjectsByName(std::string_view name)
+{
+    for (auto obj : getObjectsByName(name)) obj->remove();
 }
 
-void GameScene::removeObjectsByName(std::string str)
+Player* GameScene::getPlayer()
 {
-    for (auto obj : getObjectsByName(str)) if (obj) obj->remove();
+    if (auto player = playerHandle.get()) return player;
+
+    playerHandle = getObjectHandleByName<Player>("player");
+    return playerHandle.get();
 }
 
 cpVect GameScene::wrapPosition(cpVect pos)
@@ -289,7 +325,7 @@ void GameScene::update(FrameTime curTime)
     {
         if (sceneRequested == NextScene::Pause)
         {
-            auto player = getObjectByName<Player>("player");
+            auto player = getPlayer();
             auto scene = new PauseScene(services);
             scene->setMapLevelData(levelData, curRoomID, player->getDisplayPosition(), visibleMaps);
             scene->setCollectedFrameSavedGame(savedGame);
@@ -317,15 +353,30 @@ void GameScene::update(FrameTime curTime)
     }
     
     inputPlayerController.update();
-    gameSpace.step(toSeconds<cpFloat>(UpdatePeriod));
+    {
+        PROFILE_ZONE("cp::Space::step");
+        gameSpace.step(toSeconds<cpFloat>(UpdatePeriod));
+    }
 
     room.update(curTime - pauseLag);
-    for (const auto& obj : gameObjects) obj->update(curTime - pauseLag);
+    for (const auto& obj : gameObjects)
+    {
+        PROFILE_OBJECT_ZONE("GameObject::update", *obj);
+        obj->update(curTime - pauseLag);
+    }
+    {
+        PROFILE_ZONE("ParticleSystem::update");
+        particleSystem.update(curTime - pauseLag);
+    }
 
     gameObjects.erase(std::remove_if(gameObjects.begin(), gameObjects.end(),
         [](const auto& obj) { return obj->shouldRemove; }), gameObjects.end());
 
-    std::move(objectsToAdd.begin(), objectsToAdd.end(), std::back_inserter(gameObjects));
+    for (auto& obj : objectsToAdd)
+    {
+        objectRegistry.add(*obj);
+        gameObjects.push_back(std::move(obj));
+    }
     objectsToAdd.clear();
 
     checkWarps();
@@ -359,11 +410,12 @@ void GameScene::notifyTransitionEnded()
     room.clearTransition();
     gameObjects.erase(std::remove_if(gameObjects.begin(), gameObjects.end(),
         [](const auto& obj) { return obj->transitionState; }), gameObjects.end());
+    particleSystem.removeTransitionEmitters();
 }
 
 void GameScene::checkWarps()
 {
-    auto player = getObjectByName<Player>("player");
+    auto player = getPlayer();
 
     if (player)
     {
@@ -390,6 +442,8 @@ void GameScene::checkWarps()
             checkWarp(player, WarpData::Dir::Up, pos);
         }
         if (!objectsLoaded) loadRoomObjects();
+
+        roomPrefetcher.update(player->getPosition());
     }
 }
 
@@ -448,7 +502,12 @@ void GameScene::render(Renderer& renderer)
     
     renderer.currentTransform.translate(camera.getGlobalDisplacement());
     room.render(renderer, camera.transitionOccuring());
-    for (const auto& obj : gameObjects) obj->render(renderer);
+    for (const auto& obj : gameObjects)
+    {
+        PROFILE_OBJECT_ZONE("GameObject::render", *obj);
+        obj->render(renderer);
+    }
+    particleSystem.render(renderer);
 
 #if CP_DEBUG
     renderer.pushDrawable(debug, {}, 800);
@@ -469,7 +528,7 @@ void GameScene::resume()
     joystickMap = buildJoystickSpecifierMap(services.settings, services.localizationManager);
 }
 
-const StringSpecifierMap& GameScene::getInputSpecifierMap() const
+const RawSpecifierMap& GameScene::getInputSpecifierMap() const
 {
     if (services.inputManager.isJoystickCurrent()) return joystickMap;
     else return keysMap;
@@ -31,7 +31,10 @@
 #include "objects/Camera.hpp"
 #include "objects/LevelTransition.hpp"
 #include "objects/MessageBox.hpp"
+#include "objects/ObjectRegistry.hpp"
 #include "gameplay/LevelPersistentData.hpp"
+#include "gameplay/RoomPrefetcher.hpp"
+#include "particles/ParticleSystem.hpp"
 
 #include "settings/Settings.hpp"
 #include "gameplay/SavedGame.hpp"
@@ -47,6 +50,7 @@
 #include <chronoUtils.hpp>
 #include <type_traits>
 #include <exception>
+#include <string_view>
 
 #define CP_DEBUG 0
 
@@ -75,7 +79,12 @@ class GameScene : public Scene
     LevelPersistentData levelPersistentData;
 
     std::shared_ptr<RoomData> currentRoomData;
+    RoomPrefetcher roomPrefetcher;
+    // declared before the object lists, so it outlives the objects that unregister from it
+    ObjectRegistry objectRegistry;
     std::vector<std::unique_ptr<GameObject>> gameObjects, objectsToAdd;
+    ObjectHandle<Player> playerHandle;
+    ParticleSystem particleSystem;
     size_t curRoomID, requestedID;
     bool objectsLoaded, pausing;
     std::vector<bool> visibleMaps;
@@ -92,7 +101,7 @@ class GameScene : public Scene
     LevelTransition levelTransition;
     MessageBox messageBox;
     Script cutsceneScript;
-    StringSpecifierMap keysMap, joystickMap;
+    RawSpecifierMap keysMap, joystickMap;
     
     FrameTime curTime;
     FrameDuration pauseLag;
@@ -122,8 +131,10 @@ public:
     LocalizationManager& getLocalizationManager() const { return services.localizationManager; }
     AudioManager& getAudioManager() const { return services.audioManager; }
     LevelPersistentData& getLevelPersistentData() { return levelPersistentData; }
+    ParticleSystem& getParticleSystem() { return particleSystem; }
 
     void loadLevel(std::string levelName);
+    void playLevelMusic();
     void reloadLevel();
     void loadRoom(size_t id, bool transition = false, cpVect displacement = cpVect{0,0}, bool deletePersistent = false);
     void loadRoomObjects();
@@ -139,7 +150,7 @@ public:
         nextLevelRequested = nextLevel;
     }
 
-    const StringSpecifierMap& getInputSpecifierMap() const;
+    const RawSpecifierMap& getInputSpecifierMap() const;
 
     const PlayerController& getPlayerController() const
     {
@@ -150,14 +161,27 @@ public:
     void resetPlayerController();
 
     void addObject(std::unique_ptr<GameObject> obj);
-    GameObject* getObjectByName(std::string str);
+    GameObject* getObjectByName(std::string_view name) const;
 
     template <typename T>
     std::enable_if_t<std::is_base_of<GameObject, T>::value && !std::is_same<GameObject, T>::value, T*>
-    getObjectByName(std::string str) { return dynamic_cast<T*>(getObjectByName(str)); }
+    getObjectByName(std::string_view name) const { return dynamic_cast<T*>(getObjectByName(name)); }
 
-    std::vector<GameObject*> getObjectsByName(std::string str);
-    void removeObjectsByName(std::string str);
+    const std::vector<GameObject*>& getObjectsByName(std::string_view name) const;
+    void removeObjectsByName(std::string_view name);
+
+    template <typename T>
+    ObjectHandle<T> getObjectHandle(T& obj) const { return objectRegistry.getHandle(obj); }
+
+    template <typename T>
+    ObjectHandle<T> getObjectHandleByName(std::string_view name) const
+    {
+        auto obj = getObjectByName<T>(name);
+        return obj ? objectRegistry.getHandle(*obj) : ObjectHandle<T>();
+    }
+
+    // the object named "player", through a cached handle
+    Player* getPlayer();
 
     Script& getCutsceneScript() { return cutsceneScript; }
     const Script& getCutsceneScript() const { return cutsceneScript; }
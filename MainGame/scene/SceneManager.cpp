@@ -26,6 +26,7 @@
 #include "rendering/Renderer.hpp"
 
 #include "Transition.hpp"
+#include "profiler/Profiler.hpp"
 
 SceneManager::SceneManager() : sceneStack(), scheduledOperation(None), operationScene(), popCount(0)
 {
@@ -125,6 +126,7 @@ void SceneManager::handleScreenTransition()
 
 void SceneManager::update(FrameTime curTime)
 {
+    PROFILE_ZONE("SceneManager::update");
     this->curTime = curTime;
     handleScreenTransition();
 
@@ -143,6 +145,7 @@ void SceneManager::update(FrameTime curTime)
 
 void SceneManager::render(Renderer& renderer)
 {
+    PROFILE_ZONE("SceneManager::render");
     if (sceneStack.empty()) return;
     auto it = sceneStack.rbegin();
     do
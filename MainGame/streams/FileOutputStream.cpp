@@ -40,6 +40,15 @@ bool FileOutputStream::openForAppending(const std::string& filename)
     return (file = std::fopen(filename.c_str(), "ab")) != nullptr;
 }
 
+// Reports the errors of the buffered writes, which fclose only flushes now
+bool FileOutputStream::close()
+{
+    if (!file) return false;
+    bool success = std::fclose(file) == 0;
+    file = nullptr;
+    return success;
+}
+
 bool FileOutputStream::write(const void* data, size_t size)
 {
     if (!file) return false;
@@ -37,5 +37,6 @@ public:
 
     bool open(const std::string& filename);
     bool openForAppending(const std::string& filename);
+    bool close();
     virtual bool write(const void* data, size_t size) override;
 };
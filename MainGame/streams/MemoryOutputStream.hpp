@@ -33,10 +33,13 @@ class MemoryOutputStream final : public OutputStream
     
 public:
     MemoryOutputStream() {}
+    // Writes over a recycled buffer, keeping its capacity
+    explicit MemoryOutputStream(std::vector<uint8_t> buffer) : contents(std::move(buffer)) { contents.clear(); }
     ~MemoryOutputStream() {}
     
     virtual bool write(const void* data, size_t size) override;
     void alignTo(size_t align);
     auto& getContents() { contents.shrink_to_fit(); return contents; }
     const auto& getContents() const { return contents; }
+    std::vector<uint8_t> takeContents() { return std::move(contents); }
 };
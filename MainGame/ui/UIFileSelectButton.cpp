@@ -85,7 +85,7 @@ UIFileSelectButton::UIFileSelectButton(const SavedGame& sg, Services& services,
     showSecretPowerups = sg.getDoubleArmor() || sg.getMoveRegen();
 
     auto& lm = services.localizationManager;
-    auto indexStr = lm.getFormattedString("file-select-index", {}, { { "i", index+1 } }, {});
+    std::string indexStr(lm.getFormattedString("file-select-index", { SpecifierArgument::fromNumber("i", index+1) }));
     fileName.setFontHandler(loadDefaultFont(services));
     fileName.setString(indexStr + ' ' + getLevelNameForNumber(lm, sg.getCurLevel()));
     fileName.setFontSize(TextSize);
@@ -99,7 +99,8 @@ UIFileSelectButton::UIFileSelectButton(const SavedGame& sg, Services& services,
     configTextDrawable(fileName, lm);
     fileName.buildGeometry();
 
-    auto gtStr = lm.getFormattedString("file-select-golden-token-count", {}, { { "n", sg.getGoldenTokenCount() } }, {});
+    auto gtStr = lm.getFormattedString("file-select-golden-token-count",
+        { SpecifierArgument::fromNumber("n", sg.getGoldenTokenCount()) });
     goldenTokenAmount.setFontHandler(loadDefaultFont(services));
     goldenTokenAmount.setString(gtStr);
     goldenTokenAmount.setFontSize(TextSize);
@@ -111,7 +112,7 @@ UIFileSelectButton::UIFileSelectButton(const SavedGame& sg, Services& services,
     configTextDrawable(goldenTokenAmount, lm);
     goldenTokenAmount.buildGeometry();
 
-    auto pStr = lm.getFormattedString("file-select-picket-count", {}, { { "n", sg.getPicketCount() } }, {});
+    auto pStr = lm.getFormattedString("file-select-picket-count", { SpecifierArgument::fromNumber("n", sg.getPicketCount()) });
     picketAmount.setFontHandler(loadDefaultFont(services));
     picketAmount.setString(pStr);
     picketAmount.setFontSize(TextSize);
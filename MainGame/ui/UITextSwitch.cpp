@@ -112,7 +112,7 @@ void createCommonTextSwitch(UITextSwitch& button, Services& services,
     caption.setWordWrappingWidth(destRect.width - 2 * captionDisplacement.x);
     caption.setWordAlignment(TextDrawable::Alignment::Inverse);
     
-    button.setTrueString(services.localizationManager.getString("ui-switch-yes"));
-    button.setFalseString(services.localizationManager.getString("ui-switch-no"));
+    button.setTrueString(std::string(services.localizationManager.getString("ui-switch-yes")));
+    button.setFalseString(std::string(services.localizationManager.getString("ui-switch-no")));
     button.resetText();
 }
@@ -25,16 +25,20 @@
 #include <harfbuzz/hb.h>
 #include <harfbuzz/hb-ot.h>
 
-HarfBuzzWrapper::HarfBuzzWrapper(const char* data, size_t size)
+HarfBuzzWrapper::HarfBuzzWrapper(const char* data, size_t size) : fontSize(0)
 {
     blob = hb_blob_create(data, size, HB_MEMORY_MODE_READONLY, nullptr, nullptr);
     face = hb_face_create(blob, 0);
     font = hb_font_create(face);
     hb_ot_font_set_funcs(font);
+    
+    buffer = hb_buffer_create();
+    hb_buffer_set_cluster_level(buffer, HB_BUFFER_CLUSTER_LEVEL_MONOTONE_GRAPHEMES);
 }
 
 HarfBuzzWrapper::~HarfBuzzWrapper()
 {
+    if (buffer) hb_buffer_destroy(buffer);
     if (font) hb_font_destroy(font);
     if (face) hb_face_destroy(face);
     if (blob) hb_blob_destroy(blob);
@@ -42,15 +46,24 @@ HarfBuzzWrapper::~HarfBuzzWrapper()
 
 void HarfBuzzWrapper::setFontSize(size_t size)
 {
+    if (fontSize == size) return;
+    
+    fontSize = size;
     hb_font_set_scale(font, size, size);
 }
 
-StringProperties HarfBuzzWrapper::shape(const char* string, size_t strSize)
+const StringProperties& HarfBuzzWrapper::shape(const char* string, size_t strSize)
 {
-    hb_buffer_t* buffer = hb_buffer_create();
+    runKey.assign((const char*)&fontSize, sizeof(size_t));
+    runKey.append(string, strSize);
+    
+    auto it = shapedRuns.find(runKey);
+    if (it != shapedRuns.end()) return it->second;
+    
+    // clear_contents keeps the cluster level set up on construction
+    hb_buffer_clear_contents(buffer);
     hb_buffer_add_utf8(buffer, string, strSize, 0, strSize);
     hb_buffer_guess_segment_properties(buffer);
-    hb_buffer_set_cluster_level(buffer, HB_BUFFER_CLUSTER_LEVEL_MONOTONE_GRAPHEMES);
     
     hb_shape(font, buffer, nullptr, 0);
     
@@ -58,11 +71,12 @@ StringProperties HarfBuzzWrapper::shape(const char* string, size_t strSize)
     hb_glyph_info_t *info = hb_buffer_get_glyph_infos(buffer, &glyphCount);
     hb_glyph_position_t *positions = hb_buffer_get_glyph_positions(buffer, &glyphCount);
     
-    std::vector<StringProperties::GlyphData> glyphs;
+    if (shapedRuns.size() >= MaxCachedRuns) shapedRuns.clear();
+    auto& properties = shapedRuns[runKey];
     
     size_t prevCluster = (size_t)-1;
     size_t clusterIndex = (size_t)-1;
-    glyphs.reserve(glyphCount);
+    properties.glyphs.reserve(glyphCount);
     for (size_t i = 0; i < glyphCount; i++)
     {
         if (prevCluster != info[i].cluster)
@@ -71,14 +85,14 @@ StringProperties HarfBuzzWrapper::shape(const char* string, size_t strSize)
             clusterIndex++;
         }
         
-        glyphs.push_back({ info[i].codepoint, clusterIndex,
+        properties.glyphs.push_back({ info[i].codepoint, clusterIndex,
             sf::Vector2f(positions[i].x_offset, -positions[i].y_offset),
             sf::Vector2f(positions[i].x_advance, -positions[i].y_advance) });
     }
     
-    hb_segment_properties_t properties;
-    hb_buffer_get_segment_properties(buffer, &properties);
+    hb_segment_properties_t segmentProperties;
+    hb_buffer_get_segment_properties(buffer, &segmentProperties);
+    properties.isRTL = HB_DIRECTION_IS_BACKWARD(segmentProperties.direction);
     
-    hb_buffer_destroy(buffer);
-    return { HB_DIRECTION_IS_BACKWARD(properties.direction), glyphs };
+    return properties;
 }
@@ -27,6 +27,7 @@
 #include <cstdint>
 #include <string>
 #include <vector>
+#include <unordered_map>
 #include <harfbuzz/hb.h>
 
 struct StringProperties
@@ -47,11 +48,26 @@ class HarfBuzzWrapper final
     hb_blob_t* blob;
     hb_face_t* face;
     hb_font_t* font;
+    hb_buffer_t* buffer;
+    size_t fontSize;
+    
+    // Shaped runs keyed by font size and text, so text laid out again (menus,
+    // message boxes, HUD labels) skips HarfBuzz entirely; the direction is
+    // guessed from the text itself, so it needs no place in the key
+    static constexpr size_t MaxCachedRuns = 4096;
+    std::unordered_map<std::string,StringProperties> shapedRuns;
+    std::string runKey;
     
 public:
     HarfBuzzWrapper(const char* data, size_t size);
     ~HarfBuzzWrapper();
     
+    HarfBuzzWrapper(const HarfBuzzWrapper&) = delete;
+    HarfBuzzWrapper& operator=(const HarfBuzzWrapper&) = delete;
+    
     void setFontSize(size_t size);
-    StringProperties shape(const char* string, size_t strSize);
+    
+    // The returned reference stays valid until the next call to shape
+    const StringProperties& shape(const char* string, size_t strSize);
+    void clearCache() { shapedRuns.clear(); }
 };